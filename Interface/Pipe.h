@@ -8,6 +8,20 @@
 
 class IPipeThrottler;
 
+struct SPipeBuffer
+{
+	SPipeBuffer()
+		: buf(NULL), bsize(0)
+	{}
+
+	SPipeBuffer(const char* buf, size_t bsize)
+		: buf(buf), bsize(bsize)
+	{}
+
+	const char* buf;
+	size_t bsize;
+};
+
 class IPipe : public IObject
 {
 public:
@@ -21,6 +35,47 @@ public:
 
 	virtual bool Flush(int timeoutms=-1)=0;
 
+	/**
+	* Writes the buffers as if they were concatenated. Pipes overwrite this
+	* to pass the buffers to the next layer without copying them together.
+	* @param timeoutms -1 for blocking >=0 to block only for x ms. Default: blocking
+	*/
+	virtual bool Writev(const SPipeBuffer* bufs, size_t n_bufs, int timeoutms=-1, bool flush=true)
+	{
+		for (size_t i = 0; i < n_bufs; ++i)
+		{
+			if (!Write(bufs[i].buf, bufs[i].bsize, timeoutms, flush && i + 1 == n_bufs))
+			{
+				return false;
+			}
+		}
+		if (n_bufs == 0 && flush)
+		{
+			return Flush(timeoutms);
+		}
+		return true;
+	}
+
+	/**
+	* Reads directly into buffer until at least min_size bytes (at most bsize bytes)
+	* have been read. Returns less than min_size on error or timeout.
+	* @param timeoutms -1 for blocking >=0 to block only for x ms for each read from the pipe. Default: blocking
+	*/
+	virtual size_t ReadInto(char *buffer, size_t bsize, size_t min_size, int timeoutms=-1)
+	{
+		size_t read = 0;
+		do
+		{
+			size_t rc = Read(buffer + read, bsize - read, timeoutms);
+			if (rc == 0)
+			{
+				break;
+			}
+			read += rc;
+		} while (read < min_size && read < bsize);
+		return read;
+	}
+
 	/**
 	* @param timeoutms -1 for blocking >=0 to block only for x ms. Default: nonblocking
 	*/
@@ -18,6 +18,14 @@ public:
 	virtual bool addBytes(size_t n_bytes, bool wait)=0;
 	virtual void changeThrottleLimit(size_t bps, bool p_percent_max)=0;
 	virtual void changeThrottleUpdater(IPipeThrottlerUpdater* new_updater)=0;
+
+	//Bytes added to this throttler are also charged to the parent.
+	//Siblings share the parent's bandwidth proportional to their weight
+	virtual void setParent(IPipeThrottler* parent, unsigned int weight)=0;
+
+	//Total time callers of addBytes spent waiting on this throttler
+	//or its parents (in microseconds)
+	virtual int64 getThrottleWaitTimeUs()=0;
 };
 
 
@@ -0,0 +1,20 @@
+#ifndef IRINGBUFFERPIPE_H
+#define IRINGBUFFERPIPE_H
+
+#include "Pipe.h"
+
+/**
+* Bounded in-process message pipe. Messages are stored in a preallocated
+* ring buffer, so writing and reading does not allocate (except for messages
+* larger than half of the capacity). Writers block if the pipe is full.
+*
+* Only one thread may read. Only one thread may write unless the pipe was
+* created with multi_producer=true.
+*/
+class IRingBufferPipe : public IPipe
+{
+public:
+	virtual size_t getCapacity(void)=0;
+};
+
+#endif //IRINGBUFFERPIPE_H
@@ -22,6 +22,7 @@ class ISharedMutex;
 class IThread;
 class ISettingsReader;
 class IPipe;
+class IRingBufferPipe;
 class IFile;
 class IFsFile;
 class IOutputStream;
@@ -104,6 +105,7 @@ public:
 	virtual bool createThread(IThread *thread, const std::string& name=std::string(), CreateThreadFlags flags = CreateThreadFlags_None)=0;
 	virtual void setCurrentThreadName(const std::string& name) = 0;
 	virtual IPipe *createMemoryPipe(void)=0;
+	virtual IRingBufferPipe *createRingBufferPipe(size_t capacity, bool multi_producer=false)=0;
 	virtual IThreadPool *getThreadPool(void)=0;
 	virtual ISettingsReader* createFileSettingsReader(const std::string& pFile)=0;
 	virtual ISettingsReader* createDBSettingsReader(THREAD_ID tid, DATABASE_ID pIdentifier, const std::string &pTable, const std::string &pSQL="")=0;
@@ -20,9 +20,50 @@
 #include "Server.h"
 #include "Interface/Mutex.h"
 #include "stringtools.h"
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <limits>
+#include <algorithm>
 
 #define DLOG(x) //x
 
+namespace
+{
+	//Bytes a throttler may pass without waiting after being idle
+	const int64 throttle_burst_ms = 100;
+	const size_t throttle_min_burst = 32*1024;
+
+	//Waiters check again after this time even if not woken up
+	const int64 throttle_recheck_us = 100*1000;
+
+	const int64 eligible_never = (std::numeric_limits<int64>::max)();
+
+	const size_t max_idle_flows = 64;
+
+	int64 getTimeUs()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+struct PipeThrottler::SWaiter
+{
+	SWaiter(PipeThrottler* node, size_t bytes, THREAD_ID flow, int64 starttime)
+		: node(node), bytes(bytes), flow(flow), starttime(starttime),
+		granted(false)
+	{}
+
+	PipeThrottler* node;
+	size_t bytes;
+	THREAD_ID flow;
+	int64 starttime;
+	bool granted;
+	queue_t::iterator queue_it;
+	std::condition_variable cond;
+};
+
 PipeThrottler::PipeThrottler(size_t bps,
 	bool percent_max,
 	IPipeThrottlerUpdater* updater)
@@ -31,7 +72,10 @@ PipeThrottler::PipeThrottler(size_t bps,
 	throttle_state(ThrottleState_Probe),
 	lastprobetime(0), probe_bps(0),
 	throttle_percent(bps), last_probe_result(0),
-	probe_interval(10 * 60 * 1000)
+	probe_interval(10 * 60 * 1000), tree_mutex(std::make_shared<std::mutex>()),
+	parent(NULL), weight(1),
+	tokens(static_cast<double>(throttle_min_burst)), lastrefilltime(getTimeUs()),
+	vtime(0), in_parent_queue(false), parent_finish(0), wait_time(0)
 {
 	mutex=Server->createMutex();
 	lastupdatetime=Server->getTimeMS();
@@ -47,41 +91,231 @@ PipeThrottler::PipeThrottler(size_t bps,
 
 PipeThrottler::~PipeThrottler(void)
 {
+	{
+		std::unique_lock<std::mutex> lock;
+		std::shared_ptr<std::mutex> curr_tree = lockTree(lock);
+
+		detachParent();
+
+		//The children become roots of their own trees
+		for(size_t i=0;i<children.size();++i)
+		{
+			children[i]->parent=NULL;
+			children[i]->in_parent_queue=false;
+			children[i]->setTreeMutex(std::make_shared<std::mutex>());
+		}
+	}
+
 	Server->destroy(mutex);
 }
 
 bool PipeThrottler::addBytes(size_t new_bytes, bool wait)
 {
-	IScopedLock lock(mutex);
-
-	if(throttle_bps==0) return true;
+	std::unique_lock<std::mutex> lock;
+	std::shared_ptr<std::mutex> curr_tree = lockTree(lock);
 
 	int64 ctime=Server->getTimeMS();
 
-	if(updater.get() && update_time_interval>=0 &&
-		ctime-lastupdatetime>update_time_interval)
+	std::vector<PipeThrottler*> update_nodes;
+	for(PipeThrottler* node=this;node!=NULL;node=node->parent)
+	{
+		if(node->update_time_interval>=0 &&
+			ctime-node->lastupdatetime>node->update_time_interval)
+		{
+			node->lastupdatetime=ctime;
+			update_nodes.push_back(node);
+		}
+	}
+
+	if(!update_nodes.empty())
+	{
+		lock.unlock();
+		for(size_t i=0;i<update_nodes.size();++i)
+		{
+			update_nodes[i]->updateLimit();
+		}
+		curr_tree = lockTree(lock);
+	}
+
+	//Fast path if no throttler on the path to the root is limited
+	bool unlimited=true;
+	for(PipeThrottler* node=this;node!=NULL;node=node->parent)
+	{
+		if(node->currentRate()!=0 || !node->queue.empty())
+		{
+			unlimited=false;
+			break;
+		}
+	}
+
+	if(unlimited)
 	{
-		size_t new_throttle_bps = updater->getThrottleLimit(percent_max);
+		for(PipeThrottler* node=this;node!=NULL;node=node->parent)
+		{
+			node->countBytes(new_bytes, ctime);
+		}
+		return true;
+	}
+
+	int64 ctime_us=getTimeUs();
 
-		if (percent_max)
+	if(!wait || new_bytes==0)
+	{
+		//Charge all throttlers without queueing and only
+		//report if one of them is over its limit
+		bool ret=true;
+		int64 next_eligible=eligible_never;
+		for(PipeThrottler* node=this;node!=NULL;node=node->parent)
 		{
-			throttle_percent = new_throttle_bps;
-			if (throttle_percent == 0)
+			if(!node->hasTokens(ctime_us, next_eligible))
+			{
+				ret=false;
+			}
+
+			if(new_bytes>0)
 			{
-				throttle_bps = 0;
+				if(node->currentRate()>0)
+				{
+					node->tokens-=new_bytes;
+				}
+				node->countBytes(new_bytes, ctime);
 			}
 		}
-		else
+		return ret;
+	}
+
+	SWaiter waiter(this, new_bytes, Server->getThreadID(), ctime_us);
+	enqueue(&waiter);
+
+	bool waited=false;
+	while(true)
+	{
+		int64 next_eligible;
+		getRoot()->dispatch(ctime_us, next_eligible);
+
+		if(waiter.granted)
+		{
+			break;
+		}
+
+		waited=true;
+
+		int64 wait_until = (std::min)(next_eligible, ctime_us+throttle_recheck_us);
+
+		DLOG(Server->Log("Throttler: Waiting for " + convert(wait_until-ctime_us)+ "us", LL_DEBUG));
+
+		waiter.cond.wait_until(lock, std::chrono::steady_clock::time_point(
+			std::chrono::microseconds(wait_until)));
+
+		if(std::atomic_load(&tree_mutex)!=curr_tree)
 		{
-			throttle_bps = new_throttle_bps;
+			//Moved to another tree while waiting
+			lock.unlock();
+			curr_tree = lockTree(lock);
 		}
 
-		lastupdatetime = ctime;
-		if(throttle_bps==0) return true;
+		ctime_us=getTimeUs();
+	}
+
+	return !waited;
+}
+
+void PipeThrottler::updateLimit(void)
+{
+	IScopedLock lock(mutex);
+
+	if(updater.get()==NULL)
+	{
+		return;
 	}
 
-	if (percent_max &&
-		throttle_state == ThrottleState_Throttle
+	bool new_percent_max;
+	size_t new_throttle_bps = updater->getThrottleLimit(new_percent_max);
+
+	std::unique_lock<std::mutex> tree_lock;
+	std::shared_ptr<std::mutex> curr_tree = lockTree(tree_lock);
+
+	percent_max = new_percent_max;
+
+	if (percent_max)
+	{
+		throttle_percent = new_throttle_bps;
+		if (throttle_percent == 0)
+		{
+			throttle_bps = 0;
+		}
+	}
+	else
+	{
+		throttle_bps = new_throttle_bps;
+	}
+
+	wakeWaiters();
+}
+
+size_t PipeThrottler::currentRate(void)
+{
+	if (percent_max && throttle_state == ThrottleState_Probe)
+	{
+		return 0;
+	}
+
+	return throttle_bps;
+}
+
+void PipeThrottler::refill(int64 ctime_us)
+{
+	size_t rate=currentRate();
+
+	if(rate==0)
+	{
+		tokens = static_cast<double>(throttle_min_burst);
+	}
+	else if(ctime_us>lastrefilltime)
+	{
+		double burst = (std::max)(static_cast<double>(throttle_min_burst),
+			(static_cast<double>(rate)*throttle_burst_ms)/1000);
+
+		tokens += (static_cast<double>(ctime_us-lastrefilltime)*rate)/1000000;
+
+		if(tokens>burst)
+		{
+			tokens=burst;
+		}
+	}
+
+	lastrefilltime=ctime_us;
+}
+
+bool PipeThrottler::hasTokens(int64 ctime_us, int64& next_eligible_us)
+{
+	size_t rate=currentRate();
+	if(rate==0)
+	{
+		return true;
+	}
+
+	refill(ctime_us);
+
+	if(tokens>0)
+	{
+		return true;
+	}
+
+	int64 eligible_us = ctime_us + static_cast<int64>((-tokens*1000000)/rate) + 1;
+	next_eligible_us = (std::min)(next_eligible_us, eligible_us);
+
+	return false;
+}
+
+void PipeThrottler::countBytes(size_t new_bytes, int64 ctime)
+{
+	if(!percent_max)
+	{
+		return;
+	}
+
+	if (throttle_state == ThrottleState_Throttle
 		&& ctime - lastprobetime > static_cast<int64>(probe_interval))
 	{
 		throttle_state = ThrottleState_Probe;
@@ -91,10 +325,11 @@ bool PipeThrottler::addBytes(size_t new_bytes, bool wait)
 
 	if(ctime-lastresettime>1000)
 	{
-		if (percent_max && throttle_state == ThrottleState_Probe)
+		int64 passed_time = ctime - lastresettime;
+		float bps = (curr_bytes * 1000.f) / passed_time;
+
+		if (throttle_state == ThrottleState_Probe)
 		{
-			int64 passed_time = ctime - lastresettime;
-			float bps = (curr_bytes * 1000.f) / passed_time;
 			if (bps > 10 * 1024)
 			{
 				if (probe_bps == 0)
@@ -115,7 +350,7 @@ bool PipeThrottler::addBytes(size_t new_bytes, bool wait)
 							+ " throttling "+convert(throttle_percent)+"% to "+PrettyPrintSpeed(throttle_bps), LL_DEBUG);
 						lastprobetime = ctime;
 						throttle_state = ThrottleState_Throttle;
-						
+						tokens = static_cast<double>(throttle_min_burst);
 
 						if (last_probe_result != 0)
 						{
@@ -148,87 +383,245 @@ bool PipeThrottler::addBytes(size_t new_bytes, bool wait)
 					" during probing for max speed because it is too low", LL_DEBUG);
 			}
 		}
+		else if (bps > 1.1f*last_probe_result)
+		{
+			Server->Log("PROBE Current speed per second at " + PrettyPrintSpeed(static_cast<size_t>(bps + 0.5f)) +
+				" 10% higher than max speed during probe at " + PrettyPrintSpeed(static_cast<size_t>(last_probe_result + 0.5f)) +
+				". Reprobing for max speed.", LL_DEBUG);
+			throttle_state = ThrottleState_Probe;
+			probe_bps = 0;
+		}
 
 		lastresettime=ctime;
 		curr_bytes=0;
 	}
 
 	curr_bytes += new_bytes;
+}
 
-	if (percent_max && throttle_state == ThrottleState_Probe)
+PipeThrottler* PipeThrottler::getRoot(void)
+{
+	PipeThrottler* node=this;
+	while(node->parent!=NULL)
 	{
-		return true;
+		node=node->parent;
 	}
+	return node;
+}
 
-	int64 passed_time=ctime-lastresettime;
+void PipeThrottler::enqueue(SWaiter* waiter)
+{
+	double start = vtime;
 
-	size_t maxRateTime=(size_t)(((_i64)curr_bytes*1000)/throttle_bps);
-	if(passed_time>0)
+	std::map<THREAD_ID, double>::iterator it=flow_finish.find(waiter->flow);
+	if(it!=flow_finish.end() && it->second>start)
 	{
-		size_t bps=(size_t)(((_i64)curr_bytes*1000)/passed_time);
+		start = it->second;
+	}
 
-		if (throttle_state == ThrottleState_Throttle
-			&& curr_bytes > static_cast<size_t>(1.1f*last_probe_result+0.5f))
+	waiter->queue_it = queue.insert(std::make_pair(start, SQueueEntry(NULL, waiter)));
+
+	activate();
+}
+
+void PipeThrottler::dequeue(SWaiter* waiter, size_t served_bytes)
+{
+	PipeThrottler* node=waiter->node;
+
+	node->vtime = waiter->queue_it->first;
+	node->queue.erase(waiter->queue_it);
+	node->flow_finish[waiter->flow] = node->vtime + served_bytes;
+
+	if(node->flow_finish.size()>max_idle_flows)
+	{
+		for(std::map<THREAD_ID, double>::iterator it=node->flow_finish.begin();
+			it!=node->flow_finish.end();)
 		{
-			Server->Log("PROBE Current speed per second at " + PrettyPrintSpeed(curr_bytes) +
-				" 10% higher than max speed during probe at " + PrettyPrintSpeed(static_cast<size_t>(last_probe_result + 0.5f)) +
-				". Reprobing for max speed.", LL_DEBUG);
-			throttle_state = ThrottleState_Probe;
-			probe_bps = 0;
-			return true;
+			if(it->second<=node->vtime)
+			{
+				node->flow_finish.erase(it++);
+			}
+			else
+			{
+				++it;
+			}
 		}
+	}
 
-		if(bps>throttle_bps)
-		{		
-			unsigned int sleepTime=(unsigned int)(maxRateTime-passed_time);
+	//Advance the start tags of all throttlers on the path
+	//in the queues of their parents
+	while(node->in_parent_queue)
+	{
+		PipeThrottler* p=node->parent;
 
-			if(sleepTime>0)
-			{
-				if(wait)
-				{
-					DLOG(Server->Log("Throttler: Sleeping for " + convert(sleepTime)+ "ms", LL_DEBUG));
-					Server->wait(sleepTime);
+		p->vtime = node->parent_queue_it->first;
+		p->queue.erase(node->parent_queue_it);
+		node->parent_finish = p->vtime + served_bytes/node->weight;
 
-					if(Server->getTimeMS()-lastresettime>1000)
-					{
-						curr_bytes=0;
-						lastresettime=Server->getTimeMS();
-					}
-				}
+		if(node->queue.empty())
+		{
+			node->in_parent_queue=false;
+		}
+		else
+		{
+			node->parent_queue_it = p->queue.insert(std::make_pair(node->parent_finish, SQueueEntry(node, NULL)));
+		}
 
-				return false;
-			}
+		node=p;
+	}
+}
+
+void PipeThrottler::activate(void)
+{
+	PipeThrottler* node=this;
+	while(node->parent!=NULL && !node->in_parent_queue)
+	{
+		PipeThrottler* p=node->parent;
+		double start = (std::max)(p->vtime, node->parent_finish);
+		node->parent_queue_it = p->queue.insert(std::make_pair(start, SQueueEntry(node, NULL)));
+		node->in_parent_queue=true;
+		node=p;
+	}
+}
+
+void PipeThrottler::deactivate(void)
+{
+	PipeThrottler* node=this;
+	while(node->queue.empty() && node->in_parent_queue)
+	{
+		node->parent->queue.erase(node->parent_queue_it);
+		node->in_parent_queue=false;
+		node=node->parent;
+	}
+}
+
+PipeThrottler::SWaiter* PipeThrottler::select(int64 ctime_us, int64& next_eligible_us)
+{
+	if(!hasTokens(ctime_us, next_eligible_us))
+	{
+		return NULL;
+	}
+
+	//Lowest start tag first. Children which are over their own
+	//limit are skipped, so the remaining bandwidth is shared
+	for(queue_t::iterator it=queue.begin();it!=queue.end();++it)
+	{
+		if(it->second.waiter!=NULL)
+		{
+			return it->second.waiter;
+		}
+
+		SWaiter* ret = it->second.child->select(ctime_us, next_eligible_us);
+		if(ret!=NULL)
+		{
+			return ret;
 		}
 	}
-	else if(curr_bytes>=throttle_bps)
+
+	return NULL;
+}
+
+void PipeThrottler::serve(SWaiter* waiter, int64 ctime_us)
+{
+	int64 ctime=Server->getTimeMS();
+	int64 waited=ctime_us-waiter->starttime;
+
+	for(PipeThrottler* node=waiter->node;node!=NULL;node=node->parent)
 	{
-		if (throttle_state == ThrottleState_Throttle
-			&& curr_bytes > static_cast<size_t>(1.1f*last_probe_result + 0.5f))
+		if(node->currentRate()>0)
 		{
-			Server->Log("PROBE 2 Current speed per second at " + PrettyPrintSpeed(curr_bytes) +
-				" significantly higher than max speed during probe at " + PrettyPrintSpeed(static_cast<size_t>(last_probe_result + 0.5f)) +
-				". Reprobing for max speed.", LL_DEBUG);
-			throttle_state = ThrottleState_Probe;
-			probe_bps = 0;
-			return true;
+			node->refill(ctime_us);
+			node->tokens-=waiter->bytes;
 		}
+		node->countBytes(waiter->bytes, ctime);
+		node->wait_time+=waited;
+	}
+
+	dequeue(waiter, waiter->bytes);
+	waiter->granted=true;
+}
+
+void PipeThrottler::dispatch(int64 ctime_us, int64& next_eligible_us)
+{
+	while(true)
+	{
+		next_eligible_us=eligible_never;
 
-		if(wait)
+		SWaiter* waiter = select(ctime_us, next_eligible_us);
+		if(waiter==NULL)
 		{
-			DLOG(Server->Log("Throttler: Sleeping for " + convert(maxRateTime)+ "ms", LL_DEBUG));
-			Server->wait(static_cast<unsigned int>(maxRateTime));
+			return;
 		}
-		curr_bytes=0;
-		lastresettime=Server->getTimeMS();
-		return false;
+
+		serve(waiter, ctime_us);
+		waiter->cond.notify_one();
 	}
+}
 
-	return true;
+void PipeThrottler::wakeWaiters(void)
+{
+	for(queue_t::iterator it=queue.begin();it!=queue.end();++it)
+	{
+		if(it->second.waiter!=NULL)
+		{
+			it->second.waiter->cond.notify_one();
+		}
+		else
+		{
+			it->second.child->wakeWaiters();
+		}
+	}
+}
+
+void PipeThrottler::detachParent(void)
+{
+	if(parent==NULL)
+	{
+		return;
+	}
+
+	if(in_parent_queue)
+	{
+		parent->queue.erase(parent_queue_it);
+		in_parent_queue=false;
+		parent->deactivate();
+	}
+
+	parent->children.erase(std::remove(parent->children.begin(),
+		parent->children.end(), this), parent->children.end());
+
+	parent=NULL;
+}
+
+std::shared_ptr<std::mutex> PipeThrottler::lockTree(std::unique_lock<std::mutex>& lock)
+{
+	while(true)
+	{
+		std::shared_ptr<std::mutex> curr_tree = std::atomic_load(&tree_mutex);
+		std::unique_lock<std::mutex> curr_lock(*curr_tree);
+		//Only changed while holding the current tree mutex
+		if(std::atomic_load(&tree_mutex)==curr_tree)
+		{
+			lock.swap(curr_lock);
+			return curr_tree;
+		}
+	}
+}
+
+void PipeThrottler::setTreeMutex(const std::shared_ptr<std::mutex>& new_tree_mutex)
+{
+	std::atomic_store(&tree_mutex, new_tree_mutex);
+
+	for(size_t i=0;i<children.size();++i)
+	{
+		children[i]->setTreeMutex(new_tree_mutex);
+	}
 }
 
 void PipeThrottler::changeThrottleLimit(size_t bps, bool p_percent_max)
 {
-	IScopedLock lock(mutex);
+	std::unique_lock<std::mutex> lock;
+	std::shared_ptr<std::mutex> curr_tree = lockTree(lock);
 
 	percent_max = p_percent_max;
 
@@ -240,6 +633,8 @@ void PipeThrottler::changeThrottleLimit(size_t bps, bool p_percent_max)
 	{
 		throttle_bps = bps;
 	}
+
+	wakeWaiters();
 }
 
 void PipeThrottler::changeThrottleUpdater(IPipeThrottlerUpdater* new_updater)
@@ -247,4 +642,106 @@ void PipeThrottler::changeThrottleUpdater(IPipeThrottlerUpdater* new_updater)
 	IScopedLock lock(mutex);
 
 	updater.reset(new_updater);
+
+	std::unique_lock<std::mutex> tree_lock;
+	std::shared_ptr<std::mutex> curr_tree = lockTree(tree_lock);
+
+	if(updater.get()!=NULL)
+	{
+		update_time_interval = updater->getUpdateIntervalMs();
+	}
+	else
+	{
+		update_time_interval = -1;
+	}
 }
+
+void PipeThrottler::setParent(IPipeThrottler* p_parent, unsigned int p_weight)
+{
+	PipeThrottler* new_parent = dynamic_cast<PipeThrottler*>(p_parent);
+
+	//Lock this tree and the tree of the new parent
+	std::shared_ptr<std::mutex> curr_tree;
+	std::shared_ptr<std::mutex> parent_tree;
+	std::unique_lock<std::mutex> lock;
+	std::unique_lock<std::mutex> parent_lock;
+	while(true)
+	{
+		curr_tree = std::atomic_load(&tree_mutex);
+		parent_tree = new_parent!=NULL ? std::atomic_load(&new_parent->tree_mutex) : curr_tree;
+
+		lock = std::unique_lock<std::mutex>(*curr_tree, std::defer_lock);
+		if(parent_tree!=curr_tree)
+		{
+			parent_lock = std::unique_lock<std::mutex>(*parent_tree, std::defer_lock);
+			std::lock(lock, parent_lock);
+		}
+		else
+		{
+			lock.lock();
+		}
+
+		if(std::atomic_load(&tree_mutex)==curr_tree
+			&& (new_parent==NULL || std::atomic_load(&new_parent->tree_mutex)==parent_tree))
+		{
+			break;
+		}
+
+		lock = std::unique_lock<std::mutex>();
+		parent_lock = std::unique_lock<std::mutex>();
+	}
+
+	weight = p_weight>0 ? p_weight : 1;
+
+	if(new_parent==parent)
+	{
+		return;
+	}
+
+	for(PipeThrottler* node=new_parent;node!=NULL;node=node->parent)
+	{
+		if(node==this)
+		{
+			return;
+		}
+	}
+
+	bool was_child = parent!=NULL;
+
+	detachParent();
+
+	parent=new_parent;
+
+	std::unique_lock<std::mutex> new_tree_lock;
+	if(parent!=NULL)
+	{
+		parent->children.push_back(this);
+		parent_finish=0;
+
+		if(!queue.empty())
+		{
+			activate();
+		}
+
+		if(parent_tree!=curr_tree)
+		{
+			setTreeMutex(parent_tree);
+		}
+	}
+	else if(was_child)
+	{
+		//Now the root of its own tree. Locked until done
+		std::shared_ptr<std::mutex> new_tree = std::make_shared<std::mutex>();
+		new_tree_lock = std::unique_lock<std::mutex>(*new_tree);
+		setTreeMutex(new_tree);
+	}
+
+	wakeWaiters();
+}
+
+int64 PipeThrottler::getThrottleWaitTimeUs()
+{
+	std::unique_lock<std::mutex> lock;
+	std::shared_ptr<std::mutex> curr_tree = lockTree(lock);
+	return wait_time;
+}
\ No newline at end of file
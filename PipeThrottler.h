@@ -1,7 +1,11 @@
 #pragma once
 
 #include "Interface/PipeThrottler.h"
+#include "Interface/Types.h"
 #include <memory>
+#include <map>
+#include <vector>
+#include <mutex>
 
 class IMutex;
 
@@ -18,6 +22,10 @@ public:
 
 	virtual void changeThrottleUpdater(IPipeThrottlerUpdater* new_updater);
 
+	virtual void setParent(IPipeThrottler* parent, unsigned int weight);
+
+	virtual int64 getThrottleWaitTimeUs();
+
 private:
 	enum ThrottleState
 	{
@@ -25,6 +33,38 @@ private:
 		ThrottleState_Throttle
 	};
 
+	struct SWaiter;
+
+	struct SQueueEntry
+	{
+		SQueueEntry(PipeThrottler* child, SWaiter* waiter)
+			: child(child), waiter(waiter) {}
+
+		PipeThrottler* child;
+		SWaiter* waiter;
+	};
+
+	typedef std::multimap<double, SQueueEntry> queue_t;
+
+	void updateLimit(void);
+	size_t currentRate(void);
+	void refill(int64 ctime_us);
+	bool hasTokens(int64 ctime_us, int64& next_eligible_us);
+	void countBytes(size_t new_bytes, int64 ctime);
+
+	PipeThrottler* getRoot(void);
+	void enqueue(SWaiter* waiter);
+	void dequeue(SWaiter* waiter, size_t served_bytes);
+	void activate(void);
+	void deactivate(void);
+	SWaiter* select(int64 ctime_us, int64& next_eligible_us);
+	void serve(SWaiter* waiter, int64 ctime_us);
+	void dispatch(int64 ctime_us, int64& next_eligible_us);
+	void wakeWaiters(void);
+	void detachParent(void);
+	std::shared_ptr<std::mutex> lockTree(std::unique_lock<std::mutex>& lock);
+	void setTreeMutex(const std::shared_ptr<std::mutex>& new_tree_mutex);
+
 	size_t throttle_bps;
 	bool percent_max;
 	int64 update_time_interval;
@@ -40,4 +80,30 @@ private:
 	size_t probe_interval;
 
 	IMutex *mutex;
+
+	//Shared by all throttlers of one tree (the root and all its
+	//descendants), so that bytes can be charged along the whole path
+	//to the root at once. Replaced when the throttler is moved to
+	//another tree, while holding the old and the new tree mutex
+	std::shared_ptr<std::mutex> tree_mutex;
+
+	//All following members are protected by tree_mutex
+	PipeThrottler* parent;
+	std::vector<PipeThrottler*> children;
+	double weight;
+
+	double tokens;
+	int64 lastrefilltime;
+
+	//Start-time fair queueing of the backlogged children
+	//and connections of this throttler
+	queue_t queue;
+	double vtime;
+	std::map<THREAD_ID, double> flow_finish;
+
+	bool in_parent_queue;
+	queue_t::iterator parent_queue_it;
+	double parent_finish;
+
+	int64 wait_time;
 };
\ No newline at end of file
@@ -0,0 +1,439 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "RingBufferPipe.h"
+#include "Server.h"
+#include <string.h>
+
+namespace
+{
+	enum ERecordType
+	{
+		ERecordType_Data = 0,
+		//Rest of the buffer is unused. Next record is at the beginning.
+		ERecordType_Wrap = 1,
+		//Message did not fit into the buffer. Payload is a std::string*.
+		ERecordType_Overflow = 2
+	};
+
+	struct SRecordHeader
+	{
+		unsigned int size;
+		unsigned int type;
+	};
+
+	const size_t c_min_capacity = 4096;
+	const size_t c_spin_count = 100;
+
+	size_t record_size(size_t payload)
+	{
+		return sizeof(SRecordHeader) + ((payload + 7) & ~static_cast<size_t>(7));
+	}
+
+	size_t round_capacity(size_t capacity)
+	{
+		size_t ret = c_min_capacity;
+		while (ret < capacity)
+		{
+			ret *= 2;
+		}
+		return ret;
+	}
+}
+
+CRingBufferPipe::CRingBufferPipe(size_t capacity, bool multi_producer)
+	: capacity(round_capacity(capacity)), multi_producer(multi_producer),
+	write_pos(0), n_written(0), reserved_pad(0), reserved_size(0), reserved_overflow(NULL),
+	read_pos(0), n_read(0), partial_offset(0), producer_mutex(NULL),
+	waiters(0), has_error(false)
+{
+	mask = this->capacity - 1;
+	buffer = new char[this->capacity];
+	mutex = Server->createMutex();
+	cond = Server->createCondition();
+	if (multi_producer)
+	{
+		producer_mutex = Server->createMutex();
+	}
+}
+
+CRingBufferPipe::~CRingBufferPipe(void)
+{
+	size_t size;
+	while (canRead()
+		&& currentRecord(size) != NULL)
+	{
+		commitRead();
+	}
+
+	delete reserved_overflow;
+	delete[] buffer;
+	Server->destroy(mutex);
+	Server->destroy(cond);
+	if (producer_mutex != NULL)
+	{
+		Server->destroy(producer_mutex);
+	}
+}
+
+char* CRingBufferPipe::beginWrite(size_t size, int timeoutms)
+{
+	if (multi_producer)
+	{
+		producer_mutex->Lock();
+	}
+
+	bool overflow = record_size(size) > capacity / 2;
+	size_t needed = record_size(overflow ? sizeof(std::string*) : size);
+
+	size_t wpos = write_pos.load(std::memory_order_relaxed);
+	size_t off = wpos & mask;
+	size_t pad = 0;
+	if (capacity - off < needed)
+	{
+		pad = capacity - off;
+	}
+
+	if (has_error.load()
+		|| !waitFor(true, pad + needed, timeoutms))
+	{
+		if (multi_producer)
+		{
+			producer_mutex->Unlock();
+		}
+		return NULL;
+	}
+
+	reserved_pad = pad;
+	reserved_size = size;
+
+	if (overflow)
+	{
+		reserved_overflow = new std::string;
+		reserved_overflow->resize(size);
+		return &(*reserved_overflow)[0];
+	}
+
+	return buffer + ((wpos + pad) & mask) + sizeof(SRecordHeader);
+}
+
+void CRingBufferPipe::commitWrite(void)
+{
+	size_t wpos = write_pos.load(std::memory_order_relaxed);
+
+	SRecordHeader header;
+	if (reserved_pad > 0)
+	{
+		header.size = 0;
+		header.type = ERecordType_Wrap;
+		memcpy(buffer + (wpos & mask), &header, sizeof(header));
+		wpos += reserved_pad;
+	}
+
+	char* rec = buffer + (wpos & mask);
+	size_t len;
+	if (reserved_overflow != NULL)
+	{
+		header.size = sizeof(std::string*);
+		header.type = ERecordType_Overflow;
+		memcpy(rec + sizeof(SRecordHeader), &reserved_overflow, sizeof(std::string*));
+		len = record_size(sizeof(std::string*));
+		reserved_overflow = NULL;
+	}
+	else
+	{
+		header.size = static_cast<unsigned int>(reserved_size);
+		header.type = ERecordType_Data;
+		len = record_size(reserved_size);
+	}
+	memcpy(rec, &header, sizeof(header));
+
+	//Count before publishing so getNumElements never sees more reads than writes
+	n_written.fetch_add(1, std::memory_order_relaxed);
+	write_pos.store(wpos + len);
+
+	if (multi_producer)
+	{
+		producer_mutex->Unlock();
+	}
+
+	wakeWaiters();
+}
+
+const char* CRingBufferPipe::beginRead(size_t& size, int timeoutms)
+{
+	if (!waitFor(false, 0, timeoutms))
+	{
+		return NULL;
+	}
+
+	return currentRecord(size);
+}
+
+const char* CRingBufferPipe::currentRecord(size_t& size)
+{
+	size_t rpos = read_pos.load(std::memory_order_relaxed);
+	SRecordHeader header;
+	memcpy(&header, buffer + (rpos & mask), sizeof(header));
+
+	if (header.type == ERecordType_Wrap)
+	{
+		//Padding and the following record are published together
+		rpos += capacity - (rpos & mask);
+		read_pos.store(rpos);
+		memcpy(&header, buffer, sizeof(header));
+	}
+
+	const char* payload = buffer + (rpos & mask) + sizeof(SRecordHeader);
+
+	if (header.type == ERecordType_Overflow)
+	{
+		std::string* msg;
+		memcpy(&msg, payload, sizeof(msg));
+		size = msg->size();
+		return msg->data();
+	}
+
+	size = header.size;
+	return payload;
+}
+
+void CRingBufferPipe::commitRead(void)
+{
+	size_t rpos = read_pos.load(std::memory_order_relaxed);
+	SRecordHeader header;
+	memcpy(&header, buffer + (rpos & mask), sizeof(header));
+
+	if (header.type == ERecordType_Overflow)
+	{
+		std::string* msg;
+		memcpy(&msg, buffer + (rpos & mask) + sizeof(SRecordHeader), sizeof(msg));
+		delete msg;
+	}
+
+	partial_offset = 0;
+	n_read.fetch_add(1, std::memory_order_relaxed);
+	read_pos.store(rpos + record_size(header.size));
+
+	wakeWaiters();
+}
+
+bool CRingBufferPipe::canWrite(size_t needed)
+{
+	return capacity - (write_pos.load(std::memory_order_relaxed) - read_pos.load()) >= needed;
+}
+
+bool CRingBufferPipe::canRead(void)
+{
+	return write_pos.load() != read_pos.load(std::memory_order_relaxed);
+}
+
+bool CRingBufferPipe::waitFor(bool write, size_t needed, int timeoutms)
+{
+	for (size_t i = 0; i < c_spin_count; ++i)
+	{
+		if (write ? canWrite(needed) : canRead())
+		{
+			return true;
+		}
+	}
+
+	if (timeoutms == 0)
+	{
+		return false;
+	}
+
+	int64 starttime = Server->getTimeMS();
+
+	IScopedLock lock(mutex);
+	//Either the other side sees waiters>0 after publishing its position
+	//or we see the new position here
+	waiters.fetch_add(1);
+
+	bool ret;
+	while (true)
+	{
+		if (write ? canWrite(needed) : canRead())
+		{
+			ret = true;
+			break;
+		}
+
+		if (has_error.load())
+		{
+			ret = false;
+			break;
+		}
+
+		if (timeoutms < 0)
+		{
+			cond->wait(&lock);
+		}
+		else
+		{
+			int64 passed = Server->getTimeMS() - starttime;
+			if (passed >= timeoutms)
+			{
+				ret = false;
+				break;
+			}
+			cond->wait(&lock, timeoutms - static_cast<int>(passed));
+		}
+	}
+
+	waiters.fetch_sub(1);
+
+	return ret;
+}
+
+void CRingBufferPipe::wakeWaiters(void)
+{
+	if (waiters.load() > 0)
+	{
+		IScopedLock lock(mutex);
+		cond->notify_all();
+	}
+}
+
+size_t CRingBufferPipe::Read(char *buffer, size_t bsize, int timeoutms)
+{
+	size_t size;
+	const char* msg = beginRead(size, timeoutms);
+	if (msg == NULL)
+	{
+		return 0;
+	}
+
+	size_t avail = size - partial_offset;
+	if (avail <= bsize)
+	{
+		memcpy(buffer, msg + partial_offset, avail);
+		commitRead();
+		return avail;
+	}
+	else
+	{
+		memcpy(buffer, msg + partial_offset, bsize);
+		partial_offset += bsize;
+		return bsize;
+	}
+}
+
+bool CRingBufferPipe::Write(const char *buffer, size_t bsize, int timeoutms, bool flush)
+{
+	char* buf = beginWrite(bsize, timeoutms);
+	if (buf == NULL)
+	{
+		return false;
+	}
+
+	memcpy(buf, buffer, bsize);
+	commitWrite();
+
+	return true;
+}
+
+size_t CRingBufferPipe::Read(std::string *ret, int timeoutms)
+{
+	size_t size;
+	const char* msg = beginRead(size, timeoutms);
+	if (msg == NULL)
+	{
+		return 0;
+	}
+
+	size_t avail = size - partial_offset;
+	ret->assign(msg + partial_offset, avail);
+	commitRead();
+
+	return avail;
+}
+
+bool CRingBufferPipe::Write(const std::string &str, int timeoutms, bool flush)
+{
+	return Write(str.data(), str.size(), timeoutms, flush);
+}
+
+bool CRingBufferPipe::isWritable(int timeoutms)
+{
+	if (has_error.load())
+	{
+		return false;
+	}
+
+	return waitFor(true, record_size(0), timeoutms);
+}
+
+bool CRingBufferPipe::isReadable(int timeoutms)
+{
+	return waitFor(false, 0, timeoutms);
+}
+
+bool CRingBufferPipe::hasError(void)
+{
+	return has_error.load();
+}
+
+void CRingBufferPipe::shutdown(void)
+{
+	has_error.store(true);
+	IScopedLock lock(mutex);
+	cond->notify_all();
+}
+
+size_t CRingBufferPipe::getNumElements(void)
+{
+	size_t l_read = n_read.load();
+	size_t l_written = n_written.load();
+	if (l_written < l_read)
+	{
+		return 0;
+	}
+	return l_written - l_read;
+}
+
+void CRingBufferPipe::addThrottler(IPipeThrottler *throttler)
+{
+}
+
+void CRingBufferPipe::addOutgoingThrottler(IPipeThrottler *throttler)
+{
+}
+
+void CRingBufferPipe::addIncomingThrottler(IPipeThrottler *throttler)
+{
+}
+
+_i64 CRingBufferPipe::getTransferedBytes(void)
+{
+	return 0;
+}
+
+void CRingBufferPipe::resetTransferedBytes(void)
+{
+}
+
+bool CRingBufferPipe::Flush( int timeoutms/*=-1 */ )
+{
+	return true;
+}
+
+size_t CRingBufferPipe::getCapacity(void)
+{
+	return capacity;
+}
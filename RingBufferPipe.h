@@ -0,0 +1,83 @@
+#ifndef RINGBUFFERPIPE_H_
+#define RINGBUFFERPIPE_H_
+
+#include "Interface/RingBufferPipe.h"
+#include "Interface/Mutex.h"
+#include "Interface/Condition.h"
+#include <atomic>
+#include <string>
+
+class CRingBufferPipe : public IRingBufferPipe
+{
+public:
+	CRingBufferPipe(size_t capacity, bool multi_producer);
+	~CRingBufferPipe(void);
+
+	virtual size_t Read(char *buffer, size_t bsize, int timeoutms);
+	virtual bool Write(const char *buffer, size_t bsize, int timeoutms, bool flush);
+	virtual size_t Read(std::string *ret, int timeoutms);
+	virtual bool Write(const std::string &str, int timeoutms, bool flush);
+
+	virtual bool isWritable(int timeoutms);
+	virtual bool isReadable(int timeoutms);
+
+	virtual bool hasError(void);
+
+	virtual void shutdown(void);
+
+	virtual size_t getNumElements(void);
+
+	virtual void addThrottler(IPipeThrottler *throttler);
+	virtual void addOutgoingThrottler(IPipeThrottler *throttler);
+	virtual void addIncomingThrottler(IPipeThrottler *throttler);
+
+	virtual _i64 getTransferedBytes(void);
+	virtual void resetTransferedBytes(void);
+
+	virtual bool Flush( int timeoutms=-1 );
+
+	virtual size_t getCapacity(void);
+
+private:
+	char* beginWrite(size_t size, int timeoutms);
+	void commitWrite(void);
+
+	const char* beginRead(size_t& size, int timeoutms);
+	void commitRead(void);
+
+	bool waitFor(bool write, size_t needed, int timeoutms);
+	bool canWrite(size_t needed);
+	bool canRead(void);
+	void wakeWaiters(void);
+	const char* currentRecord(size_t& size);
+
+	char* buffer;
+	size_t capacity;
+	size_t mask;
+	bool multi_producer;
+
+	//Only modified by the producer
+	std::atomic<size_t> write_pos;
+	std::atomic<size_t> n_written;
+	size_t reserved_pad;
+	size_t reserved_size;
+	std::string* reserved_overflow;
+
+	char pad_producer[64];
+
+	//Only modified by the consumer
+	std::atomic<size_t> read_pos;
+	std::atomic<size_t> n_read;
+	size_t partial_offset;
+
+	char pad_consumer[64];
+
+	IMutex *producer_mutex;
+
+	IMutex *mutex;
+	ICondition *cond;
+	std::atomic<int> waiters;
+	std::atomic<bool> has_error;
+};
+
+#endif /*RINGBUFFERPIPE_H_*/
@@ -27,6 +27,7 @@
 #include "Server.h"
 #include "stringtools.h"
 #include <errno.h>
+#include <algorithm>
 
 std::vector<CWorkerThread*> workers;
 IMutex* workers_mutex=NULL;
@@ -68,6 +69,22 @@ CSelectThread::CSelectThread(_u32 pWorkerThreadsPerMaster)
 		}
 	}
 	run=true;
+
+#ifdef USE_EPOLL
+	epoll_fd=epoll_create1(EPOLL_CLOEXEC);
+	wakeup_fd=eventfd(0, EFD_CLOEXEC|EFD_NONBLOCK);
+	if(epoll_fd==-1 || wakeup_fd==-1)
+	{
+		Server->Log("Creating epoll/eventfd failed. errno="+convert(errno), LL_ERROR);
+	}
+	else
+	{
+		epoll_event ev;
+		ev.events=EPOLLIN;
+		ev.data.ptr=NULL;
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &ev);
+	}
+#endif
 }
 
 CSelectThread::~CSelectThread()
@@ -92,10 +109,20 @@ CSelectThread::~CSelectThread()
 	Server->destroy(stop_mutex);
 	Server->destroy(cond);
 	Server->destroy(stop_cond);
+
+#ifdef USE_EPOLL
+	if(epoll_fd!=-1) close(epoll_fd);
+	if(wakeup_fd!=-1) close(wakeup_fd);
+#endif
 }
 
 void CSelectThread::operator()()
 {
+#ifdef USE_EPOLL
+	epollLoop();
+	return;
+#endif
+
 #ifdef _WIN32
 	_i32 max;
 	fd_set fdset;
@@ -234,12 +261,61 @@ void CSelectThread::operator()()
 	stop_cond->notify_one();
 }
 
+#ifdef USE_EPOLL
+void CSelectThread::epollLoop(void)
+{
+	epoll_event events[max_clients+1];
+	while(run)
+	{
+		//Client sockets are registered with EPOLLONESHOT and re-armed in
+		//ClientDone(), so a client being processed by a worker produces no events
+		int rc = epoll_wait(epoll_fd, events, max_clients+1, -1);
+
+		if(rc>0)
+		{
+			IScopedLock lock(mutex);
+			for(int i=0;i<rc;++i)
+			{
+				CClient* client=static_cast<CClient*>(events[i].data.ptr);
+				if(client==NULL)
+				{
+					uint64_t cnt;
+					while(read(wakeup_fd, &cnt, sizeof(cnt))==sizeof(cnt)) {}
+					continue;
+				}
+
+				if(std::find(clients.begin(), clients.end(), client)!=clients.end())
+				{
+					FindWorker(client);
+				}
+			}
+		}
+		else if(rc==-1 && errno!=EINTR)
+		{
+			Server->Log("Epoll error: "+convert(errno),LL_ERROR);
+			Server->wait(10);
+		}
+	}
+	IScopedLock slock(stop_mutex);
+	stop_cond->notify_one();
+}
+#endif
+
 bool CSelectThread::AddClient(CClient *client)
 {
 	if( FreeClients()>0 )
 	{
 		IScopedLock lock(mutex);
 		clients.push_back(client);
+#ifdef USE_EPOLL
+		epoll_event ev;
+		ev.events=EPOLLIN|EPOLLONESHOT;
+		ev.data.ptr=client;
+		if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client->getSocket(), &ev)!=0)
+		{
+			Server->Log("Adding socket to epoll failed. errno="+convert(errno), LL_ERROR);
+		}
+#endif
 		WakeUp();
 		return true;
 	}
@@ -259,6 +335,9 @@ bool CSelectThread::RemoveClient(CClient *client)
 	{
 		if( clients[i]==client )
 		{
+#ifdef USE_EPOLL
+			epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client->getSocket(), NULL);
+#endif
 			clients.erase( clients.begin()+i );
 			client->remove();
 			delete client;
@@ -282,4 +361,24 @@ void CSelectThread::FindWorker(CClient *client)
 void CSelectThread::WakeUp(void)
 {
 	cond->notify_one();
+#ifdef USE_EPOLL
+	uint64_t cnt=1;
+	if(write(wakeup_fd, &cnt, sizeof(cnt))!=sizeof(cnt))
+	{
+		//Counter already pending, the thread wakes up anyway
+	}
+#endif
+}
+
+void CSelectThread::ClientDone(CClient *client)
+{
+#ifdef USE_EPOLL
+	IScopedLock lock(mutex);
+	epoll_event ev;
+	ev.events=EPOLLIN|EPOLLONESHOT;
+	ev.data.ptr=client;
+	epoll_ctl(epoll_fd, EPOLL_CTL_MOD, client->getSocket(), &ev);
+#else
+	WakeUp();
+#endif
 }
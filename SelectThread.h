@@ -7,6 +7,7 @@
 #include <deque>
 #include <vector>
 #include "types.h"
+#include "socket_header.h"
 
 class CClient;
 class CWorkerThread;
@@ -27,9 +28,19 @@ public:
 	size_t FreeClients(void);
 
 	void WakeUp(void);
+
+	//Called by a worker once it is done with the client
+	void ClientDone(CClient *client);
 private:
 	void FindWorker(CClient *client);
 
+#ifdef USE_EPOLL
+	void epollLoop(void);
+
+	int epoll_fd;
+	int wakeup_fd;
+#endif
+
 	std::deque<CClient*> clients;
 
 	IMutex *mutex;
@@ -50,6 +50,7 @@
 #include "file.h"
 #include "utf8/utf8.h"
 #include "MemoryPipe.h"
+#include "RingBufferPipe.h"
 #include "MemorySettingsReader.h"
 #include "Database.h"
 #include "SQLiteFactory.h"
@@ -1412,6 +1413,11 @@ IPipe *CServer::createMemoryPipe(void)
 	return new CMemoryPipe;
 }
 
+IRingBufferPipe *CServer::createRingBufferPipe(size_t capacity, bool multi_producer)
+{
+	return new CRingBufferPipe(capacity, multi_producer);
+}
+
 #ifdef _WIN32
 struct SThreadInfo
 {
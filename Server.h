@@ -103,6 +103,7 @@ public:
 	virtual ISharedMutex* createSharedMutex();
 	virtual ICondition* createCondition(void);
 	virtual IPipe *createMemoryPipe(void);
+	virtual IRingBufferPipe *createRingBufferPipe(size_t capacity, bool multi_producer=false);
 	virtual bool createThread(IThread *thread, const std::string& name = std::string(), CreateThreadFlags flags = CreateThreadFlags_None);
 	virtual void setCurrentThreadName(const std::string& name);
 	virtual IThreadPool *getThreadPool(void);
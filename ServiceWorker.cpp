@@ -52,6 +52,22 @@ CServiceWorker::CServiceWorker(IService *pService, std::string pName, IPipe * pE
 			max_clients=MAX_CLIENTS;
 		}
 	}
+
+#ifdef USE_EPOLL
+	epoll_fd=epoll_create1(EPOLL_CLOEXEC);
+	wakeup_fd=eventfd(0, EFD_CLOEXEC|EFD_NONBLOCK);
+	if(epoll_fd==-1 || wakeup_fd==-1)
+	{
+		Server->Log(name+": Creating epoll/eventfd failed. errno="+convert(errno), LL_ERROR);
+	}
+	else
+	{
+		epoll_event ev;
+		ev.events=EPOLLIN;
+		ev.data.ptr=NULL;
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &ev);
+	}
+#endif
 }
 
 CServiceWorker::~CServiceWorker()
@@ -63,6 +79,11 @@ CServiceWorker::~CServiceWorker()
 	}
 	clients.clear();
 
+#ifdef USE_EPOLL
+	if(epoll_fd!=-1) close(epoll_fd);
+	if(wakeup_fd!=-1) close(wakeup_fd);
+#endif
+
 	Server->destroy(mutex);
 	Server->destroy(nc_mutex);
 	Server->destroy(cond);
@@ -73,6 +94,9 @@ void CServiceWorker::stop(void)
 	IScopedLock lock(mutex);
 	do_stop=true;
 	cond->notify_all();
+#ifdef USE_EPOLL
+	wakeUp();
+#endif
 }
 
 
@@ -134,6 +158,10 @@ void CServiceWorker::work(ICustomClient * skip_client)
 		{
 			IScopedLock lock(mutex);
 			//Server->Log(name+": Removing user"+convert(Server->getTimeMS()), LL_DEBUG);
+#ifdef USE_EPOLL
+			epoll_ctl(epoll_fd, EPOLL_CTL_DEL, clients[i].second->getSocket(), NULL);
+			clients_epoll_in.erase(clients_epoll_in.begin() + i);
+#endif
 			if (clients[i].first->closeSocket())
 			{
 				delete clients[i].second;
@@ -157,6 +185,8 @@ void CServiceWorker::work(ICustomClient * skip_client)
 #ifdef _WIN32
 	fd_set fdset;
 	int max;
+#elif defined(USE_EPOLL)
+	epoll_event events[MAX_EPOLL_EVENTS];
 #else
 	std::vector<pollfd> conn;
 	std::vector<ICustomClient*> conn_clients;
@@ -166,7 +196,7 @@ void CServiceWorker::work(ICustomClient * skip_client)
 #ifdef _WIN32
 	FD_ZERO(&fdset);
 	max = 0;
-#else
+#elif !defined(USE_EPOLL)
 	conn.clear();
 	conn_clients.clear();
 #endif
@@ -180,14 +210,25 @@ void CServiceWorker::work(ICustomClient * skip_client)
 			continue;
 		}
 
-		if (clients[i].first->wantReceive())
+		bool want_receive = clients[i].first->wantReceive();
+
+#ifdef USE_EPOLL
+		//Sockets stay registered, only changes of wantReceive() touch epoll
+		if (want_receive != clients_epoll_in[i])
+		{
+			setEpollIn(i, want_receive);
+		}
+#endif
+
+		if (want_receive)
 		{
-			SOCKET s = clients[i].second->getSocket();
 #ifdef _WIN32
+			SOCKET s = clients[i].second->getSocket();
 			if ((_i32)s>max)
 				max = (_i32)s;
 			FD_SET(s, &fdset);
-#else
+#elif !defined(USE_EPOLL)
+			SOCKET s = clients[i].second->getSocket();
 			pollfd nconn;
 			nconn.fd = s;
 			nconn.events = POLLIN;
@@ -200,6 +241,39 @@ void CServiceWorker::work(ICustomClient * skip_client)
 	}
 
 
+#ifdef USE_EPOLL
+	//The timeout is the Run() interval of the clients. New clients and stop() wake up via the eventfd
+	if (has_select_client || skip_client==NULL)
+	{
+		int rc = epoll_wait(epoll_fd, events, MAX_EPOLL_EVENTS, 10);
+
+		for (int i = 0; i<rc; ++i)
+		{
+			ICustomClient* client = static_cast<ICustomClient*>(events[i].data.ptr);
+
+			if (client == NULL)
+			{
+				uint64_t cnt;
+				while (read(wakeup_fd, &cnt, sizeof(cnt)) == sizeof(cnt)) {}
+				continue;
+			}
+
+			if (client == skip_client)
+			{
+				continue;
+			}
+
+			curr_work.top().client = client;
+
+			client->ReceivePackets(this);
+
+			if (curr_work.top().did_other_work)
+			{
+				return;
+			}
+		}
+	}
+#else
 	if (has_select_client)
 	{
 #ifdef _WIN32
@@ -257,6 +331,7 @@ void CServiceWorker::work(ICustomClient * skip_client)
 	{
 		Server->wait(10);
 	}
+#endif //USE_EPOLL
 }
 
 void CServiceWorker::addNewClients(void)
@@ -267,10 +342,40 @@ void CServiceWorker::addNewClients(void)
 		ICustomClient *nc=service->createClient();
 		nc->Init(tid, pipe, new_clients[i].second);
 		clients.push_back( std::pair<ICustomClient*, CStreamPipe*>(nc, pipe) );
+#ifdef USE_EPOLL
+		epoll_event ev;
+		ev.events=EPOLLIN;
+		ev.data.ptr=nc;
+		if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, new_clients[i].first, &ev)!=0)
+		{
+			Server->Log(name+": Adding socket to epoll failed. errno="+convert(errno), LL_ERROR);
+		}
+		clients_epoll_in.push_back(true);
+#endif
     }
     new_clients.clear();
 }
 
+#ifdef USE_EPOLL
+void CServiceWorker::setEpollIn(size_t idx, bool b)
+{
+	epoll_event ev;
+	ev.events = b ? static_cast<uint32_t>(EPOLLIN) : 0;
+	ev.data.ptr=clients[idx].first;
+	epoll_ctl(epoll_fd, EPOLL_CTL_MOD, clients[idx].second->getSocket(), &ev);
+	clients_epoll_in[idx]=b;
+}
+
+void CServiceWorker::wakeUp(void)
+{
+	uint64_t cnt=1;
+	if(write(wakeup_fd, &cnt, sizeof(cnt))!=sizeof(cnt))
+	{
+		//Counter already pending, the worker wakes up anyway
+	}
+}
+#endif
+
 void CServiceWorker::runOther()
 {
 	curr_work.top().did_other_work = true;
@@ -307,6 +412,9 @@ void CServiceWorker::AddClient(SOCKET pSocket, const std::string& endpoint)
 	new_clients.push_back( std::make_pair(pSocket, endpoint) );
 	
 	cond->notify_all();
+#ifdef USE_EPOLL
+	wakeUp();
+#endif
 	
 	IScopedLock lock2(nc_mutex);
 	++nClients;
@@ -10,6 +10,9 @@
 #include "Interface/CustomClient.h"
 
 const int MAX_CLIENTS=20;
+#ifdef USE_EPOLL
+const int MAX_EPOLL_EVENTS=64;
+#endif
 
 class IService;
 class CStreamPipe;
@@ -41,8 +44,19 @@ private:
     
 	void addNewClients(void);
 
+#ifdef USE_EPOLL
+	void setEpollIn(size_t idx, bool b);
+	void wakeUp(void);
+#endif
+
 	std::vector<std::pair<ICustomClient*, CStreamPipe*> > clients;
 	std::vector<std::pair<SOCKET, std::string> > new_clients;
+#ifdef USE_EPOLL
+	//Whether the socket of the client is registered for EPOLLIN
+	std::vector<bool> clients_epoll_in;
+	int epoll_fd;
+	int wakeup_fd;
+#endif
 
 	IMutex* mutex;
 	IMutex* nc_mutex;
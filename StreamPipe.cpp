@@ -23,11 +23,15 @@
 #ifndef _WIN32
 #include <memory.h>
 #include <errno.h>
+#include <sys/uio.h>
 #endif
 #include "Server.h"
 #include "Interface/PipeThrottler.h"
 #include "stringtools.h"
 
+//Number of buffers passed to the OS per send call
+const size_t max_send_bufs = 64;
+
 CStreamPipe::CStreamPipe( SOCKET pSocket)
 	: transfered_bytes(0)
 {
@@ -226,6 +230,180 @@ bool CStreamPipe::Write(const std::string &str, int timeoutms, bool flush)
 	return Write(&str[0], str.size(), timeoutms, flush);
 }
 
+bool CStreamPipe::Writev(const SPipeBuffer* bufs, size_t n_bufs, int timeoutms, bool flush)
+{
+	size_t idx = 0;
+	size_t off = 0;
+	bool first_send = true;
+
+	while (true)
+	{
+		while (idx<n_bufs && off >= bufs[idx].bsize)
+		{
+			++idx;
+			off = 0;
+		}
+
+		if (idx >= n_bufs)
+		{
+			return true;
+		}
+
+		int rc = selectSocketWrite(s, first_send ? timeoutms : -1);
+		first_send = false;
+
+		if (rc <= 0)
+		{
+			if (rc < 0)
+			{
+				has_error = true;
+			}
+			return false;
+		}
+
+		size_t written;
+#ifdef _WIN32
+		WSABUF wsabufs[max_send_bufs];
+		DWORD n_wsabufs = 0;
+		for (size_t i = idx; i < n_bufs && n_wsabufs < max_send_bufs; ++i)
+		{
+			size_t curr_off = i == idx ? off : 0;
+			if (bufs[i].bsize > curr_off)
+			{
+				wsabufs[n_wsabufs].buf = const_cast<char*>(bufs[i].buf) + curr_off;
+				wsabufs[n_wsabufs].len = static_cast<ULONG>(bufs[i].bsize - curr_off);
+				++n_wsabufs;
+			}
+		}
+
+		DWORD sent = 0;
+		if (WSASend(s, wsabufs, n_wsabufs, &sent, 0, NULL, NULL) != 0)
+		{
+			DWORD err = WSAGetLastError();
+			if (err == WSAEINTR)
+			{
+				continue;
+			}
+
+			if (err != WSAEWOULDBLOCK)
+			{
+				has_error = true;
+			}
+			return false;
+		}
+		written = sent;
+#else
+		iovec iov[max_send_bufs];
+		size_t n_iov = 0;
+		for (size_t i = idx; i < n_bufs && n_iov < max_send_bufs; ++i)
+		{
+			size_t curr_off = i == idx ? off : 0;
+			if (bufs[i].bsize > curr_off)
+			{
+				iov[n_iov].iov_base = const_cast<char*>(bufs[i].buf) + curr_off;
+				iov[n_iov].iov_len = bufs[i].bsize - curr_off;
+				++n_iov;
+			}
+		}
+
+		msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = n_iov;
+
+		ssize_t sent = sendmsg(s, &msg, MSG_NOSIGNAL);
+		if (sent < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+			{
+				has_error = true;
+			}
+			return false;
+		}
+		written = static_cast<size_t>(sent);
+#endif
+
+		doThrottle(written, true, true);
+
+		while (written > 0)
+		{
+			size_t avail = bufs[idx].bsize - off;
+			if (written >= avail)
+			{
+				written -= avail;
+				++idx;
+				off = 0;
+			}
+			else
+			{
+				off += written;
+				written = 0;
+			}
+		}
+	}
+}
+
+size_t CStreamPipe::ReadInto(char *buffer, size_t bsize, size_t min_size, int timeoutms)
+{
+	size_t read = Read(buffer, bsize, timeoutms);
+	if (read == 0)
+	{
+		return 0;
+	}
+
+#ifndef _WIN32
+	if (timeoutms < 0)
+	{
+		//Let the kernel wait for the rest instead of polling for each segment
+		while (read < min_size)
+		{
+			ssize_t rc = recv(s, buffer + read, min_size - read, MSG_WAITALL | MSG_NOSIGNAL);
+			if (rc <= 0)
+			{
+				if (rc < 0 && errno == EINTR)
+				{
+					continue;
+				}
+				if (rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+				{
+					//Non-blocking socket. Wait for data with Read
+					size_t rrc = Read(buffer + read, bsize - read, timeoutms);
+					if (rrc == 0)
+					{
+						return read;
+					}
+					read += rrc;
+					continue;
+				}
+				has_error = true;
+				return read;
+			}
+
+			doThrottle(rc, false, true);
+			read += rc;
+		}
+		return read;
+	}
+#endif
+
+	while (read < min_size)
+	{
+		size_t rc = Read(buffer + read, bsize - read, timeoutms);
+		if (rc == 0)
+		{
+			break;
+		}
+		read += rc;
+	}
+
+	return read;
+}
+
 size_t CStreamPipe::Read(std::string *ret, int timeoutms)
 {
 	char buffer[8192];
@@ -14,6 +14,8 @@ public:
 	virtual bool Write(const char *buffer, size_t bsize, int timeoutms, bool flush);
 	virtual size_t Read(std::string *ret, int timeoutms);
 	virtual bool Write(const std::string &str, int timeoutms, bool flush);
+	virtual bool Writev(const SPipeBuffer* bufs, size_t n_bufs, int timeoutms, bool flush);
+	virtual size_t ReadInto(char *buffer, size_t bsize, size_t min_size, int timeoutms);
 
 	virtual bool isWritable(int timeoutms);
 	virtual bool isReadable(int timeoutms);
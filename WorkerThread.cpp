@@ -156,7 +156,7 @@ void CWorkerThread::operator()()
 					else
 					{
 						client->setProcessing(false);
-						Master->WakeUp();
+						Master->ClientDone(client);
 					}
 
 					lock.relock(clients_mutex);
@@ -31,6 +31,14 @@ adler32.c -- compute the Adler-32 checksum of a data stream
 
 /* @(#) $Id$ */
 
+#include "adler32.h"
+#include "cpu_features.h"
+
+#if !defined(ADLER32_NO_ACCEL) && defined(CPU_FEATURES_X86)
+#define ADLER32_ACCEL_X86
+#include <immintrin.h>
+#endif
+
 #define BASE 65521      /* largest prime smaller than 65536 */
 #define NMAX 5552
 /* NMAX is the largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1 */
@@ -46,10 +54,211 @@ adler32.c -- compute the Adler-32 checksum of a data stream
 #  define MOD28(a) a %= BASE
 #  define MOD63(a) a %= BASE
 
+namespace
+{
+	typedef unsigned int(*adler32_fn)(unsigned int adler, const unsigned char* buf, unsigned int len);
+
+	unsigned int adler32_portable(unsigned int adler, const unsigned char* buf, unsigned int len);
+
+	/* Number of 32 byte blocks which can be summed before the lanes have to be reduced */
+	const unsigned int c_simd_block_size = 32;
+	const unsigned int c_simd_nmax = NMAX / c_simd_block_size;
+
+	/* Below this the setup and horizontal sums cost more than they save */
+	const unsigned int c_simd_min_len = 64;
+
+#ifdef ADLER32_ACCEL_X86
+	CPU_TARGET("ssse3")
+	unsigned int adler32_ssse3(unsigned int adler, const unsigned char* buf, unsigned int len)
+	{
+		unsigned int s1 = adler & 0xffff;
+		unsigned int s2 = (adler >> 16) & 0xffff;
+
+		const __m128i taps1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+		const __m128i taps2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i ones = _mm_set1_epi16(1);
+
+		unsigned int blocks = len / c_simd_block_size;
+		len -= blocks*c_simd_block_size;
+
+		while (blocks)
+		{
+			unsigned int n = blocks < c_simd_nmax ? blocks : c_simd_nmax;
+			blocks -= n;
+
+			/* Contribution of the initial s1 to s2 for every byte of this chunk */
+			unsigned long long ls2 = s2 + static_cast<unsigned long long>(s1) * n * c_simd_block_size;
+
+			__m128i v_ps = _mm_setzero_si128();
+			__m128i v_s1 = _mm_setzero_si128();
+			__m128i v_s2 = _mm_setzero_si128();
+
+			do
+			{
+				__m128i bytes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+				__m128i bytes2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 16));
+
+				/* s1 of all previous blocks is added to s2 once per byte of this block */
+				v_ps = _mm_add_epi32(v_ps, v_s1);
+
+				v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+				v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+
+				v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, taps1), ones));
+				v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, taps2), ones));
+
+				buf += c_simd_block_size;
+			} while (--n);
+
+			v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+			v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+			v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+			s1 += static_cast<unsigned int>(_mm_cvtsi128_si32(v_s1));
+
+			v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+			v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+			ls2 += static_cast<unsigned int>(_mm_cvtsi128_si32(v_s2));
+
+			s1 %= BASE;
+			s2 = static_cast<unsigned int>(ls2 % BASE);
+		}
+
+		if (len)
+		{
+			return adler32_portable(s1 | (s2 << 16), buf, len);
+		}
+
+		return s1 | (s2 << 16);
+	}
+
+	CPU_TARGET("avx2")
+	unsigned int adler32_avx2(unsigned int adler, const unsigned char* buf, unsigned int len)
+	{
+		unsigned int s1 = adler & 0xffff;
+		unsigned int s2 = (adler >> 16) & 0xffff;
+
+		const __m256i taps = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+			16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i ones = _mm256_set1_epi16(1);
+
+		unsigned int blocks = len / c_simd_block_size;
+		len -= blocks*c_simd_block_size;
+
+		while (blocks)
+		{
+			unsigned int n = blocks < c_simd_nmax ? blocks : c_simd_nmax;
+			blocks -= n;
+
+			unsigned long long ls2 = s2 + static_cast<unsigned long long>(s1) * n * c_simd_block_size;
+
+			__m256i v_ps = _mm256_setzero_si256();
+			__m256i v_s1 = _mm256_setzero_si256();
+			__m256i v_s2 = _mm256_setzero_si256();
+
+			do
+			{
+				__m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buf));
+
+				v_ps = _mm256_add_epi32(v_ps, v_s1);
+				v_s1 = _mm256_add_epi32(v_s1, _mm256_sad_epu8(bytes, zero));
+				v_s2 = _mm256_add_epi32(v_s2, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, taps), ones));
+
+				buf += c_simd_block_size;
+			} while (--n);
+
+			v_s2 = _mm256_add_epi32(v_s2, _mm256_slli_epi32(v_ps, 5));
+
+			__m128i h_s1 = _mm_add_epi32(_mm256_castsi256_si128(v_s1), _mm256_extracti128_si256(v_s1, 1));
+			h_s1 = _mm_add_epi32(h_s1, _mm_shuffle_epi32(h_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+			h_s1 = _mm_add_epi32(h_s1, _mm_shuffle_epi32(h_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+			s1 += static_cast<unsigned int>(_mm_cvtsi128_si32(h_s1));
+
+			__m128i h_s2 = _mm_add_epi32(_mm256_castsi256_si128(v_s2), _mm256_extracti128_si256(v_s2, 1));
+			h_s2 = _mm_add_epi32(h_s2, _mm_shuffle_epi32(h_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+			h_s2 = _mm_add_epi32(h_s2, _mm_shuffle_epi32(h_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+			ls2 += static_cast<unsigned int>(_mm_cvtsi128_si32(h_s2));
+
+			s1 %= BASE;
+			s2 = static_cast<unsigned int>(ls2 % BASE);
+		}
+
+		if (len)
+		{
+			return adler32_portable(s1 | (s2 << 16), buf, len);
+		}
+
+		return s1 | (s2 << 16);
+	}
+#endif //ADLER32_ACCEL_X86
+
+	adler32_fn select_adler32_accel()
+	{
+#ifdef ADLER32_ACCEL_X86
+		if (cpu_features::has_avx2())
+		{
+			return adler32_avx2;
+		}
+		if (cpu_features::has_ssse3())
+		{
+			return adler32_ssse3;
+		}
+#endif
+		return NULL;
+	}
+
+	adler32_fn adler32_accel_avail = select_adler32_accel();
+	adler32_fn adler32_accel = adler32_accel_avail;
+}
+
 /* ========================================================================= */
 unsigned int urb_adler32(unsigned int adler, const char* pbuf, unsigned int len)
 {
-	const unsigned char* buf = reinterpret_cast<const unsigned char*>(pbuf);
+	if (pbuf != 0 && len >= c_simd_min_len && adler32_accel != NULL)
+	{
+		return adler32_accel(adler, reinterpret_cast<const unsigned char*>(pbuf), len);
+	}
+
+	return adler32_portable(adler, reinterpret_cast<const unsigned char*>(pbuf), len);
+}
+
+void urb_adler32_blocks(const char* buf, unsigned int len, unsigned int block_size, unsigned int* out)
+{
+	unsigned int init = urb_adler32(0, 0, 0);
+	for (unsigned int pos = 0; pos < len; pos += block_size, ++out)
+	{
+		unsigned int curr = len - pos < block_size ? len - pos : block_size;
+		*out = urb_adler32(init, buf + pos, curr);
+	}
+}
+
+void urb_adler32_set_accel(bool enable)
+{
+	adler32_accel = enable ? adler32_accel_avail : NULL;
+}
+
+std::string urb_adler32_accel_name()
+{
+#ifdef ADLER32_ACCEL_X86
+	if (adler32_accel == adler32_avx2)
+	{
+		return "avx2";
+	}
+	if (adler32_accel == adler32_ssse3)
+	{
+		return "ssse3";
+	}
+#endif
+	return "portable";
+}
+
+namespace
+{
+/* ========================================================================= */
+unsigned int adler32_portable(unsigned int adler, const unsigned char* buf, unsigned int len)
+{
     unsigned int sum2;
     unsigned int n;
 
@@ -114,6 +323,7 @@ unsigned int urb_adler32(unsigned int adler, const char* pbuf, unsigned int len)
     /* return recombined sums */
     return adler | (sum2 << 16);
 }
+}
 
 unsigned int urb_adler32_combine(unsigned int adler1, unsigned int adler2, unsigned int len2)
 {
@@ -134,4 +344,22 @@ unsigned int urb_adler32_combine(unsigned int adler1, unsigned int adler2, unsig
 	if (sum2 >= (BASE << 1)) sum2 -= (BASE << 1);
 	if (sum2 >= BASE) sum2 -= BASE;
 	return sum1 | (sum2 << 16);
-}
\ No newline at end of file
+}
+unsigned int urb_adler32_roll(unsigned int adler, unsigned int len, unsigned char out_byte, unsigned char in_byte)
+{
+	unsigned long sum1 = adler & 0xffff;
+	unsigned long sum2 = (adler >> 16) & 0xffff;
+	unsigned long rem = len;
+	MOD(rem);
+
+	/* window x_1..x_n -> x_2..x_n+1:
+	   sum1' = sum1 - x_1 + x_n+1, sum2' = sum2 - n*x_1 + sum1' - 1 */
+	sum1 += BASE - out_byte + in_byte;
+	if (sum1 >= BASE) sum1 -= BASE;
+	if (sum1 >= BASE) sum1 -= BASE;
+	unsigned long sub = rem * out_byte;
+	MOD(sub);
+	sum2 += sum1 + (BASE - 1) + (BASE - sub);
+	MOD(sum2);
+	return sum1 | (sum2 << 16);
+}
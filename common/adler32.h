@@ -1,5 +1,20 @@
 #pragma once
 
+#include <string>
+
 unsigned int urb_adler32(unsigned int adler, const char *pbuf, unsigned int len);
 
-unsigned int urb_adler32_combine(unsigned int adler1, unsigned int adler2, unsigned int len2);
\ No newline at end of file
+/* Computes the Adler-32 of each block_size block of buf (starting with a fresh
+   checksum per block) into out. The last block may be shorter. */
+void urb_adler32_blocks(const char* buf, unsigned int len, unsigned int block_size, unsigned int* out);
+
+/* For benchmarking. Disables/enables the SSSE3/AVX2 code path. */
+void urb_adler32_set_accel(bool enable);
+
+std::string urb_adler32_accel_name();
+
+unsigned int urb_adler32_combine(unsigned int adler1, unsigned int adler2, unsigned int len2);
+
+/* Moves a len byte Adler-32 window one byte forward: out_byte leaves the
+   window at the front, in_byte is appended at the end. */
+unsigned int urb_adler32_roll(unsigned int adler, unsigned int len, unsigned char out_byte, unsigned char in_byte);
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CPU_FEATURES_X86
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define CPU_TARGET(x)
+#else
+#include <cpuid.h>
+#define CPU_TARGET(x) __attribute__((target(x)))
+#endif
+
+namespace cpu_features
+{
+	inline void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4])
+	{
+#ifdef _MSC_VER
+		__cpuidex(reinterpret_cast<int*>(regs), leaf, subleaf);
+#else
+		__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	}
+
+	inline unsigned int max_leaf()
+	{
+		unsigned int regs[4];
+		cpuid(0, 0, regs);
+		return regs[0];
+	}
+
+	inline unsigned int leaf1_ecx()
+	{
+		unsigned int regs[4];
+		cpuid(1, 0, regs);
+		return regs[2];
+	}
+
+	inline unsigned int leaf7_ebx()
+	{
+		if (max_leaf() < 7)
+		{
+			return 0;
+		}
+		unsigned int regs[4];
+		cpuid(7, 0, regs);
+		return regs[1];
+	}
+
+	//OS saves the AVX registers on context switch
+	inline bool os_saves_ymm()
+	{
+		if ((leaf1_ecx() & (1 << 27)) == 0)
+		{
+			//No OSXSAVE
+			return false;
+		}
+#ifdef _MSC_VER
+		unsigned long long xcr0 = _xgetbv(0);
+#else
+		unsigned int eax, edx;
+		__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		unsigned long long xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+		return (xcr0 & 6) == 6;
+	}
+
+	inline bool has_ssse3()
+	{
+		return (leaf1_ecx() & (1 << 9)) != 0;
+	}
+
+	inline bool has_sse41()
+	{
+		return (leaf1_ecx() & (1 << 19)) != 0;
+	}
+
+	inline bool has_sha()
+	{
+		return (leaf7_ebx() & (1 << 29)) != 0;
+	}
+
+	inline bool has_avx2()
+	{
+		return (leaf1_ecx() & (1 << 28)) != 0
+			&& (leaf7_ebx() & (1 << 5)) != 0
+			&& os_saves_ymm();
+	}
+}
+
+#endif //x86
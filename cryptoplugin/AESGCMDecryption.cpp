@@ -24,11 +24,12 @@
 
 const size_t iv_size = 12;
 const size_t end_marker_zeros = 4;
+const size_t tag_size = 16;
 
 using namespace CryptoPPCompat;
 
 AESGCMDecryption::AESGCMDecryption( const std::string &password, bool hash_password )
-	: decryption(), decryption_filter(decryption), iv_done(false), end_marker_state(0),
+	: decryption(), plain_pos(0), verified_size(0), iv_done(false), end_marker_state(0),
 	overhead_bytes(0)
 {
 	if(hash_password)
@@ -114,17 +115,20 @@ bool AESGCMDecryption::put( const char *data, size_t data_size)
 
 				if(carry_zeros>0)
 				{
-					for(size_t i=0;i<carry_zeros;++i)
-						decryption_filter.Put(0);
+					char zeros[end_marker_zeros] = {};
+					decryptData(zeros, carry_zeros);
 				}
 
-				if(has_copy && data_size-escaped_zeros>0)
+				if(has_copy)
 				{
-					decryption_filter.Put(reinterpret_cast<const byte*>(data_copy.data()), data_size-escaped_zeros);
+					if(data_size-escaped_zeros>0)
+					{
+						decryptData(data_copy.data(), data_size-escaped_zeros);
+					}
 				}
 				else if(data_size>0)
 				{
-					decryption_filter.Put(reinterpret_cast<const byte*>(data), data_size);
+					decryptData(data, data_size);
 				}
 
 				VLOG(Server->Log("Data without end: "+convert(data_size), LL_DEBUG));
@@ -136,31 +140,33 @@ bool AESGCMDecryption::put( const char *data, size_t data_size)
 			{
 				if(carry_zeros>0)
 				{
-					for(size_t i=0;i<carry_zeros;++i)
-						decryption_filter.Put(0);
+					char zeros[end_marker_zeros] = {};
+					decryptData(zeros, carry_zeros);
 				}
 
 				if(has_copy)
 				{
-					decryption_filter.Put(reinterpret_cast<const byte*>(data_copy.data()), end_marker_pos-end_marker_zeros-1);
+					decryptData(data_copy.data(), end_marker_pos-end_marker_zeros-1);
 				}
 				else
 				{
-					decryption_filter.Put(reinterpret_cast<const byte*>(data), end_marker_pos-end_marker_zeros-1);
+					decryptData(data, end_marker_pos-end_marker_zeros-1);
 				}
 			}
-			try
+			else if(carry_zeros+end_marker_pos>end_marker_zeros+1)
 			{
-				VLOG(Server->Log("Message end. Size: "+convert(decryption_filter.MaxRetrievable()), LL_DEBUG));
-				decryption_filter.MessageEnd();
+				//End marker started in the previous data, but not all of the
+				//zeros held back from there belong to it
+				char zeros[end_marker_zeros] = {};
+				decryptData(zeros, carry_zeros+end_marker_pos-end_marker_zeros-1);
 			}
-			catch (CryptoPP::Exception& e)
+			
+			if(!endMessage())
 			{
-				Server->Log(std::string("Exception during decryption (message end): ") + e.what(), LL_DEBUG);
 				return false;
 			}
-			
-			overhead_bytes+=16; //tag size
+
+			overhead_bytes+=tag_size;
 
 			CryptoPP::IncrementCounterByOne(reinterpret_cast<byte*>(&iv_buffer[0]), static_cast<unsigned int>(iv_buffer.size()));
 			decryption.Resynchronize(reinterpret_cast<const byte*>(iv_buffer.data()), static_cast<int>(iv_buffer.size()));
@@ -180,63 +186,97 @@ bool AESGCMDecryption::put( const char *data, size_t data_size)
 	}
 }
 
-std::string AESGCMDecryption::get( bool& has_error )
+void AESGCMDecryption::decryptData( const char *data, size_t data_size )
 {
-	try
+	//Hold back the last tag_size bytes as they might be the tag
+	if(tag_buffer.size()+data_size<=tag_size)
 	{
-		std::string ret;
-		if(decryption_filter.NumberOfMessages()>0)
-		{
-			ret.resize(decryption_filter.MaxRetrievable());
+		tag_buffer.append(data, data_size);
+		return;
+	}
 
-			if(!ret.empty())
-			{
-				size_t nb = decryption_filter.Get(reinterpret_cast<byte*>(&ret[0]), ret.size());
-				if(nb!=ret.size())
-				{
-					assert(false);
-					ret.resize(nb);
-				}
-			}
+	size_t release = tag_buffer.size()+data_size-tag_size;
+	size_t from_tag = (std::min)(release, tag_buffer.size());
+	if(from_tag>0)
+	{
+		decryptToPlain(tag_buffer.data(), from_tag);
+		tag_buffer.erase(0, from_tag);
+	}
 
-			decryption_filter.GetNextMessage();
-		}
+	size_t from_data = release-from_tag;
+	if(from_data>0)
+	{
+		decryptToPlain(data, from_data);
+	}
 
-		has_error=false;
-		return ret;
+	tag_buffer.append(data+from_data, data_size-from_data);
+}
+
+void AESGCMDecryption::decryptToPlain( const char *data, size_t data_size )
+{
+	if(plain_pos==plain.size())
+	{
+		plain.clear();
+		plain_pos=0;
+		verified_size=0;
 	}
-	catch (CryptoPP::Exception& e)
+	else if(plain_pos>plain.size()/2)
 	{
-		Server->Log(std::string("Exception during decryption (get): ")+e.what(), LL_ERROR);
-		has_error=true;
+		plain.erase(0, plain_pos);
+		verified_size-=plain_pos;
+		plain_pos=0;
 	}
 
-	return std::string();
+	//Decrypt directly into the output buffer. Crypto++ uses AES-NI and
+	//PCLMUL for this if the CPU supports them.
+	size_t offset = plain.size();
+	plain.resize(offset+data_size);
+	decryption.ProcessData(reinterpret_cast<byte*>(&plain[offset]),
+		reinterpret_cast<const byte*>(data), data_size);
 }
 
-bool AESGCMDecryption::get( char *data, size_t& data_size )
+bool AESGCMDecryption::endMessage()
 {
-	try
-	{
-		if(decryption_filter.NumberOfMessages()>0)
-		{
-			data_size = decryption_filter.Get(reinterpret_cast<byte*>(data), data_size);
+	VLOG(Server->Log("Message end. Size: "+convert(plain.size()-verified_size), LL_DEBUG));
 
-			decryption_filter.GetNextMessage();
-		}
-		else
-		{
-			data_size=0;
-		}
+	if(tag_buffer.size()!=tag_size)
+	{
+		Server->Log("Encrypted message too short", LL_DEBUG);
+		return false;
+	}
 
-		return true;
+	if(!decryption.TruncatedVerify(reinterpret_cast<const byte*>(tag_buffer.data()), tag_size))
+	{
+		Server->Log("Error during decryption (message end): Authentication failed", LL_DEBUG);
+		return false;
 	}
-	catch (CryptoPP::Exception& e)
+
+	tag_buffer.clear();
+	verified_size=plain.size();
+	return true;
+}
+
+std::string AESGCMDecryption::get( bool& has_error )
+{
+	has_error=false;
+
+	std::string ret(plain.data()+plain_pos, verified_size-plain_pos);
+	plain_pos=verified_size;
+
+	return ret;
+}
+
+bool AESGCMDecryption::get( char *data, size_t& data_size )
+{
+	data_size = (std::min)(data_size, verified_size-plain_pos);
+
+	if(data_size>0)
 	{
-		Server->Log(std::string("Exception during decryption (get2): ")+e.what(), LL_ERROR);
+		memcpy(data, plain.data()+plain_pos, data_size);
+		plain_pos+=data_size;
 	}
 
-	return false;
+	return true;
 }
 
 size_t AESGCMDecryption::findAndUnescapeEndMarker( const char* data, size_t data_size, std::string& data_copy,
@@ -313,6 +353,6 @@ int64 AESGCMDecryption::getOverheadBytes()
 
 bool AESGCMDecryption::hasData()
 {
-	return decryption_filter.NumberOfMessages()>0;
+	return plain_pos<verified_size;
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "IAESGCMDecryption.h"
 #include "cryptopp_inc.h"
+#include <string>
 
 class AESGCMDecryption : public IAESGCMDecryption
 {
@@ -18,12 +19,21 @@ public:
 	virtual bool hasData();
 
 private:
+	void decryptData(const char *data, size_t data_size);
+	void decryptToPlain(const char *data, size_t data_size);
+	bool endMessage();
+
 	size_t findAndUnescapeEndMarker(const char *data, size_t data_size,
 		std::string& data_copy, bool& has_copy, bool& has_error,
 		size_t& escaped_zeros);
 
 	CryptoPP::GCM<CryptoPP::AES >::Decryption decryption;
-	CryptoPP::AuthenticatedDecryptionFilter decryption_filter;
+	//Last bytes of the current message. Those are the tag if the message ends.
+	std::string tag_buffer;
+	//Decrypted data. Only data before verified_size has been authenticated.
+	std::string plain;
+	size_t plain_pos;
+	size_t verified_size;
 
 	CryptoPP::SecByteBlock m_sbbKey;
 	std::string iv_buffer;
@@ -25,11 +25,12 @@
 
 const size_t iv_size = 12;
 const size_t end_marker_zeros = 4;
+const size_t tag_size = 16;
 
 using namespace CryptoPPCompat;
 
 AESGCMEncryption::AESGCMEncryption( const std::string& key, bool hash_password)
-	: encryption(), encryption_filter(encryption), iv_done(false), end_marker_state(0),
+	: encryption(), end_marker_state(0),
 	overhead_size(0), message_size(0)
 {
 	if(hash_password)
@@ -52,9 +53,9 @@ AESGCMEncryption::AESGCMEncryption( const std::string& key, bool hash_password)
 	encryption.SetKeyWithIV(m_sbbKey.BytePtr(), m_sbbKey.size(),
 		m_IV.BytePtr(), m_IV.size());
 
-	m_orig_IV = m_IV;
-
-	iv_done=false;
+	//The stream starts with the initial IV
+	output.assign(reinterpret_cast<const char*>(m_IV.BytePtr()), m_IV.size());
+	overhead_size+=m_IV.size();
 
 	assert(encryption.CanUseStructuredIVs());
 	assert(encryption.IsResynchronizable());
@@ -63,89 +64,64 @@ AESGCMEncryption::AESGCMEncryption( const std::string& key, bool hash_password)
 
 void AESGCMEncryption::put( const char *data, size_t data_size )
 {
-	encryption_filter.Put(reinterpret_cast<const byte*>(data), data_size);
+	if(data_size==0)
+	{
+		return;
+	}
+
+	//Encrypt directly into the output buffer. Crypto++ uses AES-NI and
+	//PCLMUL for this if the CPU supports them.
+	size_t offset = output.size();
+	output.resize(offset+data_size);
+	encryption.ProcessData(reinterpret_cast<byte*>(&output[offset]),
+		reinterpret_cast<const byte*>(data), data_size);
+
+	escapeEndMarker(offset);
 	message_size+=data_size;
 }
 
 void AESGCMEncryption::flush()
 {
-	encryption_filter.MessageEnd();
-	end_markers.push_back(encryption_filter.MaxRetrievable());
+	byte tag[tag_size];
+	encryption.TruncatedFinal(tag, tag_size);
+
+	size_t offset = output.size();
+	output.append(reinterpret_cast<const char*>(tag), tag_size);
+	escapeEndMarker(offset);
+
+	output.append(end_marker_zeros, 0);
+	output+=static_cast<char>(1);
+	end_marker_state=0;
+	overhead_size+=tag_size+end_marker_zeros+1;
+
+	VLOG(Server->Log("New message. Size: "+convert(message_size+end_marker_zeros+1), LL_DEBUG));
+	message_size=0;
+
 	CryptoPP::IncrementCounterByOne(m_IV.BytePtr(), static_cast<unsigned int>(m_IV.size()));
 	encryption.Resynchronize(m_IV.BytePtr(), static_cast<int>(m_IV.size()));
-	overhead_size+=16; //tag size
 }
 
 std::string AESGCMEncryption::get()
 {
 	std::string ret;
-
-	size_t iv_add = iv_done ? 0 : m_IV.size();
-
-	size_t max_retrievable;
-
-	bool add_end_marker=false;
-	if(!end_markers.empty())
-	{
-		max_retrievable = end_markers[0];
-		end_markers.erase(end_markers.begin());
-		add_end_marker=true;
-	}
-	else
-	{
-		max_retrievable = encryption_filter.MaxRetrievable();
-	}
-
-	ret.resize(max_retrievable+iv_add + ( add_end_marker ? (end_marker_zeros + 1) : 0 ) );
-
-	if(!iv_done)
-	{
-		memcpy(&ret[0], m_orig_IV.BytePtr(), m_orig_IV.size());
-		iv_done=true;
-		overhead_size+=m_orig_IV.size();
-	}
-
-	if(max_retrievable>0)
-	{
-		size_t nb = encryption_filter.Get(reinterpret_cast<byte*>(&ret[iv_add]), max_retrievable);
-		assert(nb==max_retrievable);
-		/*if(nb!=max_retrievable)
-		{
-			ret.resize(nb+iv_add+ ( add_end_marker ? (end_marker_zeros + 1) : 0 ));
-		}*/
-		escapeEndMarker(ret, iv_add+nb, iv_add);
-		decEndMarkers(nb);
-	}
-
-	if(add_end_marker)	
-	{
-		//The rest is already zero
-		ret[ret.size()-1]=1;
-		end_marker_state=0;
-		overhead_size+=end_marker_zeros+1;
-		message_size+=end_marker_zeros+1;
-		encryption_filter.GetNextMessage();
-		VLOG(Server->Log("New message. Size: "+convert(message_size), LL_DEBUG));
-		message_size=0;
-	}
-
+	get(ret);
 	return ret;
 }
 
-void AESGCMEncryption::decEndMarkers( size_t n )
+void AESGCMEncryption::get(std::string& ret)
 {
-	for(size_t i=0;i<end_markers.size();++i)
-		end_markers[i]-=n;
+	ret.clear();
+	ret.swap(output);
 }
 
-void AESGCMEncryption::escapeEndMarker(std::string& ret, size_t size, size_t offset)
+void AESGCMEncryption::escapeEndMarker(size_t offset)
 {
-	for(size_t i=offset;i<size;)
+	for(size_t i=offset;i<output.size();)
 	{
-		char ch=ret[i];
+		char ch=output[i];
 
-		if(end_marker_state==0 && i+end_marker_zeros<=size
-			&& ret[i+end_marker_zeros-1]!=0)
+		if(end_marker_state==0 && i+end_marker_zeros<=output.size()
+			&& output[i+end_marker_zeros-1]!=0)
 		{
 			i+=end_marker_zeros;
 			continue;
@@ -158,7 +134,7 @@ void AESGCMEncryption::escapeEndMarker(std::string& ret, size_t size, size_t off
 			if(end_marker_state==end_marker_zeros)
 			{
 				char ich=2;
-				ret.insert(ret.begin()+i+1, ich);
+				output.insert(output.begin()+i+1, ich);
 				++i;
 				end_marker_state=0;
 				Server->Log("Escaped something at "+convert(i), LL_DEBUG);
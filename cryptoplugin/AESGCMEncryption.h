@@ -1,7 +1,7 @@
 #pragma once
 #include "IAESGCMEncryption.h"
 #include "cryptopp_inc.h"
-#include <vector>
+#include <string>
 
 class AESGCMEncryption : public IAESGCMEncryption
 {
@@ -14,22 +14,20 @@ public:
 
 	virtual std::string get();
 
+	virtual void get(std::string& ret);
+
 	virtual int64 getOverheadBytes();
 
 private:
-	void reinit();
-	void decEndMarkers(size_t n);
-	void escapeEndMarker(std::string& ret, size_t size, size_t offset);
+	void escapeEndMarker(size_t offset);
 
 	size_t end_marker_state;
-	bool iv_done;
 	CryptoPP::SecByteBlock m_sbbKey;
 	CryptoPP::SecByteBlock m_IV;
-	CryptoPP::SecByteBlock m_orig_IV;
 
 	CryptoPP::GCM<CryptoPP::AES >::Encryption encryption;
-	CryptoPP::AuthenticatedEncryptionFilter encryption_filter;
-	std::vector<size_t> end_markers;
+	//Encrypted and escaped data not retrieved yet
+	std::string output;
 	int64 overhead_size;
 	size_t message_size;
 };
\ No newline at end of file
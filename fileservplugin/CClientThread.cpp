@@ -41,6 +41,7 @@
 #include "FileServFactory.h"
 #include "../urbackupcommon/os_functions.h"
 #include "PipeSessions.h"
+#include "ReadAheadEngine.h"
 
 #ifndef _WIN32
 #include <sys/types.h>
@@ -57,13 +58,6 @@
 #define O_LARGEFILE 0
 #define stat64 stat
 #define fstat64 fstat
-
-#if defined(__FreeBSD__)
-#define sendfile64(a, b, c, d, e) sendfile(a, b, c, d, NULL, e, 0)
-#else
-#define sendfile64(a, b, c, d, e) sendfile(a, b, c, e, NULL, 0)
-#endif
-
 #endif
 
 #include "FileMetadataPipe.h"
@@ -87,6 +81,12 @@
 #define CHECK_BASE_PATH
 #define SEND_TIMEOUT 300000
 
+namespace
+{
+	//Maximum number of bytes to send with one sendfile call
+	const size_t c_sendfile_bsize = 1024 * 1024;
+}
+
 
 CClientThread::CClientThread(SOCKET pSocket, CTCPFileServ* pParent)
 	: extra_buffer(NULL), waiting_for_chunk(false),
@@ -497,18 +497,8 @@ bool CClientThread::ProcessPacket(CRData *data)
 #ifdef _WIN32
 				if(!is_script)
 				{
-					if(filename.size()>=2 && filename[0]=='\\' && filename[1]=='\\' )
-					{
-						if(filename.size()<3 || filename[2]!='?')
-						{
-							filename="\\\\?\\UNC"+filename.substr(1);
-						}
-					}
-					else
-					{
-						filename = "\\\\?\\"+filename;
-					}
-				}				
+					addLongPathPrefix(filename);
+				}
 
 				if(bufmgr==NULL && !is_script)
 				{
@@ -516,21 +506,17 @@ bool CClientThread::ProcessPacket(CRData *data)
 				}
 #endif
 
-				if (!is_script
-					&& metadata_id != 0
-					&& FileServ::hasReadError(filename))
+				if (!is_script)
 				{
-					FileServ::clearReadErrorFile(filename);
-
-					char ch = ID_READ_ERROR;
-					int rc = SendInt(&ch, 1);
-					if (rc == SOCKET_ERROR)
+					bool sent_read_error;
+					if (!sendPreviousReadError(filename, metadata_id, sent_read_error))
 					{
-						Log("Error: Socket Error - DBG: Send ID_READ_ERROR", LL_DEBUG);
 						return false;
 					}
-					Log("Info: Returning read error instead of sending file \""+filename+"\"", LL_DEBUG);
-					break;
+					if (sent_read_error)
+					{
+						break;
+					}
 				}
 				
 				if(is_script)
@@ -612,66 +598,20 @@ bool CClientThread::ProcessPacket(CRData *data)
 						break;
 					}
 				}
-				else if(metadata_id!=0 && next(s_filename, 0, "clientdl"))
-				{
-					PipeSessions::transmitFileMetadata(filename,
-						s_filename, ident, ident, folder_items, metadata_id);
-				}
-				else if(metadata_id!=0 && s_filename.find("|")!=std::string::npos)
-				{
-					PipeSessions::transmitFileMetadata(filename,
-						getafter("|",s_filename), getuntil("|", s_filename), ident, folder_items, metadata_id);
-				}
+
+				transmitMetadata(filename, s_filename, ident, folder_items, metadata_id);
 
 				ScopedShareActive scoped_share_active(o_filename);
 
 #ifndef LINUX
-				DWORD extra_flags = 0;
-				if (id == ID_GET_FILE_METADATA_ONLY)
-				{
-					extra_flags = FILE_FLAG_OPEN_REPARSE_POINT;
-				}
-#ifndef BACKUP_SEM
-				hFile=CreateFileW(Server->ConvertToWchar(filename).c_str(), FILE_READ_DATA, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED|FILE_FLAG_SEQUENTIAL_SCAN, NULL);
-#else
-				if (backup_semantics)
-					extra_flags |= FILE_FLAG_BACKUP_SEMANTICS;
-				hFile=CreateFileW(Server->ConvertToWchar(filename).c_str(), FILE_READ_DATA, FILE_SHARE_READ, NULL, OPEN_EXISTING,
-					FILE_FLAG_OVERLAPPED|FILE_FLAG_SEQUENTIAL_SCAN|extra_flags, NULL);
-#endif
+				hFile=openSendFile(filename, true, id == ID_GET_FILE_METADATA_ONLY);
 
 				if(hFile == INVALID_HANDLE_VALUE)
 				{
-					std::string openerr = os_last_error_str();
-#ifdef CHECK_BASE_PATH
-					std::string share_name = getuntil("/",o_filename);
-					if(!share_name.empty())
-					{
-						bool allow_exec;
-						std::string basePath=map_file(share_name+"/", ident, allow_exec, NULL);
-						if(!isDirectory(basePath))
-						{
-							char ch=ID_BASE_DIR_LOST;
-							int rc=SendInt(&ch, 1);
-							if(rc==SOCKET_ERROR)
-							{
-								Log("Error: Socket Error - DBG: Send BASE_DIR_LOST", LL_DEBUG);
-								return false;
-							}
-							Log("Info: Base dir lost", LL_DEBUG);
-							break;
-						}
-					}					
-#endif
-					
-					char ch=ID_COULDNT_OPEN;
-					int rc=SendInt(&ch, 1);
-					if(rc==SOCKET_ERROR)
+					if (!sendOpenError(o_filename, ident, "Could not open file "+ filename+". "+ os_last_error_str(), metadata_id != 0 ? LL_ERROR : LL_INFO))
 					{
-						Log("Error: Socket Error - DBG: Send COULDNT OPEN", LL_DEBUG);
 						return false;
 					}
-					Log("Could not open file "+ filename+". "+ openerr, metadata_id != 0 ? LL_ERROR : LL_INFO);
 					break;
 				}
 
@@ -979,46 +919,14 @@ bool CClientThread::ProcessPacket(CRData *data)
                     break;
                 }
 
-				int flags = O_RDONLY | O_LARGEFILE;
-#if defined(O_CLOEXEC)
-				flags |= O_CLOEXEC;
-#endif
-#if defined(O_NOATIME)
-				if(backup_semantics)
-					flags |= O_NOATIME;
-#endif
-				hFile=open64(filename.c_str(), flags);
+				hFile=openSendFile(filename, false, false);
 				
 				if(hFile == INVALID_HANDLE_VALUE)
 				{
-#ifdef CHECK_BASE_PATH
-					std::string share_name = getuntil("/",o_filename);
-					if(!share_name.empty())
+					if (!sendOpenError(o_filename, ident, "Info: Couldn't open file", LL_DEBUG))
 					{
-						bool allow_exec;
-						std::string basePath=map_file(share_name+"/", ident, allow_exec, NULL);
-						if(!isDirectory(basePath))
-						{
-							char ch=ID_BASE_DIR_LOST;
-							int rc=SendInt(&ch, 1);
-							if(rc==SOCKET_ERROR)
-							{
-								Log("Error: Socket Error - DBG: Send BASE_DIR_LOST", LL_DEBUG);
-								return false;
-							}
-							Log("Info: Base dir lost", LL_DEBUG);
-							break;
-						}
-					}					
-#endif
-					char ch=ID_COULDNT_OPEN;
-					int rc=SendInt(&ch, 1);
-					if(rc==SOCKET_ERROR)
-					{
-						Log("Error: Socket Error - DBG: Send COULDNT OPEN", LL_DEBUG);
 						return false;
 					}
-					Log("Info: Couldn't open file", LL_DEBUG);
 					break;
 				}
 				
@@ -1093,6 +1001,9 @@ bool CClientThread::ProcessPacket(CRData *data)
 
 				unsigned int s_bsize=8192;
 
+				//Plain TCP connection. Send directly from file to socket
+				bool use_sendfile = has_socket && !with_hashes;
+
 				if( !with_hashes )
 				{
 					s_bsize=32768;
@@ -1105,7 +1016,7 @@ bool CClientThread::ProcessPacket(CRData *data)
 					    next_checkpoint=curr_filesize;
 				}
 
-				if((clientpipe!=NULL || with_hashes) && foffset>0)
+				if(!use_sendfile && foffset>0)
 				{
 					if(lseek64(hFile, foffset, SEEK_SET)!=foffset)
 					{
@@ -1118,6 +1029,21 @@ bool CClientThread::ProcessPacket(CRData *data)
 				std::vector<char> buf;
 				buf.resize(s_bsize);
 
+				bool use_read_ahead = false;
+				if (!use_sendfile)
+				{
+					if (read_ahead.get() == NULL)
+					{
+						read_ahead.reset(ReadAheadEngine::create());
+					}
+
+					if (read_ahead.get() != NULL)
+					{
+						use_read_ahead = read_ahead->setFd(hFile);
+						read_ahead->setEnd(filesize);
+					}
+				}
+
 				bool has_error=false;
 				size_t extent_pos = 0;
 
@@ -1146,7 +1072,7 @@ bool CClientThread::ProcessPacket(CRData *data)
 							if (next_checkpoint>curr_filesize)
 								next_checkpoint = curr_filesize;
 
-							if (clientpipe != NULL || with_hashes)
+							if (!use_sendfile)
 							{
 								off64_t rc = lseek64(hFile, foffset, SEEK_SET);
 
@@ -1173,28 +1099,37 @@ bool CClientThread::ProcessPacket(CRData *data)
 						}
 					}
 				
-					size_t count=(std::min)((size_t)s_bsize, (size_t)(next_checkpoint-foffset));
+					size_t max_count = s_bsize;
+					if (use_sendfile && !FileServ::isPause())
+					{
+						max_count = c_sendfile_bsize;
+					}
+
+					size_t count=(std::min)(max_count, (size_t)(next_checkpoint-foffset));
 
 					if (has_file_extents)
 					{
 						if (extent_pos < file_extents.size())
 						{
 							count = static_cast<size_t>((std::min)(file_extents[extent_pos].offset - foffset, static_cast<int64>(count)));
+
+							if (use_read_ahead)
+							{
+								read_ahead->setEnd(file_extents[extent_pos].offset);
+							}
+						}
+						else if (use_read_ahead)
+						{
+							read_ahead->setEnd(filesize);
 						}
 					}
 
-					if( clientpipe==NULL && !with_hashes && count>0 )
+					if( use_sendfile && count>0 )
 					{
-						#if defined(__APPLE__) || defined(__FreeBSD__)
-						ssize_t rc=sendfile64(int_socket, hFile, foffset, count, reinterpret_cast<off_t*>(&count));
-						if(rc==0)
-						{
-							foffset+=count;
-							rc=count;
-						}
-						#else			
-						ssize_t rc=sendfile64(int_socket, hFile, &foffset, count);
-						#endif
+						int64 l_foffset = foffset;
+						int64 rc = sendFileRange(hFile, l_foffset, count);
+						foffset = l_foffset;
+
 						if(rc<0)
 						{
 							Log("Error: Reading and sending from file failed. Errno: "+convert(errno), LL_DEBUG);
@@ -1202,18 +1137,20 @@ bool CClientThread::ProcessPacket(CRData *data)
 							CloseHandle(hFile);
 							return false;
 						}
-						else if(rc==0 && foffset<filesize && errno == 0) //other process made the file smaller
+						else if(rc<static_cast<int64>(count)) //other process made the file smaller
 						{
 							memset(buf.data(), 0, s_bsize);
 							while(foffset<filesize)
 							{
-								rc=SendInt(buf.data(), (std::min)((size_t)s_bsize, (size_t)(next_checkpoint-foffset)));
-								if(rc==SOCKET_ERROR)
+								size_t tosend = (std::min)((size_t)s_bsize, (size_t)(filesize-foffset));
+								int src=SendInt(buf.data(), tosend);
+								if(src==SOCKET_ERROR)
 								{
 									Log("Error: Sending data failed");
 									CloseHandle(hFile);
 									return false;
 								}
+								foffset+=tosend;
 							}
 						}
 					}
@@ -1221,7 +1158,20 @@ bool CClientThread::ProcessPacket(CRData *data)
 					{
 						if (count > 0)
 						{
-							ssize_t rc = read(hFile, buf.data(), count);
+							ssize_t rc;
+							if (use_read_ahead)
+							{
+								bool read_error = false;
+								rc = read_ahead->Read(foffset, buf.data(), static_cast<_u32>(count), &read_error);
+								if (read_error)
+								{
+									rc = -1;
+								}
+							}
+							else
+							{
+								rc = read(hFile, buf.data(), count);
+							}
 
 							if (rc == 0 && rc < count && errno == 0)  //other process made the file smaller
 							{
@@ -1276,6 +1226,11 @@ bool CClientThread::ProcessPacket(CRData *data)
 					}
 				}
 				
+				if (use_read_ahead)
+				{
+					read_ahead->setFd(-1);
+				}
+
 				CloseHandle(hFile);
 				hFile=INVALID_HANDLE_VALUE;
 #endif
@@ -1329,6 +1284,20 @@ bool CClientThread::ProcessPacket(CRData *data)
 					return false;
 				}
 			} break;
+		case ID_COMPRESS_STREAM:
+			{
+				if (!CompressStream(data))
+				{
+					return false;
+				}
+			} break;
+		case ID_GET_FILE_BUNDLE:
+			{
+				if (!GetFileBundle(data))
+				{
+					return false;
+				}
+			} break;
 		case ID_FREE_SERVER_FILE:
 			{
 				if (chunk_send_thread_ticket != ILLEGAL_THREADPOOL_TICKET)
@@ -1500,6 +1469,60 @@ bool CClientThread::ReadFilePart(HANDLE hFile, _i64 offset, bool last, _u32 tore
 {
 	return false;
 }
+
+int64 CClientThread::sendFileRange(HANDLE hFile, int64& foffset, size_t count)
+{
+	int64 sent = 0;
+	while (count > 0)
+	{
+		errno = 0;
+#if defined(__APPLE__)
+		off_t l_sent = static_cast<off_t>(count);
+		int rc = sendfile(hFile, int_socket, static_cast<off_t>(foffset), &l_sent, NULL, 0);
+#elif defined(__FreeBSD__)
+		off_t l_sent = 0;
+		int rc = sendfile(hFile, int_socket, static_cast<off_t>(foffset), count, NULL, &l_sent, 0);
+#else
+		off64_t l_foffset = foffset;
+		ssize_t rc = sendfile64(int_socket, hFile, &l_foffset, count);
+		off64_t l_sent = rc > 0 ? l_foffset - foffset : 0;
+#endif
+		if (l_sent > 0)
+		{
+			foffset += l_sent;
+			sent += l_sent;
+			count -= static_cast<size_t>(l_sent);
+		}
+
+		if (rc >= 0)
+		{
+			if (l_sent == 0)
+			{
+				//EOF
+				return sent;
+			}
+			continue;
+		}
+
+		if (errno == EINTR)
+		{
+			continue;
+		}
+
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			if (!clientpipe->isWritable(SEND_TIMEOUT))
+			{
+				return -1;
+			}
+			continue;
+		}
+
+		return -1;
+	}
+
+	return sent;
+}
 #endif
 
 int CClientThread::SendData()
@@ -1794,17 +1817,7 @@ bool CClientThread::GetFileBlockdiff(CRData *data, bool with_metadata)
 #ifdef _WIN32
 	if(!is_script)
 	{
-		if(filename.size()>=2 && filename[0]=='\\' && filename[1]=='\\' )
-		{
-			if(filename.size()<3 || filename[2]!='?')
-			{
-				filename="\\\\?\\UNC"+filename.substr(1);
-			}
-		}
-		else
-		{
-			filename = "\\\\?\\"+filename;
-		}
+		addLongPathPrefix(filename);
 	}
 #endif
 
@@ -1880,44 +1893,17 @@ bool CClientThread::GetFileBlockdiff(CRData *data, bool with_metadata)
 
 		scoped_share_active.reset(s_filename);
 
-#ifdef _WIN32
-#ifndef BACKUP_SEM
-		hFile=CreateFileW(Server->ConvertToWchar(filename).c_str(), FILE_READ_DATA, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
-#else
-		DWORD flags = FILE_FLAG_SEQUENTIAL_SCAN;
-		if (backup_semantics)
-			flags |= FILE_FLAG_BACKUP_SEMANTICS;
-		hFile=CreateFileW(Server->ConvertToWchar(filename).c_str(), FILE_READ_DATA, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
-#endif
-#else //_WIN32
-		int flags = O_RDONLY | O_LARGEFILE;
-#if defined(O_CLOEXEC)
-		flags |= O_CLOEXEC;
-#endif
-#if defined(O_NOATIME)
-		if(backup_semantics)
-			flags |= O_NOATIME;
-#endif
-		hFile=open64(filename.c_str(), flags);
-#endif //_WIN32
+		hFile=openSendFile(filename, false, false);
 
 		if(hFile == INVALID_HANDLE_VALUE)
 		{
 			std::string errstr = os_last_error_str();
-	#ifdef CHECK_BASE_PATH
-			std::string share_name = getuntil("/",o_filename);
-			if(!share_name.empty())
+			if(isBaseDirLost(o_filename, ident))
 			{
-				bool allow_exec;
-				std::string basePath=map_file(share_name+"/", ident, allow_exec, NULL);
-				if(!isDirectory(basePath))
-				{
-					queueChunk(SChunk(ID_BASE_DIR_LOST));
-					Log("Info: Base dir lost", LL_DEBUG);
-					return true;
-				}
-			}			
-	#endif
+				queueChunk(SChunk(ID_BASE_DIR_LOST));
+				Log("Info: Base dir lost", LL_DEBUG);
+				return true;
+			}
 					
 			queueChunk(SChunk(ID_COULDNT_OPEN));
 			Log("Could not open file "+filename+". " + errstr, metadata_id != 0 ? LL_ERROR : LL_INFO);
@@ -2027,7 +2013,8 @@ bool CClientThread::Handle_ID_BLOCK_REQUEST(CRData *data)
 		data->incrementPtr(big_hash_size);
 		memcpy(chunk.small_hash, data->getCurrDataPtr(), small_hash_size*(c_checkpoint_dist/c_small_hash_dist));
 	}
-	else if(chunk.transfer_all==0)
+	else if(chunk.transfer_all==0
+		|| chunk.transfer_all==c_block_request_copy)
 	{
 		return false;
 	}
@@ -2128,47 +2115,14 @@ bool CClientThread::GetFileHashAndMetadata( CRData* data )
 	}
 
 #ifdef _WIN32
-	if(filename.size()>=2 && filename[0]=='\\' && filename[1]=='\\' )
-	{
-		if(filename.size()<3 || filename[2]!='?')
-		{
-			filename="\\\\?\\UNC"+filename.substr(1);
-		}
-	}
-	else
-	{
-		filename = "\\\\?\\"+filename;
-	}		
+	addLongPathPrefix(filename);
 #endif
 
-#ifdef _WIN32
-#ifndef BACKUP_SEM
-	hFile=CreateFileW(Server->ConvertToWchar(filename).c_str(), FILE_READ_DATA, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
-#else
-	DWORD flags = FILE_FLAG_SEQUENTIAL_SCAN;
-	if (backup_semantics)
-		flags |= FILE_FLAG_BACKUP_SEMANTICS;
-	hFile=CreateFileW(Server->ConvertToWchar(filename).c_str(), FILE_READ_DATA, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
-#endif
-#else //_WIN32
-	int flags = O_RDONLY | O_LARGEFILE;
-#if defined(O_CLOEXEC)
-	flags |= O_CLOEXEC;
-#endif
-#if defined(O_NOATIME)
-	if(backup_semantics)
-		flags |= O_NOATIME;
-#endif
-	hFile=open64(filename.c_str(), flags);
-#endif //_WIN32
+	hFile=openSendFile(filename, false, false);
 
 	if(hFile == INVALID_HANDLE_VALUE)
 	{
-#ifdef CHECK_BASE_PATH
-		std::string share_name = getuntil("/",o_filename);
-		bool allow_exec;
-		std::string basePath=map_file(share_name + "/", ident, allow_exec, NULL);
-		if(!isDirectory(basePath))
+		if(isBaseDirLost(o_filename, ident))
 		{
 			char ch=ID_BASE_DIR_LOST;
 			int rc=SendInt(&ch, 1);
@@ -2180,7 +2134,6 @@ bool CClientThread::GetFileHashAndMetadata( CRData* data )
 			Log("Info: Base dir lost -hash", LL_DEBUG);
 			return false;
 		}
-#endif
 
 		char ch=ID_COULDNT_OPEN;
 		int rc=SendInt(&ch, 1);
@@ -2247,7 +2200,267 @@ bool CClientThread::GetFileHashAndMetadata( CRData* data )
 	return true;
 }
 
-bool CClientThread::sendFullFile(IFile* file, _i64 start_offset, bool with_hashes)
+bool CClientThread::GetFileBundle(CRData* data)
+{
+#ifdef CHECK_IDENT
+	std::string ident;
+	data->getStr(&ident);
+	if(!FileServ::checkIdentity(ident))
+	{
+		Log("Identity check failed -bundle", LL_DEBUG);
+		return false;
+	}
+#endif
+
+	char c_version;
+	if(!data->getChar(&c_version)
+		|| c_version!=0)
+	{
+		return false;
+	}
+
+	char c_with_hashes;
+	if(!data->getChar(&c_with_hashes))
+	{
+		return false;
+	}
+
+	size_t n_files = 0;
+	while(data->getLeft()>0)
+	{
+		std::string s_filename;
+		if(!data->getStr(&s_filename))
+		{
+			return false;
+		}
+
+		int64 metadata_id;
+		if(!data->getVarInt(&metadata_id))
+		{
+			return false;
+		}
+
+		if(!sendBundleFile(s_filename, ident, metadata_id, c_with_hashes!=0))
+		{
+			return false;
+		}
+
+		++n_files;
+	}
+
+	Log("Sent file bundle with "+convert(n_files)+" files", LL_DEBUG);
+
+	return true;
+}
+
+bool CClientThread::sendBundleFile(const std::string& s_filename, const std::string& ident, int64 metadata_id, bool with_hashes)
+{
+	Log("Sending file (bundle) "+s_filename+" metadata_id="+convert(metadata_id), LL_DEBUG);
+
+	if(next(s_filename, 0, "SCRIPT|"))
+	{
+		Log("Scripts cannot be sent in a file bundle", LL_ERROR);
+		char ch=ID_COULDNT_OPEN;
+		return SendInt(&ch, 1)!=SOCKET_ERROR;
+	}
+
+	bool allow_exec;
+	std::string filename=map_file(s_filename, ident, allow_exec, NULL);
+
+	Log("Mapped name: "+filename, LL_DEBUG);
+
+	if(filename.empty())
+	{
+		char ch=ID_BASE_DIR_LOST;
+		int rc=SendInt(&ch, 1);
+		if(rc==SOCKET_ERROR)
+		{
+			Log("Error: Socket Error - DBG: Send BASE_DIR_LOST -bundle", LL_DEBUG);
+			return false;
+		}
+		Log("Info: Base dir lost -bundle", LL_DEBUG);
+		return true;
+	}
+
+#ifdef _WIN32
+	addLongPathPrefix(filename);
+#endif
+
+	bool sent_read_error;
+	if (!sendPreviousReadError(filename, metadata_id, sent_read_error))
+	{
+		return false;
+	}
+	if (sent_read_error)
+	{
+		return true;
+	}
+
+	transmitMetadata(filename, s_filename, ident, 0, metadata_id);
+
+	ScopedShareActive scoped_share_active(s_filename);
+
+	if(isDirectory(filename))
+	{
+		CWData data;
+		data.addUChar(ID_FILESIZE);
+		data.addUInt64(little_endian(static_cast<uint64>(0)));
+
+		int rc=SendInt(data.getDataPtr(), data.getDataSize());
+		if(rc==SOCKET_ERROR)
+		{
+			Log("Error: Socket Error - DBG: Send file size -bundle", LL_DEBUG);
+			return false;
+		}
+		return true;
+	}
+
+	hFile=openSendFile(filename, false, false);
+
+	if(hFile == INVALID_HANDLE_VALUE)
+	{
+		return sendOpenError(s_filename, ident, "Could not open file "+ filename+". "+ os_last_error_str(), metadata_id != 0 ? LL_ERROR : LL_INFO);
+	}
+
+	std::auto_ptr<IFile> tf(Server->openFileFromHandle((void*)hFile, filename));
+	hFile = INVALID_HANDLE_VALUE;
+	if(tf.get()==NULL)
+	{
+		Log("Could not open file from handle -bundle", LL_ERROR);
+		return false;
+	}
+
+	if(with_hashes)
+	{
+		hash_func.init();
+	}
+
+	//Not flushed. The whole bundle is flushed at once.
+	return sendFullFile(tf.get(), 0, with_hashes, false, &s_filename);
+}
+
+#ifdef _WIN32
+void CClientThread::addLongPathPrefix(std::string& filename)
+{
+	if(filename.size()>=2 && filename[0]=='\\' && filename[1]=='\\' )
+	{
+		if(filename.size()<3 || filename[2]!='?')
+		{
+			filename="\\\\?\\UNC"+filename.substr(1);
+		}
+	}
+	else
+	{
+		filename = "\\\\?\\"+filename;
+	}
+}
+#endif
+
+HANDLE CClientThread::openSendFile(const std::string& filename, bool overlapped, bool open_reparse_point)
+{
+#ifdef _WIN32
+	DWORD flags = FILE_FLAG_SEQUENTIAL_SCAN;
+	if (overlapped)
+		flags |= FILE_FLAG_OVERLAPPED;
+#ifdef BACKUP_SEM
+	if (open_reparse_point)
+		flags |= FILE_FLAG_OPEN_REPARSE_POINT;
+	if (backup_semantics)
+		flags |= FILE_FLAG_BACKUP_SEMANTICS;
+#endif
+	return CreateFileW(Server->ConvertToWchar(filename).c_str(), FILE_READ_DATA, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
+#else //_WIN32
+	int flags = O_RDONLY | O_LARGEFILE;
+#if defined(O_CLOEXEC)
+	flags |= O_CLOEXEC;
+#endif
+#if defined(O_NOATIME)
+	if(backup_semantics)
+		flags |= O_NOATIME;
+#endif
+	return open64(filename.c_str(), flags);
+#endif //_WIN32
+}
+
+bool CClientThread::isBaseDirLost(const std::string& s_filename, const std::string& ident)
+{
+#ifdef CHECK_BASE_PATH
+	std::string share_name = getuntil("/",s_filename);
+	if(!share_name.empty())
+	{
+		bool allow_exec;
+		std::string basePath=map_file(share_name+"/", ident, allow_exec, NULL);
+		return !isDirectory(basePath);
+	}
+#endif
+	return false;
+}
+
+bool CClientThread::sendOpenError(const std::string& s_filename, const std::string& ident, const std::string& log_msg, int loglevel)
+{
+	if(isBaseDirLost(s_filename, ident))
+	{
+		char ch=ID_BASE_DIR_LOST;
+		int rc=SendInt(&ch, 1);
+		if(rc==SOCKET_ERROR)
+		{
+			Log("Error: Socket Error - DBG: Send BASE_DIR_LOST", LL_DEBUG);
+			return false;
+		}
+		Log("Info: Base dir lost", LL_DEBUG);
+		return true;
+	}
+
+	char ch=ID_COULDNT_OPEN;
+	int rc=SendInt(&ch, 1);
+	if(rc==SOCKET_ERROR)
+	{
+		Log("Error: Socket Error - DBG: Send COULDNT OPEN", LL_DEBUG);
+		return false;
+	}
+	Log(log_msg, loglevel);
+	return true;
+}
+
+bool CClientThread::sendPreviousReadError(const std::string& filename, int64 metadata_id, bool& sent)
+{
+	sent = false;
+
+	if (metadata_id == 0
+		|| !FileServ::hasReadError(filename))
+	{
+		return true;
+	}
+
+	FileServ::clearReadErrorFile(filename);
+
+	char ch = ID_READ_ERROR;
+	int rc = SendInt(&ch, 1);
+	if (rc == SOCKET_ERROR)
+	{
+		Log("Error: Socket Error - DBG: Send ID_READ_ERROR", LL_DEBUG);
+		return false;
+	}
+	Log("Info: Returning read error instead of sending file \""+filename+"\"", LL_DEBUG);
+	sent = true;
+	return true;
+}
+
+void CClientThread::transmitMetadata(const std::string& filename, const std::string& s_filename, const std::string& ident, int64 folder_items, int64 metadata_id)
+{
+	if(metadata_id!=0 && next(s_filename, 0, "clientdl"))
+	{
+		PipeSessions::transmitFileMetadata(filename,
+			s_filename, ident, ident, folder_items, metadata_id);
+	}
+	else if(metadata_id!=0 && s_filename.find("|")!=std::string::npos)
+	{
+		PipeSessions::transmitFileMetadata(filename,
+			getafter("|",s_filename), getuntil("|", s_filename), ident, folder_items, metadata_id);
+	}
+}
+
+bool CClientThread::sendFullFile(IFile* file, _i64 start_offset, bool with_hashes, bool flush_size, const std::string* s_filename)
 {
 	curr_filesize = file->Size();
 
@@ -2275,7 +2488,7 @@ bool CClientThread::sendFullFile(IFile* file, _i64 start_offset, bool with_hashe
 	data.addUChar(ID_FILESIZE);
 	data.addUInt64(little_endian(static_cast<uint64>(curr_filesize)));
 
-	int rc=SendInt(data.getDataPtr(), data.getDataSize(), true);	
+	int rc=SendInt(data.getDataPtr(), data.getDataSize(), flush_size);	
 	if(rc==SOCKET_ERROR)
 	{
 		return false;
@@ -2334,7 +2547,16 @@ bool CClientThread::sendFullFile(IFile* file, _i64 start_offset, bool with_hashe
 		}
 		else if(has_error)
 		{
-			Log("Error: Reading from file failed.", LL_DEBUG);
+			if (s_filename != NULL)
+			{
+				std::string errstr = os_last_error_str();
+				Log("Error: Reading from file \"" + file->getFilename() + "\" failed. " + errstr, LL_ERROR);
+				FileServ::callErrorCallback(*s_filename, file->getFilename(), foffset, errstr);
+			}
+			else
+			{
+				Log("Error: Reading from file failed.", LL_DEBUG);
+			}
 			return false;
 		}
 
@@ -2464,6 +2686,70 @@ bool CClientThread::StopPhash(CRData * data)
 	return true;
 }
 
+bool CClientThread::CompressStream(CRData * data)
+{
+#ifdef CHECK_IDENT
+	std::string ident;
+	data->getStr(&ident);
+	if (!FileServ::checkIdentity(ident))
+	{
+		Log("Identity check failed -compress", LL_DEBUG);
+		return false;
+	}
+#endif
+
+	int compression_level;
+	int min_level;
+	int max_level;
+	if (!data->getInt(&compression_level)
+		|| !data->getInt(&min_level)
+		|| !data->getInt(&max_level))
+	{
+		Log("Error: Compress stream packet too short", LL_ERROR);
+		return false;
+	}
+
+	//Only uncompressed direct connections, and only before anything else was requested
+	bool can_compress = has_socket
+		&& chunk_send_thread_ticket == ILLEGAL_THREADPOOL_TICKET
+		&& stack.getBuffersize() == 0;
+
+	char ch = can_compress ? ID_STREAM_COMPRESSED : ID_STREAM_UNCOMPRESSED;
+	IPipe* comp_pipe = NULL;
+	if (can_compress)
+	{
+		comp_pipe = FileServ::compressStream(clientpipe, close_the_socket, compression_level, min_level, max_level);
+		if (comp_pipe == NULL)
+		{
+			ch = ID_STREAM_UNCOMPRESSED;
+		}
+	}
+
+	int rc = SendInt(&ch, 1);
+	if (rc == SOCKET_ERROR
+		|| !clientpipe->Flush(CLIENT_TIMEOUT * 1000))
+	{
+		Log("Error: Sending data failed (CompressStream)");
+		if (comp_pipe != NULL)
+		{
+			clientpipe = comp_pipe;
+			close_the_socket = true;
+		}
+		return false;
+	}
+
+	if (comp_pipe != NULL)
+	{
+		Log("Compressing connection with level " + convert(compression_level), LL_DEBUG);
+		clientpipe = comp_pipe;
+		close_the_socket = true;
+		//No sendfile on a compressed connection
+		has_socket = false;
+	}
+
+	return true;
+}
+
 bool CClientThread::FinishScript( CRData * data )
 {
 #ifdef CHECK_IDENT
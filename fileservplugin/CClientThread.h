@@ -13,6 +13,7 @@
 #include <deque>
 #include <vector>
 #include <queue>
+#include <memory>
 
 #include "../Interface/Thread.h"
 #include "../Interface/ThreadPool.h"
@@ -31,6 +32,7 @@ class IFsFile;
 class IMutex;
 class ICondition;
 class ScopedPipeFileUser;
+class ReadAheadEngine;
 
 #include "chunk_settings.h"
 #include "packet_ids.h"
@@ -119,12 +121,16 @@ public:
 	static std::string getDummyMetadata(std::string output_fn, int64 folder_items, int64 metadata_id, bool is_dir);
 private:
 
-	bool sendFullFile(IFile* file, _i64 start_offset, bool with_hashes);
+	//Read errors are reported to the error callback of the share of s_filename if not NULL
+	bool sendFullFile(IFile* file, _i64 start_offset, bool with_hashes, bool flush_size=true, const std::string* s_filename=NULL);
 
 	bool RecvMessage();
 	bool ProcessPacket(CRData *data);
 	bool ReadFilePart(HANDLE hFile, _i64 offset, bool last, _u32 toread);
 	int SendData();
+#ifndef _WIN32
+	int64 sendFileRange(HANDLE hFile, int64& foffset, size_t count);
+#endif
 	void ReleaseMemory(void);
 	void CloseThread(HANDLE hFile);
 
@@ -133,10 +139,26 @@ private:
 
 	bool GetFileHashAndMetadata(CRData* data);
 
+	bool GetFileBundle(CRData* data);
+	bool sendBundleFile(const std::string& s_filename, const std::string& ident, int64 metadata_id, bool with_hashes);
+
+#ifdef _WIN32
+	static void addLongPathPrefix(std::string& filename);
+#endif
+	HANDLE openSendFile(const std::string& filename, bool overlapped, bool open_reparse_point);
+	bool isBaseDirLost(const std::string& s_filename, const std::string& ident);
+	//Sends ID_BASE_DIR_LOST or ID_COULDNT_OPEN after openSendFile failed and logs log_msg in the latter case.
+	//Returns false on socket error
+	bool sendOpenError(const std::string& s_filename, const std::string& ident, const std::string& log_msg, int loglevel);
+	//Sends ID_READ_ERROR if reading the file failed during the previous (metadata) transfer
+	bool sendPreviousReadError(const std::string& filename, int64 metadata_id, bool& sent);
+	void transmitMetadata(const std::string& filename, const std::string& s_filename, const std::string& ident, int64 folder_items, int64 metadata_id);
+
 	void queueChunk(const SChunk& chunk);
 	bool InformMetadataStreamEnd( CRData * data );
 	bool StopPhash(CRData * data);
 	bool FinishScript( CRData * data );
+	bool CompressStream(CRData * data);
 
 	struct SExtent
 	{
@@ -209,4 +231,6 @@ private:
 	std::vector<char>* extra_buffer;
 
 	bool backup_semantics;
+
+	std::auto_ptr<ReadAheadEngine> read_ahead;
 };
@@ -24,6 +24,7 @@
 #include "socket_header.h"
 #include <memory.h>
 #include <assert.h>
+#include <algorithm>
 
 #include "../Interface/File.h"
 #include "../Interface/Server.h"
@@ -33,6 +34,7 @@
 #include <errno.h>
 #endif
 #include "PipeSessions.h"
+#include "ReadAheadEngine.h"
 
 namespace
 {
@@ -57,11 +59,21 @@ namespace
 
 		return true;
 	}
+
+	const size_t c_copy_index_blocks = 64;
+	const size_t c_copy_index_candidates = 4;
+	const size_t c_copy_filter_size = 65536;
+
+	size_t copyFilterIdx(unsigned int adler)
+	{
+		return (adler ^ (adler >> 16)) & (c_copy_filter_size - 1);
+	}
 }
 
 
 ChunkSendThread::ChunkSendThread(CClientThread *parent)
-	: parent(parent), file(NULL), has_error(false), cbt_hash_file_info()
+	: parent(parent), file(NULL), has_error(false), cbt_hash_file_info(),
+	read_ahead(ReadAheadEngine::create()), read_ahead_active(false)
 {
 	chunk_buf=new char[(c_checkpoint_dist/c_chunk_size)*(c_chunk_size)+c_chunk_padding];
 }
@@ -71,6 +83,36 @@ ChunkSendThread::~ChunkSendThread(void)
 	delete []chunk_buf;
 }
 
+void ChunkSendThread::startReadAhead()
+{
+	if (read_ahead.get() != NULL
+		&& file != NULL
+		&& pipe_file_user.get() == NULL
+		&& curr_file_size > 0)
+	{
+		read_ahead->setFile(static_cast<IFsFile*>(file));
+		read_ahead_active = true;
+	}
+}
+
+void ChunkSendThread::stopReadAhead()
+{
+	if (read_ahead_active)
+	{
+		read_ahead->setFile(NULL);
+		read_ahead_active = false;
+	}
+}
+
+_u32 ChunkSendThread::readFile(int64 spos, char* buffer, _u32 bsize, bool* has_error)
+{
+	if (read_ahead_active)
+	{
+		return read_ahead->Read(spos, buffer, bsize, has_error);
+	}
+	return file->Read(spos, buffer, bsize, has_error);
+}
+
 void ChunkSendThread::operator()(void)
 {
 	SChunk chunk;
@@ -85,6 +127,7 @@ void ChunkSendThread::operator()(void)
 		}
 		else if (chunk.msg == ID_FREE_SERVER_FILE)
 		{
+			stopReadAhead();
 			if (pipe_file_user.get()==NULL && file != NULL)
 			{
 				Server->Log("Closing file (free) " + file->getFilename(), LL_DEBUG);
@@ -98,6 +141,7 @@ void ChunkSendThread::operator()(void)
 				file = NULL;
 			}
 			pipe_file_user.reset();
+			resetCopyIndex();
 
 			if (cbt_hash_file_info.cbt_hash_file != NULL
 				&& cbt_hash_file_info.metadata_offset != -1)
@@ -118,6 +162,7 @@ void ChunkSendThread::operator()(void)
 		}
 		else if(chunk.update_file!=NULL)
 		{
+			stopReadAhead();
 			if(pipe_file_user.get() == NULL && file!=NULL)
 			{
 				Server->Log("Closing file " + file->getFilename(), LL_DEBUG);
@@ -140,6 +185,8 @@ void ChunkSendThread::operator()(void)
 			pipe_file_user.reset(chunk.pipe_file_user);
 			file_extents.clear();
 			has_more_extents = true;
+			resetCopyIndex();
+			startReadAhead();
 
 			std::vector<IFsFile::SSparseExtent> sparse_extents;
 			if (chunk.with_sparse)
@@ -214,6 +261,8 @@ void ChunkSendThread::operator()(void)
 		}
 	}
 
+	stopReadAhead();
+
 	if(pipe_file_user.get() == NULL && file!=NULL)
 	{
 		Server->Log("Closing file (finish) " + file->getFilename(), LL_DEBUG);
@@ -246,7 +295,12 @@ bool ChunkSendThread::sendChunk(SChunk *chunk)
 		return sendError(ERR_SEEKING_FAILED, getSystemErrorCode());
 	}
 
-	if(chunk->transfer_all)
+	if (read_ahead_active)
+	{
+		read_ahead->setEnd((std::min)(chunk->startpos + c_checkpoint_dist, curr_file_size));
+	}
+
+	if(chunk->transfer_all && chunk->transfer_all!=c_block_request_copy)
 	{
 		size_t off=1+sizeof(_i64)+sizeof(_u32);
 		*chunk_buf=ID_WHOLE_BLOCK;
@@ -290,7 +344,7 @@ bool ChunkSendThread::sendChunk(SChunk *chunk)
 				while(r<toread)
 				{
 					bool c_readerr = false;
-					_u32 r_add=file->Read(spos, chunk_buf+off+r,  toread-r, &c_readerr);
+					_u32 r_add=readFile(spos, chunk_buf+off+r,  toread-r, &c_readerr);
 
 					if (c_readerr)
 					{
@@ -491,6 +545,15 @@ bool ChunkSendThread::sendChunk(SChunk *chunk)
 		new_chunkhashes.resize(sizeof(_u16) + chunkhash_single_size);
 	}
 
+	//Changed chunks are sent after the whole block is read, so data which
+	//moved to another offset can be found via the rolling hash
+	bool with_copy = chunk->transfer_all == c_block_request_copy && curr_file_size > 0;
+	std::vector<std::pair<unsigned int, _u32> > changed_chunks;
+	if (with_copy)
+	{
+		addCopyIndex(chunk);
+	}
+
 	if (!cbt_unchanged)
 	{
 		do
@@ -510,7 +573,7 @@ bool ChunkSendThread::sendChunk(SChunk *chunk)
 
 			bool readerr = false;
 
-			r = file->Read(spos, cptr, to_read, &readerr);
+			r = readFile(spos, cptr, to_read, &readerr);
 			spos += r;
 			real_r = r;
 
@@ -524,7 +587,7 @@ bool ChunkSendThread::sendChunk(SChunk *chunk)
 
 			while (r < to_read)
 			{
-				_u32 r_add = file->Read(spos, cptr + r, to_read - r, &readerr);
+				_u32 r_add = readFile(spos, cptr + r, to_read - r, &readerr);
 				spos += r_add;
 
 				if (readerr)
@@ -570,26 +633,14 @@ bool ChunkSendThread::sendChunk(SChunk *chunk)
 					|| curr_pos + r > curr_hash_size)
 				{
 					sent_update = true;
-					char tmp_backup[c_chunk_padding];
-					memcpy(tmp_backup, cptr - c_chunk_padding, c_chunk_padding);
-
-					*(cptr - c_chunk_padding) = ID_UPDATE_CHUNK;
-					_i64 curr_pos_tmp = little_endian(curr_pos);
-					memcpy(cptr - sizeof(_i64) - sizeof(_u32), &curr_pos_tmp, sizeof(_i64));
-					_u32 r_tmp = little_endian(r);
-					memcpy(cptr - sizeof(_u32), &r_tmp, sizeof(_u32));
-
-					Log("Sending chunk start=" + convert(curr_pos) + " size=" + convert(r), LL_DEBUG);
-
-					if (parent->SendInt(cptr - c_chunk_padding, c_chunk_padding + r) == SOCKET_ERROR)
+					if (with_copy)
+					{
+						changed_chunks.push_back(std::make_pair(read_total - r, r));
+					}
+					else if (!sendUpdateChunk(curr_pos, cptr, r))
 					{
-						Log("Error sending chunk", LL_DEBUG);
 						return false;
 					}
-
-					if (FileServ::isPause()) Sleep(500);
-
-					memcpy(cptr - c_chunk_padding, tmp_backup, c_chunk_padding);
 				}
 
 				if (!new_chunkhashes.empty())
@@ -617,6 +668,12 @@ bool ChunkSendThread::sendChunk(SChunk *chunk)
 		cbt_hash_file_info.cbt_hash_file->Write(index_chunkhash_pos, new_chunkhashes.data(), static_cast<_u32>(new_chunkhashes.size()));
 	}
 
+	if (!changed_chunks.empty()
+		&& !sendCopyChunks(chunk, changed_chunks, read_total))
+	{
+		return false;
+	}
+
 	if(!sent_update && !cbt_unchanged && memcmp(md5_hash.raw_digest_int(), chunk->big_hash, big_hash_size)!=0 )
 	{
 		Log("Sending whole block(2) start="+convert(chunk->startpos)+" size="+convert(read_total), LL_DEBUG);
@@ -699,3 +756,235 @@ bool ChunkSendThread::sendError( _u32 errorcode1, _u32 errorcode2 )
 		return true;
 	}
 }
+
+bool ChunkSendThread::sendUpdateChunk(_i64 pos, char* cptr, _u32 size)
+{
+	char tmp_backup[c_chunk_padding];
+	memcpy(tmp_backup, cptr - c_chunk_padding, c_chunk_padding);
+
+	*(cptr - c_chunk_padding) = ID_UPDATE_CHUNK;
+	_i64 curr_pos_tmp = little_endian(pos);
+	memcpy(cptr - sizeof(_i64) - sizeof(_u32), &curr_pos_tmp, sizeof(_i64));
+	_u32 r_tmp = little_endian(size);
+	memcpy(cptr - sizeof(_u32), &r_tmp, sizeof(_u32));
+
+	Log("Sending chunk start=" + convert(pos) + " size=" + convert(size), LL_DEBUG);
+
+	if (parent->SendInt(cptr - c_chunk_padding, c_chunk_padding + size) == SOCKET_ERROR)
+	{
+		Log("Error sending chunk", LL_DEBUG);
+		return false;
+	}
+
+	if (FileServ::isPause()) Sleep(500);
+
+	memcpy(cptr - c_chunk_padding, tmp_backup, c_chunk_padding);
+
+	return true;
+}
+
+bool ChunkSendThread::sendCopyChunks(SChunk* chunk, const std::vector<std::pair<unsigned int, _u32> >& changed_chunks, unsigned int read_total)
+{
+	char* data = chunk_buf + c_chunk_padding;
+
+	//Roll a c_chunk_size window over every position which may cover a part
+	//of a changed chunk and remember where it equals a chunk of the original file
+	std::map<unsigned int, std::vector<_i64> > matches;
+	if (read_total >= c_chunk_size
+		&& !copy_index.empty())
+	{
+		unsigned int last_window = read_total - c_chunk_size;
+		unsigned int roll_next = 0;
+		for (size_t i = 0; i < changed_chunks.size(); ++i)
+		{
+			unsigned int off = changed_chunks[i].first;
+			if (changed_chunks[i].second != c_chunk_size)
+			{
+				continue;
+			}
+
+			unsigned int wstart = off >= c_chunk_size ? off - c_chunk_size + 1 : 0;
+			unsigned int wend = (std::min)(off + c_chunk_size, last_window);
+			if (wstart < roll_next)
+			{
+				wstart = roll_next;
+			}
+			if (wstart > wend)
+			{
+				continue;
+			}
+
+			unsigned int adler = urb_adler32(urb_adler32(0, NULL, 0), data + wstart, c_chunk_size);
+			for (unsigned int p = wstart;; ++p)
+			{
+				if (copy_index_filter[copyFilterIdx(adler)] > 0)
+				{
+					std::pair<std::multimap<unsigned int, _i64>::iterator, std::multimap<unsigned int, _i64>::iterator> range
+						= copy_index.equal_range(adler);
+					for (std::multimap<unsigned int, _i64>::iterator it = range.first; it != range.second; ++it)
+					{
+						matches[p].push_back(it->second);
+					}
+				}
+
+				if (p == wend)
+				{
+					break;
+				}
+
+				adler = urb_adler32_roll(adler, c_chunk_size,
+					static_cast<unsigned char>(data[p]), static_cast<unsigned char>(data[p + c_chunk_size]));
+			}
+
+			roll_next = wend + 1;
+		}
+	}
+
+	for (size_t i = 0; i < changed_chunks.size(); ++i)
+	{
+		unsigned int off = changed_chunks[i].first;
+		_u32 size = changed_chunks[i].second;
+		_i64 dest_pos = chunk->startpos + off;
+
+		_i64 src_pos = -1;
+		if (size == c_chunk_size
+			&& !matches.empty())
+		{
+			src_pos = findCopySource(matches, off, dest_pos);
+		}
+
+		if (src_pos == -1)
+		{
+			if (!sendUpdateChunk(dest_pos, data + off, size))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		char buf[1 + 2 * sizeof(_i64) + sizeof(_u32)];
+		buf[0] = ID_COPY_CHUNK;
+		_i64 dest_pos_tmp = little_endian(dest_pos);
+		memcpy(buf + 1, &dest_pos_tmp, sizeof(_i64));
+		_i64 src_pos_tmp = little_endian(src_pos);
+		memcpy(buf + 1 + sizeof(_i64), &src_pos_tmp, sizeof(_i64));
+		_u32 size_tmp = little_endian(size);
+		memcpy(buf + 1 + 2 * sizeof(_i64), &size_tmp, sizeof(_u32));
+
+		Log("Sending copy chunk start=" + convert(dest_pos) + " src=" + convert(src_pos) + " size=" + convert(size), LL_DEBUG);
+
+		if (parent->SendInt(buf, sizeof(buf)) == SOCKET_ERROR)
+		{
+			Log("Error sending copy chunk", LL_DEBUG);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+_i64 ChunkSendThread::findCopySource(const std::map<unsigned int, std::vector<_i64> >& matches, unsigned int off, _i64 dest_pos)
+{
+	//Either a window matches exactly at the chunk or two adjacent windows
+	//with the same shift cover it
+	std::map<unsigned int, std::vector<_i64> >::const_iterator it
+		= matches.lower_bound(off >= c_chunk_size ? off - c_chunk_size + 1 : 0);
+	for (; it != matches.end() && it->first <= off; ++it)
+	{
+		for (size_t i = 0; i < it->second.size(); ++i)
+		{
+			_i64 src_pos = it->second[i];
+			if (it->first == off)
+			{
+				if (src_pos != dest_pos)
+				{
+					return src_pos;
+				}
+				continue;
+			}
+
+			std::map<unsigned int, std::vector<_i64> >::const_iterator it_next = matches.find(it->first + c_chunk_size);
+			if (it_next != matches.end()
+				&& std::find(it_next->second.begin(), it_next->second.end(), src_pos + c_chunk_size) != it_next->second.end())
+			{
+				return src_pos + (off - it->first);
+			}
+		}
+	}
+
+	return -1;
+}
+
+void ChunkSendThread::addCopyIndex(SChunk* chunk)
+{
+	if (std::find(copy_index_blocks.begin(), copy_index_blocks.end(), chunk->startpos) != copy_index_blocks.end())
+	{
+		return;
+	}
+
+	if (copy_index_filter.empty())
+	{
+		copy_index_filter.resize(c_copy_filter_size);
+	}
+
+	if (copy_index_blocks.size() >= c_copy_index_blocks)
+	{
+		removeCopyIndexBlock(copy_index_blocks.front());
+		copy_index_blocks.pop_front();
+	}
+
+	copy_index_blocks.push_back(chunk->startpos);
+
+	for (unsigned int i = 0; i < c_checkpoint_dist / c_small_hash_dist; ++i)
+	{
+		_i64 pos = chunk->startpos + i*c_small_hash_dist;
+		if (pos + c_chunk_size > curr_hash_size)
+		{
+			break;
+		}
+
+		_u32 adler;
+		memcpy(&adler, &chunk->small_hash[small_hash_size*i], sizeof(adler));
+		adler = little_endian(adler);
+
+		//Bounds the work for e.g. zero chunks which are everywhere
+		if (copy_index.count(adler) >= c_copy_index_candidates)
+		{
+			continue;
+		}
+
+		copy_index.insert(std::make_pair(adler, pos));
+		copy_index_offsets[pos] = adler;
+		++copy_index_filter[copyFilterIdx(adler)];
+	}
+}
+
+void ChunkSendThread::removeCopyIndexBlock(_i64 startpos)
+{
+	std::map<_i64, unsigned int>::iterator it = copy_index_offsets.lower_bound(startpos);
+	while (it != copy_index_offsets.end()
+		&& it->first < startpos + c_checkpoint_dist)
+	{
+		std::pair<std::multimap<unsigned int, _i64>::iterator, std::multimap<unsigned int, _i64>::iterator> range
+			= copy_index.equal_range(it->second);
+		for (std::multimap<unsigned int, _i64>::iterator it_idx = range.first; it_idx != range.second; ++it_idx)
+		{
+			if (it_idx->second == it->first)
+			{
+				copy_index.erase(it_idx);
+				break;
+			}
+		}
+
+		--copy_index_filter[copyFilterIdx(it->second)];
+		copy_index_offsets.erase(it++);
+	}
+}
+
+void ChunkSendThread::resetCopyIndex()
+{
+	copy_index.clear();
+	copy_index_offsets.clear();
+	copy_index_blocks.clear();
+	std::fill(copy_index_filter.begin(), copy_index_filter.end(), 0);
+}
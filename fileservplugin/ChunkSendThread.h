@@ -6,9 +6,13 @@
 #include "../Interface/File.h"
 #include "../md5.h"
 #include <memory>
+#include <map>
+#include <deque>
+#include <vector>
 
 class ScopedPipeFileUser;
 class CClientThread;
+class ReadAheadEngine;
 struct SChunk;
 
 class ChunkSendThread : public IThread
@@ -25,6 +29,19 @@ private:
 
 	bool sendError(_u32 errorcode1, _u32 errorcode2);
 
+	bool sendUpdateChunk(_i64 pos, char* cptr, _u32 size);
+
+	bool sendCopyChunks(SChunk* chunk, const std::vector<std::pair<unsigned int, _u32> >& changed_chunks, unsigned int read_total);
+	_i64 findCopySource(const std::map<unsigned int, std::vector<_i64> >& matches, unsigned int off, _i64 dest_pos);
+
+	void addCopyIndex(SChunk* chunk);
+	void removeCopyIndexBlock(_i64 startpos);
+	void resetCopyIndex();
+
+	void startReadAhead();
+	void stopReadAhead();
+	_u32 readFile(int64 spos, char* buffer, _u32 bsize, bool* has_error);
+
 	CClientThread *parent;
 	IFile *file;
 	std::string s_filename;
@@ -34,10 +51,19 @@ private:
 	IFileServ::CbtHashFileInfo cbt_hash_file_info;
 	std::vector<IFsFile::SFileExtent> file_extents;
 	bool has_more_extents;
+	std::auto_ptr<ReadAheadEngine> read_ahead;
+	bool read_ahead_active;
 
 	char *chunk_buf;
 
 	bool has_error;
 
 	MD5 md5_hash;
+
+	//Chunk hashes of the last requested blocks of the current file
+	//for the rolling hash search (adler -> offset in original file)
+	std::multimap<unsigned int, _i64> copy_index;
+	std::map<_i64, unsigned int> copy_index_offsets;
+	std::deque<_i64> copy_index_blocks;
+	std::vector<unsigned short> copy_index_filter;
 };
\ No newline at end of file
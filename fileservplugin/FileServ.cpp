@@ -26,6 +26,7 @@
 #include "CUDPThread.h"
 #include "PipeSessions.h"
 #include "PipeFileExt.h"
+#include "ReadAheadEngine.h"
 
 IMutex *FileServ::mutex=NULL;
 std::vector<std::string> FileServ::identities;
@@ -35,6 +36,7 @@ IFileServ::ITokenCallbackFactory* FileServ::token_callback_factory = NULL;
 std::map<std::string, std::string> FileServ::fn_redirects;
 std::map<std::string, size_t> FileServ::active_shares;
 FileServ::IReadErrorCallback* FileServ::read_error_callback = NULL;
+FileServ::IStreamCompressionCallback* FileServ::stream_compression_callback = NULL;
 std::vector<std::string> FileServ::read_error_files;
 std::map<std::pair<std::string, std::string>, IFileServ::CbtHashFileInfo> FileServ::cbt_hash_files;
 
@@ -361,6 +363,21 @@ void FileServ::registerReadErrorCallback(IReadErrorCallback * cb)
 	read_error_callback = cb;
 }
 
+void FileServ::registerStreamCompressionCallback(IStreamCompressionCallback * cb)
+{
+	stream_compression_callback = cb;
+}
+
+IPipe * FileServ::compressStream(IPipe * pipe, bool destroy_pipe, int compression_level, int min_level, int max_level)
+{
+	if (stream_compression_callback == NULL)
+	{
+		return NULL;
+	}
+
+	return stream_compression_callback->compressStream(pipe, destroy_pipe, compression_level, min_level, max_level);
+}
+
 void FileServ::clearReadErrors()
 {
 	IScopedLock lock(mutex);
@@ -418,3 +435,8 @@ void FileServ::deregisterScriptPipeFile(const std::string & script_fn)
 		script_mappings.erase(it);
 	}
 }
+
+IFileServ::SReadStats FileServ::getReadStats()
+{
+	return ReadAheadEngine::getStats();
+}
@@ -59,6 +59,10 @@ public:
 
 	virtual void registerReadErrorCallback(IReadErrorCallback* cb);
 
+	virtual void registerStreamCompressionCallback(IStreamCompressionCallback* cb);
+
+	static IPipe* compressStream(IPipe* pipe, bool destroy_pipe, int compression_level, int min_level, int max_level);
+
 	void clearReadErrors();
 
 	static void clearReadErrorFile(const std::string& filepath);
@@ -71,6 +75,8 @@ public:
 
 	virtual void deregisterScriptPipeFile(const std::string& script_fn);
 
+	virtual SReadStats getReadStats();
+
 private:
 	bool *dostop;
 	THREADPOOL_TICKET serverticket;
@@ -109,6 +115,8 @@ private:
 
 	static IReadErrorCallback* read_error_callback;
 
+	static IStreamCompressionCallback* stream_compression_callback;
+
 	static std::vector<std::string> read_error_files;
 
 	static std::map<std::pair<std::string, std::string>, CbtHashFileInfo> cbt_hash_files;
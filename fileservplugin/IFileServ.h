@@ -40,6 +40,13 @@ public:
 		virtual void onReadError(const std::string& sharename, const std::string& filepath, int64 pos, const std::string& msg) = 0;
 	};
 
+	class IStreamCompressionCallback
+	{
+	public:
+		//Returns a pipe compressing the data sent over pipe (or NULL). Adapts the compression level if min_level!=max_level
+		virtual IPipe* compressStream(IPipe* pipe, bool destroy_pipe, int compression_level, int min_level, int max_level) = 0;
+	};
+
 
 	virtual void shareDir(const std::string &name, const std::string &path, const std::string& identity, bool allow_exec)=0;
 	virtual bool removeDir(const std::string &name, const std::string& identity)=0;
@@ -59,6 +66,7 @@ public:
 	virtual bool hasActiveTransfers(const std::string& sharename, const std::string& server_token) = 0;
 	virtual bool registerFnRedirect(const std::string& source_fn, const std::string& target_fn) = 0;
 	virtual void registerReadErrorCallback(IReadErrorCallback* cb) = 0;
+	virtual void registerStreamCompressionCallback(IStreamCompressionCallback* cb) = 0;
 	virtual void registerScriptPipeFile(const std::string& script_fn, IPipeFileExt* pipe_file) = 0;
 	virtual void deregisterScriptPipeFile(const std::string& script_fn) = 0;
 	virtual void clearReadErrors() = 0;
@@ -87,6 +95,23 @@ public:
 	};
 
 	virtual void setCbtHashFile(const std::string& sharename, const std::string& identity, CbtHashFileInfo hash_file_info) = 0;
+
+	struct SReadStats
+	{
+		std::string engine;
+		int64 queue_depth;
+		int64 inflight;
+		int64 max_inflight;
+		int64 reads;
+		int64 bytes;
+		int64 avg_latency_us;
+		int64 max_latency_us;
+		int64 stalls;
+		int64 avg_stall_us;
+		int64 restarts;
+	};
+
+	virtual SReadStats getReadStats() = 0;
 };
 
 #endif //IFILESERV_H
\ No newline at end of file
@@ -0,0 +1,844 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "ReadAheadEngine.h"
+#include "../Interface/Server.h"
+#include "../Interface/Mutex.h"
+#include "../Interface/Thread.h"
+#include "../stringtools.h"
+#include <memory.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include "../config.h"
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#endif
+
+#if defined(__linux__) && defined(HAVE_LINUX_IO_URING_H)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define READ_AHEAD_URING
+#endif
+#endif
+
+#if defined(__FreeBSD__) || defined(__APPLE__)
+#define pread64 pread
+#endif
+
+ReadAheadEngine::EEngine ReadAheadEngine::engine = ReadAheadEngine::EEngine_Threads;
+size_t ReadAheadEngine::queue_depth = 8;
+IMutex* ReadAheadEngine::mutex = NULL;
+int64 ReadAheadEngine::stat_reads = 0;
+int64 ReadAheadEngine::stat_bytes = 0;
+int64 ReadAheadEngine::stat_latency_us = 0;
+int64 ReadAheadEngine::stat_max_latency_us = 0;
+int64 ReadAheadEngine::stat_inflight = 0;
+int64 ReadAheadEngine::stat_max_inflight = 0;
+int64 ReadAheadEngine::stat_stalls = 0;
+int64 ReadAheadEngine::stat_stall_us = 0;
+int64 ReadAheadEngine::stat_restarts = 0;
+
+namespace
+{
+	const _u32 c_read_ahead_bsize = 64 * 1024;
+	const size_t c_max_queue_depth = 256;
+	const int64 c_log_stats_interval = 100000;
+
+	int64 time_us()
+	{
+#ifdef _WIN32
+		LARGE_INTEGER freq;
+		LARGE_INTEGER counter;
+		QueryPerformanceFrequency(&freq);
+		QueryPerformanceCounter(&counter);
+		return (counter.QuadPart / freq.QuadPart) * 1000000
+			+ ((counter.QuadPart % freq.QuadPart) * 1000000) / freq.QuadPart;
+#else
+		timespec tp;
+		if (clock_gettime(CLOCK_MONOTONIC, &tp) != 0)
+		{
+			return Server->getTimeMS() * 1000;
+		}
+		return static_cast<int64>(tp.tv_sec) * 1000000 + tp.tv_nsec / 1000;
+#endif
+	}
+
+	unsigned int getSystemErrorCode()
+	{
+#ifdef _WIN32
+		return GetLastError();
+#else
+		return errno;
+#endif
+	}
+
+	void setSystemErrorCode(unsigned int err)
+	{
+#ifdef _WIN32
+		SetLastError(err);
+#else
+		errno = err;
+#endif
+	}
+
+	_u32 read_block(SReadAheadBlock& block, int64 offset, char* buf, _u32 size)
+	{
+		_u32 r = 0;
+		while (r < size)
+		{
+			_u32 r_add;
+			if (block.file != NULL)
+			{
+				bool has_error = false;
+				r_add = block.file->Read(offset + r, buf + r, size - r, &has_error);
+				if (has_error)
+				{
+					block.err = getSystemErrorCode();
+					break;
+				}
+			}
+#ifndef _WIN32
+			else
+			{
+				ssize_t rc = pread64(block.fd, buf + r, size - r, offset + r);
+				if (rc < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					block.err = errno;
+					break;
+				}
+				r_add = static_cast<_u32>(rc);
+			}
+#else
+			else
+			{
+				block.err = ERROR_INVALID_HANDLE;
+				break;
+			}
+#endif
+			if (r_add == 0)
+			{
+				break;
+			}
+			r += r_add;
+		}
+		return r;
+	}
+
+	class ReadAheadTask : public IThread
+	{
+	public:
+		ReadAheadTask(SReadAheadBlock& block)
+			: block(block)
+		{}
+
+		void operator()()
+		{
+			block.rsize = read_block(block, block.offset, block.buf, block.size);
+			block.complete_time = time_us();
+			delete this;
+		}
+
+	private:
+		SReadAheadBlock& block;
+	};
+
+	class ThreadsBackend : public IReadAheadBackend
+	{
+	public:
+		virtual void submit(SReadAheadBlock& block)
+		{
+			block.ticket = Server->getThreadPool()->execute(new ReadAheadTask(block), "filesrv: read-ahead");
+		}
+
+		virtual void flush()
+		{
+		}
+
+		virtual void poll(SReadAheadBlock& block)
+		{
+			if (!Server->getThreadPool()->isRunning(block.ticket))
+			{
+				block.done = true;
+			}
+		}
+
+		virtual void wait(SReadAheadBlock& block)
+		{
+			Server->getThreadPool()->waitFor(block.ticket);
+			block.done = true;
+		}
+	};
+
+#ifdef READ_AHEAD_URING
+	class UringBackend : public IReadAheadBackend
+	{
+	public:
+		UringBackend()
+			: ring_fd(-1), sq_ptr(MAP_FAILED), cq_ptr(MAP_FAILED), sqes_ptr(MAP_FAILED),
+			broken(false)
+		{}
+
+		~UringBackend()
+		{
+			if (sqes_ptr != MAP_FAILED)
+			{
+				munmap(sqes_ptr, sqes_len);
+			}
+			if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr)
+			{
+				munmap(cq_ptr, cq_len);
+			}
+			if (sq_ptr != MAP_FAILED)
+			{
+				munmap(sq_ptr, sq_len);
+			}
+			if (ring_fd != -1)
+			{
+				close(ring_fd);
+			}
+		}
+
+		bool init(size_t entries)
+		{
+			io_uring_params p;
+			memset(&p, 0, sizeof(p));
+			ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned int>(entries), &p));
+			if (ring_fd < 0)
+			{
+				ring_fd = -1;
+				return false;
+			}
+
+			sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+			cq_len = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+			sqes_len = p.sq_entries * sizeof(io_uring_sqe);
+
+			bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+			single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+			if (single_mmap)
+			{
+				sq_len = cq_len = (std::max)(sq_len, cq_len);
+			}
+
+			sq_ptr = mmap(NULL, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+			if (sq_ptr == MAP_FAILED)
+			{
+				return false;
+			}
+
+			if (single_mmap)
+			{
+				cq_ptr = sq_ptr;
+			}
+			else
+			{
+				cq_ptr = mmap(NULL, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+				if (cq_ptr == MAP_FAILED)
+				{
+					return false;
+				}
+			}
+
+			sqes_ptr = mmap(NULL, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+			if (sqes_ptr == MAP_FAILED)
+			{
+				return false;
+			}
+
+			char* sq = static_cast<char*>(sq_ptr);
+			sq_tail = reinterpret_cast<unsigned int*>(sq + p.sq_off.tail);
+			sq_mask = *reinterpret_cast<unsigned int*>(sq + p.sq_off.ring_mask);
+			sq_array = reinterpret_cast<unsigned int*>(sq + p.sq_off.array);
+			sqes = static_cast<io_uring_sqe*>(sqes_ptr);
+
+			char* cq = static_cast<char*>(cq_ptr);
+			cq_head = reinterpret_cast<unsigned int*>(cq + p.cq_off.head);
+			cq_tail = reinterpret_cast<unsigned int*>(cq + p.cq_off.tail);
+			cq_mask = *reinterpret_cast<unsigned int*>(cq + p.cq_off.ring_mask);
+			cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+			iovs.resize(entries);
+
+			return true;
+		}
+
+		virtual void submit(SReadAheadBlock& block)
+		{
+			if (broken)
+			{
+				block.rsize = read_block(block, block.offset, block.buf, block.size);
+				block.complete_time = time_us();
+				block.done = true;
+				return;
+			}
+
+			iovec& iov = iovs[block.idx];
+			iov.iov_base = block.buf;
+			iov.iov_len = block.size;
+
+			unsigned int tail = *sq_tail;
+			unsigned int idx = tail & sq_mask;
+			io_uring_sqe* sqe = &sqes[idx];
+			memset(sqe, 0, sizeof(io_uring_sqe));
+			sqe->opcode = IORING_OP_READV;
+			sqe->fd = block.fd;
+			sqe->off = block.offset;
+			sqe->addr = reinterpret_cast<uintptr_t>(&iov);
+			sqe->len = 1;
+			sqe->user_data = reinterpret_cast<uintptr_t>(&block);
+			sq_array[idx] = idx;
+			__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+			pending.push_back(&block);
+		}
+
+		virtual void flush()
+		{
+			while (!pending.empty())
+			{
+				int rc = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd,
+					static_cast<unsigned int>(pending.size()), 0, 0, NULL, 0));
+				if (rc < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					else if ((errno == EAGAIN || errno == EBUSY)
+						&& getEvents())
+					{
+						continue;
+					}
+
+					Server->Log("Submitting io_uring reads failed. Errno: " + convert(errno) + ". Reading synchronously.", LL_ERROR);
+					broken = true;
+					for (size_t i = 0; i < pending.size(); ++i)
+					{
+						SReadAheadBlock& block = *pending[i];
+						block.rsize = read_block(block, block.offset, block.buf, block.size);
+						block.complete_time = time_us();
+						block.done = true;
+					}
+					pending.clear();
+				}
+				else
+				{
+					pending.erase(pending.begin(), pending.begin() + rc);
+				}
+			}
+		}
+
+		virtual void poll(SReadAheadBlock& block)
+		{
+			reap();
+		}
+
+		virtual void wait(SReadAheadBlock& block)
+		{
+			reap();
+			while (!block.done)
+			{
+				if (!getEvents())
+				{
+					Server->Log("Waiting for io_uring reads failed. Errno: " + convert(errno), LL_ERROR);
+					Server->wait(10);
+				}
+				reap();
+			}
+		}
+
+	private:
+		bool getEvents()
+		{
+			int rc = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0));
+			return rc >= 0 || errno == EINTR;
+		}
+
+		void reap()
+		{
+			unsigned int head = *cq_head;
+			unsigned int tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+			if (head == tail)
+			{
+				return;
+			}
+
+			int64 now = time_us();
+			for (; head != tail; ++head)
+			{
+				io_uring_cqe* cqe = &cqes[head & cq_mask];
+				SReadAheadBlock* block = reinterpret_cast<SReadAheadBlock*>(static_cast<uintptr_t>(cqe->user_data));
+				if (cqe->res < 0)
+				{
+					block->rsize = 0;
+					block->err = -cqe->res;
+				}
+				else
+				{
+					block->rsize = static_cast<_u32>(cqe->res);
+				}
+				block->complete_time = now;
+				block->done = true;
+			}
+
+			__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+		}
+
+		int ring_fd;
+		void* sq_ptr;
+		size_t sq_len;
+		void* cq_ptr;
+		size_t cq_len;
+		void* sqes_ptr;
+		size_t sqes_len;
+
+		unsigned int* sq_tail;
+		unsigned int sq_mask;
+		unsigned int* sq_array;
+		io_uring_sqe* sqes;
+
+		unsigned int* cq_head;
+		unsigned int* cq_tail;
+		unsigned int cq_mask;
+		io_uring_cqe* cqes;
+
+		std::vector<iovec> iovs;
+		std::vector<SReadAheadBlock*> pending;
+		bool broken;
+	};
+#endif //READ_AHEAD_URING
+
+	std::string engine_name(ReadAheadEngine::EEngine engine)
+	{
+		switch (engine)
+		{
+		case ReadAheadEngine::EEngine_Uring: return "io_uring";
+		case ReadAheadEngine::EEngine_Threads: return "threads";
+		default: return "none";
+		}
+	}
+}
+
+void ReadAheadEngine::init()
+{
+	mutex = Server->createMutex();
+
+	std::string s_queue_depth = Server->getServerParameter("fileserv_read_queue_depth");
+	if (!s_queue_depth.empty())
+	{
+		queue_depth = (std::min)(static_cast<size_t>(atoi(s_queue_depth.c_str())), c_max_queue_depth);
+	}
+
+	std::string s_engine = Server->getServerParameter("fileserv_read_engine");
+	engine = EEngine_Threads;
+
+#ifdef READ_AHEAD_URING
+	if (s_engine.empty() || s_engine == "io_uring")
+	{
+		UringBackend probe;
+		if (probe.init(1))
+		{
+			engine = EEngine_Uring;
+		}
+		else
+		{
+			Server->Log("io_uring not available (errno " + convert(errno) + "). Using thread pool for file read-ahead.", LL_INFO);
+		}
+	}
+#endif
+
+	if (s_engine == "none" || queue_depth <= 1)
+	{
+		engine = EEngine_None;
+	}
+
+	Server->Log("File server read-ahead engine: " + engine_name(engine) + " queue depth: " + convert(queue_depth), LL_DEBUG);
+}
+
+void ReadAheadEngine::destroy()
+{
+	Server->destroy(mutex);
+}
+
+ReadAheadEngine* ReadAheadEngine::create()
+{
+	if (engine == EEngine_None)
+	{
+		return NULL;
+	}
+
+	IReadAheadBackend* backend = NULL;
+#ifdef READ_AHEAD_URING
+	if (engine == EEngine_Uring)
+	{
+		UringBackend* uring_backend = new UringBackend;
+		if (uring_backend->init(queue_depth))
+		{
+			backend = uring_backend;
+		}
+		else
+		{
+			Server->Log("Setting up io_uring failed. Errno: " + convert(errno) + ". Using thread pool for file read-ahead.", LL_WARNING);
+			delete uring_backend;
+		}
+	}
+#endif
+
+	if (backend == NULL)
+	{
+		backend = new ThreadsBackend;
+	}
+
+	return new ReadAheadEngine(backend);
+}
+
+ReadAheadEngine::ReadAheadEngine(IReadAheadBackend* p_backend)
+	: file(NULL),
+#ifndef _WIN32
+	fd(-1), owns_fd(false),
+#endif
+	backend(p_backend), head(0), n_queued(0), head_consumed(0),
+	read_pos(0), submit_pos(0), end_pos(LLONG_MAX), positioned(false)
+{
+	buffers.resize(queue_depth*c_read_ahead_bsize);
+	blocks.resize(queue_depth);
+	for (size_t i = 0; i < blocks.size(); ++i)
+	{
+		memset(&blocks[i], 0, sizeof(SReadAheadBlock));
+		blocks[i].buf = &buffers[i*c_read_ahead_bsize];
+		blocks[i].idx = i;
+	}
+}
+
+ReadAheadEngine::~ReadAheadEngine()
+{
+	drain();
+	closeFd();
+}
+
+void ReadAheadEngine::setFile(IFsFile* p_file)
+{
+	drain();
+	closeFd();
+	positioned = false;
+	end_pos = LLONG_MAX;
+	file = p_file;
+#ifndef _WIN32
+	fd = p_file != NULL ? p_file->getOsHandle() : -1;
+#endif
+}
+
+#ifndef _WIN32
+bool ReadAheadEngine::setFd(int p_fd)
+{
+	drain();
+	closeFd();
+	positioned = false;
+	end_pos = LLONG_MAX;
+	file = NULL;
+	if (p_fd != -1)
+	{
+		fd = dup(p_fd);
+		owns_fd = fd != -1;
+		return owns_fd;
+	}
+	return true;
+}
+#endif
+
+void ReadAheadEngine::closeFd()
+{
+#ifndef _WIN32
+	if (owns_fd)
+	{
+		close(fd);
+		owns_fd = false;
+	}
+	fd = -1;
+#endif
+}
+
+void ReadAheadEngine::setEnd(int64 p_end_pos)
+{
+	end_pos = p_end_pos;
+}
+
+_u32 ReadAheadEngine::Read(int64 spos, char* buffer, _u32 bsize, bool* has_error)
+{
+	if (!positioned || spos != read_pos)
+	{
+		restart(spos);
+	}
+
+	_u32 ret = 0;
+	while (ret < bsize)
+	{
+		fill();
+
+		if (n_queued == 0)
+		{
+			//Past the read-ahead end
+			SReadAheadBlock direct;
+			memset(&direct, 0, sizeof(direct));
+			direct.file = file;
+#ifndef _WIN32
+			direct.fd = fd;
+#endif
+			_u32 r = read_block(direct, read_pos, buffer + ret, bsize - ret);
+			ret += r;
+			read_pos += r;
+			submit_pos = read_pos;
+			if (direct.err != 0)
+			{
+				positioned = false;
+				if (has_error != NULL) *has_error = true;
+				setSystemErrorCode(direct.err);
+			}
+			break;
+		}
+
+		waitHead();
+
+		SReadAheadBlock& block = blocks[head];
+
+		if (block.err != 0)
+		{
+			unsigned int err = block.err;
+			head = (head + 1) % blocks.size();
+			--n_queued;
+			drain();
+			positioned = false;
+			if (has_error != NULL) *has_error = true;
+			setSystemErrorCode(err);
+			break;
+		}
+
+		_u32 tocopy = (std::min)(block.rsize - head_consumed, bsize - ret);
+		memcpy(buffer + ret, block.buf + head_consumed, tocopy);
+		ret += tocopy;
+		head_consumed += tocopy;
+		read_pos += tocopy;
+
+		if (head_consumed == block.rsize)
+		{
+			bool short_read = block.rsize < block.size;
+
+			head = (head + 1) % blocks.size();
+			--n_queued;
+			head_consumed = 0;
+
+			if (short_read)
+			{
+				//EOF (or file got smaller). Read-ahead after it is useless
+				drain();
+				submit_pos = read_pos;
+				break;
+			}
+		}
+	}
+
+	return ret;
+}
+
+void ReadAheadEngine::restart(int64 spos)
+{
+	if (positioned)
+	{
+		IScopedLock lock(mutex);
+		++stat_restarts;
+	}
+
+	drain();
+	read_pos = spos;
+	submit_pos = spos;
+	positioned = true;
+}
+
+void ReadAheadEngine::fill()
+{
+	size_t n_submitted = 0;
+	int64 now = time_us();
+	while (n_queued < blocks.size()
+		&& submit_pos < end_pos)
+	{
+		SReadAheadBlock& block = blocks[(head + n_queued) % blocks.size()];
+		block.offset = submit_pos;
+		block.size = static_cast<_u32>((std::min)(static_cast<int64>(c_read_ahead_bsize), end_pos - submit_pos));
+		block.rsize = 0;
+		block.err = 0;
+		block.done = false;
+		block.file = file;
+#ifndef _WIN32
+		block.fd = fd;
+#endif
+		block.submit_time = now;
+		block.complete_time = now;
+
+		backend->submit(block);
+
+		submit_pos += block.size;
+		++n_queued;
+		++n_submitted;
+	}
+
+	if (n_submitted > 0)
+	{
+		backend->flush();
+
+		IScopedLock lock(mutex);
+		stat_inflight += n_submitted;
+		if (stat_inflight > stat_max_inflight)
+		{
+			stat_max_inflight = stat_inflight;
+		}
+	}
+}
+
+void ReadAheadEngine::waitHead()
+{
+	SReadAheadBlock& block = blocks[head];
+	if (head_consumed > 0)
+	{
+		return;
+	}
+
+	if (!block.done)
+	{
+		backend->poll(block);
+	}
+
+	int64 stall_us = -1;
+	if (!block.done)
+	{
+		int64 wait_start = time_us();
+		backend->wait(block);
+		stall_us = time_us() - wait_start;
+	}
+
+	int64 latency_us = block.complete_time - block.submit_time;
+
+	if (block.err != 0)
+	{
+		//Retry synchronously to get a definitive result
+		block.err = 0;
+		block.rsize = read_block(block, block.offset, block.buf, block.size);
+	}
+
+	bool log_stats;
+	{
+		IScopedLock lock(mutex);
+		--stat_inflight;
+		++stat_reads;
+		stat_bytes += block.rsize;
+		stat_latency_us += latency_us;
+		if (latency_us > stat_max_latency_us)
+		{
+			stat_max_latency_us = latency_us;
+		}
+		if (stall_us >= 0)
+		{
+			++stat_stalls;
+			stat_stall_us += stall_us;
+		}
+		log_stats = stat_reads % c_log_stats_interval == 0;
+	}
+
+	if (log_stats)
+	{
+		Server->Log("File read-ahead: " + getStatsStr(), LL_DEBUG);
+	}
+}
+
+void ReadAheadEngine::drain()
+{
+	if (n_queued == 0)
+	{
+		head = 0;
+		head_consumed = 0;
+		return;
+	}
+
+	for (size_t i = 0; i < n_queued; ++i)
+	{
+		SReadAheadBlock& block = blocks[(head + i) % blocks.size()];
+		if (!block.done)
+		{
+			backend->wait(block);
+		}
+	}
+
+	{
+		IScopedLock lock(mutex);
+		//Head block was already accounted if it was partially consumed
+		stat_inflight -= head_consumed > 0 ? n_queued - 1 : n_queued;
+	}
+
+	n_queued = 0;
+	head = 0;
+	head_consumed = 0;
+}
+
+IFileServ::SReadStats ReadAheadEngine::getStats()
+{
+	IScopedLock lock(mutex);
+	IFileServ::SReadStats ret;
+	ret.engine = engine_name(engine);
+	ret.queue_depth = static_cast<int64>(queue_depth);
+	ret.inflight = stat_inflight;
+	ret.max_inflight = stat_max_inflight;
+	ret.reads = stat_reads;
+	ret.bytes = stat_bytes;
+	ret.avg_latency_us = stat_reads > 0 ? stat_latency_us / stat_reads : 0;
+	ret.max_latency_us = stat_max_latency_us;
+	ret.stalls = stat_stalls;
+	ret.avg_stall_us = stat_stalls > 0 ? stat_stall_us / stat_stalls : 0;
+	ret.restarts = stat_restarts;
+	return ret;
+}
+
+std::string ReadAheadEngine::getStatsStr()
+{
+	IFileServ::SReadStats stats = getStats();
+	return "engine=" + stats.engine
+		+ " queue_depth=" + convert(stats.queue_depth)
+		+ " inflight=" + convert(stats.inflight)
+		+ " max_inflight=" + convert(stats.max_inflight)
+		+ " reads=" + convert(stats.reads)
+		+ " bytes=" + PrettyPrintBytes(stats.bytes)
+		+ " avg_latency=" + convert(stats.avg_latency_us) + "us"
+		+ " max_latency=" + convert(stats.max_latency_us) + "us"
+		+ " stalls=" + convert(stats.stalls)
+		+ " avg_stall=" + convert(stats.avg_stall_us) + "us"
+		+ " restarts=" + convert(stats.restarts);
+}
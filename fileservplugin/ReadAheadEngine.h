@@ -0,0 +1,123 @@
+#pragma once
+
+#include "../Interface/Types.h"
+#include "../Interface/File.h"
+#include "../Interface/ThreadPool.h"
+#include "IFileServ.h"
+#include <vector>
+#include <memory>
+#include <string>
+
+class IMutex;
+
+struct SReadAheadBlock
+{
+	size_t idx;
+	IFile* file;
+#ifndef _WIN32
+	int fd;
+#endif
+	char* buf;
+	int64 offset;
+	_u32 size;
+	_u32 rsize;
+	unsigned int err;
+	bool done;
+	int64 submit_time;
+	int64 complete_time;
+	THREADPOOL_TICKET ticket;
+};
+
+class IReadAheadBackend
+{
+public:
+	virtual ~IReadAheadBackend() {}
+	//Queue a read of the block. Submission may be delayed until flush()
+	virtual void submit(SReadAheadBlock& block) = 0;
+	virtual void flush() = 0;
+	//Check if the block is done without blocking
+	virtual void poll(SReadAheadBlock& block) = 0;
+	//Wait until the block is done
+	virtual void wait(SReadAheadBlock& block) = 0;
+};
+
+/**
+* Keeps up to queue depth sequential block reads in flight ahead of the
+* file server send paths. Uses io_uring if available and falls back to
+* reads in the thread pool otherwise.
+* Read() behaves like IFile::Read(spos, ...). A read which does not continue
+* where the previous one stopped restarts the read-ahead at that position.
+*/
+class ReadAheadEngine
+{
+public:
+	enum EEngine
+	{
+		EEngine_None = 0,
+		EEngine_Threads = 1,
+		EEngine_Uring = 2
+	};
+
+	static void init();
+	static void destroy();
+
+	//Returns NULL if read-ahead is disabled
+	static ReadAheadEngine* create();
+
+	~ReadAheadEngine();
+
+	//Switch to reading from another file. Outstanding reads are discarded
+	void setFile(IFsFile* file);
+#ifndef _WIN32
+	//Reads from a duplicate of fd, so the caller may close it at any time
+	bool setFd(int fd);
+#endif
+
+	_u32 Read(int64 spos, char* buffer, _u32 bsize, bool* has_error = NULL);
+
+	//Do not read ahead at or after end_pos
+	void setEnd(int64 end_pos);
+
+	static IFileServ::SReadStats getStats();
+
+	static std::string getStatsStr();
+
+private:
+	ReadAheadEngine(IReadAheadBackend* backend);
+
+	void restart(int64 spos);
+	void fill();
+	void drain();
+	void waitHead();
+	void closeFd();
+
+	IFile* file;
+#ifndef _WIN32
+	int fd;
+	bool owns_fd;
+#endif
+	std::auto_ptr<IReadAheadBackend> backend;
+	std::vector<SReadAheadBlock> blocks;
+	std::vector<char> buffers;
+	size_t head;
+	size_t n_queued;
+	_u32 head_consumed;
+	int64 read_pos;
+	int64 submit_pos;
+	int64 end_pos;
+	bool positioned;
+
+	static EEngine engine;
+	static size_t queue_depth;
+
+	static IMutex* mutex;
+	static int64 stat_reads;
+	static int64 stat_bytes;
+	static int64 stat_latency_us;
+	static int64 stat_max_latency_us;
+	static int64 stat_inflight;
+	static int64 stat_max_inflight;
+	static int64 stat_stalls;
+	static int64 stat_stall_us;
+	static int64 stat_restarts;
+};
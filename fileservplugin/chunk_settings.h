@@ -14,4 +14,12 @@ const unsigned int chunkhash_single_size=big_hash_size+small_hash_size*(c_checkp
 
 const unsigned int c_reconnection_tries=30;
 
+//Transfer mode of ID_BLOCK_REQUEST: chunk hashes follow and the client
+//may answer with ID_COPY_CHUNK for data found at another offset
+const char c_block_request_copy=2;
+
+//Marks a patch record which copies patch_size bytes from the original
+//file. The source offset follows the header instead of data.
+const unsigned int c_patch_copy_flag=0x80000000;
+
 #endif //CHUNK_SETTINGS_H
\ No newline at end of file
@@ -44,6 +44,7 @@ extern IServer* Server;
 #include "IFileServFactory.h"
 #include "IFileServ.h"
 #include "PipeSessions.h"
+#include "ReadAheadEngine.h"
 #include "../stringtools.h"
 #include <stdlib.h>
 
@@ -55,6 +56,7 @@ DLLEXPORT void LoadActions(IServer* pServer)
 
 	FileServ::init_mutex();
 	PipeSessions::init();
+	ReadAheadEngine::init();
 
 	fileservpluginmgr=new CFileServPluginMgr;
 
@@ -91,6 +93,7 @@ DLLEXPORT void UnloadActions(void)
 	{
 		FileServ::destroy_mutex();
 		PipeSessions::destroy();
+		ReadAheadEngine::destroy();
 	}
 }
 
@@ -40,6 +40,12 @@
 #endif //!_WIN32
 #endif //!SOCK_CLOEXEC
 
+#if !defined(_WIN32) && defined(__linux__) && defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_EVENTFD_H)
+#	define USE_EPOLL
+#	include <sys/epoll.h>
+#	include <sys/eventfd.h>
+#endif
+
 #ifdef EMULATE_ACCEPT_CLOEXEC
 #ifndef ACCEPT_CLOEXEC_DEFINED
 #define ACCEPT_CLOEXEC_DEFINED
@@ -314,6 +314,14 @@ bool ClientConnector::Run(IRunOtherCallback* p_run_other)
 		return false;
 	}
 
+	if (compressed_pipe.get() != NULL
+		&& want_receive
+		&& compressed_pipe->isReadable(0))
+	{
+		//Decompressed data may be buffered without the socket being readable
+		ReceivePackets(p_run_other);
+	}
+
 	switch(state)
 	{
 	case CCSTATE_NORMAL:
@@ -1092,6 +1100,10 @@ void ClientConnector::ReceivePackets(IRunOtherCallback* p_run_other)
 			{
 				CMD_WRITE_TOKENS(cmd.substr(13)); continue;
 			}
+			else if (next(cmd, 0, "COMPRESS "))
+			{
+				CMD_COMPRESS(cmd.substr(9)); continue;
+			}
 			else if (next(cmd, 0, "ADD IDENTITY "))
 			{
 				CMD_ADD_IDENTITY(cmd.substr(13)); continue;
@@ -6,6 +6,7 @@
 
 #include <map>
 #include <deque>
+#include <memory>
 
 class ClientService : public IService
 {
@@ -342,6 +343,7 @@ private:
 	void CMD_RESTORE_OK(str_map &params);
 	void CMD_CLIENT_ACCESS_KEY(const std::string& cmd);
 	void CMD_WRITE_TOKENS(const std::string& cmd);
+	void CMD_COMPRESS(const std::string& cmd);
 
 	int getCapabilities(IDatabase* db);
 	bool multipleChannelServers();
@@ -361,6 +363,7 @@ private:
 
 	unsigned int curr_result_id;
 	IPipe *pipe;
+	std::auto_ptr<IPipe> compressed_pipe;
 	THREAD_ID tid;
 	ClientConnectorState state;
 	int64 lasttime;
@@ -29,6 +29,7 @@
 #include "database.h"
 #include "../stringtools.h"
 #include "../urbackupcommon/json.h"
+#include "../urbackupcommon/CompressedPipeZstd.h"
 #include "../cryptoplugin/ICryptoFactory.h"
 #include "file_permissions.h"
 #ifdef _WIN32
@@ -1081,6 +1082,40 @@ void ClientConnector::CMD_STATUS_DETAIL(const std::string &cmd)
 
 	ret.set("capability_bits", getCapabilities(db));
 
+	IFileServ* filesrv = IndexThread::getFileSrv();
+	if (filesrv != NULL)
+	{
+		IFileServ::SReadStats read_stats = filesrv->getReadStats();
+		JSON::Object j_read_stats;
+		j_read_stats.set("engine", read_stats.engine);
+		j_read_stats.set("queue_depth", read_stats.queue_depth);
+		j_read_stats.set("inflight", read_stats.inflight);
+		j_read_stats.set("max_inflight", read_stats.max_inflight);
+		j_read_stats.set("reads", read_stats.reads);
+		j_read_stats.set("bytes", read_stats.bytes);
+		j_read_stats.set("avg_latency_us", read_stats.avg_latency_us);
+		j_read_stats.set("max_latency_us", read_stats.max_latency_us);
+		j_read_stats.set("stalls", read_stats.stalls);
+		j_read_stats.set("avg_stall_us", read_stats.avg_stall_us);
+		j_read_stats.set("restarts", read_stats.restarts);
+		ret.set("file_read_stats", j_read_stats);
+	}
+
+#ifndef NO_ZSTD_COMPRESSION
+	SZstdPipeStats zstd_stats = CompressedPipeZstd::getGlobalStats();
+	JSON::Object j_zstd_stats;
+	j_zstd_stats.set("uncompressed_sent", zstd_stats.uncompressed_sent_bytes);
+	j_zstd_stats.set("compressed_sent", zstd_stats.compressed_sent_bytes);
+	j_zstd_stats.set("uncompressed_received", zstd_stats.uncompressed_received_bytes);
+	j_zstd_stats.set("compressed_received", zstd_stats.compressed_received_bytes);
+	j_zstd_stats.set("bytes_saved", zstd_stats.uncompressed_sent_bytes - zstd_stats.compressed_sent_bytes
+		+ zstd_stats.uncompressed_received_bytes - zstd_stats.compressed_received_bytes);
+	j_zstd_stats.set("compress_time_ms", zstd_stats.compress_time_us / 1000);
+	j_zstd_stats.set("decompress_time_ms", zstd_stats.decompress_time_us / 1000);
+	j_zstd_stats.set("level_changes", zstd_stats.level_changes);
+	ret.set("compression_stats", j_zstd_stats);
+#endif
+
     tcpstack.Send(pipe, ret.stringify(false));
 
 	db->destroyAllQueries();
@@ -2547,6 +2582,11 @@ void ClientConnector::CMD_CAPA(const std::string &cmd)
 		imm_backup = "&BACKUP=" + EscapeParamString(imm_backup);
 	}
 
+	std::string lan_zstd;
+#ifndef NO_ZSTD_COMPRESSION
+	lan_zstd = "&LAN_ZSTD=1";
+#endif
+
 #ifdef _WIN32
 	std::string buf;
 	buf.resize(1024);
@@ -2575,11 +2615,11 @@ void ClientConnector::CMD_CAPA(const std::string &cmd)
 		last_metered = metered;
 	}
 
-	tcpstack.Send(pipe, "FILE=2&FILE2=1&IMAGE=1&UPDATE=1&MBR=1&FILESRV=3&SET_SETTINGS=1&IMAGE_VER=1&CLIENTUPDATE=2&ASYNC_INDEX=1"
+	tcpstack.Send(pipe, "FILE=2&FILE2=1&IMAGE=1&UPDATE=1&MBR=1&FILESRV=5&SET_SETTINGS=1&IMAGE_VER=1&CLIENTUPDATE=2&ASYNC_INDEX=1"
 		"&CLIENT_VERSION_STR="+EscapeParamString((client_version_str))+"&OS_VERSION_STR="+EscapeParamString(os_version_str)+
 		"&ALL_VOLUMES="+EscapeParamString(win_volumes)+"&ETA=1&CDP=0&ALL_NONUSB_VOLUMES="+EscapeParamString(win_nonusb_volumes)+"&EFI=1"
 		"&FILE_META=1&SELECT_SHA=1&PHASH=1&RESTORE="+restore+"&CLIENT_BITMAP=1&CMD=2&SYMBIT=1&WTOKENS=1&OS_SIMPLE=windows"
-		"&clientuid="+EscapeParamString(clientuid)+conn_metered+ send_prev_cbitmap + imm_backup);
+		"&clientuid="+EscapeParamString(clientuid)+conn_metered+ send_prev_cbitmap + imm_backup + lan_zstd);
 #else
 
 #ifdef __APPLE__
@@ -2598,10 +2638,10 @@ void ClientConnector::CMD_CAPA(const std::string &cmd)
 
 
 	std::string os_version_str=get_lin_os_version();
-	tcpstack.Send(pipe, "FILE=2&FILE2=1&FILESRV=3&SET_SETTINGS=1&IMAGE_VER=1&CLIENTUPDATE=2&ASYNC_INDEX=1"
+	tcpstack.Send(pipe, "FILE=2&FILE2=1&FILESRV=5&SET_SETTINGS=1&IMAGE_VER=1&CLIENTUPDATE=2&ASYNC_INDEX=1"
 		"&CLIENT_VERSION_STR="+EscapeParamString((client_version_str))+"&OS_VERSION_STR="+EscapeParamString(os_version_str)
 		+"&ETA=1&CPD=0&EFI=1&FILE_META=1&SELECT_SHA=1&PHASH=1&RESTORE="+restore+"&CLIENT_BITMAP=1&CMD=2&SYMBIT=1&WTOKENS=1&OS_SIMPLE="+os_simple
-		+"&clientuid=" + EscapeParamString(clientuid) + imm_backup + image_args);
+		+"&clientuid=" + EscapeParamString(clientuid) + imm_backup + image_args + lan_zstd);
 #endif
 }
 
@@ -2989,4 +3029,36 @@ void ClientConnector::CMD_WRITE_TOKENS(const std::string& cmd)
 
 	tcpstack.Send(pipe, "ASYNC-async_id=" + bytesToHex(async_id));
 }
+
+void ClientConnector::CMD_COMPRESS(const std::string& cmd)
+{
+#ifndef NO_ZSTD_COMPRESSION
+	if (internet_conn
+		|| is_channel
+		|| compressed_pipe.get() != NULL)
+	{
+		tcpstack.Send(pipe, "ERR");
+		return;
+	}
+
+	str_map params;
+	ParseParamStrHttp(cmd, &params);
+
+	int compression_level = watoi(params["level"]);
+	int min_level = watoi(params["min_level"]);
+	int max_level = watoi(params["max_level"]);
+
+	tcpstack.Send(pipe, "OK");
+
+	CompressedPipeZstd* comp_pipe = new CompressedPipeZstd(pipe, compression_level, -1);
+	if (min_level != max_level)
+	{
+		comp_pipe->setAdaptiveLevel(min_level, max_level);
+	}
+	compressed_pipe.reset(comp_pipe);
+	pipe = comp_pipe;
+#else
+	tcpstack.Send(pipe, "ERR");
+#endif
+}
 	
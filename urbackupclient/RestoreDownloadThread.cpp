@@ -353,7 +353,7 @@ bool RestoreDownloadThread::load_file_patch( SQueueItem todl )
 	return true;
 }
 
-std::string RestoreDownloadThread::getQueuedFileFull( FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id)
+std::string RestoreDownloadThread::getQueuedFileFull( FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id, int64& predicted_filesize)
 {
 	IScopedLock lock(mutex.get());
 	for(std::deque<SQueueItem>::iterator it=dl_queue.begin();
@@ -374,6 +374,7 @@ std::string RestoreDownloadThread::getQueuedFileFull( FileClient::MetadataQueue&
 			folder_items = it->folder_items;
 			finish_script = false;
 			file_id=it->id+1;
+			predicted_filesize=-1;
 			return (it->remotefn);
 		}
 	}
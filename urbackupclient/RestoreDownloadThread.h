@@ -80,7 +80,7 @@ public:
 
 	bool load_file_patch(SQueueItem todl);
 
-	virtual std::string getQueuedFileFull( FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id);
+	virtual std::string getQueuedFileFull( FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id, int64& predicted_filesize);
 
 	virtual void unqueueFileFull( const std::string& fn, bool finish_script);
 
@@ -45,6 +45,7 @@
 #include "../fileservplugin/chunk_settings.h"
 #include "ImageThread.h"
 #include "../common/adler32.h"
+#include "../urbackupcommon/CompressedPipeZstd.h"
 
 //For truncating files
 #ifdef _WIN32
@@ -4167,6 +4168,21 @@ void IndexThread::onReadError(const std::string& sharename, const std::string& f
 	}
 }
 
+IPipe* IndexThread::compressStream(IPipe* pipe, bool destroy_pipe, int compression_level, int min_level, int max_level)
+{
+#ifndef NO_ZSTD_COMPRESSION
+	CompressedPipeZstd* ret = new CompressedPipeZstd(pipe, compression_level, -1);
+	ret->destroyBackendPipeOnDelete(destroy_pipe);
+	if (min_level != max_level)
+	{
+		ret->setAdaptiveLevel(min_level, max_level);
+	}
+	return ret;
+#else
+	return NULL;
+#endif
+}
+
 void IndexThread::deregisterFileSrvScriptFn(const std::string & fn)
 {
 	filesrv->deregisterScriptPipeFile(fn);
@@ -4553,6 +4569,7 @@ void IndexThread::start_filesrv(void)
 	ServerIdentityMgr::loadServerIdentities();
 
 	filesrv->registerReadErrorCallback(this);
+	filesrv->registerStreamCompressionCallback(this);
 }
 
 void IndexThread::shareDir(const std::string& token, std::string name, const std::string &path)
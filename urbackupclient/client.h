@@ -311,7 +311,7 @@ struct SQueueRef
 	}
 };
 
-class IndexThread : public IThread, public IFileServ::IReadErrorCallback, public IDeregisterFileSrvScriptFn
+class IndexThread : public IThread, public IFileServ::IReadErrorCallback, public IFileServ::IStreamCompressionCallback, public IDeregisterFileSrvScriptFn
 {
 public:
 	static const char IndexThreadAction_StartFullFileBackup;
@@ -373,6 +373,8 @@ public:
 
 	void onReadError(const std::string& sharename, const std::string& filepath, int64 pos, const std::string& msg);
 
+	IPipe* compressStream(IPipe* pipe, bool destroy_pipe, int compression_level, int min_level, int max_level);
+
 	void deregisterFileSrvScriptFn(const std::string& fn);
 
 	static unsigned int getResultId();
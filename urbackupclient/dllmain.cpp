@@ -72,6 +72,7 @@ extern IServer* Server;
 
 #include "../urbackupcommon/chunk_hasher.h"
 #include "../urbackupcommon/WalCheckpointThread.h"
+#include "../urbackupcommon/CompressedPipeZstd.h"
 
 #define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
 #include "../common/miniz.h"
@@ -248,6 +249,9 @@ DLLEXPORT void LoadActions(IServer* pServer)
 	init_chunk_hasher();
 
 	ServerIdentityMgr::init_mutex();
+#ifndef NO_ZSTD_COMPRESSION
+	CompressedPipeZstd::init_mutex();
+#endif
 #ifdef _WIN32
 	DirectoryWatcherThread::init_mutex();
 #endif
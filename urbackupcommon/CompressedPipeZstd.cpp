@@ -22,14 +22,19 @@
 #include "../Interface/Server.h"
 #include "../Interface/Mutex.h"
 #include <limits.h>
-#include <memory.h>
-#include <string.h>
+#include <memory.h>
+#include <string.h>
 #include "../stringtools.h"
 #include <assert.h>
-#include <stdexcept>
-#include <assert.h>
+#include <stdexcept>
+#include <assert.h>
 #include "InternetServicePipe2.h"
 #include "os_functions.h"
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
 
 #define VLOG(x)
 
@@ -38,6 +43,57 @@ const size_t max_send_size=20000;
 const size_t output_incr_size=8192;
 const size_t output_max_size=32*1024;
 
+//Re-evaluate the adaptive compression level after this many uncompressed bytes
+const int64 adaptive_window_size=8*1024*1024;
+//If compressing and sending took less than this in a window, the sender is the bottleneck
+const int64 adaptive_min_busy_us=50000;
+//Sending has to take this many times longer than compressing to increase the level
+const int64 adaptive_link_bound_factor=2;
+//Only use compression worker threads for streams larger than this
+const int64 workers_min_stream_size=32*1024*1024;
+//Add to global statistics after this many bytes
+const int64 stats_batch_size=1024*1024;
+
+IMutex* CompressedPipeZstd::stats_mutex = NULL;
+SZstdPipeStats CompressedPipeZstd::global_stats;
+
+namespace
+{
+	int64 time_us()
+	{
+#ifdef _WIN32
+		LARGE_INTEGER freq;
+		LARGE_INTEGER counter;
+		QueryPerformanceFrequency(&freq);
+		QueryPerformanceCounter(&counter);
+		return (counter.QuadPart / freq.QuadPart) * 1000000
+			+ ((counter.QuadPart % freq.QuadPart) * 1000000) / freq.QuadPart;
+#else
+		timespec tp;
+		if (clock_gettime(CLOCK_MONOTONIC, &tp) != 0)
+		{
+			return Server->getTimeMS() * 1000;
+		}
+		return static_cast<int64>(tp.tv_sec) * 1000000 + tp.tv_nsec / 1000;
+#endif
+	}
+
+	int nextLevel(int level, int dir, int min_level, int max_level)
+	{
+		//Level 0 means default level
+		int ret = level + dir;
+		if (ret == 0)
+		{
+			ret += dir;
+		}
+		if (ret<min_level || ret>max_level)
+		{
+			return level;
+		}
+		return ret;
+	}
+}
+
 CompressedPipeZstd::CompressedPipeZstd(IPipe *cs, int compression_level, int threads)
 	: cs(cs), has_error(false),
 	uncompressed_sent_bytes(0), uncompressed_received_bytes(0), sent_flushes(0),
@@ -50,6 +106,24 @@ CompressedPipeZstd::CompressedPipeZstd(IPipe *cs, int compression_level, int thr
 	input_buffer.resize(16384);
 	destroy_cs=false;
 
+	this->compression_level = compression_level;
+	pending_level = compression_level;
+	adaptive = false;
+	adaptive_min_level = compression_level;
+	adaptive_max_level = compression_level;
+	pending_workers = false;
+	workers_enabled = false;
+	end_frame = false;
+	window_bytes = 0;
+	window_compress_us = 0;
+	window_send_us = 0;
+
+	if (threads == -1)
+	{
+		threads = static_cast<int>(os_get_num_cpus());
+	}
+	this->threads = threads;
+
 	if(inf_stream==NULL)
 	{
 		throw std::runtime_error("Error initializing compression stream");
@@ -66,24 +140,13 @@ CompressedPipeZstd::CompressedPipeZstd(IPipe *cs, int compression_level, int thr
 		throw std::runtime_error(std::string("Error setting zstd compression level. ") + ZSTD_getErrorName(err));
 	}
 
-	/*if (threads == -1)
-	{
-		threads = static_cast<int>(os_get_num_cpus());
-	}
-
-	if (threads > 1)
-	{
-		size_t err = ZSTD_CCtx_setParameter(def_stream, ZSTD_c_nbWorkers, threads);
-
-		if (ZSTD_isError(err))
-		{
-			throw std::runtime_error(std::string("Error setting zstd workers. ") + ZSTD_getErrorName(err));
-		}
-	}*/	
 }
 
 CompressedPipeZstd::~CompressedPipeZstd(void)
 {
+	addGlobalStats(true, true);
+	addGlobalStats(false, true);
+
 	ZSTD_freeDStream(inf_stream);
 	ZSTD_freeCCtx(def_stream);
 	
@@ -96,6 +159,29 @@ CompressedPipeZstd::~CompressedPipeZstd(void)
 size_t CompressedPipeZstd::Read(char *buffer, size_t bsize, int timeoutms)
 {
 	IScopedLock lock(read_mutex.get());
+	return ReadInt(buffer, bsize, timeoutms);
+}
+
+size_t CompressedPipeZstd::ReadInto(char *buffer, size_t bsize, size_t min_size, int timeoutms)
+{
+	IScopedLock lock(read_mutex.get());
+
+	size_t read = 0;
+	do
+	{
+		size_t rc = ReadInt(buffer + read, bsize - read, timeoutms);
+		if (rc == 0)
+		{
+			break;
+		}
+		read += rc;
+	} while (read < min_size && read < bsize);
+
+	return read;
+}
+
+size_t CompressedPipeZstd::ReadInt(char *buffer, size_t bsize, int timeoutms)
+{
 	VLOG(Server->Log("Read bsize=" + convert(bsize) + " timeoutms=" + convert(timeoutms)+" input_buffer_size="+convert(input_buffer_size), LL_DEBUG));
 
 	if(input_buffer_size>0)
@@ -117,7 +203,8 @@ size_t CompressedPipeZstd::Read(char *buffer, size_t bsize, int timeoutms)
 		if(rc==0)
 			return 0;
 
-		input_buffer_size+=rc;		
+		input_buffer_size+=rc;
+		local_stats.compressed_received_bytes+=rc;
 		return ProcessToBuffer(buffer, bsize, false);
 	}
 	else if(timeoutms==-1)
@@ -133,7 +220,8 @@ size_t CompressedPipeZstd::Read(char *buffer, size_t bsize, int timeoutms)
 				return 0;
 			}
 
-			input_buffer_size += rc;	
+			input_buffer_size+=rc;
+			local_stats.compressed_received_bytes+=rc;
 			rc = ProcessToBuffer(buffer, bsize, false);
 		}
 		while(rc==0);
@@ -157,7 +245,8 @@ size_t CompressedPipeZstd::Read(char *buffer, size_t bsize, int timeoutms)
 		{
 			return 0;
 		}
-		input_buffer_size += rc;	
+		input_buffer_size+=rc;
+		local_stats.compressed_received_bytes+=rc;
 		rc = ProcessToBuffer(buffer, bsize, false);
 	}
 	while(rc==0 && Server->getTimeMS()-starttime<static_cast<int64>(timeoutms));
@@ -180,11 +269,14 @@ size_t CompressedPipeZstd::ProcessToBuffer(char *buffer, size_t bsize, bool from
 
 		VLOG(Server->Log("ZSTD_decompressStream(1) avail_in=" + convert(inf_in_last.size - inf_in_last.pos) + " avail_out=" + convert(bsize), LL_DEBUG));
 
+		int64 decomp_start = time_us();
 		size_t rc = ZSTD_decompressStream(inf_stream, &outBuffer, &inf_in_last);
+		local_stats.decompress_time_us += time_us() - decomp_start;
 		
 		assert(bsize >= outBuffer.size - outBuffer.pos);
 		size_t used = outBuffer.pos;
 		uncompressed_received_bytes+=used;
+		local_stats.uncompressed_received_bytes+=used;
 
 		VLOG(Server->Log("rc=" + convert(rc) + " used=" + convert(used) + " avail_in = " + convert(inf_in_last.size - inf_in_last.pos) + " avail_out = " + convert(outBuffer.size - outBuffer.pos), LL_DEBUG));
 
@@ -214,11 +306,15 @@ size_t CompressedPipeZstd::ProcessToBuffer(char *buffer, size_t bsize, bool from
 	outBuffer.pos = 0;
 
 	VLOG(Server->Log("ZSTD_decompressStream(2) avail_in=" + convert(input_buffer_size) + " avail_out=" + convert(bsize), LL_DEBUG));
+	int64 decomp_start = time_us();
 	size_t rc = ZSTD_decompressStream(inf_stream, &outBuffer, &inf_in_last);
+	local_stats.decompress_time_us += time_us() - decomp_start;
 
 	size_t used = outBuffer.pos;
 	VLOG(Server->Log("rc=" + convert(rc) + " used=" + convert(used)+" avail_in = " + convert(inf_in_last.size - inf_in_last.pos) + " avail_out = " + convert(outBuffer.size - outBuffer.pos), LL_DEBUG));
 	uncompressed_received_bytes+=used;
+	local_stats.uncompressed_received_bytes+=used;
+	addGlobalStats(false, false);
 
 	if (ZSTD_isError(rc))
 	{
@@ -271,17 +367,51 @@ void CompressedPipeZstd::ProcessToString(std::string* ret, bool fromLast )
 bool CompressedPipeZstd::Write(const char *buffer, size_t bsize, int timeoutms, bool flush)
 {
 	IScopedLock lock(write_mutex.get());
+	return WriteInt(buffer, bsize, timeoutms, flush, Server->getTimeMS());
+}
 
+bool CompressedPipeZstd::Writev(const SPipeBuffer* bufs, size_t n_bufs, int timeoutms, bool flush)
+{
+	IScopedLock lock(write_mutex.get());
+
+	if (n_bufs == 0)
+	{
+		return WriteInt(NULL, 0, timeoutms, flush, Server->getTimeMS());
+	}
+
+	//Only flush the compression stream after the last buffer so that
+	//all buffers end up in the same compressed block
+	int64 starttime = Server->getTimeMS();
+	for (size_t i = 0; i < n_bufs; ++i)
+	{
+		if (!WriteInt(bufs[i].buf, bufs[i].bsize, timeoutms, flush && i + 1 == n_bufs, starttime))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool CompressedPipeZstd::WriteInt(const char *buffer, size_t bsize, int timeoutms, bool flush, int64 starttime)
+{
 	assert(buffer != NULL || bsize == 0);
 	const char* ptr=buffer;
 	size_t cbsize=bsize;
-	int64 starttime = Server->getTimeMS();
 	do
 	{
+		if (adaptive
+			&& window_bytes >= adaptive_window_size)
+		{
+			adaptLevel();
+		}
+
 		cbsize=(std::min)(max_send_size, bsize);
 
 		bsize-=cbsize;
 		uncompressed_sent_bytes+=cbsize;
+		local_stats.uncompressed_sent_bytes+=cbsize;
+		window_bytes+=cbsize;
 
 		bool has_next = bsize>0;
 		bool curr_flush = has_next ? false : flush;
@@ -292,11 +422,19 @@ bool CompressedPipeZstd::Write(const char *buffer, size_t bsize, int timeoutms,
 			curr_flush = true;
 		}
 
+		if (end_frame)
+		{
+			//New parameters can only be applied to the next frame
+			curr_flush = true;
+		}
+
 		if(curr_flush)
 		{
 			++sent_flushes;
 		}
 
+		ZSTD_EndDirective directive = curr_flush ? (end_frame ? ZSTD_e_end : ZSTD_e_flush) : ZSTD_e_continue;
+
 		
 		ZSTD_inBuffer inbuf;
 		inbuf.src = ptr;
@@ -313,7 +451,11 @@ bool CompressedPipeZstd::Write(const char *buffer, size_t bsize, int timeoutms,
 			outbuf.size = comp_buffer.size();
 
 			VLOG(Server->Log("ZSTD_compressStream2 avail_in=" + convert(inbuf.size-inbuf.pos) + " avail_out=" + convert(outbuf.size)+" flush="+convert(curr_flush), LL_DEBUG));
-			rc = ZSTD_compressStream2(def_stream, &outbuf, &inbuf, curr_flush ? ZSTD_e_flush : ZSTD_e_continue);
+			int64 comp_start = time_us();
+			rc = ZSTD_compressStream2(def_stream, &outbuf, &inbuf, directive);
+			int64 comp_us = time_us() - comp_start;
+			local_stats.compress_time_us += comp_us;
+			window_compress_us += comp_us;
 
 			if(ZSTD_isError(rc))
 			{
@@ -323,6 +465,13 @@ bool CompressedPipeZstd::Write(const char *buffer, size_t bsize, int timeoutms,
 				return false;
 			}
 
+			if (directive == ZSTD_e_end
+				&& rc == 0)
+			{
+				applyPendingParameters();
+				directive = ZSTD_e_flush;
+			}
+
 			assert(comp_buffer.size() >= outbuf.size - outbuf.pos);
 
 			size_t used = outbuf.pos;
@@ -348,25 +497,203 @@ bool CompressedPipeZstd::Write(const char *buffer, size_t bsize, int timeoutms,
 			if(used>0)
 			{
 				last_send_time = Server->getTimeMS();
+				local_stats.compressed_sent_bytes+=used;
 
+				int64 send_start = time_us();
 				bool b=cs->Write(comp_buffer.data(), used, curr_timeout, curr_flush);
+				window_send_us += time_us() - send_start;
 				if(!b)
 					return false;
 			}
-			else if(!has_next && flush)
+			else if(!has_next && flush
+				&& inbuf.pos==inbuf.size)
 			{
 				return cs->Flush(curr_timeout);
 			}
 
-		} while(outbuf.pos==outbuf.size || (curr_flush && rc!=0) );
+		} while(outbuf.pos==outbuf.size
+			|| inbuf.pos<inbuf.size
+			|| (curr_flush && rc!=0) );
 
 		ptr+=cbsize;
 		
 	} while(bsize>0);
 
+	addGlobalStats(true, false);
+
 	return true;
 }
 
+void CompressedPipeZstd::adaptLevel()
+{
+	int64 compress_us = window_compress_us;
+	int64 send_us = window_send_us;
+	window_bytes = 0;
+	window_compress_us = 0;
+	window_send_us = 0;
+
+	if (compress_us + send_us < adaptive_min_busy_us)
+	{
+		return;
+	}
+
+	int new_level = compression_level;
+
+	if (compress_us > send_us)
+	{
+		if (!workers_enabled
+			&& threads > 1
+			&& compression_level > 0
+			&& uncompressed_sent_bytes >= workers_min_stream_size)
+		{
+			pending_workers = true;
+		}
+		else
+		{
+			new_level = nextLevel(compression_level, -1, adaptive_min_level, adaptive_max_level);
+		}
+	}
+	else if (send_us > compress_us*adaptive_link_bound_factor)
+	{
+		new_level = nextLevel(compression_level, 1, adaptive_min_level, adaptive_max_level);
+	}
+
+	if (new_level != compression_level
+		|| pending_workers)
+	{
+		VLOG(Server->Log("Adapting zstd compression. compress_us=" + convert(compress_us) + " send_us=" + convert(send_us)
+			+ " new_level=" + convert(new_level) + " workers=" + convert(pending_workers), LL_DEBUG));
+		pending_level = new_level;
+		end_frame = true;
+	}
+}
+
+bool CompressedPipeZstd::applyPendingParameters()
+{
+	end_frame = false;
+	bool ret = true;
+
+	if (pending_level != compression_level)
+	{
+		size_t err = ZSTD_CCtx_setParameter(def_stream, ZSTD_c_compressionLevel, pending_level);
+		if (ZSTD_isError(err))
+		{
+			Server->Log(std::string("Error changing zstd compression level. ") + ZSTD_getErrorName(err), LL_WARNING);
+			pending_level = compression_level;
+			ret = false;
+		}
+		else
+		{
+			compression_level = pending_level;
+			++local_stats.level_changes;
+		}
+	}
+
+	if (pending_workers)
+	{
+		pending_workers = false;
+
+		size_t err = ZSTD_CCtx_setParameter(def_stream, ZSTD_c_nbWorkers, threads);
+		if (ZSTD_isError(err))
+		{
+			Server->Log(std::string("Cannot use zstd compression workers. ") + ZSTD_getErrorName(err), LL_DEBUG);
+			threads = 0;
+			ret = false;
+		}
+		else
+		{
+			workers_enabled = true;
+		}
+	}
+
+	return ret;
+}
+
+void CompressedPipeZstd::setAdaptiveLevel(int min_level, int max_level)
+{
+	IScopedLock lock(write_mutex.get());
+
+	adaptive = true;
+	adaptive_min_level = min_level;
+	adaptive_max_level = max_level;
+
+	if (compression_level < min_level)
+	{
+		pending_level = min_level;
+		end_frame = true;
+	}
+	else if (compression_level > max_level)
+	{
+		pending_level = max_level;
+		end_frame = true;
+	}
+}
+
+int CompressedPipeZstd::getCompressionLevel()
+{
+	IScopedLock lock(write_mutex.get());
+	return compression_level;
+}
+
+void CompressedPipeZstd::addGlobalStats(bool write_side, bool force)
+{
+	if (stats_mutex == NULL)
+	{
+		return;
+	}
+
+	if (write_side)
+	{
+		if (!force
+			&& local_stats.uncompressed_sent_bytes < stats_batch_size)
+		{
+			return;
+		}
+
+		IScopedLock lock(stats_mutex);
+		global_stats.uncompressed_sent_bytes += local_stats.uncompressed_sent_bytes;
+		global_stats.compressed_sent_bytes += local_stats.compressed_sent_bytes;
+		global_stats.compress_time_us += local_stats.compress_time_us;
+		global_stats.level_changes += local_stats.level_changes;
+		local_stats.uncompressed_sent_bytes = 0;
+		local_stats.compressed_sent_bytes = 0;
+		local_stats.compress_time_us = 0;
+		local_stats.level_changes = 0;
+	}
+	else
+	{
+		if (!force
+			&& local_stats.uncompressed_received_bytes < stats_batch_size)
+		{
+			return;
+		}
+
+		IScopedLock lock(stats_mutex);
+		global_stats.uncompressed_received_bytes += local_stats.uncompressed_received_bytes;
+		global_stats.compressed_received_bytes += local_stats.compressed_received_bytes;
+		global_stats.decompress_time_us += local_stats.decompress_time_us;
+		local_stats.uncompressed_received_bytes = 0;
+		local_stats.compressed_received_bytes = 0;
+		local_stats.decompress_time_us = 0;
+	}
+}
+
+void CompressedPipeZstd::init_mutex()
+{
+	stats_mutex = Server->createMutex();
+}
+
+SZstdPipeStats CompressedPipeZstd::getGlobalStats()
+{
+	if (stats_mutex == NULL)
+	{
+		return SZstdPipeStats();
+	}
+
+	IScopedLock lock(stats_mutex);
+	return global_stats;
+}
+
 size_t CompressedPipeZstd::Read(std::string *ret, int timeoutms)
 {
 	IScopedLock lock(read_mutex.get());
@@ -395,6 +722,7 @@ size_t CompressedPipeZstd::Read(std::string *ret, int timeoutms)
 			return 0;
 		}
 		input_buffer_size+=rc;
+		local_stats.compressed_received_bytes+=rc;
 		ProcessToString(ret, false);
 		return ret->size();
 	}
@@ -413,6 +741,7 @@ size_t CompressedPipeZstd::Read(std::string *ret, int timeoutms)
 			}
 
 			input_buffer_size+=rc;
+			local_stats.compressed_received_bytes+=rc;
 			ProcessToString(ret, false);
 			rc=ret->size();
 		}
@@ -435,6 +764,7 @@ size_t CompressedPipeZstd::Read(std::string *ret, int timeoutms)
 			return 0;
 		}
 		input_buffer_size+=rc;
+		local_stats.compressed_received_bytes+=rc;
 		ProcessToString(ret, false);
 		rc=ret->size();
 	}
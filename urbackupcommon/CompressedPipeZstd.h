@@ -11,6 +11,22 @@
 
 class IMutex;
 
+struct SZstdPipeStats
+{
+	SZstdPipeStats()
+		: uncompressed_sent_bytes(0), compressed_sent_bytes(0),
+		uncompressed_received_bytes(0), compressed_received_bytes(0),
+		compress_time_us(0), decompress_time_us(0), level_changes(0)
+	{}
+
+	int64 uncompressed_sent_bytes;
+	int64 compressed_sent_bytes;
+	int64 uncompressed_received_bytes;
+	int64 compressed_received_bytes;
+	int64 compress_time_us;
+	int64 decompress_time_us;
+	int64 level_changes;
+};
 
 class CompressedPipeZstd : public ICompressedPipe
 {
@@ -22,6 +38,8 @@ public:
 	virtual bool Write(const char *buffer, size_t bsize, int timeoutms=-1, bool flush=true);
 	virtual size_t Read(std::string *ret, int timeoutms=-1);
 	virtual bool Write(const std::string &str, int timeoutms=-1, bool flush=true);
+	virtual bool Writev(const SPipeBuffer* bufs, size_t n_bufs, int timeoutms=-1, bool flush=true);
+	virtual size_t ReadInto(char *buffer, size_t bsize, size_t min_size, int timeoutms=-1);
 
 	/**
 	* @param timeoutms -1 for blocking >=0 to block only for x ms. Default: nonblocking
@@ -54,10 +72,30 @@ public:
 
 	virtual _i64 getRealTransferredBytes();
 
+	/**
+	* Adapt the compression level between min_level and max_level (may be negative)
+	* depending on whether compressing or sending is slower. Level changes and
+	* enabling compression worker threads (for large streams) happen at zstd frame boundaries.
+	*/
+	void setAdaptiveLevel(int min_level, int max_level);
+
+	int getCompressionLevel();
+
+	static void init_mutex();
+
+	//Statistics of all zstd compressed pipes since start
+	static SZstdPipeStats getGlobalStats();
+
 private:
+	size_t ReadInt(char *buffer, size_t bsize, int timeoutms);
+	bool WriteInt(const char *buffer, size_t bsize, int timeoutms, bool flush, int64 starttime);
 	size_t ProcessToBuffer(char *buffer, size_t bsize, bool fromLast);
 	void ProcessToString(std::string* ret, bool fromLast);
 
+	void adaptLevel();
+	bool applyPendingParameters();
+	void addGlobalStats(bool write_side, bool force);
+
 	IPipe *cs;
 	std::vector<char> comp_buffer;
 	std::vector<char> input_buffer;
@@ -77,6 +115,24 @@ private:
 
 	std::auto_ptr<IMutex> read_mutex;
 	std::auto_ptr<IMutex> write_mutex;
+
+	int compression_level;
+	bool adaptive;
+	int adaptive_min_level;
+	int adaptive_max_level;
+	int pending_level;
+	int threads;
+	bool pending_workers;
+	bool workers_enabled;
+	bool end_frame;
+	int64 window_bytes;
+	int64 window_compress_us;
+	int64 window_send_us;
+
+	SZstdPipeStats local_stats;
+
+	static IMutex* stats_mutex;
+	static SZstdPipeStats global_stats;
 };
 
 #endif //NO_ZSTD_COMPRESSION
\ No newline at end of file
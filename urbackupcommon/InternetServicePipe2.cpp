@@ -23,6 +23,13 @@
 
 extern ICryptoFactory *crypto_fak;
 
+//Maximum amount of data in one encrypted record (with one authentication tag)
+const size_t record_max_size=128*1024;
+//End the current record after this time, even if nobody flushes
+const int64 record_max_latency_ms=200;
+//Collect this much encrypted data before passing it on, unless the record ends
+const size_t send_batch_size=64*1024;
+
 InternetServicePipe2::InternetServicePipe2()
 	: read_mutex(Server->createMutex()), write_mutex(Server->createMutex())
 {
@@ -49,6 +56,7 @@ void InternetServicePipe2::init( IPipe *pcs, const std::string &key )
 	destroy_cs=false;
 	has_error=false;
 	curr_write_chunk_size=0;
+	unsent_size=0;
 	last_flush_time=Server->getTimeMS();
 
 	enc.reset(crypto_fak->createAESGCMEncryption(key));
@@ -56,9 +64,31 @@ void InternetServicePipe2::init( IPipe *pcs, const std::string &key )
 }
 
 size_t InternetServicePipe2::Read( char *buffer, size_t bsize, int timeoutms/*=-1 */ )
+{
+	IScopedLock lock(read_mutex.get());
+	return ReadInt(buffer, bsize, timeoutms);
+}
+
+size_t InternetServicePipe2::ReadInto( char *buffer, size_t bsize, size_t min_size, int timeoutms/*=-1 */ )
 {
 	IScopedLock lock(read_mutex.get());
 
+	size_t read = 0;
+	do
+	{
+		size_t rc = ReadInt(buffer + read, bsize - read, timeoutms);
+		if (rc == 0)
+		{
+			break;
+		}
+		read += rc;
+	} while (read < min_size && read < bsize);
+
+	return read;
+}
+
+size_t InternetServicePipe2::ReadInt( char *buffer, size_t bsize, int timeoutms )
+{
 	size_t data_size = bsize;
 	if(!dec->get(buffer, data_size))
 	{
@@ -181,22 +211,54 @@ bool InternetServicePipe2::Write( const char *buffer, size_t bsize, int timeoutm
 	if(buffer!=NULL)
 	{
 		curr_write_chunk_size+=bsize;
+		unsent_size+=bsize;
 		enc->put(buffer, bsize);
 	}
 
-	if( (flush || curr_write_chunk_size>128*1024 || (Server->getTimeMS()-last_flush_time)>200)
+	return sendEncrypted(timeoutms, flush);
+}
+
+bool InternetServicePipe2::Writev( const SPipeBuffer* bufs, size_t n_bufs, int timeoutms/*=-1*/, bool flush/*=true */ )
+{
+	IScopedLock lock(write_mutex.get());
+
+	for(size_t i=0;i<n_bufs;++i)
+	{
+		if(bufs[i].bsize>0)
+		{
+			curr_write_chunk_size+=bufs[i].bsize;
+			unsent_size+=bufs[i].bsize;
+			enc->put(bufs[i].buf, bufs[i].bsize);
+		}
+	}
+
+	return sendEncrypted(timeoutms, flush);
+}
+
+bool InternetServicePipe2::sendEncrypted( int timeoutms, bool flush )
+{
+	bool record_end=false;
+	if( (flush || curr_write_chunk_size>record_max_size || (Server->getTimeMS()-last_flush_time)>record_max_latency_ms)
 		&& curr_write_chunk_size>0 )
 	{
 		enc->flush();
 		curr_write_chunk_size=0;
 		last_flush_time=Server->getTimeMS();
+		record_end=true;
+	}
+
+	if(!flush && !record_end
+		&& unsent_size<send_batch_size)
+	{
+		return true;
 	}
 
-	std::string tosend = enc->get();
+	unsent_size=0;
+	enc->get(send_buffer);
 
-	if(!tosend.empty())
+	if(!send_buffer.empty())
 	{
-		return cs->Write(tosend, timeoutms, flush);
+		return cs->Write(send_buffer, timeoutms, flush);
 	}
 	else
 	{
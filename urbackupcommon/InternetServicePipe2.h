@@ -39,6 +39,10 @@ public:
 
 	virtual bool Write( const std::string &str, int timeoutms=-1, bool flush=true );
 
+	virtual bool Writev( const SPipeBuffer* bufs, size_t n_bufs, int timeoutms=-1, bool flush=true );
+
+	virtual size_t ReadInto( char *buffer, size_t bsize, size_t min_size, int timeoutms=-1 );
+
 	virtual bool Flush(int timeoutms=-1);
 
 	virtual bool isWritable( int timeoutms=0 );
@@ -73,6 +77,9 @@ public:
 	int64 getEncryptionOverheadBytes();
 
 private:
+	size_t ReadInt( char *buffer, size_t bsize, int timeoutms );
+	bool sendEncrypted( int timeoutms, bool flush );
+
 	std::auto_ptr<IAESGCMDecryption> dec;
 	std::auto_ptr<IAESGCMEncryption> enc;
 
@@ -81,6 +88,8 @@ private:
 	bool has_error;
 
 	size_t curr_write_chunk_size;
+	size_t unsent_size;
+	std::string send_buffer;
 	int64 last_flush_time;
 
 	std::auto_ptr<IMutex> read_mutex;
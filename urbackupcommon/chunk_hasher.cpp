@@ -121,6 +121,8 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 
 	_i64 n_chunks=c_checkpoint_dist/c_small_hash_dist;
 	char buf[c_small_hash_dist];
+	std::vector<char> checkpoint_buf(c_checkpoint_dist);
+	unsigned int small_hashes[c_checkpoint_dist/c_small_hash_dist];
 	char copy_buf[c_small_hash_dist];
 	_i64 copy_write_pos=0;
 	bool copy_read_eof=false;
@@ -369,10 +371,14 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 		_u32 buf_read = 0;
 		bool all_zeros = true;
 		_i64 start_pos = pos;
-		for(;pos<epos && pos<fsize;pos+=c_small_hash_dist,++chunkidx)
+
+		//Read the whole checkpoint at once and compute all small hashes in one go
+		_u32 checkpoint_toread = static_cast<_u32>((std::min)(epos, fsize) - pos);
+		_u32 checkpoint_read = 0;
+		while (checkpoint_read < checkpoint_toread)
 		{
 			bool has_read_error = false;
-			_u32 r=f->Read(buf, c_small_hash_dist, &has_read_error);
+			_u32 r = f->Read(checkpoint_buf.data() + checkpoint_read, checkpoint_toread - checkpoint_read, &has_read_error);
 
 			if (has_read_error)
 			{
@@ -380,19 +386,39 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 				return false;
 			}
 
-			if (treehash!=NULL && !buf_is_zero(buf, r))
+			if (r == 0)
+			{
+				break;
+			}
+
+			checkpoint_read += r;
+		}
+
+		urb_adler32_blocks(checkpoint_buf.data(), checkpoint_read, c_small_hash_dist, small_hashes);
+
+		for(;pos<epos && pos<fsize;pos+=c_small_hash_dist,++chunkidx)
+		{
+			_u32 chunk_offset = static_cast<_u32>(pos - start_pos);
+			const char* chunk_buf = checkpoint_buf.data() + chunk_offset;
+			_u32 r = 0;
+			if (chunk_offset < checkpoint_read)
+			{
+				r = (std::min)(static_cast<_u32>(c_small_hash_dist), checkpoint_read - chunk_offset);
+			}
+
+			if (treehash!=NULL && !buf_is_zero(chunk_buf, r))
 			{
 				all_zeros = false;
 			}
 
-			*reinterpret_cast<unsigned int*>(&new_chunk.small_hash[chunkidx*small_hash_size]) = urb_adler32(urb_adler32(0, NULL, 0), buf, r);
-			big_hash.update((unsigned char*)buf, r);
+			*reinterpret_cast<unsigned int*>(&new_chunk.small_hash[chunkidx*small_hash_size]) = r > 0 ? small_hashes[chunkidx] : urb_adler32(0, NULL, 0);
+			big_hash.update((unsigned char*)chunk_buf, r);
 			buf_read += r;
 
 			if(hashf!=NULL && treehash==NULL)
 			{
 				int64 buf_offset = pos%sha_buf.size();
-				memcpy(sha_buf.data() + buf_offset, buf, r);
+				memcpy(sha_buf.data() + buf_offset, chunk_buf, r);
 			}
 			if(copy!=NULL)
 			{
@@ -402,7 +428,7 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 					{
 						if(memcmp(&new_chunk.small_hash[chunkidx*small_hash_size], &chunk_hashes->small_hash[chunkidx*small_hash_size], small_hash_size)==0)
 						{
-							big_hash_copy_control.update((unsigned char*)buf, r);
+							big_hash_copy_control.update((unsigned char*)chunk_buf, r);
 						}
 						else
 						{
@@ -419,7 +445,7 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 
 							//write new data
 							copy->Seek(copy_write_pos);
-							if (!writeRepeatFreeSpace(copy, buf, r, cb))
+							if (!writeRepeatFreeSpace(copy, chunk_buf, r, cb))
 							{
 								Server->Log("Error writing to copy file (" + copy->getFilename() + ") -2", LL_DEBUG);
 								return false;
@@ -451,10 +477,10 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 							}
 						}
 
-						if(copy_read_eof || copy_r!=r || memcmp(copy_buf, buf, r)!=0)
+						if(copy_read_eof || copy_r!=r || memcmp(copy_buf, chunk_buf, r)!=0)
 						{
 							copy->Seek(copy_write_pos);
-							if (!writeRepeatFreeSpace(copy, buf, r, cb))
+							if (!writeRepeatFreeSpace(copy, chunk_buf, r, cb))
 							{
 								Server->Log("Error writing to copy file (" + copy->getFilename() + ") -3", LL_DEBUG);
 								return false;
@@ -472,7 +498,7 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 				}
 				else
 				{
-					if (!writeRepeatFreeSpace(copy, buf, r, cb))
+					if (!writeRepeatFreeSpace(copy, chunk_buf, r, cb))
 					{
 						Server->Log("Error writing to copy file (" + copy->getFilename() + ") -4", LL_DEBUG);
 						return false;
@@ -57,6 +57,9 @@ namespace
 
 	const size_t maxQueuedFiles = 3000;
 	const size_t queuedFilesLow = 100;
+	const int64 bundleMaxFilesize = 64 * 1024;
+	const size_t bundleMaxFiles = 256;
+	const int64 bundleMaxBytes = 4 * 1024 * 1024;
 	const char* multicast_group = "ff12::f894:d:dd00:ef91";
 }
 
@@ -100,7 +103,7 @@ FileClient::FileClient(bool enable_find_servers, std::string identity, int proto
 	identity(identity), received_data_bytes(0), queue_callback(NULL), dl_off(0),
 	last_transferred_bytes(0), last_progress_log(0), progress_log_callback(NULL), needs_flush(false),
 	real_transferred_bytes(0), is_downloading(false), sparse_extends_f(NULL), sparse_bytes(0),
-	reconnect_tries(50)
+	reconnect_tries(50), bundle_small_files(false)
 {
 	memset(buffer, 0, BUFFERSIZE_UDP);
 
@@ -1108,7 +1111,20 @@ bool FileClient::Reconnect(void)
 					|| (dl_buf[0] == ID_FILESIZE_AND_EXTENTS && dl_off<1 + 2*sizeof(_u64)) )
 			) )
 		{
-			rc = tcpsock->Read(&dl_buf[dl_off], BUFFERSIZE-dl_off, 120000);
+			if (!firstpacket
+				&& !is_script
+				&& dl_off == 0
+				&& state == EReceiveState_Data
+				&& next_checkpoint > received)
+			{
+				//Only file data until the next checkpoint. Fill the buffer before writing it
+				size_t min_size = static_cast<size_t>((std::min)(next_checkpoint - received, static_cast<_u64>(BUFFERSIZE)));
+				rc = tcpsock->ReadInto(dl_buf, BUFFERSIZE, min_size, 120000);
+			}
+			else
+			{
+				rc = tcpsock->Read(&dl_buf[dl_off], BUFFERSIZE-dl_off, 120000);
+			}
 
 			if (rc != 0)
 			{
@@ -1752,6 +1768,11 @@ void FileClient::setQueueCallback( QueueCallback* cb )
 	queue_callback = cb;
 }
 
+void FileClient::setBundleSmallFiles( bool b )
+{
+	bundle_small_files = b;
+}
+
 _u32 FileClient::fillQueue()
 {
 	if(queue_callback==NULL)
@@ -1779,39 +1800,62 @@ _u32 FileClient::fillQueue()
 	bool needs_send_flush=false;
 
 	std::vector<SQueueItem> queued_files;
+	std::vector<SBundleItem> bundle_files;
+	int64 bundle_bytes = 0;
 	int64 queue_starttime = Server->getTimeMS();
 
-	while(queued.size()<maxQueuedFiles
+	while(queued.size()+bundle_files.size()<maxQueuedFiles
 		&& Server->getTimeMS()-queue_starttime<10000)
 	{
 		if(!tcpsock->isWritable())
 		{
-			if (needs_flush)
-			{
-				needs_flush = false;
-				return Flush();
-			}
-
-			return ERR_SUCCESS;
+			break;
 		}
 
 		MetadataQueue metadata_queue = MetadataQueue_Data;
 		size_t folder_items = 0;
 		bool finish_script=false;
 		int64 file_id;
-		std::string queue_fn = queue_callback->getQueuedFileFull(metadata_queue, folder_items, finish_script, file_id);
+		int64 predicted_filesize = -1;
+		std::string queue_fn = queue_callback->getQueuedFileFull(metadata_queue, folder_items, finish_script, file_id, predicted_filesize);
 
 		if(queue_fn.empty())
 		{
-			if(needs_flush)
+			break;
+		}
+
+		if(bundle_small_files
+			&& metadata_queue==MetadataQueue_Data
+			&& file_id!=0
+			&& !finish_script
+			&& predicted_filesize>=0
+			&& predicted_filesize<=bundleMaxFilesize)
+		{
+			bundle_files.push_back(SBundleItem(queue_fn, file_id));
+			bundle_bytes+=predicted_filesize;
+
+			if(bundle_files.size()>=bundleMaxFiles
+				|| bundle_bytes>=bundleMaxBytes)
 			{
-				needs_flush=false;
-				needs_send_flush=false;
-				return Flush();
+				_u32 rc = sendFileBundle(bundle_files, queued_files);
+				if(rc!=ERR_SUCCESS)
+				{
+					return rc;
+				}
+				bundle_bytes=0;
+				needs_send_flush=true;
 			}
+			continue;
+		}
 
-			return ERR_SUCCESS;
+		//Keeps the order of the responses the same as the order of the queue
+		_u32 rc = sendFileBundle(bundle_files, queued_files);
+		if(rc!=ERR_SUCCESS)
+		{
+			queue_callback->unqueueFileFull(queue_fn, finish_script);
+			return rc;
 		}
+		bundle_bytes=0;
 
 		CWData data;
 		if(metadata_queue==MetadataQueue_Data)
@@ -1870,6 +1914,16 @@ _u32 FileClient::fillQueue()
 		needs_flush=true;
 	}
 
+	if(!bundle_files.empty())
+	{
+		_u32 rc = sendFileBundle(bundle_files, queued_files);
+		if(rc!=ERR_SUCCESS)
+		{
+			return rc;
+		}
+		needs_send_flush=true;
+	}
+
 	if (needs_flush)
 	{
 		needs_flush = false;
@@ -1891,6 +1945,56 @@ _u32 FileClient::fillQueue()
 	return ERR_SUCCESS;
 }
 
+_u32 FileClient::sendFileBundle(std::vector<SBundleItem>& bundle_files, std::vector<SQueueItem>& queued_files)
+{
+	if(bundle_files.empty())
+	{
+		return ERR_SUCCESS;
+	}
+
+	CWData data;
+	data.addUChar(ID_GET_FILE_BUNDLE);
+	data.addString(identity);
+	data.addChar(0);
+	data.addChar(protocol_version>1);
+
+	for(size_t i=0;i<bundle_files.size();++i)
+	{
+		data.addString(bundle_files[i].fn);
+		data.addVarInt(bundle_files[i].file_id);
+	}
+
+	if(stack.Send( tcpsock, data.getDataPtr(), data.getDataSize(), c_default_timeout, false)!=data.getDataSize())
+	{
+		Server->Log("Queueing file bundle failed", LL_DEBUG);
+
+		for (size_t i = 0; i<queued_files.size(); ++i)
+		{
+			queue_callback->unqueueFileFull(queued_files[i].fn, queued_files[i].finish_script);
+		}
+
+		for (size_t i = 0; i<bundle_files.size(); ++i)
+		{
+			queue_callback->unqueueFileFull(bundle_files[i].fn, false);
+		}
+
+		bundle_files.clear();
+
+		return ERR_TIMEOUT;
+	}
+
+	for(size_t i=0;i<bundle_files.size();++i)
+	{
+		queued.push_back(SQueueItem(bundle_files[i].fn, false));
+		queued_files.push_back(SQueueItem(bundle_files[i].fn, false));
+	}
+
+	bundle_files.clear();
+	needs_flush=true;
+
+	return ERR_SUCCESS;
+}
+
 void FileClient::logProgress(const std::string& remotefn, _u64 filesize, _u64 received)
 {
 	int64 ct = Server->getTimeMS();
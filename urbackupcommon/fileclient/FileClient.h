@@ -61,7 +61,7 @@ public:
 		class QueueCallback
 		{
 		public:
-			virtual std::string getQueuedFileFull(MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id) = 0;
+			virtual std::string getQueuedFileFull(MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id, int64& predicted_filesize) = 0;
 			virtual void unqueueFileFull(const std::string& fn, bool finish_script) = 0;
 			virtual void resetQueueFull() = 0;
 		};
@@ -70,6 +70,7 @@ public:
 		{
 		public:
 			virtual void log_progress(const std::string& fn, int64 total, int64 downloaded, int64 speed_bps) = 0;
+			virtual void log_chunk_window(const std::string& fn, unsigned int window, unsigned int in_flight, int64 min_rtt_ms) {}
 		};
 
 
@@ -162,6 +163,10 @@ public:
 
 		void setQueueCallback(FileClient::QueueCallback* cb);
 
+		//Requests queued small files with a known size in bundles
+		//(ID_GET_FILE_BUNDLE) instead of one request per file
+		void setBundleSmallFiles(bool b);
+
 		void setProgressLogCallback(FileClient::ProgressLogCallback* cb);
 
 		FileClient::ProgressLogCallback* getProgressLogCallback();
@@ -275,6 +280,20 @@ private:
 
 		std::deque<SQueueItem> queued;
 
+		struct SBundleItem
+		{
+			SBundleItem(std::string fn, int64 file_id)
+				: fn(fn), file_id(file_id)
+			{
+
+			}
+
+			std::string fn;
+			int64 file_id;
+		};
+
+		_u32 sendFileBundle(std::vector<SBundleItem>& bundle_files, std::vector<SQueueItem>& queued_files);
+
 		char dl_buf[BUFFERSIZE];
 		size_t dl_off;
 
@@ -291,6 +310,8 @@ private:
 		_i64 sparse_bytes;
 
 		int reconnect_tries;
+
+		bool bundle_small_files;
 };
 
 const _u32 ERR_CONTINUE=0;
@@ -63,13 +63,14 @@ int64 get_hashdata_size(int64 hashfilesize)
 FileClientChunked::FileClientChunked(IPipe *pipe, bool del_pipe, CTCPStack *stack,
 	FileClientChunked::ReconnectionCallback *reconnection_callback, FileClientChunked::NoFreeSpaceCallback *nofreespace_callback
 	, std::string identity, FileClientChunked* prev)
-	: pipe(pipe), destroy_pipe(del_pipe), stack(stack), transferred_bytes(0), reconnection_callback(reconnection_callback),
+	: pipe(pipe), destroy_pipe(del_pipe), stack(stack), allow_copy_chunks(false), transferred_bytes(0), reconnection_callback(reconnection_callback),
 	  nofreespace_callback(nofreespace_callback), reconnection_timeout(300000), identity(identity), received_data_bytes(0),
 	  parent(prev), queue_only(false), queue_callback(NULL), remote_filesize(-1), ofb_pipe(NULL), hashfilesize(-1), did_queue_fc(false), queued_chunks(0),
 	  last_transferred_bytes(0), last_progress_log(0), progress_log_callback(NULL), reconnected(false), needs_flush(false),
 	  real_transferred_bytes(0), queue_next(false), sparse_bytes(0)
 {
 	has_error=false;
+	resetChunkWindow();
 	if(parent==NULL)
 	{
 		mutex = Server->createMutex();
@@ -81,11 +82,12 @@ FileClientChunked::FileClientChunked(IPipe *pipe, bool del_pipe, CTCPStack *stac
 }
 
 FileClientChunked::FileClientChunked(void)
-	: pipe(NULL), stack(NULL), destroy_pipe(false), transferred_bytes(0), reconnection_callback(NULL), reconnection_timeout(300000), received_data_bytes(0),
+	: pipe(NULL), stack(NULL), allow_copy_chunks(false), destroy_pipe(false), transferred_bytes(0), reconnection_callback(NULL), reconnection_timeout(300000), received_data_bytes(0),
 	  parent(NULL), remote_filesize(-1), ofb_pipe(NULL), hashfilesize(-1), did_queue_fc(false), queued_chunks(0), last_transferred_bytes(0), last_progress_log(0),
 	  progress_log_callback(NULL), reconnected(false), real_transferred_bytes(0), queue_next(false), sparse_bytes(0)
 {
 	has_error=true;
+	resetChunkWindow();
 	mutex=NULL;
 }
 
@@ -293,18 +295,21 @@ _u32 FileClientChunked::GetFile(std::string remotefn, _i64& filesize_out, int64
 		num_total_chunks=0;
 	}
 
-	size_t queued_chunks_low = c_queued_chunks_low;
-
-	if(queue_only)
-	{
-		queued_chunks_low = c_max_queued_chunks;
-	}
-
 	do
 	{
+		//The window is shared with the queued next files (queued_fcs), which fill it
+		//completely, while the current file refills once it drained by a quarter
+		unsigned int chunk_window = chunkWindow();
+		unsigned int queued_chunks_low = chunk_window - chunk_window/4;
+
+		if(queue_only)
+		{
+			queued_chunks_low = chunk_window;
+		}
+
 		if(queuedChunks()<queued_chunks_low && remote_filesize!=-1 && next_chunk<num_total_chunks)
 		{		
-			while(queuedChunks()<c_max_queued_chunks && next_chunk<num_total_chunks)
+			while(queuedChunks()<chunk_window && next_chunk<num_total_chunks)
 			{
 				if(!getPipe()->isWritable())
 				{
@@ -356,7 +361,7 @@ _u32 FileClientChunked::GetFile(std::string remotefn, _i64& filesize_out, int64
 				{					
 					buf[0]=ID_BLOCK_REQUEST;
 					*((_i64*)(buf+1))=little_endian(next_chunk*c_checkpoint_dist);
-					buf[1+sizeof(_i64)]=0;
+					buf[1+sizeof(_i64)]=(patch_mode && allow_copy_chunks) ? c_block_request_copy : 0;
 					_u32 r=m_chunkhashes->Read(&buf[2*sizeof(char)+sizeof(_i64)], chunkhash_single_size);
 					if(r==0)
 					{
@@ -371,7 +376,9 @@ _u32 FileClientChunked::GetFile(std::string remotefn, _i64& filesize_out, int64
 						char *sptr=&buf[2*sizeof(char)+sizeof(_i64)];
 						SChunkHashes chhash;
 						memcpy(chhash.big_hash, sptr, big_hash_size);
-						memcpy(chhash.small_hash, sptr+big_hash_size, chunkhash_single_size-big_hash_size);					
+						memcpy(chhash.small_hash, sptr+big_hash_size, chunkhash_single_size-big_hash_size);
+						chhash.request_time = Server->getTimeMS();
+						chhash.queued_ahead = queuedChunks();
 						pending_chunks.insert(std::pair<_i64, SChunkHashes>(next_chunk*c_checkpoint_dist, chhash));
 					}					
 				}
@@ -387,7 +394,10 @@ _u32 FileClientChunked::GetFile(std::string remotefn, _i64& filesize_out, int64
 					buf[1 + sizeof(_i64)] = 1;
 					buf_size = sizeof(char) * 2 + sizeof(_i64);
 
-					pending_chunks.insert(std::pair<_i64, SChunkHashes>(next_chunk*c_checkpoint_dist, SChunkHashes() ));
+					SChunkHashes chhash = SChunkHashes();
+					chhash.request_time = Server->getTimeMS();
+					chhash.queued_ahead = queuedChunks();
+					pending_chunks.insert(std::pair<_i64, SChunkHashes>(next_chunk*c_checkpoint_dist, chhash));
 				}
 
 				if (stack->Send(getPipe(), buf, buf_size, c_default_timeout, false) != buf_size)
@@ -482,6 +492,7 @@ _u32 FileClientChunked::GetFile(std::string remotefn, _i64& filesize_out, int64
 
 						next->setQueueCallback(queue_callback);
 						next->setProgressLogCallback(progress_log_callback);
+						next->setAllowCopyChunks(allow_copy_chunks);
 
 						next->setQueueOnly(true);
 
@@ -783,6 +794,7 @@ void FileClientChunked::State_First(void)
 	case ID_COULDNT_OPEN: need_bytes=0; break;
 	case ID_WHOLE_BLOCK: need_bytes=sizeof(_i64)+sizeof(_u32); break;
 	case ID_UPDATE_CHUNK: need_bytes=sizeof(_i64)+sizeof(_u32); break;
+	case ID_COPY_CHUNK: need_bytes=2*sizeof(_i64)+sizeof(_u32); break;
 	case ID_NO_CHANGE: need_bytes=sizeof(_i64); break;
 	case ID_BLOCK_HASH: need_bytes=sizeof(_i64)+big_hash_size; break;
 	case ID_BLOCK_ERROR: need_bytes=sizeof(_u32)*2; break;
@@ -1059,48 +1071,14 @@ void FileClientChunked::State_Acc(bool ignore_filesize, bool allow_reconnect, IF
 			{
 				_i64 new_chunk_start;
 				msg.getInt64(&new_chunk_start);
-				bool new_block;
-				Hash_upto(new_chunk_start, new_block);
 				msg.getUInt(&adler_remaining);
 
-				VLOG(Server->Log("FileClientChunked: Chunk start="+convert(chunk_start)+" remaining="+convert(adler_remaining), LL_DEBUG));
-
-				file_pos=chunk_start;
-				_i64 block=chunk_start/c_checkpoint_dist;
-
-				std::map<_i64, SChunkHashes>::iterator it=pending_chunks.find(block*c_checkpoint_dist);
-				if(it==pending_chunks.end())
+				if(!Chunk_start(new_chunk_start))
 				{
-					Server->Log("Chunk not requested. ("+convert(block*c_checkpoint_dist)+")", LL_ERROR);
-					logPendingChunks();
-					assert(false);
-					retval=ERR_ERROR;
-					getfile_done=true;
 					return;
 				}
-				else if(new_block && m_hashoutput!=NULL)
-				{
-					m_hashoutput->Seek(chunkhash_file_off+(chunk_start/c_checkpoint_dist)*chunkhash_single_size);
-					_i64 block_start = block*c_checkpoint_dist;
-					if(block_start+c_checkpoint_dist>remote_filesize)
-					{
-						size_t missing_chunks = static_cast<size_t>((block_start + c_checkpoint_dist - remote_filesize)/c_chunk_size);
-						writeFileRepeat(m_hashoutput, it->second.big_hash, chunkhash_single_size - missing_chunks*small_hash_size);
-					}
-					else
-					{
-						writeFileRepeat(m_hashoutput, it->second.big_hash, chunkhash_single_size);
-					}
-				}
 
-				m_file->Seek(chunk_start);
-				
-				unsigned int chunknum=(chunk_start%c_checkpoint_dist)/c_chunk_size;
-				if(m_hashoutput!=NULL)
-				{
-					m_hashoutput->Seek(chunkhash_file_off+block*chunkhash_single_size
-						+big_hash_size+chunknum*small_hash_size);
-				}				
+				VLOG(Server->Log("FileClientChunked: Chunk start="+convert(chunk_start)+" remaining="+convert(adler_remaining), LL_DEBUG));
 
 				if (adler_remaining > 0)
 				{
@@ -1113,6 +1091,35 @@ void FileClientChunked::State_Acc(bool ignore_filesize, bool allow_reconnect, IF
 				adler_hash=urb_adler32(0, NULL, 0);
 
 			}break;
+		case ID_COPY_CHUNK:
+			{
+				_i64 new_chunk_start;
+				msg.getInt64(&new_chunk_start);
+				_i64 src_pos;
+				msg.getInt64(&src_pos);
+				unsigned int copy_size;
+				msg.getUInt(&copy_size);
+
+				if(!patch_mode || !allow_copy_chunks
+					|| copy_size==0 || copy_size>c_chunk_size
+					|| src_pos<0)
+				{
+					Server->Log("Unexpected copy chunk start="+convert(new_chunk_start)+" src="+convert(src_pos)+" size="+convert(copy_size), LL_ERROR);
+					retval=ERR_ERROR;
+					getfile_done=true;
+					return;
+				}
+
+				if(!Chunk_start(new_chunk_start))
+				{
+					return;
+				}
+
+				VLOG(Server->Log("FileClientChunked: Copy chunk start="+convert(chunk_start)+" src="+convert(src_pos)+" size="+convert(copy_size), LL_DEBUG));
+
+				Chunk_copy(src_pos, copy_size);
+				state = CS_ID_FIRST;
+			}break;
 		case ID_NO_CHANGE:
 			{
 				_i64 block_start;
@@ -1333,8 +1340,10 @@ void FileClientChunked::Hash_finalize(_i64 curr_pos, const char *hash_from_clien
 		if(it!=pending_chunks.end())
 		{
 			addReceivedBlock(curr_pos);
+			int64 request_time = it->second.request_time;
+			unsigned int queued_ahead = it->second.queued_ahead;
 			pending_chunks.erase(it);
-			decrQueuedChunks();
+			decrQueuedChunks(request_time, queued_ahead);
 		}
 		else
 		{
@@ -1376,8 +1385,10 @@ void FileClientChunked::Hash_nochange(_i64 curr_pos)
 			}
 			curr_output_fsize = (std::max)(curr_output_fsize, remote_filesize);
 		}
+		int64 request_time = it->second.request_time;
+		unsigned int queued_ahead = it->second.queued_ahead;
 		pending_chunks.erase(it);
-		decrQueuedChunks();
+		decrQueuedChunks(request_time, queued_ahead);
 	}
 	else
 	{
@@ -1515,6 +1526,87 @@ void FileClientChunked::State_Chunk(void)
 	}
 }
 
+bool FileClientChunked::Chunk_start(_i64 new_chunk_start)
+{
+	bool new_block;
+	Hash_upto(new_chunk_start, new_block);
+
+	file_pos=chunk_start;
+	_i64 block=chunk_start/c_checkpoint_dist;
+
+	std::map<_i64, SChunkHashes>::iterator it=pending_chunks.find(block*c_checkpoint_dist);
+	if(it==pending_chunks.end())
+	{
+		Server->Log("Chunk not requested. ("+convert(block*c_checkpoint_dist)+")", LL_ERROR);
+		logPendingChunks();
+		assert(false);
+		retval=ERR_ERROR;
+		getfile_done=true;
+		return false;
+	}
+	else if(new_block && m_hashoutput!=NULL)
+	{
+		m_hashoutput->Seek(chunkhash_file_off+(chunk_start/c_checkpoint_dist)*chunkhash_single_size);
+		_i64 block_start = block*c_checkpoint_dist;
+		if(block_start+c_checkpoint_dist>remote_filesize)
+		{
+			size_t missing_chunks = static_cast<size_t>((block_start + c_checkpoint_dist - remote_filesize)/c_chunk_size);
+			writeFileRepeat(m_hashoutput, it->second.big_hash, chunkhash_single_size - missing_chunks*small_hash_size);
+		}
+		else
+		{
+			writeFileRepeat(m_hashoutput, it->second.big_hash, chunkhash_single_size);
+		}
+	}
+
+	m_file->Seek(chunk_start);
+
+	unsigned int chunknum=(chunk_start%c_checkpoint_dist)/c_chunk_size;
+	if(m_hashoutput!=NULL)
+	{
+		m_hashoutput->Seek(chunkhash_file_off+block*chunkhash_single_size
+			+big_hash_size+chunknum*small_hash_size);
+	}
+
+	return true;
+}
+
+void FileClientChunked::Chunk_copy(_i64 src_pos, unsigned int size)
+{
+	//The data is in the original file already. Only the block hash and
+	//the new chunk hash have to be computed from it.
+	char buf[c_chunk_size];
+	bool has_read_error = false;
+	_u32 r = m_file->Read(src_pos, buf, size, &has_read_error);
+
+	if(r<size)
+	{
+		Server->Log("Error reading copy chunk source at position "+convert(src_pos)+" size="+convert(size)+" read="+convert(r)+". This will cause the whole block to be loaded. "+os_last_error_str(), LL_WARNING);
+		memset(buf+r, 0, size-r);
+	}
+
+	adler_hash=urb_adler32(urb_adler32(0, NULL, 0), buf, size);
+	md5_hash.update((unsigned char*)buf, size);
+
+	if(r<size)
+	{
+		writePatch(file_pos, size, buf, true);
+	}
+	else
+	{
+		writePatchCopy(file_pos, size, src_pos);
+	}
+
+	file_pos+=size;
+	chunk_start+=size;
+
+	_u32 endian_adler_hash = little_endian(adler_hash);
+	if(m_hashoutput!=NULL)
+	{
+		writeFileRepeat(m_hashoutput, (char*)&endian_adler_hash, small_hash_size);
+	}
+}
+
 void FileClientChunked::State_SparseExtents(IFile** sparse_extents_f)
 {
 	if (whole_block_remaining > big_hash_size)
@@ -1624,6 +1716,32 @@ void FileClientChunked::writePatchInt(_i64 pos, unsigned int length, char *buf)
 	curr_output_fsize = (std::max)(curr_output_fsize, pos + length);
 }
 
+void FileClientChunked::writePatchCopy(_i64 pos, unsigned int length, _i64 src_pos)
+{
+	if(patch_buf_pos>0)
+	{
+		writePatchInt(patch_buf_start, patch_buf_pos, patch_buf);
+		patch_buf_pos=0;
+	}
+
+	const unsigned int plen=sizeof(_i64)+sizeof(unsigned int)+sizeof(_i64);
+	char pd[plen];
+	_i64 pos_tmp = little_endian(pos);
+	memcpy(pd, &pos_tmp, sizeof(_i64));
+	unsigned int length_tmp = little_endian(length | c_patch_copy_flag);
+	memcpy(pd+sizeof(_i64), &length_tmp, sizeof(unsigned int));
+	_i64 src_pos_tmp = little_endian(src_pos);
+	memcpy(pd+sizeof(_i64)+sizeof(unsigned int), &src_pos_tmp, sizeof(_i64));
+	writeFileRepeat(m_patchfile, pd, plen);
+	if (last_chunk_patches.empty())
+	{
+		last_patch_output_fsize = curr_output_fsize;
+	}
+	last_chunk_patches.push_back(patchfile_pos);
+	patchfile_pos+=plen;
+	curr_output_fsize = (std::max)(curr_output_fsize, pos + length);
+}
+
 void FileClientChunked::writePatchSize(_i64 remote_fs)
 {
 	m_patchfile->Seek(0);
@@ -1872,6 +1990,11 @@ void FileClientChunked::setQueueCallback( QueueCallback* cb )
 	queue_callback = cb;
 }
 
+void FileClientChunked::setAllowCopyChunks( bool b )
+{
+	allow_copy_chunks = b;
+}
+
 void FileClientChunked::setQueueOnly( bool b )
 {
 	queue_only = b;
@@ -1956,6 +2079,14 @@ bool FileClientChunked::constructOutOfBandPipe()
 
 void FileClientChunked::requestOfbChunk(_i64 chunk_pos)
 {
+	std::map<_i64, SChunkHashes>::iterator it=pending_chunks.find(chunk_pos);
+	if(it!=pending_chunks.end())
+	{
+		//Re-requested on another connection. Only the new request counts for the RTT
+		it->second.request_time = Server->getTimeMS();
+		it->second.queued_ahead = 0;
+	}
+
 	{
 		CWData data;
 		data.addUChar( ID_GET_FILE_BLOCKDIFF );
@@ -2124,15 +2255,20 @@ void FileClientChunked::incrQueuedChunks()
 	}
 }
 
-void FileClientChunked::decrQueuedChunks()
+void FileClientChunked::decrQueuedChunks(int64 request_time, unsigned int queued_ahead)
 {
 	if(parent)
 	{
-		return parent->decrQueuedChunks();
+		return parent->decrQueuedChunks(request_time, queued_ahead);
 	}
 	else
 	{
 		--queued_chunks;
+		//Chunks requested before a reconnect would give stale RTT samples
+		if(request_time>=chunk_window_reset_time)
+		{
+			updateChunkWindow(Server->getTimeMS()-request_time, queued_ahead);
+		}
 	}
 }
 
@@ -2145,9 +2281,118 @@ void FileClientChunked::resetQueuedChunks()
 	else
 	{
 		queued_chunks = 0;
+		resetChunkWindow();
+	}
+}
+
+unsigned int FileClientChunked::chunkWindow()
+{
+	if(parent)
+	{
+		return parent->chunkWindow();
+	}
+	else
+	{
+		return chunk_window;
 	}
 }
 
+void FileClientChunked::updateChunkWindow(int64 rtt, unsigned int queued_ahead)
+{
+	int64 ct = Server->getTimeMS();
+
+	//Chunk completion rate, sampled at least once per RTT
+	++chunk_rate_sample_chunks;
+	if(chunk_rate_sample_start==0)
+	{
+		chunk_rate_sample_start = ct;
+	}
+	else if(ct-chunk_rate_sample_start>=(std::max)(chunk_min_rtt, c_chunk_window_min_rate_interval))
+	{
+		double rate = static_cast<double>(chunk_rate_sample_chunks)/(ct-chunk_rate_sample_start);
+		if(chunk_rate<=0)
+		{
+			chunk_rate = rate;
+		}
+		else
+		{
+			chunk_rate = 0.75*chunk_rate + 0.25*rate;
+		}
+		chunk_rate_sample_start = ct;
+		chunk_rate_sample_chunks = 0;
+	}
+
+	if(chunk_rate<=0)
+	{
+		return;
+	}
+
+	//The chunks requested before this one had to be served first. Without
+	//removing that self-induced queueing delay the RTT would grow with the window
+	rtt -= static_cast<int64>(queued_ahead/chunk_rate);
+	rtt = (std::max)(rtt, static_cast<int64>(1));
+
+	//Minimum RTT over the current and the previous interval. Samples are
+	//never older than two intervals, so the estimate follows route changes
+	//without jumping to a single (possibly queued) sample on expiry
+	if(ct-chunk_min_rtt_time>c_chunk_window_rtt_expiry)
+	{
+		chunk_prev_min_rtt = chunk_min_rtt;
+		chunk_min_rtt = rtt;
+		chunk_min_rtt_time = ct;
+	}
+	else if(chunk_min_rtt<0 || rtt<chunk_min_rtt)
+	{
+		chunk_min_rtt = rtt;
+	}
+
+	int64 min_rtt = chunk_min_rtt;
+	if(chunk_prev_min_rtt>0 && chunk_prev_min_rtt<min_rtt)
+	{
+		min_rtt = chunk_prev_min_rtt;
+	}
+
+	double target = 2*chunk_rate*min_rtt;
+
+	//Grows by one per completed chunk (doubling per RTT) below the target,
+	//drains by one per completed chunk above it
+	if(chunk_window<target && chunk_window<c_max_queued_chunks)
+	{
+		++chunk_window;
+	}
+	else if(chunk_window>target+1 && chunk_window>c_min_chunk_window)
+	{
+		--chunk_window;
+	}
+}
+
+void FileClientChunked::resetChunkWindow()
+{
+	chunk_window = c_initial_chunk_window;
+	chunk_window_reset_time = Server->getTimeMS();
+	chunk_min_rtt = -1;
+	chunk_prev_min_rtt = -1;
+	chunk_min_rtt_time = chunk_window_reset_time;
+	chunk_rate = 0;
+	chunk_rate_sample_start = 0;
+	chunk_rate_sample_chunks = 0;
+}
+
+void FileClientChunked::logChunkWindow()
+{
+	FileClientChunked* root = this;
+	while(root->parent!=NULL) root = root->parent;
+
+	int64 min_rtt = root->chunk_min_rtt;
+	if(root->chunk_prev_min_rtt>0 && (min_rtt<0 || root->chunk_prev_min_rtt<min_rtt))
+	{
+		min_rtt = root->chunk_prev_min_rtt;
+	}
+
+	progress_log_callback->log_chunk_window(remote_filename, root->chunk_window,
+		root->queued_chunks, min_rtt);
+}
+
 IPipe* FileClientChunked::ofbPipe()
 {
 	if(parent)
@@ -2237,6 +2482,8 @@ void FileClientChunked::logTransferProgress()
 			{
 				progress_log_callback->log_progress(remote_filename,
 					remote_filesize, file_pos, speed_bps);
+
+				logChunkWindow();
 			}
 		}
 
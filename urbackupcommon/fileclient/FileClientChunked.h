@@ -16,6 +16,14 @@ class CTCPStack;
 
 const unsigned int c_max_queued_chunks=1000;
 const unsigned int c_queued_chunks_low=100;
+//Bounds of the adaptive chunk request window. It grows towards
+//two bandwidth-delay products (measured chunk rate times minimum RTT).
+//Starts at the old fixed queue size so the first round trips are never
+//slower than before; it drains towards the target once the rate is known
+const unsigned int c_min_chunk_window=16;
+const unsigned int c_initial_chunk_window=c_max_queued_chunks;
+const int64 c_chunk_window_rtt_expiry=10000;
+const int64 c_chunk_window_min_rate_interval=100;
 
 enum EChunkedState
 {
@@ -30,6 +38,8 @@ struct SChunkHashes
 {
 	char big_hash[big_hash_size];
 	char small_hash[small_hash_size*(c_checkpoint_dist/c_small_hash_dist)];
+	int64 request_time;
+	unsigned int queued_ahead;
 };
 
 int64 get_hashdata_size(int64 hashfilesize);
@@ -87,6 +97,8 @@ public:
 
 	void setProgressLogCallback(FileClient::ProgressLogCallback* cb);
 
+	void setAllowCopyChunks(bool b);
+
 	_u32 getErrorcode1();
 
 	_u32 getErrorcode2();
@@ -113,6 +125,9 @@ private:
 	void State_Chunk(void);
 	void State_SparseExtents(IFile** sparse_extents_f);
 
+	bool Chunk_start(_i64 new_chunk_start);
+	void Chunk_copy(_i64 src_pos, unsigned int size);
+
 	void Hash_finalize(_i64 curr_pos, const char *hash_from_client);
 	void Hash_upto(_i64 chunk_start, bool &new_block);
 	void Hash_nochange(_i64 curr_pos);
@@ -120,6 +135,7 @@ private:
 	void writeFileRepeat(IFile *f, const char *buf, size_t bsize);
 	void writePatch(_i64 pos, unsigned int length, char *buf, bool last);
 	void writePatchInt(_i64 pos, unsigned int length, char *buf);
+	void writePatchCopy(_i64 pos, unsigned int length, _i64 src_pos);
 	void writePatchSize(_i64 remote_fs);
 
 	void invalidateLastPatches(void);
@@ -144,8 +160,12 @@ private:
 
 	unsigned int queuedChunks();
 	void incrQueuedChunks();
-	void decrQueuedChunks();
+	void decrQueuedChunks(int64 request_time, unsigned int queued_ahead);
 	void resetQueuedChunks();
+	unsigned int chunkWindow();
+	void updateChunkWindow(int64 rtt, unsigned int queued_ahead);
+	void resetChunkWindow();
+	void logChunkWindow();
 
 	void addReceivedBytes(size_t bytes);
 
@@ -188,6 +208,7 @@ private:
 	std::vector<_i64> last_chunk_patches;
 	int64 last_patch_output_fsize;
 	bool patch_mode;
+	bool allow_copy_chunks;
 	char patch_buf[c_chunk_size];
 	unsigned int patch_buf_pos;
 	_i64 patch_buf_start;
@@ -200,6 +221,16 @@ private:
 	int64 starttime;
 	unsigned int queued_chunks;
 
+	//Adaptive chunk request window (root client only)
+	unsigned int chunk_window;
+	int64 chunk_window_reset_time;
+	int64 chunk_min_rtt;
+	int64 chunk_prev_min_rtt;
+	int64 chunk_min_rtt_time;
+	double chunk_rate;
+	int64 chunk_rate_sample_start;
+	unsigned int chunk_rate_sample_chunks;
+
 	EChunkedState state;
 	char curr_id;
 	unsigned int need_bytes;
@@ -285,4 +316,4 @@ private:
 	int reconnect_tries;
 };
 
-#endif //FILECLIENTCHUNKED_H
\ No newline at end of file
+#endif //FILECLIENTCHUNKED_H
\ No newline at end of file
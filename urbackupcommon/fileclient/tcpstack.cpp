@@ -63,52 +63,51 @@ size_t CTCPStack::Send(IPipe* p, char* buf, size_t msglen, int timeoutms, bool f
 		return 0;
 	}
 
-	char* buffer;
-	size_t msg_off=sizeof(MAX_PACKETSIZE);
+	char header[checksum_len+sizeof(MAX_PACKETSIZE)];
 	size_t len_off=0;
-	size_t packet_len=msglen+sizeof(MAX_PACKETSIZE);
-	if(!add_checksum)
-	{
-		buffer=new char[packet_len];
-	}
-	else
+	size_t header_len=sizeof(MAX_PACKETSIZE);
+	if(add_checksum)
 	{
-		packet_len=checksum_len+msglen+sizeof(MAX_PACKETSIZE);
-		buffer=new char[packet_len];
-		msg_off=checksum_len+sizeof(MAX_PACKETSIZE);
 		len_off=checksum_len;
+		header_len+=checksum_len;
 	}
 
 	MAX_PACKETSIZE len=little_endian((MAX_PACKETSIZE)msglen);
 
-	memcpy(&buffer[len_off], &len, sizeof(MAX_PACKETSIZE) );
-	if(msglen>0)
-	{
-	    memcpy(&buffer[msg_off], buf, msglen);
-	}
+	memcpy(&header[len_off], &len, sizeof(MAX_PACKETSIZE) );
 
 	if(add_checksum)
 	{
-		MD5 md((unsigned char*)&buffer[len_off], (unsigned int)msglen+sizeof(MAX_PACKETSIZE));
-		memcpy(buffer, md.raw_digest_int(), checksum_len);
+		MD5 md;
+		md.update((unsigned char*)&header[len_off], sizeof(MAX_PACKETSIZE));
+		if(msglen>0)
+		{
+			md.update((unsigned char*)buf, (unsigned int)msglen);
+		}
+		md.finalize();
+		memcpy(header, md.raw_digest_int(), checksum_len);
 	}
 
-	size_t currpos=0;
+	//Only the first part of the packet may time out. Header and message
+	//are passed as separate buffers so they are not copied together.
+	size_t first_len=(std::min)((size_t)MAX_PACKET, msglen);
 
-	bool first_packet = true;
-	while(currpos<packet_len)
+	SPipeBuffer bufs[2];
+	bufs[0] = SPipeBuffer(header, header_len);
+	bufs[1] = SPipeBuffer(buf, first_len);
+
+	bool has_rest = first_len<msglen;
+
+	if(!p->Writev(bufs, first_len>0 ? 2 : 1, timeoutms, flush && !has_rest))
 	{
-		size_t ts=(std::min)((size_t)MAX_PACKET, packet_len-currpos);
-		bool b=p->Write(&buffer[currpos], ts, first_packet ? timeoutms : -1, flush);
-		first_packet=false;
-		currpos+=ts;
-		if(!b)
-		{
-			delete[] buffer;
-			return 0;
-		}
+		return 0;
+	}
+
+	if(has_rest
+		&& !p->Write(buf+first_len, msglen-first_len, -1, flush))
+	{
+		return 0;
 	}
-	delete[] buffer;
 
 	return msglen;
 }
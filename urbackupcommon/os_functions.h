@@ -125,6 +125,15 @@ bool copy_file(const std::string &src, const std::string &dst, bool flush = fals
 class IFile;
 bool copy_file(IFile *fsrc, IFile *fdst, std::string* error_str = NULL);
 
+class IFsFile;
+//Shares the extents of a range of fsrc with fdst (FICLONERANGE/DUPLICATE_EXTENTS).
+//Offsets and size have to be aligned to the file system block size
+bool os_clone_file_range(IFsFile *fsrc, int64 src_off, IFsFile *fdst, int64 dst_off, int64 size);
+
+//Copies a range of fsrc to fdst inside the kernel (copy_file_range, falling back to sendfile).
+//Returns false if the range could not be copied completely. Changes the file position of fdst
+bool os_copy_file_range(IFsFile *fsrc, int64 src_off, IFsFile *fdst, int64 dst_off, int64 size);
+
 bool os_path_absolute(const std::string& path);
 
 bool os_sync(const std::string& path);
@@ -48,6 +48,7 @@
 #include <sys/resource.h>
 #include <sys/syscall.h>
 #include <linux/fs.h>
+#include <sys/sendfile.h>
 #endif
 #include <stack>
 
@@ -314,9 +315,11 @@ bool os_create_reflink(const std::string &linkname, const std::string &fname)
 	}
 
 #define BTRFS_IOCTL_MAGIC 0x94
-#define BTRFS_IOC_CLONE _IOW (BTRFS_IOCTL_MAGIC, 9, int)
+#ifndef FICLONE
+#define FICLONE _IOW (BTRFS_IOCTL_MAGIC, 9, int)
+#endif
 	
-	int rc=ioctl(dst_desc, BTRFS_IOC_CLONE, src_desc);
+	int rc=ioctl(dst_desc, FICLONE, src_desc);
 	
 	if(rc)
 	{
@@ -340,6 +343,35 @@ bool os_create_reflink(const std::string &linkname, const std::string &fname)
 #endif
 }
 
+#ifdef __linux__
+#ifndef FICLONERANGE
+struct file_clone_range
+{
+	int64_t src_fd;
+	uint64_t src_offset;
+	uint64_t src_length;
+	uint64_t dest_offset;
+};
+#define FICLONERANGE _IOW (BTRFS_IOCTL_MAGIC, 13, struct file_clone_range)
+#endif
+#endif
+
+bool os_clone_file_range(IFsFile *fsrc, int64 src_off, IFsFile *fdst, int64 dst_off, int64 size)
+{
+#ifdef __linux__
+	file_clone_range clone_range;
+	clone_range.src_fd = fsrc->getOsHandle();
+	clone_range.src_offset = src_off;
+	clone_range.src_length = size;
+	clone_range.dest_offset = dst_off;
+
+	return ioctl(fdst->getOsHandle(), FICLONERANGE, &clone_range)==0;
+#else
+	errno = ENOTSUP;
+	return false;
+#endif
+}
+
 bool os_create_hardlink(const std::string &linkname, const std::string &fname, bool use_ioref, bool* too_many_links)
 {
 	if(too_many_links!=NULL)
@@ -871,9 +903,84 @@ bool os_set_file_time(const std::string& fn, int64 created, int64 last_modified,
 }
 
 #ifndef OS_FUNC_NO_SERVER
+bool os_copy_file_range(IFsFile *fsrc, int64 src_off, IFsFile *fdst, int64 dst_off, int64 size)
+{
+#ifdef __linux__
+	int fd_in = fsrc->getOsHandle();
+	int fd_out = fdst->getOsHandle();
+
+#ifdef __NR_copy_file_range
+	bool use_copy_file_range = true;
+#else
+	bool use_copy_file_range = false;
+#endif
+	bool out_positioned = false;
+
+	while (size > 0)
+	{
+		size_t tocopy = static_cast<size_t>((std::min)(size, static_cast<int64>(1024 * 1024 * 1024)));
+		ssize_t rc = -1;
+
+#ifdef __NR_copy_file_range
+		if (use_copy_file_range)
+		{
+			loff_t off_in = src_off;
+			loff_t off_out = dst_off;
+			rc = syscall(__NR_copy_file_range, fd_in, &off_in, fd_out, &off_out, tocopy, 0);
+
+			if (rc < 0
+				&& (errno == ENOSYS || errno == EXDEV
+					|| errno == EOPNOTSUPP || errno == EINVAL) )
+			{
+				use_copy_file_range = false;
+			}
+		}
+#endif
+
+		if (!use_copy_file_range)
+		{
+			if (!out_positioned)
+			{
+				if (lseek64(fd_out, dst_off, SEEK_SET) != dst_off)
+				{
+					return false;
+				}
+				out_positioned = true;
+			}
+
+			off64_t off_in = src_off;
+			rc = sendfile64(fd_out, fd_in, &off_in, tocopy);
+		}
+
+		if (rc < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return false;
+		}
+		else if (rc == 0)
+		{
+			//Source is shorter than expected
+			return false;
+		}
+
+		src_off += rc;
+		dst_off += rc;
+		size -= rc;
+	}
+
+	return true;
+#else
+	errno = ENOTSUP;
+	return false;
+#endif
+}
+
 bool copy_file(const std::string &src, const std::string &dst, bool flush, std::string* error_str)
 {
-	IFile *fsrc=Server->openFile(src, MODE_READ);
+	IFsFile *fsrc=Server->openFile(src, MODE_READ);
 	if (fsrc == NULL)
 	{
 		if (error_str != NULL)
@@ -882,7 +989,7 @@ bool copy_file(const std::string &src, const std::string &dst, bool flush, std::
 		}
 		return false;
 	}
-	IFile *fdst=Server->openFile(dst, MODE_WRITE);
+	IFsFile *fdst=Server->openFile(dst, MODE_WRITE);
 	if(fdst==NULL)
 	{
 		if (error_str != NULL)
@@ -893,7 +1000,13 @@ bool copy_file(const std::string &src, const std::string &dst, bool flush, std::
 		return false;
 	}
 
-	bool copy_ok = copy_file(fsrc, fdst, error_str);
+	bool copy_ok = os_copy_file_range(fsrc, 0, fdst, 0, fsrc->Size());
+
+	if (!copy_ok)
+	{
+		copy_ok = fdst->Resize(0)
+			&& copy_file(fsrc, fdst, error_str);
+	}
 
 	if (copy_ok && flush)
 	{
@@ -711,6 +711,25 @@ bool os_create_reflink(const std::string &linkname, const std::string &fname)
 	return true;
 }
 
+bool os_clone_file_range(IFsFile *fsrc, int64 src_off, IFsFile *fdst, int64 dst_off, int64 size)
+{
+	reflink::DUPLICATE_EXTENTS_DATA reflink_data;
+	reflink_data.FileHandle = fsrc->getOsHandle();
+	reflink_data.SourceFileOffset.QuadPart = src_off;
+	reflink_data.TargetFileOffset.QuadPart = dst_off;
+	reflink_data.ByteCount.QuadPart = size;
+
+	DWORD ret_bytes;
+	return DeviceIoControl(fdst->getOsHandle(), reflink::LOCAL_FSCTL_DUPLICATE_EXTENTS_TO_FILE,
+		&reflink_data, sizeof(reflink_data), NULL, 0, &ret_bytes, NULL)!=FALSE;
+}
+
+bool os_copy_file_range(IFsFile *fsrc, int64 src_off, IFsFile *fdst, int64 dst_off, int64 size)
+{
+	SetLastError(ERROR_NOT_SUPPORTED);
+	return false;
+}
+
 bool os_create_hardlink(const std::string &linkname, const std::string &fname, bool use_ioref, bool* too_many_links)
 {
 	if (use_ioref)
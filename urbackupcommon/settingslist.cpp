@@ -90,6 +90,10 @@ std::vector<std::string> getSettingsList(void)
 	ret.push_back("internet_full_image_style");
 	ret.push_back("create_linked_user_views");
 	ret.push_back("max_running_jobs_per_client");
+	ret.push_back("file_hash_threads");
+	ret.push_back("file_download_connections");
+	ret.push_back("local_compress");
+	ret.push_back("local_compression_level");
 	ret.push_back("cbt_volumes");
 	ret.push_back("cbt_crash_persistent_volumes");
 	ret.push_back("ignore_disk_errors");
@@ -179,6 +183,10 @@ std::vector<std::string> getOnlyServerClientSettingsList(void)
 	ret.push_back("internet_full_image_style");
 	ret.push_back("create_linked_user_views");
 	ret.push_back("max_running_jobs_per_client");
+	ret.push_back("file_hash_threads");
+	ret.push_back("file_download_connections");
+	ret.push_back("local_compress");
+	ret.push_back("local_compression_level");
 	ret.push_back("cbt_volumes");
 	ret.push_back("cbt_crash_persistent_volumes");
 	ret.push_back("ignore_disk_errors");
@@ -233,6 +241,9 @@ std::vector<std::string> getGlobalSettingsList(void)
 	ret.push_back("use_tmpfiles_images");
 	ret.push_back("tmpdir");
 	ret.push_back("update_stats_cachesize");
+	ret.push_back("stats_update_interval");
+	ret.push_back("cleanup_delete_threads");
+	ret.push_back("cleanup_delete_busy_rate");
 	ret.push_back("global_soft_fs_quota");
 	ret.push_back("show_server_updates");
 	ret.push_back("server_url");
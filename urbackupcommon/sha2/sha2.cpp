@@ -37,6 +37,8 @@
 
 #ifdef DO_NOT_USE_CRYPTOPP_SHA
 
+#include "sha2_accel.h"
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -385,7 +387,7 @@ void SHA256_Init(SHA256_CTX* context) {
 	(h) = T1 + Sigma0_256(a) + Maj((a), (b), (c)); \
 	j++
 
-void SHA256_Transform(SHA256_CTX* context, const sha2_word32* data) {
+static void SHA256_Transform_Portable(SHA256_CTX* context, const sha2_word32* data) {
 	sha2_word32	a, b, c, d, e, f, g, h, s0, s1;
 	sha2_word32	T1, *W256;
 	int		j;
@@ -443,7 +445,7 @@ void SHA256_Transform(SHA256_CTX* context, const sha2_word32* data) {
 
 #else /* SHA2_UNROLL_TRANSFORM */
 
-void SHA256_Transform(SHA256_CTX* context, const sha2_word32* data) {
+static void SHA256_Transform_Portable(SHA256_CTX* context, const sha2_word32* data) {
 	sha2_word32	a, b, c, d, e, f, g, h, s0, s1;
 	sha2_word32	T1, T2, *W256;
 	int		j;
@@ -523,6 +525,14 @@ void SHA256_Transform(SHA256_CTX* context, const sha2_word32* data) {
 
 #endif /* SHA2_UNROLL_TRANSFORM */
 
+void SHA256_Transform(SHA256_CTX* context, const sha2_word32* data) {
+	if (sha2_accel_sha256_blocks != NULL) {
+		sha2_accel_sha256_blocks(context->state, (const sha2_byte*)data, 1);
+		return;
+	}
+	SHA256_Transform_Portable(context, data);
+}
+
 void SHA256_Update(SHA256_CTX* context, const sha2_byte *data, size_t len) {
 	unsigned int	freespace, usedspace;
 
@@ -556,6 +566,14 @@ void SHA256_Update(SHA256_CTX* context, const sha2_byte *data, size_t len) {
 			return;
 		}
 	}
+	if (len >= SHA256_BLOCK_LENGTH && sha2_accel_sha256_blocks != NULL) {
+		/* Process all complete blocks with one call */
+		size_t nblocks = len / SHA256_BLOCK_LENGTH;
+		sha2_accel_sha256_blocks(context->state, data, nblocks);
+		context->bitcount += (sha2_word64)(nblocks * SHA256_BLOCK_LENGTH) << 3;
+		len -= nblocks * SHA256_BLOCK_LENGTH;
+		data += nblocks * SHA256_BLOCK_LENGTH;
+	}
 	while (len >= SHA256_BLOCK_LENGTH) {
 		/* Process as many complete blocks as we can */
 		SHA256_Transform(context, (sha2_word32*)data);
@@ -1101,7 +1119,10 @@ void sha256_final(sha256_ctx *ctx, unsigned char *digest)
 void sha256(const unsigned char *message, unsigned int len,
 	unsigned char *digest)
 {
-	SHA256_Data(message, len, reinterpret_cast<char*>(digest));
+	SHA256_CTX ctx;
+	SHA256_Init(&ctx);
+	SHA256_Update(&ctx, message, len);
+	SHA256_Final(digest, &ctx);
 }
 
 void sha512_init(sha512_ctx *ctx)
@@ -1123,7 +1144,10 @@ void sha512_final(sha512_ctx *ctx, unsigned char *digest)
 void sha512(const unsigned char *message, unsigned int len,
 	unsigned char *digest)
 {
-	SHA512_Data(message, len, reinterpret_cast<char*>(digest));
+	SHA512_CTX ctx;
+	SHA512_Init(&ctx);
+	SHA512_Update(&ctx, message, len);
+	SHA512_Final(digest, &ctx);
 }
 
 #else //!DO_NOT_USE_CRYPTOPP_SHA
@@ -35,6 +35,8 @@
 #ifndef __SHA2_H__
 #define __SHA2_H__
 
+#include <string>
+
 #ifdef DO_NOT_USE_CRYPTOPP_SHA
 
 #ifdef __cplusplus
@@ -230,6 +232,7 @@ void sha256_init(sha256_ctx * ctx);
 void sha256_update(sha256_ctx *ctx, const unsigned char *message,
 	unsigned int len);
 void sha256_final(sha256_ctx *ctx, unsigned char *digest);
+//Writes the binary digest (SHA256_DIGEST_SIZE bytes)
 void sha256(const unsigned char *message, unsigned int len,
 	unsigned char *digest);
 
@@ -238,9 +241,18 @@ void sha512_init(sha512_ctx *ctx);
 void sha512_update(sha512_ctx *ctx, const unsigned char *message,
 	unsigned int len);
 void sha512_final(sha512_ctx *ctx, unsigned char *digest);
+//Writes the binary digest (SHA512_DIGEST_SIZE bytes)
 void sha512(const unsigned char *message, unsigned int len,
 	unsigned char *digest);
 
+/*
+* Enables/disables the CPU specific SHA-2 implementation
+* (SHA-NI). It is used by default if the CPU supports it.
+*/
+void sha2_set_accel(bool enabled);
+
+std::string sha2_accel_name();
+
 
 typedef sha512_ctx sha_def_ctx;
 
@@ -0,0 +1,137 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "sha2.h"
+#include "sha2_accel.h"
+
+#include "../../common/cpu_features.h"
+
+#if !defined(SHA2_NO_ACCEL) && defined(CPU_FEATURES_X86)
+#define SHA2_ACCEL_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	const uint32_t K256[64] = {
+		0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL,
+		0x3956c25bUL, 0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL,
+		0xd807aa98UL, 0x12835b01UL, 0x243185beUL, 0x550c7dc3UL,
+		0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL, 0xc19bf174UL,
+		0xe49b69c1UL, 0xefbe4786UL, 0x0fc19dc6UL, 0x240ca1ccUL,
+		0x2de92c6fUL, 0x4a7484aaUL, 0x5cb0a9dcUL, 0x76f988daUL,
+		0x983e5152UL, 0xa831c66dUL, 0xb00327c8UL, 0xbf597fc7UL,
+		0xc6e00bf3UL, 0xd5a79147UL, 0x06ca6351UL, 0x14292967UL,
+		0x27b70a85UL, 0x2e1b2138UL, 0x4d2c6dfcUL, 0x53380d13UL,
+		0x650a7354UL, 0x766a0abbUL, 0x81c2c92eUL, 0x92722c85UL,
+		0xa2bfe8a1UL, 0xa81a664bUL, 0xc24b8b70UL, 0xc76c51a3UL,
+		0xd192e819UL, 0xd6990624UL, 0xf40e3585UL, 0x106aa070UL,
+		0x19a4c116UL, 0x1e376c08UL, 0x2748774cUL, 0x34b0bcb5UL,
+		0x391c0cb3UL, 0x4ed8aa4aUL, 0x5b9cca4fUL, 0x682e6ff3UL,
+		0x748f82eeUL, 0x78a5636fUL, 0x84c87814UL, 0x8cc70208UL,
+		0x90befffaUL, 0xa4506cebUL, 0xbef9a3f7UL, 0xc67178f2UL
+	};
+
+#ifdef SHA2_ACCEL_X86
+	CPU_TARGET("sha,sse4.1,ssse3")
+	void sha256_blocks_shani(uint32_t state[8], const unsigned char* data, size_t nblocks)
+	{
+		const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+		__m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+		__m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+
+		tmp = _mm_shuffle_epi32(tmp, 0xB1); // CDAB
+		state1 = _mm_shuffle_epi32(state1, 0x1B); // EFGH
+		__m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+		state1 = _mm_blend_epi16(state1, tmp, 0xF0); // CDGH
+
+		for (; nblocks > 0; --nblocks, data += 64)
+		{
+			__m128i abef_save = state0;
+			__m128i cdgh_save = state1;
+			__m128i w[4];
+
+			for (size_t g = 0; g < 16; ++g)
+			{
+				if (g < 4)
+				{
+					w[g] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + g * 16)), MASK);
+				}
+
+				__m128i msg = _mm_add_epi32(w[g % 4], _mm_loadu_si128(reinterpret_cast<const __m128i*>(&K256[g * 4])));
+				state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+
+				if (g >= 3 && g <= 14)
+				{
+					tmp = _mm_alignr_epi8(w[g % 4], w[(g + 3) % 4], 4);
+					w[(g + 1) % 4] = _mm_add_epi32(w[(g + 1) % 4], tmp);
+					w[(g + 1) % 4] = _mm_sha256msg2_epu32(w[(g + 1) % 4], w[g % 4]);
+				}
+
+				msg = _mm_shuffle_epi32(msg, 0x0E);
+				state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+				if (g >= 1 && g <= 12)
+				{
+					w[(g + 3) % 4] = _mm_sha256msg1_epu32(w[(g + 3) % 4], w[g % 4]);
+				}
+			}
+
+			state0 = _mm_add_epi32(state0, abef_save);
+			state1 = _mm_add_epi32(state1, cdgh_save);
+		}
+
+		tmp = _mm_shuffle_epi32(state0, 0x1B); // FEBA
+		state1 = _mm_shuffle_epi32(state1, 0xB1); // DCHG
+		state0 = _mm_blend_epi16(tmp, state1, 0xF0); // DCBA
+		state1 = _mm_alignr_epi8(state1, tmp, 8); // ABEF
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+	}
+
+	bool has_shani = cpu_features::has_ssse3() && cpu_features::has_sse41() && cpu_features::has_sha();
+#else //SHA2_ACCEL_X86
+	bool has_shani = false;
+#endif //SHA2_ACCEL_X86
+}
+
+#ifdef SHA2_ACCEL_X86
+sha256_blocks_fn sha2_accel_sha256_blocks = has_shani ? sha256_blocks_shani : NULL;
+#else
+sha256_blocks_fn sha2_accel_sha256_blocks = NULL;
+#endif
+
+void sha2_set_accel(bool enabled)
+{
+#ifdef SHA2_ACCEL_X86
+	sha2_accel_sha256_blocks = (enabled && has_shani) ? sha256_blocks_shani : NULL;
+#endif
+}
+
+std::string sha2_accel_name()
+{
+	std::string ret;
+#ifdef DO_NOT_USE_CRYPTOPP_SHA
+	ret = sha2_accel_sha256_blocks != NULL ? "sha256=shani" : "sha256=portable";
+#else
+	ret = "sha256=cryptopp";
+#endif
+	return ret;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef void(*sha256_blocks_fn)(uint32_t state[8], const unsigned char* data, size_t nblocks);
+
+//CPU specific SHA-256 compression function or NULL if not available
+extern sha256_blocks_fn sha2_accel_sha256_blocks;
@@ -0,0 +1,151 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef CLIENT_ONLY
+
+#include "BackupTelemetry.h"
+#include "../Interface/Server.h"
+#include "../stringtools.h"
+#include <algorithm>
+
+int64 SBackupStageStats::percentile(double p) const
+{
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	int64 needed = (std::max)(static_cast<int64>(count*p + 0.5), static_cast<int64>(1));
+	int64 seen = 0;
+	for (size_t i = 0; i < buckets.size(); ++i)
+	{
+		seen += buckets[i];
+		if (seen >= needed)
+		{
+			return (std::min)(BackupTelemetry::bucketLimitMs(i), max_ms);
+		}
+	}
+	return max_ms;
+}
+
+BackupTelemetry::BackupTelemetry()
+	: mutex(Server->createMutex()), stages(EBackupStage_Count)
+{
+}
+
+void BackupTelemetry::addStageTime(EBackupStage stage, int64 ms)
+{
+	if (ms < 0)
+	{
+		ms = 0;
+	}
+
+	size_t bucket = 0;
+	while (bucket + 1 < c_backup_stage_buckets
+		&& ms >= bucketLimitMs(bucket))
+	{
+		++bucket;
+	}
+
+	IScopedLock lock(mutex.get());
+	SBackupStageStats& stats = stages[stage];
+	++stats.count;
+	stats.total_ms += ms;
+	stats.max_ms = (std::max)(stats.max_ms, ms);
+	++stats.buckets[bucket];
+}
+
+void BackupTelemetry::fileQueued(int64 fileid)
+{
+	IScopedLock lock(mutex.get());
+	queued_files[fileid] = Server->getTimeMS();
+}
+
+void BackupTelemetry::fileDequeued(int64 fileid)
+{
+	int64 queue_time;
+	{
+		IScopedLock lock(mutex.get());
+		std::map<int64, int64>::iterator it = queued_files.find(fileid);
+		if (it == queued_files.end())
+		{
+			return;
+		}
+		queue_time = Server->getTimeMS() - it->second;
+		queued_files.erase(it);
+	}
+
+	addStageTime(EBackupStage_HashQueue, queue_time);
+}
+
+std::vector<SBackupStageStats> BackupTelemetry::getStats()
+{
+	IScopedLock lock(mutex.get());
+	return stages;
+}
+
+void BackupTelemetry::logSummary(logid_t logid)
+{
+	std::vector<SBackupStageStats> stats = getStats();
+
+	for (size_t i = 0; i < stats.size(); ++i)
+	{
+		if (stats[i].count == 0)
+		{
+			continue;
+		}
+
+		ServerLogger::Log(logid, "Time spent in " + stageName(static_cast<EBackupStage>(i)) + ": "
+			+ PrettyPrintTime(stats[i].total_ms) + " for " + convert(stats[i].count) + " files"
+			+ " (median " + convert(stats[i].percentile(0.5)) + "ms, 90th percentile " + convert(stats[i].percentile(0.9))
+			+ "ms, max " + convert(stats[i].max_ms) + "ms)", LL_INFO);
+	}
+}
+
+std::string BackupTelemetry::stageName(EBackupStage stage)
+{
+	switch (stage)
+	{
+	case EBackupStage_Download: return "download";
+	case EBackupStage_HashQueue: return "hash queue";
+	case EBackupStage_Hash: return "hashing";
+	case EBackupStage_LinkCopy: return "link/copy";
+	case EBackupStage_DbInsert: return "database insert";
+	default: return "unknown";
+	}
+}
+
+int64 BackupTelemetry::bucketLimitMs(size_t bucket)
+{
+	return static_cast<int64>(1) << bucket;
+}
+
+ScopedBackupStage::ScopedBackupStage(BackupTelemetry* telemetry, EBackupStage stage)
+	: telemetry(telemetry), stage(stage), starttime(telemetry!=NULL ? Server->getTimeMS() : 0)
+{
+}
+
+ScopedBackupStage::~ScopedBackupStage()
+{
+	if (telemetry != NULL)
+	{
+		telemetry->addStageTime(stage, Server->getTimeMS() - starttime);
+	}
+}
+
+#endif //CLIENT_ONLY
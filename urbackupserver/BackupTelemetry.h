@@ -0,0 +1,81 @@
+#pragma once
+#include "../Interface/Types.h"
+#include "../Interface/Mutex.h"
+#include "server_log.h"
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+
+//Histogram buckets are powers of two in milliseconds: <1ms, <2ms, <4ms ... <2^(n-2)ms and the rest
+const size_t c_backup_stage_buckets = 20;
+
+enum EBackupStage
+{
+	//Waiting for the client to read and send a file (client disk and network)
+	EBackupStage_Download = 0,
+	//Files waiting in the hash and the link/copy queues
+	EBackupStage_HashQueue = 1,
+	//Hashing the downloaded file on the server
+	EBackupStage_Hash = 2,
+	//Linking, copying or patching the file into the backup (server disk)
+	EBackupStage_LinkCopy = 3,
+	//Adding the file entry to the database
+	EBackupStage_DbInsert = 4,
+	EBackupStage_Count = 5
+};
+
+struct SBackupStageStats
+{
+	SBackupStageStats()
+		: count(0), total_ms(0), max_ms(0), buckets(c_backup_stage_buckets)
+	{}
+
+	int64 count;
+	int64 total_ms;
+	int64 max_ms;
+	std::vector<int64> buckets;
+
+	int64 percentile(double p) const;
+};
+
+/**
+* Time spent per file in each stage of a file backup, shared by the download
+* thread(s) and the hash threads of one backup.
+*/
+class BackupTelemetry
+{
+public:
+	BackupTelemetry();
+
+	void addStageTime(EBackupStage stage, int64 ms);
+
+	//Record the time a file spends between two hash pipeline stages
+	void fileQueued(int64 fileid);
+	void fileDequeued(int64 fileid);
+
+	std::vector<SBackupStageStats> getStats();
+
+	void logSummary(logid_t logid);
+
+	static std::string stageName(EBackupStage stage);
+
+	static int64 bucketLimitMs(size_t bucket);
+
+private:
+	std::auto_ptr<IMutex> mutex;
+	std::vector<SBackupStageStats> stages;
+	std::map<int64, int64> queued_files;
+};
+
+class ScopedBackupStage
+{
+public:
+	ScopedBackupStage(BackupTelemetry* telemetry, EBackupStage stage);
+	~ScopedBackupStage();
+
+private:
+	BackupTelemetry* telemetry;
+	EBackupStage stage;
+	int64 starttime;
+};
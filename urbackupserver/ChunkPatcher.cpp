@@ -20,6 +20,7 @@
 #include "../stringtools.h"
 #include <assert.h>
 #include "../urbackupcommon/ExtentIterator.h"
+#include "../fileservplugin/chunk_settings.h"
 #include <memory.h>
 #include <limits.h>
 
@@ -113,6 +114,7 @@ bool ChunkPatcher::ApplyPatch(IFile *file, IFile *patch, ExtentIterator* extent_
 	SPatchHeader next_header;
 	next_header.patch_off=-1;
 	next_header.patch_size = 0;
+	next_header.copy_off = -1;
 	bool has_header=true;
 	_i64 file_pos;
 	_i64 size;
@@ -172,18 +174,44 @@ bool ChunkPatcher::ApplyPatch(IFile *file, IFile *patch, ExtentIterator* extent_
 
 			unchanged_align_end = unchanged_align_end_next;
 
+			if (next_header.copy_off != -1
+				&& !with_sparse
+				&& cb->next_chunk_patcher_copy(next_header.copy_off, next_header.patch_size))
+			{
+				VLOG(Server->Log("Cloned copy at " + convert(file_pos) + " from " + convert(next_header.copy_off) + " length=" + convert(next_header.patch_size), LL_DEBUG));
+				file_pos += next_header.patch_size;
+				next_header.patch_size = 0;
+			}
+
 			while(next_header.patch_size>0)
 			{
 				bool has_read_error = false;
-				_u32 r=patch->Read(buf.data(), (std::min)((unsigned int)buffer_size, next_header.patch_size), &has_read_error);
-
-				if (has_read_error)
+				_u32 toread = (std::min)((unsigned int)buffer_size, next_header.patch_size);
+				_u32 r;
+				if (next_header.copy_off != -1)
 				{
-					Server->Log("Read error while reading patch data from \""+patch->getFilename()+"\"", LL_ERROR);
-					return false;
+					r = file->Read(next_header.copy_off, buf.data(), toread, &has_read_error);
+
+					if (has_read_error || r < toread)
+					{
+						Server->Log("Read error while reading copied data at position "+convert(next_header.copy_off)+" from \""+file->getFilename()+"\"", LL_ERROR);
+						return false;
+					}
+
+					next_header.copy_off += r;
 				}
+				else
+				{
+					r=patch->Read(buf.data(), toread, &has_read_error);
+
+					if (has_read_error)
+					{
+						Server->Log("Read error while reading patch data from \""+patch->getFilename()+"\"", LL_ERROR);
+						return false;
+					}
 
-				patchf_pos+=r;
+					patchf_pos+=r;
+				}
 				if (with_sparse)
 				{
 					nextChunkPatcherBytes(file_pos, buf.data(), r, true, false);
@@ -420,9 +448,29 @@ bool ChunkPatcher::readNextValidPatch(IFile *patchf, _i64 &patchf_pos, SPatchHea
 			patch_header->patch_size = little_endian(patch_header->patch_size);
 		}
 
+		patch_header->copy_off = -1;
+		if(patch_header->patch_size & c_patch_copy_flag)
+		{
+			patch_header->patch_size &= ~c_patch_copy_flag;
+
+			r=patchf->Read((char*)&patch_header->copy_off, sizeof(_i64), &has_read_error);
+			patchf_pos+=r;
+			if(r!=sizeof(_i64))
+			{
+				patch_header->patch_off=-1;
+				patch_header->patch_size=0;
+				patch_header->copy_off=-1;
+				return false;
+			}
+			patch_header->copy_off = little_endian(patch_header->copy_off);
+		}
+
 		if(patch_header->patch_off==-1)
 		{
-			patchf_pos+=patch_header->patch_size;
+			if(patch_header->copy_off==-1)
+			{
+				patchf_pos+=patch_header->patch_size;
+			}
 			patchf->Seek(patchf_pos);
 		}
 	}
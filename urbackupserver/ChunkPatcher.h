@@ -7,6 +7,7 @@ struct SPatchHeader
 {
 	_i64 patch_off;
 	unsigned int patch_size;
+	_i64 copy_off;
 };
 
 class ExtentIterator;
@@ -17,6 +18,9 @@ public:
 	virtual void next_chunk_patcher_bytes(const char *buf, size_t bsize, bool changed, bool* is_sparse=NULL)=0;
 	virtual void next_sparse_extent_bytes(const char *buf, size_t bsize) = 0;
 	virtual int64 chunk_patcher_pos() = 0;
+	//Data copied from copy_off in the source file. Returns true if the callback
+	//took care of the range (e.g. via reflink) without getting the bytes
+	virtual bool next_chunk_patcher_copy(int64 copy_off, size_t bsize) { return false; }
 };
 
 class ChunkPatcher
@@ -23,6 +23,7 @@
 #include "../Interface/Server.h"
 #include "../Interface/ThreadPool.h"
 #include "../urbackupcommon/fileclient/tcpstack.h"
+#include "../urbackupcommon/CompressedPipeZstd.h"
 #include "../common/data.h"
 #include "../urbackupcommon/settingslist.h"
 #include "server_channel.h"
@@ -79,6 +80,10 @@ const size_t minfreespace_min=50*1024*1024;
 const unsigned int ident_err_retry_time=1*60*1000;
 const unsigned int ident_err_retry_time_retok=10*60*1000;
 const unsigned int c_filesrv_connect_timeout=10000;
+const unsigned int c_compress_negotiate_timeout=10000;
+const int c_local_zstd_start_level=1;
+const int c_local_zstd_min_level=-5;
+const int c_local_zstd_max_level=9;
 const unsigned int c_internet_fileclient_timeout=30*60*1000;
 const unsigned int c_sleeptime_failed_imagebackup=20*60;
 const unsigned int c_sleeptime_failed_filebackup=20*60;
@@ -101,7 +106,7 @@ bool ClientMain::running_backups_allowed=true;
 ClientMain::ClientMain(IPipe *pPipe, FileClient::SAddrHint pAddr, const std::string &pName,
 	const std::string& pSubName, const std::string& pMainName, int filebackup_group_offset, bool internet_connection,
 	bool use_file_snapshots, bool use_image_snapshots, bool use_reflink)
-	: internet_connection(internet_connection), server_settings(NULL), client_throttler(NULL),
+	: internet_connection(internet_connection), server_settings(NULL), client_throttler(NULL), client_throttler_groupid(0),
 	  use_file_snapshots(use_file_snapshots), use_image_snapshots(use_image_snapshots), use_reflink(use_reflink),
 	  backup_dao(NULL), client_updated_time(0), continuous_backup(NULL),
 	  clientsubname(pSubName), filebackup_group_offset(filebackup_group_offset), needs_authentification(false),
@@ -122,6 +127,8 @@ ClientMain::ClientMain(IPipe *pPipe, FileClient::SAddrHint pAddr, const std::str
 	do_incr_image_now=false;
 	do_update_access_key = false;
 	cdp_needs_sync=true;
+	local_compress=false;
+	local_compression_level=0;
 
 	can_backup_images=true;
 
@@ -434,6 +441,8 @@ void ClientMain::operator ()(void)
 	sendClientLogdata();
 
 	curr_image_format = server_settings->getImageFileFormat();
+	local_compress = server_settings->getSettings()->local_compress;
+	local_compression_level = server_settings->getSettings()->local_compression_level;
 
 	ServerStatus::setCommPipe(clientname, pipe);
 
@@ -713,6 +722,8 @@ void ClientMain::operator ()(void)
 			}
 
 			curr_image_format = server_settings->getImageFileFormat();
+			local_compress = server_settings->getSettings()->local_compress;
+			local_compression_level = server_settings->getSettings()->local_compression_level;
 
 
 			bool internet_no_full_file=(internet_connection && !server_settings->getSettings()->internet_full_file_backups );
@@ -1652,6 +1663,11 @@ bool ClientMain::updateCapabilities(bool* needs_restart)
 		{
 			protocol_versions.wtokens_version = watoi(it->second);
 		}
+		it = params.find("LAN_ZSTD");
+		if (it != params.end())
+		{
+			protocol_versions.lan_zstd_version = watoi(it->second);
+		}
 		it = params.find("UPDATE_VOLS");
 		if (it != params.end())
 		{
@@ -2297,8 +2313,27 @@ bool ClientMain::tooManyClients(IDatabase * db, const std::string & clientname,
 	return false;
 }
 
-IPipeThrottler *ClientMain::getThrottler(int speed_bps)
+IPipeThrottler *ClientMain::getThrottler(ServerSettings* server_settings)
 {
+	int speed_bps;
+	IPipeThrottler* global_throttler;
+	if(internet_connection)
+	{
+		speed_bps=server_settings->getInternetSpeed();
+		global_throttler=BackupServer::getGlobalInternetThrottler(server_settings->getGlobalInternetSpeed());
+	}
+	else
+	{
+		speed_bps=server_settings->getLocalSpeed();
+		global_throttler=BackupServer::getGlobalLocalThrottler(server_settings->getGlobalLocalSpeed());
+	}
+
+	if((speed_bps==0 || speed_bps==-1)
+		&& global_throttler==NULL)
+	{
+		return NULL;
+	}
+
 	IScopedLock lock(throttle_mutex);
 
 	if(client_throttler==NULL)
@@ -2314,9 +2349,27 @@ IPipeThrottler *ClientMain::getThrottler(int speed_bps)
 			percent_max);
 	}
 
+	//global -> client group -> client. The connections of the client
+	//share the client's bandwidth fairly
+	client_throttler_groupid = server_settings->getSettings()->groupid;
+	client_throttler->setParent(BackupServer::getClientGroupThrottler(client_throttler_groupid,
+		internet_connection), 1);
+
 	return client_throttler;
 }
 
+int64 ClientMain::getThrottleWaitTime()
+{
+	IScopedLock lock(throttle_mutex);
+
+	if(client_throttler==NULL)
+	{
+		return 0;
+	}
+
+	return client_throttler->getThrottleWaitTimeUs()/1000;
+}
+
 void ClientMain::updateClientAccessKey()
 {
 	std::string access_key = ServerSettings::generateRandomAuthKey(32);
@@ -2472,17 +2525,10 @@ IPipe *ClientMain::getClientCommandConnection(ServerSettings* server_settings, i
 		IPipe *ret=InternetServiceConnector::getConnection(curr_clientname, SERVICE_COMMANDS, timeoutms);
 		if(server_settings!=NULL && ret!=NULL)
 		{
-			int internet_speed=server_settings->getInternetSpeed();
-			if(internet_speed!=0
-				&& internet_speed!=-1)
+			IPipeThrottler* throttler=getThrottler(server_settings);
+			if(throttler!=NULL)
 			{
-				ret->addThrottler(getThrottler(internet_speed));
-			}
-			int global_internet_speed=server_settings->getGlobalInternetSpeed();
-			if(global_internet_speed!=0
-				&& global_internet_speed!=-1)
-			{
-				ret->addThrottler(BackupServer::getGlobalInternetThrottler(global_internet_speed));
+				ret->addThrottler(throttler);
 			}
 		}
 		return ret;
@@ -2492,23 +2538,148 @@ IPipe *ClientMain::getClientCommandConnection(ServerSettings* server_settings, i
 		IPipe *ret=Server->ConnectStream(getClientaddr().toString(), serviceport, timeoutms);
 		if(server_settings!=NULL && ret!=NULL)
 		{
-			int local_speed=server_settings->getLocalSpeed();
-			if(local_speed!=0
-				&& local_speed!=-1)
-			{
-				ret->addThrottler(getThrottler(local_speed));
-			}
-			int global_local_speed=server_settings->getGlobalLocalSpeed();
-			if(global_local_speed!=0
-				&& global_local_speed!=-1)
+			IPipeThrottler* throttler=getThrottler(server_settings);
+			if(throttler!=NULL)
 			{
-				ret->addThrottler(BackupServer::getGlobalLocalThrottler(global_local_speed));
+				ret->addThrottler(throttler);
 			}
 		}
 		return ret;
 	}
 }
 
+bool ClientMain::getLocalCompression(int& compression_level, int& min_level, int& max_level)
+{
+#ifndef NO_ZSTD_COMPRESSION
+	if (internet_connection
+		|| !local_compress
+		|| protocol_versions.lan_zstd_version <= 0)
+	{
+		return false;
+	}
+
+	int level = local_compression_level;
+	if (level == 0)
+	{
+		compression_level = c_local_zstd_start_level;
+		min_level = c_local_zstd_min_level;
+		max_level = c_local_zstd_max_level;
+	}
+	else
+	{
+		compression_level = level;
+		min_level = level;
+		max_level = level;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+IPipe * ClientMain::compressCommandConnection(IPipe * cc, ServerSettings* server_settings)
+{
+	int compression_level, min_level, max_level;
+	if (cc == NULL
+		|| !getLocalCompression(compression_level, min_level, max_level))
+	{
+		return cc;
+	}
+
+#ifndef NO_ZSTD_COMPRESSION
+	CTCPStack tcpstack;
+	tcpstack.Send(cc, getIdentity() + "COMPRESS level=" + convert(compression_level)
+		+ "&min_level=" + convert(min_level) + "&max_level=" + convert(max_level));
+
+	std::string ret;
+	bool has_response = false;
+	int64 starttime = Server->getTimeMS();
+	while (Server->getTimeMS() - starttime <= c_compress_negotiate_timeout)
+	{
+		size_t rc = cc->Read(&ret, c_compress_negotiate_timeout);
+		if (rc == 0)
+		{
+			break;
+		}
+		tcpstack.AddData((char*)ret.c_str(), ret.size());
+
+		if (tcpstack.getPacket(ret))
+		{
+			has_response = true;
+			break;
+		}
+	}
+
+	if (!has_response)
+	{
+		//State of the connection is unknown. Use a new uncompressed one.
+		Server->Log("Timeout while enabling compression of command connection to client \"" + clientname + "\"", LL_WARNING);
+		Server->destroy(cc);
+		return getClientCommandConnection(server_settings, 10000);
+	}
+
+	if (ret != "OK")
+	{
+		Server->Log("Client \"" + clientname + "\" did not enable compression of command connection: " + ret, LL_DEBUG);
+		return cc;
+	}
+
+	CompressedPipeZstd* comp_pipe = new CompressedPipeZstd(cc, compression_level, -1);
+	comp_pipe->destroyBackendPipeOnDelete(true);
+	if (min_level != max_level)
+	{
+		comp_pipe->setAdaptiveLevel(min_level, max_level);
+	}
+	return comp_pipe;
+#else
+	return cc;
+#endif
+}
+
+IPipe * ClientMain::compressFilesrvConnection(IPipe * cp)
+{
+	int compression_level, min_level, max_level;
+	if (cp == NULL
+		|| !getLocalCompression(compression_level, min_level, max_level))
+	{
+		return cp;
+	}
+
+#ifndef NO_ZSTD_COMPRESSION
+	CWData data;
+	data.addUChar(ID_COMPRESS_STREAM);
+	data.addString(getIdentity());
+	data.addInt(compression_level);
+	data.addInt(min_level);
+	data.addInt(max_level);
+
+	CTCPStack tcpstack;
+	char ack;
+	if (tcpstack.Send(cp, data.getDataPtr(), data.getDataSize()) != data.getDataSize()
+		|| cp->Read(&ack, 1, c_compress_negotiate_timeout) != 1)
+	{
+		Server->Log("Timeout while enabling compression of file server connection to client \"" + clientname + "\"", LL_WARNING);
+		Server->destroy(cp);
+		return Server->ConnectStream(getClientaddr().toString(), TCP_PORT, c_filesrv_connect_timeout);
+	}
+
+	if (ack != ID_STREAM_COMPRESSED)
+	{
+		return cp;
+	}
+
+	CompressedPipeZstd* comp_pipe = new CompressedPipeZstd(cp, compression_level, -1);
+	comp_pipe->destroyBackendPipeOnDelete(true);
+	if (min_level != max_level)
+	{
+		comp_pipe->setAdaptiveLevel(min_level, max_level);
+	}
+	return comp_pipe;
+#else
+	return cp;
+#endif
+}
+
 _u32 ClientMain::getClientFilesrvConnection(FileClient *fc, ServerSettings* server_settings, int timeoutms)
 {
 	std::string curr_clientname = (clientname);
@@ -2526,17 +2697,10 @@ _u32 ClientMain::getClientFilesrvConnection(FileClient *fc, ServerSettings* serv
 
 		if(server_settings!=NULL)
 		{
-			int internet_speed=server_settings->getInternetSpeed();
-			if(internet_speed!=0
-				&& internet_speed!=-1)
-			{
-				fc->addThrottler(getThrottler(internet_speed));
-			}
-			int global_internet_speed=server_settings->getGlobalInternetSpeed();
-			if(global_internet_speed!=0
-				&& global_internet_speed!=-1)
+			IPipeThrottler* throttler=getThrottler(server_settings);
+			if(throttler!=NULL)
 			{
-				fc->addThrottler(BackupServer::getGlobalInternetThrottler(global_internet_speed));
+				fc->addThrottler(throttler);
 			}
 		}
 
@@ -2546,21 +2710,24 @@ _u32 ClientMain::getClientFilesrvConnection(FileClient *fc, ServerSettings* serv
 	}
 	else
 	{
-		_u32 ret=fc->Connect(getClientaddr());
+		_u32 ret;
+		int compression_level, min_level, max_level;
+		if (getLocalCompression(compression_level, min_level, max_level))
+		{
+			IPipe *cp=compressFilesrvConnection(Server->ConnectStream(getClientaddr().toString(), TCP_PORT, timeoutms));
+			ret=fc->Connect(cp);
+		}
+		else
+		{
+			ret=fc->Connect(getClientaddr());
+		}
 
 		if(server_settings!=NULL)
 		{
-			int local_speed=server_settings->getLocalSpeed();
-			if(local_speed!=0
-				&& local_speed!=-1)
-			{
-				fc->addThrottler(getThrottler(local_speed));
-			}
-			int global_local_speed=server_settings->getGlobalLocalSpeed();
-			if(global_local_speed!=0
-				&& global_local_speed!=-1)
+			IPipeThrottler* throttler=getThrottler(server_settings);
+			if(throttler!=NULL)
 			{
-				fc->addThrottler(BackupServer::getGlobalLocalThrottler(global_local_speed));
+				fc->addThrottler(throttler);
 			}
 		}
 
@@ -2596,7 +2763,7 @@ bool ClientMain::getClientChunkedFilesrvConnection(std::auto_ptr<FileClientChunk
 	}
 	else
 	{
-		IPipe *pipe=Server->ConnectStream(getClientaddr().toString(), TCP_PORT, timeoutms);
+		IPipe *pipe=compressFilesrvConnection(Server->ConnectStream(getClientaddr().toString(), TCP_PORT, timeoutms));
 		if(pipe!=NULL)
 		{
 			fc_chunked.reset(new FileClientChunked(pipe, false, &tcpstack, this, use_tmpfiles?NULL: no_free_space_callback, identity, NULL));
@@ -2608,41 +2775,14 @@ bool ClientMain::getClientChunkedFilesrvConnection(std::auto_ptr<FileClientChunk
 	}
 
 	fc_chunked->setProgressLogCallback(this);
+	fc_chunked->setAllowCopyChunks(protocol_versions.filesrv_protocol_version>3);
 
 	if(fc_chunked->getPipe()!=NULL && server_settings!=NULL)
 	{
-		int speed;
-		if(internet_connection)
-		{
-			speed=server_settings->getInternetSpeed();
-		}
-		else
-		{
-			speed=server_settings->getLocalSpeed();
-		}
-		if(speed!=0
-			&& speed!=-1)
-		{
-			fc_chunked->addThrottler(getThrottler(speed));
-		}
-
-		if(internet_connection)
-		{
-			int global_speed=server_settings->getGlobalInternetSpeed();
-			if(global_speed!=0
-				&& global_speed!=-1)
-			{
-				fc_chunked->addThrottler(BackupServer::getGlobalInternetThrottler(global_speed));
-			}
-		}
-		else
+		IPipeThrottler* throttler=getThrottler(server_settings);
+		if(throttler!=NULL)
 		{
-			int global_speed=server_settings->getGlobalLocalSpeed();
-			if(global_speed!=0
-				&& global_speed!=-1)
-			{
-				fc_chunked->addThrottler(BackupServer::getGlobalLocalThrottler(global_speed));
-			}
+			fc_chunked->addThrottler(throttler);
 		}
 	}
 
@@ -2716,7 +2856,7 @@ IPipe * ClientMain::new_fileclient_connection(void)
 	}
 	else
 	{
-		rp=Server->ConnectStream(getClientaddr().toString(), TCP_PORT, c_filesrv_connect_timeout);
+		rp=compressFilesrvConnection(Server->ConnectStream(getClientaddr().toString(), TCP_PORT, c_filesrv_connect_timeout));
 	}
 	return rp;
 }
@@ -3106,6 +3246,17 @@ void ClientMain::log_progress( const std::string& fn, int64 total, int64 downloa
 	}
 }
 
+void ClientMain::log_chunk_window( const std::string& fn, unsigned int window, unsigned int in_flight, int64 min_rtt_ms )
+{
+	std::string fn_wo_token = fn;
+	if(getuntil("/", fn).find("|")!=std::string::npos)
+	{
+		fn_wo_token = getafter("|", fn);
+	}
+
+	ServerLogger::Log(logid, "Chunk window for \""+ fn_wo_token +"\": "+convert(window)+" chunks ("+convert(in_flight)+" in flight, min RTT "+convert(min_rtt_ms)+"ms)", LL_DEBUG);
+}
+
 
 
 void ClientMain::updateClientAddress(const std::string& address_data)
@@ -3125,6 +3276,8 @@ void ClientMain::updateClientAddress(const std::string& address_data)
 			client_throttler->changeThrottleUpdater(new
 				ThrottleUpdater(clientid, internet_connection ?
 					ThrottleScope_Internet : ThrottleScope_Local));
+			client_throttler->setParent(BackupServer::getClientGroupThrottler(client_throttler_groupid,
+				internet_connection), 1);
 		}
 	}
 }
@@ -49,7 +49,7 @@ struct SProtocolVersions
 				symbit_version(0), phash_version(0),
 				wtokens_version(0), update_vols(0),
 				update_capa_interval(0), require_previous_cbitmap(0),
-				async_index_version(0)
+				async_index_version(0), lan_zstd_version(0)
 			{
 
 			}
@@ -73,6 +73,7 @@ struct SProtocolVersions
 	int wtokens_version;
 	int update_vols;
 	int update_capa_interval;
+	int lan_zstd_version;
 	std::string os_simple;
 };
 
@@ -173,6 +174,9 @@ public:
 
 	IPipe *getClientCommandConnection(ServerSettings* server_settings, int timeoutms=10000, std::string* clientaddr=NULL);
 
+	//Switches a local command connection to zstd compression if enabled and supported by the client
+	IPipe *compressCommandConnection(IPipe* cc, ServerSettings* server_settings);
+
 	virtual IPipe * new_fileclient_connection(void);
 
 	virtual bool handle_not_enough_space(const std::string &path);
@@ -186,6 +190,7 @@ public:
 	
 	
 	virtual void log_progress( const std::string& fn, int64 total, int64 downloaded, int64 speed_bps );
+	virtual void log_chunk_window( const std::string& fn, unsigned int window, unsigned int in_flight, int64 min_rtt_ms );
 
 	_u32 getClientFilesrvConnection(FileClient *fc, ServerSettings* server_settings, int timeoutms=10000);
 
@@ -209,6 +214,9 @@ public:
 	}
 
 	std::string getIdentity();
+
+	//Time connections to this client spent waiting for bandwidth throttling (ms)
+	int64 getThrottleWaitTime();
 	
 	int getCurrImageVersion()
 	{
@@ -284,7 +292,7 @@ private:
 	bool sendFile(IPipe *cc, IFile *f, int timeout);
 	bool isBackupsRunningOkay(bool file, bool incr=false);	
 	bool updateCapabilities(bool* needs_restart);
-	IPipeThrottler *getThrottler(int speed_bps);
+	IPipeThrottler *getThrottler(ServerSettings* server_settings);
 	bool inBackupWindow(Backup* backup);
 	void updateClientAccessKey();
 	bool isDataplanOkay(bool file);
@@ -324,6 +332,12 @@ private:
 	SPathComponents extractBackupComponents(const std::string& path, const std::string& backupfolder, const std::vector<std::string>& old_backupfolders);
 	std::string curr_image_format;
 
+	bool getLocalCompression(int& compression_level, int& min_level, int& max_level);
+	IPipe* compressFilesrvConnection(IPipe* cp);
+
+	volatile bool local_compress;
+	volatile int local_compression_level;
+
 	IPipe *pipe;
 	IDatabase *db;
 
@@ -380,6 +394,7 @@ private:
 
 	IMutex* throttle_mutex;
 	IPipeThrottler *client_throttler;
+	int client_throttler_groupid;
 
 	int64 last_backup_try;
 	
@@ -40,12 +40,19 @@
 #include "../urbackupcommon/TreeHash.h"
 #include "../common/data.h"
 #include "PhashLoad.h"
+#include "ParallelHashPipe.h"
+#include "ServerDownloadThread.h"
+#include "../Interface/RingBufferPipe.h"
 
 #ifndef NAME_MAX
 #define NAME_MAX _POSIX_NAME_MAX
 #endif
 
 const unsigned int full_backup_construct_timeout=4*60*60*1000;
+const int max_hash_threads=32;
+const int max_download_connections=16;
+//Capacity of each hash worker input queue. Downloading pauses if hashing falls this far behind.
+const size_t hash_queue_size=2*1024*1024;
 extern std::string server_identity;
 
 FileBackup::FileBackup( ClientMain* client_main, int clientid, std::string clientname, std::string clientsubname, LogAction log_action,
@@ -54,8 +61,7 @@ FileBackup::FileBackup( ClientMain* client_main, int clientid, std::string clien
 	:  Backup(client_main, clientid, clientname, clientsubname, log_action, true, is_incremental, server_token, details, scheduled),
 	group(group), use_tmpfiles(use_tmpfiles), tmpfile_path(tmpfile_path), use_reflink(use_reflink), use_snapshots(use_snapshots),
 	disk_error(false), with_hashes(false),
-	backupid(-1), hashpipe(NULL), hashpipe_prepare(NULL), bsh(NULL), bsh_prepare(NULL),
-	bsh_ticket(ILLEGAL_THREADPOOL_TICKET), bsh_prepare_ticket(ILLEGAL_THREADPOOL_TICKET), pingthread(NULL),
+	backupid(-1), hashpipe(NULL), hashpipe_prepare(NULL), pingthread(NULL),
 	pingthread_ticket(ILLEGAL_THREADPOOL_TICKET), cdp_path(false), metadata_download_thread_ticket(ILLEGAL_THREADPOOL_TICKET),
 	last_speed_received_bytes(0), speed_set_time(0)
 {
@@ -579,18 +585,51 @@ std::string FileBackup::clientlistName(int ref_backupid)
 	return "urbackup/clientlist_b_" + convert(ref_backupid) + ".ub";
 }
 
-void FileBackup::createHashThreads(bool use_reflink, bool ignore_hash_mismatches)
+void FileBackup::createHashThreads(bool use_reflink, bool ignore_hash_mismatches, int n_threads)
 {
-	assert(bsh==NULL);
-	assert(bsh_prepare==NULL);
+	assert(bsh.empty());
+	assert(bsh_prepare.empty());
 
-	hashpipe=Server->createMemoryPipe();
-	hashpipe_prepare=Server->createMemoryPipe();
+	if (n_threads <= 0)
+	{
+		n_threads = static_cast<int>(os_get_num_cpus());
+	}
+	if (n_threads < 1)
+	{
+		n_threads = 1;
+	}
+	if (n_threads > max_hash_threads)
+	{
+		n_threads = max_hash_threads;
+	}
 
-	bsh=new BackupServerHash(hashpipe, clientid, use_snapshots, use_reflink, use_tmpfiles, logid, use_snapshots, max_file_id);
-	bsh_prepare=new BackupServerPrepareHash(hashpipe_prepare, hashpipe, clientid, logid, ignore_hash_mismatches);
-	bsh_ticket = Server->getThreadPool()->execute(bsh, "fbackup write");
-	bsh_prepare_ticket = Server->getThreadPool()->execute(bsh_prepare, "fbackup hash");
+	std::vector<IPipe*> hash_pipes;
+	std::vector<IPipe*> prepare_hash_pipes;
+	for (int i = 0; i < n_threads; ++i)
+	{
+		hash_pipes.push_back(Server->createRingBufferPipe(hash_queue_size, true));
+		prepare_hash_pipes.push_back(Server->createRingBufferPipe(hash_queue_size, true));
+	}
+
+	hashpipe = new ParallelHashPipe(hash_pipes, ParallelHashPipe::EPartition_Hash, n_threads, NULL);
+	hashpipe_prepare = new ParallelHashPipe(prepare_hash_pipes, ParallelHashPipe::EPartition_LeastLoaded, 1, &max_file_id);
+
+	for (int i = 0; i < n_threads; ++i)
+	{
+		bsh.push_back(new BackupServerHash(hash_pipes[i], clientid, use_snapshots, use_reflink, use_tmpfiles, logid, use_snapshots, max_file_id, &telemetry));
+		bsh_prepare.push_back(new BackupServerPrepareHash(prepare_hash_pipes[i], hashpipe, clientid, logid, ignore_hash_mismatches, max_file_id, &telemetry));
+	}
+
+	for (int i = 0; i < n_threads; ++i)
+	{
+		bsh_tickets.push_back(Server->getThreadPool()->execute(bsh[i], "fbackup write"));
+		bsh_prepare_tickets.push_back(Server->getThreadPool()->execute(bsh_prepare[i], "fbackup hash"));
+	}
+
+	if (n_threads > 1)
+	{
+		ServerLogger::Log(logid, "Using " + convert(n_threads) + " file hashing and copying threads", LL_DEBUG);
+	}
 }
 
 
@@ -598,19 +637,79 @@ void FileBackup::destroyHashThreads()
 {
 	if (hashpipe_prepare != NULL)
 	{
-		assert(bsh_ticket != ILLEGAL_THREADPOOL_TICKET);
-		assert(bsh_prepare_ticket != ILLEGAL_THREADPOOL_TICKET);
+		assert(!bsh_tickets.empty());
+		assert(!bsh_prepare_tickets.empty());
 		hashpipe_prepare->Write("exit");
-		Server->getThreadPool()->waitFor(bsh_ticket);
-		Server->getThreadPool()->waitFor(bsh_prepare_ticket);
+		Server->getThreadPool()->waitFor(bsh_tickets);
+		Server->getThreadPool()->waitFor(bsh_prepare_tickets);
+
+		Server->destroy(hashpipe);
+		Server->destroy(hashpipe_prepare);
 	}
 
-	bsh_ticket=ILLEGAL_THREADPOOL_TICKET;
-	bsh_prepare_ticket=ILLEGAL_THREADPOOL_TICKET;
+	bsh_tickets.clear();
+	bsh_prepare_tickets.clear();
 	hashpipe=NULL;
 	hashpipe_prepare=NULL;
-	bsh=NULL;
-	bsh_prepare=NULL;
+	bsh.clear();
+	bsh_prepare.clear();
+}
+
+bool FileBackup::hashThreadsHaveError()
+{
+	for (size_t i = 0; i < bsh.size(); ++i)
+	{
+		if (bsh[i]->hasError())
+		{
+			return true;
+		}
+	}
+
+	for (size_t i = 0; i < bsh_prepare.size(); ++i)
+	{
+		if (bsh_prepare[i]->hasError())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+size_t FileBackup::numHashThreadsWorking()
+{
+	size_t ret = 0;
+	for (size_t i = 0; i < bsh.size(); ++i)
+	{
+		if (bsh[i]->isWorking())
+		{
+			++ret;
+		}
+	}
+	return ret;
+}
+
+size_t FileBackup::numHashThreadsQueued()
+{
+	size_t ret = 0;
+	for (size_t i = 0; i < bsh.size(); ++i)
+	{
+		ret += bsh[i]->getNumQueued();
+	}
+	return ret;
+}
+
+size_t FileBackup::numPrepareHashThreadsWorking()
+{
+	size_t ret = 0;
+	for (size_t i = 0; i < bsh_prepare.size(); ++i)
+	{
+		if (bsh_prepare[i]->isWorking())
+		{
+			++ret;
+		}
+	}
+	return ret;
 }
 
 _i64 FileBackup::getIncrementalSize(IFile *f, const std::vector<size_t> &diffs, bool& backup_with_components, bool all)
@@ -707,7 +806,7 @@ _i64 FileBackup::getIncrementalSize(IFile *f, const std::vector<size_t> &diffs,
 	return rsize;
 }
 
-void FileBackup::calculateDownloadSpeed(int64 ctime, FileClient & fc, FileClientChunked * fc_chunked)
+void FileBackup::calculateDownloadSpeed(int64 ctime, FileClient & fc, FileClientChunked * fc_chunked, ServerDownloadThread* server_download)
 {
 	if (speed_set_time == 0)
 	{
@@ -716,7 +815,8 @@ void FileBackup::calculateDownloadSpeed(int64 ctime, FileClient & fc, FileClient
 
 	if (ctime - speed_set_time>10000)
 	{
-		int64 received_data_bytes = fc.getTransferredBytes() + (fc_chunked != NULL ? fc_chunked->getTransferredBytes() : 0);
+		int64 received_data_bytes = fc.getTransferredBytes() + (fc_chunked != NULL ? fc_chunked->getTransferredBytes() : 0)
+			+ server_download->getParallelTransferredBytes();
 
 		int64 new_bytes = received_data_bytes - last_speed_received_bytes;
 		int64 passed_time = ctime - speed_set_time;
@@ -733,17 +833,21 @@ void FileBackup::calculateDownloadSpeed(int64 ctime, FileClient & fc, FileClient
 					speed_bpms);
 			}
 
+			ServerStatus::setProcessStageStats(clientname, status_id,
+				telemetry.getStats());
+
 			last_speed_received_bytes = received_data_bytes;
 		}
 	}
 }
 
 void FileBackup::calculateEtaFileBackup( int64 &last_eta_update, int64& eta_set_time, int64 ctime, FileClient &fc, FileClientChunked* fc_chunked,
-	int64 linked_bytes, int64 &last_eta_received_bytes, double &eta_estimated_speed, _i64 files_size )
+	ServerDownloadThread* server_download, int64 linked_bytes, int64 &last_eta_received_bytes, double &eta_estimated_speed, _i64 files_size )
 {
 	last_eta_update=ctime;
 
-	int64 received_data_bytes = fc.getReceivedDataBytes(true) + (fc_chunked?fc_chunked->getReceivedDataBytes(true):0) + linked_bytes;
+	int64 received_data_bytes = fc.getReceivedDataBytes(true) + (fc_chunked?fc_chunked->getReceivedDataBytes(true):0)
+		+ server_download->getParallelReceivedDataBytes(true) + linked_bytes;
 
 	int64 new_bytes =  received_data_bytes - last_eta_received_bytes;
 	int64 passed_time = Server->getTimeMS() - eta_set_time;
@@ -822,14 +926,17 @@ bool FileBackup::doBackup()
 	pingthread =new ServerPingThread(client_main, clientname, status_id, client_main->getProtocolVersions().eta_version>0, server_token);
 	pingthread_ticket=Server->getThreadPool()->execute(pingthread, "client ping");
 
-	local_hash.reset(new BackupServerHash(NULL, clientid, use_snapshots, use_reflink, use_tmpfiles, logid, use_snapshots, max_file_id));
+	local_hash.reset(new BackupServerHash(NULL, clientid, use_snapshots, use_reflink, use_tmpfiles, logid, use_snapshots, max_file_id, &telemetry));
 	local_hash->setupDatabase();
 
-	createHashThreads(use_reflink, server_settings->getSettings()->ignore_disk_errors);
+	createHashThreads(use_reflink, server_settings->getSettings()->ignore_disk_errors,
+		server_settings->getSettings()->file_hash_threads);
 	
 
 	bool backup_result = doFileBackup();
 
+	telemetry.logSummary(logid);
+
 	if(pingthread!=NULL)
 	{
 		pingthread->setStop(true);
@@ -1071,6 +1178,17 @@ void FileBackup::log_progress(const std::string & fn, int64 total, int64 downloa
 	}
 }
 
+void FileBackup::log_chunk_window(const std::string & fn, unsigned int window, unsigned int in_flight, int64 min_rtt_ms)
+{
+	std::string fn_wo_token = fn;
+	if (getuntil("/", fn).find("|") != std::string::npos)
+	{
+		fn_wo_token = getafter("|", fn);
+	}
+
+	ServerLogger::Log(logid, "Chunk window for \"" + fn_wo_token + "\": " + convert(window) + " chunks (" + convert(in_flight) + " in flight, min RTT " + convert(min_rtt_ms) + "ms)", LL_DEBUG);
+}
+
 bool FileBackup::create_hardlink(const std::string & linkname, const std::string & fname, bool use_ioref, bool * too_many_links, bool* copy)
 {
 	if (use_ioref && BackupServer::isReflinkCopy())
@@ -1208,18 +1326,18 @@ void FileBackup::waitForFileThreads(void)
 	SStatus status=ServerStatus::getStatus(clientname);
 	hashpipe->Write("flush");
 	hashpipe_prepare->Write("flush");
-	_u32 hashqueuesize=(_u32)hashpipe->getNumElements()+(bsh->isWorking()?1:0);
-	_u32 prepare_hashqueuesize=(_u32)hashpipe_prepare->getNumElements()+(bsh_prepare->isWorking()?1:0);
+	_u32 hashqueuesize=(_u32)(hashpipe->getNumElements()+numHashThreadsQueued()+numHashThreadsWorking());
+	_u32 prepare_hashqueuesize=(_u32)(hashpipe_prepare->getNumElements()+numPrepareHashThreadsWorking());
 	while(hashqueuesize>0 || prepare_hashqueuesize>0)
 	{
 		ServerStatus::setProcessQueuesize(clientname, status_id, prepare_hashqueuesize, hashqueuesize);
 		Server->wait(1000);
-		hashqueuesize=(_u32)hashpipe->getNumElements()+(bsh->isWorking()?1:0);
-		prepare_hashqueuesize=(_u32)hashpipe_prepare->getNumElements()+(bsh_prepare->isWorking()?1:0);
+		hashqueuesize=(_u32)(hashpipe->getNumElements()+numHashThreadsQueued()+numHashThreadsWorking());
+		prepare_hashqueuesize=(_u32)(hashpipe_prepare->getNumElements()+numPrepareHashThreadsWorking());
 	}
 	{
 		Server->wait(10);
-		while(bsh->isWorking()) Server->wait(1000);
+		while(numHashThreadsWorking()>0) Server->wait(1000);
 	}	
 
 	ServerStatus::setProcessQueuesize(clientname, status_id, 0, 0);
@@ -2180,6 +2298,46 @@ bool FileBackup::createSymlink(const std::string& name, size_t depth, const std:
 	return os_link_symbolic(target, os_file_prefix(name), NULL, &isdir);
 }
 
+void FileBackup::addParallelDownloadConnections(ServerDownloadThread* server_download, bool with_chunked)
+{
+	int n_connections = (std::min)(server_settings->getSettings()->file_download_connections, max_download_connections);
+
+	std::string identity = client_main->getIdentity();
+	for (int i = 1; i < n_connections; ++i)
+	{
+		std::auto_ptr<FileClient> fc(new FileClient(false, identity, client_main->getProtocolVersions().filesrv_protocol_version,
+			client_main->isOnInternetConnection(), client_main, use_tmpfiles ? NULL : this));
+
+		_u32 rc = client_main->getClientFilesrvConnection(fc.get(), server_settings.get(), 10000);
+		if (rc != ERR_CONNECTED)
+		{
+			ServerLogger::Log(logid, "Could not open additional file download connection to " + clientname + ". Errorcode: " + fc->getErrorString(rc) + " (" + convert(rc) + ")", LL_WARNING);
+			break;
+		}
+		fc->setProgressLogCallback(this);
+
+		std::auto_ptr<FileClientChunked> fc_chunked;
+		if (with_chunked)
+		{
+			if (!client_main->getClientChunkedFilesrvConnection(fc_chunked, server_settings.get(), this, 10000)
+				|| fc_chunked->hasError())
+			{
+				ServerLogger::Log(logid, "Could not open additional chunked file download connection to " + clientname, LL_WARNING);
+				break;
+			}
+			fc_chunked->setProgressLogCallback(this);
+			fc_chunked->setDestroyPipe(true);
+		}
+
+		server_download->addParallelConnection(fc.release(), fc_chunked.release());
+	}
+
+	if (server_download->getNumConnections() > 1)
+	{
+		ServerLogger::Log(logid, "Downloading files using " + convert(server_download->getNumConnections()) + " connections", LL_DEBUG);
+	}
+}
+
 bool FileBackup::startFileMetadataDownloadThread()
 {
 
@@ -2223,7 +2381,7 @@ bool FileBackup::startFileMetadataDownloadThread()
 			return false;
 		}
 
-		local_hash2.reset(new BackupServerHash(NULL, clientid, use_snapshots, use_reflink, use_tmpfiles, logid, use_snapshots, max_file_id));
+		local_hash2.reset(new BackupServerHash(NULL, clientid, use_snapshots, use_reflink, use_tmpfiles, logid, use_snapshots, max_file_id, &telemetry));
 
 		metadata_apply_thread.reset(new server::FileMetadataDownloadThread::FileMetadataApplyThread(metadata_download_thread.get(),
 			backuppath_hashes, backuppath, client_main, local_hash2.get(), filepath_corrections, max_file_id));
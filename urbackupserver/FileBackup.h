@@ -10,6 +10,7 @@
 #include "../urbackupcommon/file_metadata.h"
 #include "server_log.h"
 #include "FileMetadataDownloadThread.h"
+#include "BackupTelemetry.h"
 #include <set>
 
 class ClientMain;
@@ -18,6 +19,7 @@ class BackupServerPrepareHash;
 class ServerPingThread;
 class FileIndex;
 class PhashLoad;
+class ServerDownloadThread;
 
 namespace
 {
@@ -75,7 +77,7 @@ public:
 	MaxFileId()
 		: mutex(Server->createMutex()),
 		max_downloaded(std::string::npos), max_preprocessed(0),
-		min_downloaded(0)
+		min_downloaded(0), max_done(0), has_done(false)
 	{}
 
 	void setMinDownloaded(size_t id)
@@ -88,32 +90,36 @@ public:
 		min_downloaded = id+1;
 	}
 
+	//File with this id is completely processed (or failed)
 	void setMaxDownloaded(size_t id)
 	{
 		IScopedLock lock(mutex.get());
 
-		for (size_t i = 0; i < postponed.size();)
-		{
-			if (postponed[i] == id)
-			{
-				postponed.erase(postponed.begin() + i);
-			}
-			else if (id > postponed[i])
-			{
-				id = postponed[i] - 1;
-				++i;
-			}
-			else
-			{
-				++i;
-			}
-		}
+		outstanding.erase(id);
 
-		max_downloaded = id + 1;
-		if (max_downloaded >= min_downloaded)
+		if (!has_done || id > max_done)
 		{
-			max_downloaded = std::string::npos;
+			max_done = id;
+			has_done = true;
 		}
+
+		updateMaxDownloaded();
+	}
+
+	void startHashing(size_t id)
+	{
+		IScopedLock lock(mutex.get());
+		outstanding.insert(id);
+		updateMaxDownloaded();
+	}
+
+	//Called when a file is queued on one of several download connections.
+	//Must be followed by setMaxDownloaded(id) once the download finished or failed
+	void startDownloading(size_t id)
+	{
+		IScopedLock lock(mutex.get());
+		outstanding.insert(id);
+		updateMaxDownloaded();
 	}
 
 	void setMaxPreProcessed(size_t id)
@@ -138,13 +144,17 @@ public:
 		IScopedLock lock(mutex.get());
 		std::string ret= "max_downloaded="+convert(max_downloaded)
 			+" max_preprocessed="+convert(max_preprocessed)
-			+" min_downloaded="+convert(min_downloaded)+" postponed.size="+convert(postponed.size());
+			+" min_downloaded="+convert(min_downloaded)
+			+" max_done="+convert(max_done)
+			+" outstanding.size="+convert(outstanding.size());
 
-		if (!postponed.empty())
+		if (!outstanding.empty())
 		{
-			ret += " postponed:";
-			for (size_t i = 0; i < postponed.size(); ++i)
-				ret += " " + convert(postponed[i]);
+			ret += " outstanding:";
+			size_t n = 0;
+			for (std::set<size_t>::iterator it = outstanding.begin();
+				it != outstanding.end() && n < 10; ++it, ++n)
+				ret += " " + convert(*it);
 		}
 
 		return ret;
@@ -159,15 +169,42 @@ public:
 	void postponeDownloaded(size_t id)
 	{
 		IScopedLock lock(mutex.get());
-		postponed.push_back(id);
+		outstanding.insert(id);
+		updateMaxDownloaded();
 	}
 
 private:
+	//Files finish out of order (postponed downloads, multiple download
+	//connections, multiple prepare and hash threads). Everything up to the
+	//largest finished id is done, except the ids which were started (queued,
+	//postponed or passed to hashing) and did not finish yet
+	void updateMaxDownloaded()
+	{
+		size_t low_water = has_done ? max_done + 1 : min_downloaded;
+
+		if (!outstanding.empty()
+			&& *outstanding.begin() < low_water)
+		{
+			low_water = *outstanding.begin();
+		}
+
+		if (low_water >= min_downloaded)
+		{
+			max_downloaded = std::string::npos;
+		}
+		else
+		{
+			max_downloaded = low_water;
+		}
+	}
+
 	std::auto_ptr<IMutex> mutex;
 	size_t max_downloaded;
 	size_t max_preprocessed;
 	size_t min_downloaded;
-	std::vector<size_t> postponed;
+	std::set<size_t> outstanding;
+	size_t max_done;
+	bool has_done;
 };
 
 class FileBackup : public Backup, public FileClient::ProgressLogCallback, public FileClient::NoFreeSpaceCallback,
@@ -198,6 +235,7 @@ public:
 	static std::string fixFilenameForOS(std::string fn, std::set<std::string>& samedir_filenames, const std::string& curr_path, bool log_warnings, logid_t logid, FilePathCorrections& filepath_corrections);
 
 	virtual void log_progress(const std::string& fn, int64 total, int64 downloaded, int64 speed_bps);
+	virtual void log_chunk_window(const std::string& fn, unsigned int window, unsigned int in_flight, int64 min_rtt_ms);
 
 	virtual bool handle_not_enough_space(const std::string & path);
 
@@ -216,12 +254,17 @@ protected:
 	void logVssLogdata(int64 vss_duration_s);
 	bool getTokenFile(FileClient &fc, bool hashed_transfer, bool request);
 	std::string clientlistName(int ref_backupid);
-	void createHashThreads(bool use_reflink, bool ignore_hash_mismatches);
+	void createHashThreads(bool use_reflink, bool ignore_hash_mismatches, int n_threads);
 	void destroyHashThreads();
+	bool hashThreadsHaveError();
+	size_t numHashThreadsWorking();
+	size_t numHashThreadsQueued();
+	size_t numPrepareHashThreadsWorking();
 	_i64 getIncrementalSize(IFile *f, const std::vector<size_t> &diffs, bool& backup_with_components, bool all=false);
-	void calculateDownloadSpeed(int64 ctime, FileClient &fc, FileClientChunked* fc_chunked);
+	void calculateDownloadSpeed(int64 ctime, FileClient &fc, FileClientChunked* fc_chunked, ServerDownloadThread* server_download);
 	void calculateEtaFileBackup( int64 &last_eta_update, int64& eta_set_time, int64 ctime, FileClient &fc, FileClientChunked* fc_chunked,
-		int64 linked_bytes, int64 &last_eta_received_bytes, double &eta_estimated_speed, _i64 files_size );
+		ServerDownloadThread* server_download, int64 linked_bytes, int64 &last_eta_received_bytes, double &eta_estimated_speed, _i64 files_size );
+	void addParallelDownloadConnections(ServerDownloadThread* server_download, bool with_chunked);
 	bool hasChange(size_t line, const std::vector<size_t> &diffs);
 	bool link_file(const std::string &fn, const std::string &short_fn, const std::string &curr_path,
 		const std::string &os_path, const std::string& sha2, _i64 filesize, bool add_sql, FileMetadata& metadata);
@@ -266,10 +309,10 @@ protected:
 
 	IPipe *hashpipe;
 	IPipe *hashpipe_prepare;
-	BackupServerHash *bsh;
-	THREADPOOL_TICKET bsh_ticket;
-	BackupServerPrepareHash *bsh_prepare;
-	THREADPOOL_TICKET bsh_prepare_ticket;
+	std::vector<BackupServerHash*> bsh;
+	std::vector<THREADPOOL_TICKET> bsh_tickets;
+	std::vector<BackupServerPrepareHash*> bsh_prepare;
+	std::vector<THREADPOOL_TICKET> bsh_prepare_tickets;
 	std::auto_ptr<BackupServerHash> local_hash;
 	std::auto_ptr<BackupServerHash> local_hash2;
 
@@ -302,4 +345,6 @@ protected:
 	THREADPOOL_TICKET phash_load_ticket;
 
 	MaxFileId max_file_id;
+
+	BackupTelemetry telemetry;
 };
@@ -27,19 +27,19 @@ const unsigned int max_wait_time=1000;
 const unsigned int max_wait_time=30000;
 #endif
 const size_t min_size_no_wait=10000;
-
-std::map<FileIndex::SIndexKey, int64> FileIndex::cache_buffer_1;
-std::map<FileIndex::SIndexKey, int64> FileIndex::cache_buffer_2;
-std::map<FileIndex::SIndexKey, int64>* FileIndex::active_cache_buffer=&cache_buffer_1;
-std::map<FileIndex::SIndexKey, int64>* FileIndex::other_cache_buffer=&cache_buffer_2;
-
-
-
+//Number of independently locked write-behind buffers. Keys with the same
+//hash and filesize always end up in the same shard
+const size_t c_cache_shards=32;
+const size_t max_shard_size=max_buffer_size/c_cache_shards;
+const size_t min_shard_size_no_wait=min_size_no_wait/c_cache_shards;
+
+FileIndex::SCacheShard* FileIndex::shards=NULL;
+FileIndex* FileIndex::shards_owner=NULL;
 IMutex *FileIndex::mutex=NULL;
 ICondition *FileIndex::cond=NULL;
 bool FileIndex::do_shutdown=false;
+bool FileIndex::shard_full=false;
 bool FileIndex::do_flush=false;
-bool FileIndex::do_accept = true;
 
 
 void FileIndex::operator()(void)
@@ -47,96 +47,163 @@ void FileIndex::operator()(void)
 	mutex=Server->createMutex();
 	cond=Server->createCondition();
 
+	SCacheShard* new_shards = new SCacheShard[c_cache_shards];
+	for(size_t i=0;i<c_cache_shards;++i)
+	{
+		new_shards[i].mutex=Server->createMutex();
+		new_shards[i].cond=Server->createCondition();
+	}
+	shards=new_shards;
+	shards_owner=this;
+
 	while(true)
 	{
-		std::map<FileIndex::SIndexKey, int64>* local_buf;
+		bool flush_requested;
+		bool shutdown_requested;
 
 		{
 			IScopedLock lock(mutex);
 
-			if(do_shutdown &&
-				cache_buffer_1.empty() &&
-				cache_buffer_2.empty() )
+			int64 starttime=Server->getTimeMS();
+
+			while(!do_shutdown && !do_flush && !shard_full
+				&& Server->getTimeMS()-starttime<max_wait_time)
 			{
-				break;
+				cond->wait(&lock, max_wait_time);
 			}
 
-			while(active_cache_buffer->empty() && !do_shutdown)
+			flush_requested=do_flush;
+			shutdown_requested=do_shutdown;
+			shard_full=false;
+		}
+
+		bool has_data=false;
+		for(size_t i=0;i<c_cache_shards;++i)
+		{
+			IScopedLock lock(shards[i].mutex);
+			if(!shards[i].active.empty())
 			{
-				do_flush=false;
-				int64 starttime=Server->getTimeMS();
+				shards[i].active.swap(shards[i].flushing);
+				has_data=true;
+			}
+		}
 
-				while(active_cache_buffer->size()<min_size_no_wait
-					&& Server->getTimeMS()-starttime<max_wait_time
-					&& !do_shutdown && !do_flush)
-				{
-					cond->wait(&lock, max_wait_time);
-				}
-			}			
+		if(has_data)
+		{
+			start_transaction();
 
-			local_buf=active_cache_buffer;
-			
-			if(active_cache_buffer==&cache_buffer_1)
+			for(size_t i=0;i<c_cache_shards;++i)
 			{
-				active_cache_buffer=&cache_buffer_2;
-				other_cache_buffer=&cache_buffer_1;
+				//Only this thread modifies the flushing buffers. Readers
+				//may access them concurrently while holding the shard lock
+				std::map<FileIndex::SIndexKey, int64>& local_buf = shards[i].flushing;
+
+				for(std::map<FileIndex::SIndexKey, int64>::iterator it=local_buf.begin();
+					it!=local_buf.end();++it)
+				{
+					if(it->second!=0)
+					{
+						FILEENTRY_DEBUG(Server->Log("LMDB: PUT clientid=" + convert(it->first.getClientid()) 
+							+ " filesize=" + convert(it->first.getFilesize())
+							+ " hash=" + base64_encode(reinterpret_cast<const unsigned char*>(it->first.getHash()), bytes_in_index)
+							+ " target=" + convert(it->second), LL_DEBUG));
+						put(it->first, it->second);
+					}
+					else
+					{
+						FILEENTRY_DEBUG(Server->Log("LMDB: DEL clientid=" + convert(it->first.getClientid()) 
+							+ " filesize=" + convert(it->first.getFilesize())
+							+ " hash="+base64_encode(reinterpret_cast<const unsigned char*>(it->first.getHash()), bytes_in_index), LL_DEBUG));
+						del(it->first);
+					}
+				}
 			}
-			else
+
+			commit_transaction();
+
+			for(size_t i=0;i<c_cache_shards;++i)
 			{
-				active_cache_buffer=&cache_buffer_1;
-				other_cache_buffer=&cache_buffer_2;
+				IScopedLock lock(shards[i].mutex);
+				if(!shards[i].flushing.empty())
+				{
+					shards[i].flushing.clear();
+					shards[i].cond->notify_all();
+				}
 			}
 		}
 
-		start_transaction();
-
-		for(std::map<FileIndex::SIndexKey, int64>::iterator it=local_buf->begin();
-			it!=local_buf->end();++it)
 		{
-			if(it->second!=0)
-			{
-				FILEENTRY_DEBUG(Server->Log("LMDB: PUT clientid=" + convert(it->first.getClientid()) 
-					+ " filesize=" + convert(it->first.getFilesize())
-					+ " hash=" + base64_encode(reinterpret_cast<const unsigned char*>(it->first.getHash()), bytes_in_index)
-					+ " target=" + convert(it->second), LL_DEBUG));
-				put(it->first, it->second);
-			}
-			else
+			IScopedLock lock(mutex);
+			if(flush_requested)
 			{
-				FILEENTRY_DEBUG(Server->Log("LMDB: DEL clientid=" + convert(it->first.getClientid()) 
-					+ " filesize=" + convert(it->first.getFilesize())
-					+ " hash="+base64_encode(reinterpret_cast<const unsigned char*>(it->first.getHash()), bytes_in_index), LL_DEBUG));
-				del(it->first);
+				do_flush=false;
+				cond->notify_all();
 			}
 		}
 
-		commit_transaction();
-
+		if(shutdown_requested && !has_data)
 		{
-			IScopedLock lock(mutex);
-			local_buf->clear();
-			do_flush=false;
+			break;
 		}
 	}
 
 	delete this;
 }
 
-void FileIndex::put_delayed(const SIndexKey& key, int64 value)
+FileIndex::~FileIndex(void)
 {
-	IScopedLock lock(mutex);
+	//The shards are shared by all index instances and belong to the writer thread
+	if(shards_owner!=this)
+	{
+		return;
+	}
 
-	while(active_cache_buffer->size()>=max_buffer_size || !do_accept)
+	for(size_t i=0;i<c_cache_shards;++i)
 	{
-		lock.relock(NULL);
-		Server->wait(10);
-		lock.relock(mutex);
+		Server->destroy(shards[i].mutex);
+		Server->destroy(shards[i].cond);
 	}
+	delete[] shards;
+	shards=NULL;
+	shards_owner=NULL;
+}
+
+FileIndex::SCacheShard& FileIndex::get_shard(const SIndexKey& key)
+{
+	//The key starts with a cryptographic hash, so its first byte is evenly distributed
+	return shards[static_cast<unsigned char>(key.getHash()[0]) % c_cache_shards];
+}
 
-	(*active_cache_buffer)[key]=value;
+void FileIndex::notify_shard_full()
+{
+	IScopedLock lock(mutex);
+	shard_full=true;
 	cond->notify_all();
 }
 
+void FileIndex::put_delayed(const SIndexKey& key, int64 value)
+{
+	SCacheShard& shard = get_shard(key);
+
+	size_t shard_size;
+	{
+		IScopedLock lock(shard.mutex);
+
+		while(shard.active.size()>=max_shard_size || !shard.do_accept)
+		{
+			shard.cond->wait(&lock);
+		}
+
+		shard.active[key]=value;
+		shard_size = shard.active.size();
+	}
+
+	if(shard_size==min_shard_size_no_wait)
+	{
+		notify_shard_full();
+	}
+}
+
 void FileIndex::del_delayed(const SIndexKey& key)
 {
 	put_delayed(key, 0);
@@ -145,15 +212,16 @@ void FileIndex::del_delayed(const SIndexKey& key)
 int64 FileIndex::get_with_cache(const FileIndex::SIndexKey& key)
 {
 	{
-		IScopedLock lock(mutex);
+		SCacheShard& shard = get_shard(key);
+		IScopedLock lock(shard.mutex);
 
 		int64 ret;
-		if(get_from_cache(key, *active_cache_buffer, ret))
+		if(get_from_cache(key, shard.active, ret))
 		{
 			return ret;
 		}
 
-		if(get_from_cache(key, *other_cache_buffer, ret))
+		if(get_from_cache(key, shard.flushing, ret))
 		{
 			return ret;
 		}
@@ -166,15 +234,16 @@ int64 FileIndex::get_with_cache(const FileIndex::SIndexKey& key)
 int64 FileIndex::get_with_cache_prefer_client(const SIndexKey& key)
 {
 	{
-		IScopedLock lock(mutex);
+		SCacheShard& shard = get_shard(key);
+		IScopedLock lock(shard.mutex);
 
 		int64 ret;
-		if(get_from_cache_prefer_client(key, *active_cache_buffer, ret))
+		if(get_from_cache_prefer_client(key, shard.active, ret))
 		{
 			return ret;
 		}
 
-		if(get_from_cache_prefer_client(key, *other_cache_buffer, ret))
+		if(get_from_cache_prefer_client(key, shard.flushing, ret))
 		{
 			return ret;
 		}
@@ -183,16 +252,55 @@ int64 FileIndex::get_with_cache_prefer_client(const SIndexKey& key)
 	return get_prefer_client(key);
 }
 
+void FileIndex::get_many_with_cache_prefer_client(const std::vector<SIndexKey>& keys, std::vector<int64>& res)
+{
+	res.resize(keys.size());
+
+	std::vector<SIndexKey> db_keys;
+	std::vector<size_t> db_idx;
+
+	for(size_t i=0;i<keys.size();++i)
+	{
+		SCacheShard& shard = get_shard(keys[i]);
+		IScopedLock lock(shard.mutex);
+
+		if(get_from_cache_prefer_client(keys[i], shard.active, res[i]))
+		{
+			continue;
+		}
+
+		if(get_from_cache_prefer_client(keys[i], shard.flushing, res[i]))
+		{
+			continue;
+		}
+
+		db_keys.push_back(keys[i]);
+		db_idx.push_back(i);
+	}
+
+	if(!db_keys.empty())
+	{
+		std::vector<int64> db_res;
+		get_many_prefer_client(db_keys, db_res);
+
+		for(size_t i=0;i<db_idx.size();++i)
+		{
+			res[db_idx[i]] = db_res[i];
+		}
+	}
+}
+
 std::map<int, int64> FileIndex::get_all_clients_with_cache( const SIndexKey& key, bool with_del)
 {
 	std::map<int, int64> ret_cache;
 
 	{
-		IScopedLock lock(mutex);
+		SCacheShard& shard = get_shard(key);
+		IScopedLock lock(shard.mutex);
 
-		get_from_cache_all_clients(key, *other_cache_buffer, ret_cache);
+		get_from_cache_all_clients(key, shard.flushing, ret_cache);
 
-		get_from_cache_all_clients(key, *active_cache_buffer, ret_cache);
+		get_from_cache_all_clients(key, shard.active, ret_cache);
 	}
 
 	std::map<int, int64> ret = get_all_clients(key);
@@ -225,15 +333,16 @@ std::map<int, int64> FileIndex::get_all_clients_with_cache( const SIndexKey& key
 int64 FileIndex::get_with_cache_exact( const SIndexKey& key )
 {
 	{
-		IScopedLock lock(mutex);
+		SCacheShard& shard = get_shard(key);
+		IScopedLock lock(shard.mutex);
 
 		int64 ret;
-		if(get_from_cache_exact(key, *active_cache_buffer, ret))
+		if(get_from_cache_exact(key, shard.active, ret))
 		{
 			return ret;
 		}
 
-		if(get_from_cache_exact(key, *other_cache_buffer, ret))
+		if(get_from_cache_exact(key, shard.flushing, ret))
 		{
 			return ret;
 		}
@@ -319,18 +428,19 @@ void FileIndex::flush()
 	IScopedLock lock(mutex);
 
 	do_flush=true;
+	cond->notify_all();
 
 	while(do_flush)
 	{
-		cond->notify_all();
-		lock.relock(NULL);
-		Server->wait(100);
-		lock.relock(mutex);
+		cond->wait(&lock);
 	}
 }
 
 void FileIndex::stop_accept()
 {
-	IScopedLock lock(mutex);
-	do_accept = false;
+	for(size_t i=0;i<c_cache_shards;++i)
+	{
+		IScopedLock lock(shards[i].mutex);
+		shards[i].do_accept = false;
+	}
 }
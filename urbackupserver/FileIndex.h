@@ -92,12 +92,33 @@ public:
 	};
 #pragma pack()
 
-	virtual ~FileIndex(void) {};
+	struct SCreateEntry
+	{
+		SIndexKey key;
+		int64 id;
+		int64 next_entry;
+		int64 prev_entry;
+		int pointed_to;
+	};
+
+	/**
+	* Supplies the file entries for create() ordered by key ascending
+	* and creation time descending.
+	*/
+	class ICreateSource
+	{
+	public:
+		virtual bool next_entry(size_t n_done, SCreateEntry& entry)=0;
+	};
+
+	virtual ~FileIndex(void);
 
 	virtual bool has_error(void)=0;
 
 	virtual void create(get_data_callback_t get_data_callback, void *userdata)=0;
 
+	virtual void create(ICreateSource* source)=0;
+
 	virtual int64 get(const SIndexKey& key)=0;
 
 	virtual int64 get_any_client(const SIndexKey& key) = 0;
@@ -106,6 +127,11 @@ public:
 
 	virtual std::map<int, int64> get_all_clients(const SIndexKey& key) = 0;
 
+	/**
+	* Looks up multiple keys with get_prefer_client semantics. Keys have to be sorted.
+	*/
+	virtual void get_many_prefer_client(const std::vector<SIndexKey>& keys, std::vector<int64>& res) = 0;
+
 	virtual void start_transaction(void)=0;
 
 	virtual void put(const SIndexKey& key, int64 value)=0;
@@ -120,6 +146,8 @@ public:
 
 	virtual int64 get_with_cache_prefer_client(const SIndexKey& key);
 
+	virtual void get_many_with_cache_prefer_client(const std::vector<SIndexKey>& keys, std::vector<int64>& res);
+
 	virtual void del(const SIndexKey& key)=0;
 
 	static void del_delayed(const SIndexKey& key);
@@ -150,15 +178,29 @@ private:
 
 	void get_from_cache_all_clients( const SIndexKey &key, const std::map<SIndexKey, int64>& cache, std::map<int, int64> &ret );
 
-	static std::map<SIndexKey, int64> cache_buffer_1;
-	static std::map<SIndexKey, int64> cache_buffer_2;
-	static std::map<SIndexKey, int64>* active_cache_buffer;
-	static std::map<SIndexKey, int64>* other_cache_buffer;
-	static std::map<SIndexKey, bool> del_buffer;
+	struct SCacheShard
+	{
+		SCacheShard()
+			: mutex(NULL), cond(NULL), do_accept(true)
+		{}
+
+		IMutex* mutex;
+		ICondition* cond;
+		std::map<SIndexKey, int64> active;
+		std::map<SIndexKey, int64> flushing;
+		bool do_accept;
+	};
+
+	static SCacheShard& get_shard(const SIndexKey& key);
+
+	static void notify_shard_full();
+
+	static SCacheShard* shards;
+	static FileIndex* shards_owner;
 	static IMutex *mutex;
 	static ICondition *cond;
 	static bool do_shutdown;
+	static bool shard_full;
 
 	static bool do_flush;
-	static bool do_accept;
 };
\ No newline at end of file
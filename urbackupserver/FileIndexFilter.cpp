@@ -0,0 +1,201 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "FileIndexFilter.h"
+#include "../Interface/Server.h"
+#include "../stringtools.h"
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+	//One block is one cache line
+	const size_t c_block_words = 8;
+	const size_t c_block_bits = c_block_words * 64;
+	const int64 c_min_entries = 1000000;
+	const int64 c_log_stats_interval = 10000000;
+
+	uint64 read_u64(const char* buf)
+	{
+		uint64 ret;
+		memcpy(&ret, buf, sizeof(ret));
+		return ret;
+	}
+
+	uint64 mix64(uint64 h)
+	{
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ULL;
+		h ^= h >> 33;
+		return h;
+	}
+}
+
+FileIndexFilter::FileIndexFilter(int64 expected_entries, unsigned int bits_per_entry)
+	: ready(false), n_entries(0), n_lookups(0), n_negative(0), n_false_positive(0)
+{
+	if (expected_entries < c_min_entries)
+	{
+		expected_entries = c_min_entries;
+	}
+
+	if (bits_per_entry < 4)
+	{
+		bits_per_entry = 4;
+	}
+
+	n_blocks = static_cast<size_t>((expected_entries*bits_per_entry + c_block_bits - 1) / c_block_bits);
+
+	//Optimal number of hash functions is ln(2)*m/n. Blocked filters
+	//do better with slightly fewer.
+	n_hashes = static_cast<unsigned int>(bits_per_entry*0.6 + 0.5);
+	if (n_hashes < 1) n_hashes = 1;
+	if (n_hashes > 16) n_hashes = 16;
+
+	bits = new std::atomic<uint64>[n_blocks*c_block_words];
+	for (size_t i = 0; i < n_blocks*c_block_words; ++i)
+	{
+		bits[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+FileIndexFilter::~FileIndexFilter()
+{
+	delete[] bits;
+}
+
+void FileIndexFilter::get_pos(const FileIndex::SIndexKey& key, size_t& block, uint64& h)
+{
+	const char* hash = key.getHash();
+	uint64 h1 = mix64(read_u64(hash) ^ static_cast<uint64>(key.getFilesize()));
+	h = mix64(read_u64(hash + sizeof(uint64)) + h1);
+	block = static_cast<size_t>(h1 % n_blocks);
+}
+
+void FileIndexFilter::add(const FileIndex::SIndexKey& key)
+{
+	size_t block;
+	uint64 h;
+	get_pos(key, block, h);
+
+	std::atomic<uint64>* b = &bits[block*c_block_words];
+	uint64 h_a = h & 0xFFFFFFFF;
+	uint64 h_b = (h >> 32) | 1;
+
+	for (unsigned int i = 0; i < n_hashes; ++i)
+	{
+		size_t bit = static_cast<size_t>((h_a + i*h_b) % c_block_bits);
+		b[bit / 64].fetch_or(1ULL << (bit % 64), std::memory_order_relaxed);
+	}
+	n_entries.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool FileIndexFilter::may_contain(const FileIndex::SIndexKey& key)
+{
+	size_t block;
+	uint64 h;
+	get_pos(key, block, h);
+
+	const std::atomic<uint64>* b = &bits[block*c_block_words];
+	uint64 h_a = h & 0xFFFFFFFF;
+	uint64 h_b = (h >> 32) | 1;
+
+	//Pairs with set_ready(). All keys added by the fill thread are visible afterwards
+	if (!ready.load(std::memory_order_acquire))
+	{
+		return true;
+	}
+
+	int64 lookups = n_lookups.fetch_add(1, std::memory_order_relaxed) + 1;
+
+	//Bits of a concurrent add() may not be visible yet. Such a key is reported as
+	//missing, the same as if the lookup had happened before the add
+	bool ret = true;
+	for (unsigned int i = 0; i < n_hashes; ++i)
+	{
+		size_t bit = static_cast<size_t>((h_a + i*h_b) % c_block_bits);
+		if ((b[bit / 64].load(std::memory_order_relaxed) & (1ULL << (bit % 64))) == 0)
+		{
+			n_negative.fetch_add(1, std::memory_order_relaxed);
+			ret = false;
+			break;
+		}
+	}
+
+	if (lookups % c_log_stats_interval == 0)
+	{
+		Server->Log("File entry index filter: " + get_stats_str(), LL_DEBUG);
+	}
+
+	return ret;
+}
+
+void FileIndexFilter::set_ready()
+{
+	ready.store(true, std::memory_order_release);
+}
+
+void FileIndexFilter::add_false_positive()
+{
+	//Misses before the filter was ready were not filtered lookups
+	if (ready.load(std::memory_order_relaxed))
+	{
+		n_false_positive.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+size_t FileIndexFilter::get_memory_usage()
+{
+	return n_blocks*c_block_words*sizeof(uint64);
+}
+
+int64 FileIndexFilter::get_entries()
+{
+	return n_entries.load(std::memory_order_relaxed);
+}
+
+double FileIndexFilter::get_expected_fp_rate()
+{
+	double m = static_cast<double>(n_blocks*c_block_bits);
+	return pow(1.0 - exp(-(double)n_hashes*get_entries() / m), (double)n_hashes);
+}
+
+double FileIndexFilter::get_measured_fp_rate()
+{
+	int64 l_negative = n_negative.load(std::memory_order_relaxed);
+	int64 l_false_positive = n_false_positive.load(std::memory_order_relaxed);
+	//Lookups of keys which are not in the index either get filtered or are false positives
+	int64 n_not_in_index = l_negative + l_false_positive;
+	if (n_not_in_index == 0)
+	{
+		return 0;
+	}
+	return static_cast<double>(l_false_positive) / n_not_in_index;
+}
+
+std::string FileIndexFilter::get_stats_str()
+{
+	return "entries=" + convert(get_entries())
+		+ " memory=" + PrettyPrintBytes(get_memory_usage())
+		+ " lookups=" + convert(n_lookups.load(std::memory_order_relaxed))
+		+ " filtered=" + convert(n_negative.load(std::memory_order_relaxed))
+		+ " expected_fp_rate=" + convert(get_expected_fp_rate()*100) + "%"
+		+ " measured_fp_rate=" + convert(get_measured_fp_rate()*100) + "%";
+}
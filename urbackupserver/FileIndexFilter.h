@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../Interface/Types.h"
+#include "FileIndex.h"
+#include <atomic>
+
+/**
+* Blocked Bloom filter over the (hash, filesize) part of file index keys.
+* If the filter says a key is not present, it is guaranteed not to be in the
+* file index. Entries are never removed (a deleted key may still be in the
+* index for another client), so deletions only slowly increase the false positive rate.
+* Adding and lookups are lock-free.
+*/
+class FileIndexFilter
+{
+public:
+	FileIndexFilter(int64 expected_entries, unsigned int bits_per_entry);
+	~FileIndexFilter();
+
+	void add(const FileIndex::SIndexKey& key);
+
+	//Always returns true until set_ready() was called
+	bool may_contain(const FileIndex::SIndexKey& key);
+
+	//All keys of the file index have been added
+	void set_ready();
+
+	//Called after a positive result from may_contain was not found in the index.
+	//Ignored until set_ready() was called
+	void add_false_positive();
+
+	size_t get_memory_usage();
+
+	int64 get_entries();
+
+	double get_expected_fp_rate();
+
+	double get_measured_fp_rate();
+
+	std::string get_stats_str();
+
+private:
+	void get_pos(const FileIndex::SIndexKey& key, size_t& block, uint64& h);
+
+	std::atomic<uint64>* bits;
+	size_t n_blocks;
+	unsigned int n_hashes;
+
+	std::atomic<bool> ready;
+
+	std::atomic<int64> n_entries;
+	std::atomic<int64> n_lookups;
+	std::atomic<int64> n_negative;
+	std::atomic<int64> n_false_positive;
+};
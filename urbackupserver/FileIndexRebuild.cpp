@@ -0,0 +1,624 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "FileIndexRebuild.h"
+#include "../Interface/Server.h"
+#include "../Interface/Database.h"
+#include "../Interface/DatabaseCursor.h"
+#include "../Interface/Query.h"
+#include "../Interface/Mutex.h"
+#include "../Interface/Thread.h"
+#include "../Interface/ThreadPool.h"
+#include "../stringtools.h"
+#include "../urbackupcommon/os_functions.h"
+#include "serverinterface/helper.h"
+#include "database.h"
+#include <algorithm>
+#include <set>
+#include <memory>
+#include <string.h>
+
+namespace
+{
+	const std::string rebuild_dir = "urbackup/fileindex_rebuild";
+	const size_t c_write_chunk_size = 16 * 1024 * 1024;
+	const size_t c_min_merge_buffer = 64 * 1024;
+	const size_t c_max_merge_buffer = 4 * 1024 * 1024;
+	const int64 c_progress_log_interval = 10000;
+
+	typedef FileIndexRebuild::SRunEntry SRunEntry;
+
+	bool run_entry_less(const SRunEntry& a, const SRunEntry& b)
+	{
+		int mres = memcmp(&a.key, &b.key, sizeof(FileIndex::SIndexKey));
+		if (mres != 0)
+		{
+			return mres < 0;
+		}
+		//Newest entry first
+		if (a.created != b.created)
+		{
+			return a.created > b.created;
+		}
+		return a.id < b.id;
+	}
+
+	std::string range_done_fn(int64 range_start)
+	{
+		return rebuild_dir + "/range_" + convert(range_start) + ".done";
+	}
+
+	bool write_file_synced(const std::string& fn, const std::string& data)
+	{
+		std::auto_ptr<IFile> f(Server->openFile(fn, MODE_WRITE));
+		if (f.get() == NULL)
+		{
+			Server->Log("Error opening file \"" + fn + "\" for writing. " + os_last_error_str(), LL_ERROR);
+			return false;
+		}
+
+		if (f->Write(data) != data.size()
+			|| !f->Sync())
+		{
+			Server->Log("Error writing to file \"" + fn + "\". " + os_last_error_str(), LL_ERROR);
+			return false;
+		}
+
+		return true;
+	}
+
+	struct SSortState
+	{
+		IMutex* mutex;
+		std::vector<int64> ranges;
+		size_t next_range;
+		int64 range_ids;
+		size_t max_entries;
+		int64 rows_done;
+		size_t ranges_done;
+		bool has_error;
+	};
+
+	class RangeSortThread : public IThread
+	{
+	public:
+		RangeSortThread(SSortState& state)
+			: state(state)
+		{
+		}
+
+		void operator()()
+		{
+			IDatabase* db = Server->getDatabase(Server->getThreadID(), URBACKUPDB_SERVER_FILES);
+			if (db == NULL)
+			{
+				Server->Log("Error opening files database for sorting file entries", LL_ERROR);
+				IScopedLock lock(state.mutex);
+				state.has_error = true;
+				return;
+			}
+
+			IQuery* q_read = db->Prepare("SELECT id, shahash, filesize, clientid, next_entry, prev_entry, pointed_to, created FROM files WHERE id>=? AND id<?");
+
+			std::vector<SRunEntry> entries;
+			entries.reserve(state.max_entries);
+
+			while (true)
+			{
+				int64 range_start;
+				{
+					IScopedLock lock(state.mutex);
+					if (state.has_error
+						|| state.next_range >= state.ranges.size())
+					{
+						break;
+					}
+					range_start = state.ranges[state.next_range];
+					++state.next_range;
+				}
+
+				if (!sort_range(q_read, range_start, entries))
+				{
+					IScopedLock lock(state.mutex);
+					state.has_error = true;
+					break;
+				}
+			}
+
+			Server->destroyDatabases(Server->getThreadID());
+		}
+
+	private:
+		bool sort_range(IQuery* q_read, int64 range_start, std::vector<SRunEntry>& entries)
+		{
+			q_read->Bind(range_start);
+			q_read->Bind(range_start + state.range_ids);
+			IDatabaseCursor* cur = q_read->Cursor();
+
+			size_t part = 0;
+			int64 rows = 0;
+			db_single_result res;
+			while (cur->next(res))
+			{
+				const std::string& shahash = res["shahash"];
+
+				SRunEntry entry;
+				entry.key = FileIndex::SIndexKey(shahash.c_str(), watoi64(res["filesize"]), watoi(res["clientid"]));
+				entry.created = watoi64(res["created"]);
+				entry.id = watoi64(res["id"]);
+				entry.next_entry = watoi64(res["next_entry"]);
+				entry.prev_entry = watoi64(res["prev_entry"]);
+				entry.pointed_to = watoi(res["pointed_to"]) != 0 ? 1 : 0;
+
+				entries.push_back(entry);
+
+				if (entries.size() >= state.max_entries)
+				{
+					if (!write_run(range_start, part, entries))
+					{
+						q_read->Reset();
+						return false;
+					}
+					++part;
+				}
+
+				++rows;
+				if (rows % 10000 == 0)
+				{
+					IScopedLock lock(state.mutex);
+					state.rows_done += 10000;
+				}
+			}
+
+			bool has_error = cur->has_error();
+			q_read->Reset();
+
+			if (has_error)
+			{
+				Server->Log("Error reading file entries starting at id " + convert(range_start), LL_ERROR);
+				return false;
+			}
+
+			if (!entries.empty()
+				&& !write_run(range_start, part, entries))
+			{
+				return false;
+			}
+
+			if (!write_file_synced(range_done_fn(range_start), std::string()))
+			{
+				return false;
+			}
+
+			IScopedLock lock(state.mutex);
+			state.rows_done += rows % 10000;
+			++state.ranges_done;
+
+			return true;
+		}
+
+		bool write_run(int64 range_start, size_t part, std::vector<SRunEntry>& entries)
+		{
+			std::sort(entries.begin(), entries.end(), run_entry_less);
+
+			std::string fn = rebuild_dir + "/run_" + convert(range_start) + "_" + convert(part);
+			std::auto_ptr<IFile> f(Server->openFile(fn, MODE_WRITE));
+			if (f.get() == NULL)
+			{
+				Server->Log("Error opening sorted run file \"" + fn + "\". " + os_last_error_str(), LL_ERROR);
+				return false;
+			}
+
+			const char* data = reinterpret_cast<const char*>(entries.data());
+			size_t data_size = entries.size()*sizeof(SRunEntry);
+			for (size_t written = 0; written < data_size;)
+			{
+				_u32 towrite = static_cast<_u32>((std::min)(c_write_chunk_size, data_size - written));
+				if (f->Write(data + written, towrite) != towrite)
+				{
+					Server->Log("Error writing sorted run file \"" + fn + "\". " + os_last_error_str(), LL_ERROR);
+					return false;
+				}
+				written += towrite;
+			}
+
+			if (!f->Sync())
+			{
+				Server->Log("Error syncing sorted run file \"" + fn + "\". " + os_last_error_str(), LL_ERROR);
+				return false;
+			}
+
+			entries.clear();
+
+			return true;
+		}
+
+		SSortState& state;
+	};
+}
+
+FileIndexRebuild::FileIndexRebuild(SStartupStatus& status, size_t n_threads, size_t max_memory)
+	: status(status), n_threads(n_threads), max_memory(max_memory),
+	n_total(0), n_merged(0), merge_starttime(0), last_log_time(0), last_log_merged(0),
+	_has_error(false)
+{
+	if (this->n_threads < 1)
+	{
+		this->n_threads = 1;
+	}
+}
+
+FileIndexRebuild::~FileIndexRebuild()
+{
+	for (size_t i = 0; i < runs.size(); ++i)
+	{
+		delete runs[i];
+	}
+}
+
+bool FileIndexRebuild::load_params(int64 n_files, int64 min_id, int64 max_id, int64 range_ids)
+{
+	std::string params = convert(n_files) + " " + convert(min_id) + " " + convert(max_id) + " " + convert(range_ids);
+
+	if (os_directory_exists(rebuild_dir))
+	{
+		if (getFile(rebuild_dir + "/params") == params)
+		{
+			return true;
+		}
+
+		Server->Log("Sorted file entries are from a different files table. Discarding them...", LL_INFO);
+		cleanup();
+	}
+
+	if (!os_create_dir(rebuild_dir))
+	{
+		Server->Log("Error creating directory \"" + rebuild_dir + "\". " + os_last_error_str(), LL_ERROR);
+		return false;
+	}
+
+	return write_file_synced(rebuild_dir + "/params", params);
+}
+
+bool FileIndexRebuild::sort_runs(int64 n_files)
+{
+	IDatabase* db = Server->getDatabase(Server->getThreadID(), URBACKUPDB_SERVER_FILES);
+
+	db_results res = db->Read("SELECT MIN(id) AS min_id, MAX(id) AS max_id FROM files");
+	if (res.empty())
+	{
+		Server->Log("Error getting id range of files table", LL_ERROR);
+		return false;
+	}
+
+	int64 min_id = watoi64(res[0]["min_id"]);
+	int64 max_id = watoi64(res[0]["max_id"]);
+
+	SSortState state;
+	state.max_entries = (std::max)(max_memory / n_threads / sizeof(SRunEntry), static_cast<size_t>(1000));
+
+	//Ranges are sized for the average id density. Dense ranges are split into several runs.
+	state.range_ids = static_cast<int64>(state.max_entries);
+	if (n_files > 0
+		&& max_id - min_id + 1 > n_files)
+	{
+		state.range_ids = static_cast<int64>(static_cast<double>(state.max_entries)*(max_id - min_id + 1) / n_files);
+	}
+
+	if (!load_params(n_files, min_id, max_id, state.range_ids))
+	{
+		return false;
+	}
+
+	std::set<int64> done_ranges;
+	std::vector<SFile> files = getFiles(rebuild_dir);
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		if (next(files[i].name, 0, "range_"))
+		{
+			done_ranges.insert(watoi64(getbetween("range_", ".done", files[i].name)));
+		}
+	}
+
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		if (next(files[i].name, 0, "run_")
+			&& done_ranges.find(watoi64(getbetween("run_", "_", files[i].name))) == done_ranges.end())
+		{
+			Server->deleteFile(rebuild_dir + "/" + files[i].name);
+		}
+	}
+
+	size_t n_ranges = 0;
+	if (n_files > 0)
+	{
+		for (int64 range_start = min_id; range_start <= max_id; range_start += state.range_ids)
+		{
+			++n_ranges;
+			if (done_ranges.find(range_start) == done_ranges.end())
+			{
+				state.ranges.push_back(range_start);
+			}
+		}
+	}
+
+	if (state.ranges.size() < n_ranges)
+	{
+		Server->Log("Resuming sorting of file entries. " + convert(n_ranges - state.ranges.size()) + " of " + convert(n_ranges) + " ranges already sorted.", LL_INFO);
+	}
+
+	Server->Log("Sorting " + convert(state.ranges.size()) + " ranges of file entries with " + convert(n_threads) + " threads...", LL_INFO);
+
+	std::auto_ptr<IMutex> mutex(Server->createMutex());
+	state.mutex = mutex.get();
+	state.next_range = 0;
+	state.rows_done = 0;
+	state.ranges_done = n_ranges - state.ranges.size();
+	state.has_error = false;
+
+	std::vector<RangeSortThread*> threads;
+	std::vector<THREADPOOL_TICKET> tickets;
+	for (size_t i = 0; i < n_threads && i < state.ranges.size(); ++i)
+	{
+		threads.push_back(new RangeSortThread(state));
+		tickets.push_back(Server->getThreadPool()->execute(threads[i], "fileindex rebuild"));
+	}
+
+	int64 starttime = Server->getTimeMS();
+	int64 last_rows_done = 0;
+	int64 last_time = starttime;
+	while (!Server->getThreadPool()->waitFor(tickets, static_cast<int>(c_progress_log_interval)))
+	{
+		int64 rows_done;
+		size_t ranges_done;
+		{
+			IScopedLock lock(state.mutex);
+			rows_done = state.rows_done;
+			ranges_done = state.ranges_done;
+		}
+
+		int64 ctime = Server->getTimeMS();
+		int64 rows_per_s = ctime > last_time ? (rows_done - last_rows_done) * 1000 / (ctime - last_time) : 0;
+
+		status.processed_file_entries = static_cast<size_t>(rows_done);
+		status.pc_done = n_ranges > 0 ? 0.5*ranges_done / n_ranges : 0;
+
+		Server->Log("Sorting file entries: " + convert(ranges_done) + " of " + convert(n_ranges) + " ranges sorted, "
+			+ convert(rows_done) + " entries read (" + convert(rows_per_s) + " entries/s)", LL_INFO);
+
+		last_rows_done = rows_done;
+		last_time = ctime;
+	}
+
+	for (size_t i = 0; i < threads.size(); ++i)
+	{
+		delete threads[i];
+	}
+
+	if (state.has_error)
+	{
+		Server->Log("Error while sorting file entries", LL_ERROR);
+		return false;
+	}
+
+	int64 passed_s = (Server->getTimeMS() - starttime) / 1000;
+	Server->Log("Sorted " + convert(state.rows_done) + " file entries in " + PrettyPrintTime(passed_s * 1000)
+		+ (passed_s > 0 ? " (" + convert(state.rows_done / passed_s) + " entries/s)" : ""), LL_INFO);
+
+	return true;
+}
+
+bool FileIndexRebuild::start_merge()
+{
+	std::vector<SFile> files = getFiles(rebuild_dir);
+
+	std::vector<std::string> run_fns;
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		if (next(files[i].name, 0, "run_"))
+		{
+			run_fns.push_back(rebuild_dir + "/" + files[i].name);
+		}
+	}
+
+	size_t buffer_size = c_max_merge_buffer;
+	if (!run_fns.empty())
+	{
+		buffer_size = (std::min)(c_max_merge_buffer, (std::max)(c_min_merge_buffer, max_memory / run_fns.size()));
+	}
+	buffer_size -= buffer_size % sizeof(SRunEntry);
+
+	Server->Log("Merging " + convert(run_fns.size()) + " sorted runs of file entries...", LL_INFO);
+
+	for (size_t i = 0; i < run_fns.size(); ++i)
+	{
+		IFile* f = Server->openFile(run_fns[i], MODE_READ_SEQUENTIAL);
+		if (f == NULL)
+		{
+			Server->Log("Error opening sorted run file \"" + run_fns[i] + "\". " + os_last_error_str(), LL_ERROR);
+			_has_error = true;
+			return false;
+		}
+
+		n_total += f->Size() / sizeof(SRunEntry);
+
+		runs.push_back(new RunReader(f, buffer_size));
+
+		SMergeItem item;
+		item.run = i;
+		if (runs[i]->next(item.entry))
+		{
+			merge_queue.push(item);
+		}
+		else if (runs[i]->has_error())
+		{
+			_has_error = true;
+			return false;
+		}
+	}
+
+	merge_starttime = Server->getTimeMS();
+	last_log_time = merge_starttime;
+
+	return true;
+}
+
+bool FileIndexRebuild::next_entry(size_t n_done, FileIndex::SCreateEntry& entry)
+{
+	if (merge_queue.empty())
+	{
+		return false;
+	}
+
+	SMergeItem item = merge_queue.top();
+	merge_queue.pop();
+
+	entry.key = item.entry.key;
+	entry.id = item.entry.id;
+	entry.next_entry = item.entry.next_entry;
+	entry.prev_entry = item.entry.prev_entry;
+	entry.pointed_to = item.entry.pointed_to;
+
+	size_t run = item.run;
+	if (runs[run]->next(item.entry))
+	{
+		merge_queue.push(item);
+	}
+	else if (runs[run]->has_error())
+	{
+		_has_error = true;
+		return false;
+	}
+
+	++n_merged;
+
+	if (n_merged % 1000 == 0)
+	{
+		status.processed_file_entries = n_done;
+		update_progress(n_merged);
+	}
+
+	return true;
+}
+
+void FileIndexRebuild::update_progress(int64 n_merged)
+{
+	int last_pc = static_cast<int>(status.pc_done * 1000 + 0.5);
+
+	if (n_total > 0)
+	{
+		status.pc_done = 0.5 + 0.5*static_cast<double>(n_merged) / n_total;
+	}
+
+	int curr_pc = static_cast<int>(status.pc_done * 1000 + 0.5);
+
+	int64 ctime = Server->getTimeMS();
+	if (curr_pc != last_pc
+		|| ctime - last_log_time >= c_progress_log_interval)
+	{
+		int64 rows_per_s = ctime > last_log_time ? (n_merged - last_log_merged) * 1000 / (ctime - last_log_time) : 0;
+
+		Server->Log("Creating files index: " + convert((double)curr_pc / 10) + "% finished ("
+			+ convert(rows_per_s) + " entries/s)", LL_INFO);
+
+		last_log_time = ctime;
+		last_log_merged = n_merged;
+	}
+}
+
+bool FileIndexRebuild::has_error()
+{
+	return _has_error;
+}
+
+void FileIndexRebuild::cleanup()
+{
+	if (os_directory_exists(rebuild_dir))
+	{
+		os_remove_nonempty_dir(rebuild_dir);
+	}
+}
+
+FileIndexRebuild::RunReader::RunReader(IFile* file, size_t buffer_size)
+	: file(file), buffer(buffer_size), buffer_pos(0), buffer_end(0),
+	eof(false), read_error(false)
+{
+}
+
+FileIndexRebuild::RunReader::~RunReader()
+{
+	delete file;
+}
+
+bool FileIndexRebuild::RunReader::next(SRunEntry& entry)
+{
+	if (buffer_end - buffer_pos < sizeof(SRunEntry))
+	{
+		if (eof)
+		{
+			return false;
+		}
+
+		size_t remaining = buffer_end - buffer_pos;
+		memmove(buffer.data(), buffer.data() + buffer_pos, remaining);
+		buffer_pos = 0;
+		buffer_end = remaining;
+
+		while (buffer_end < buffer.size())
+		{
+			bool has_read_error = false;
+			_u32 read = file->Read(buffer.data() + buffer_end, static_cast<_u32>(buffer.size() - buffer_end), &has_read_error);
+			if (has_read_error)
+			{
+				Server->Log("Error reading sorted run file \"" + file->getFilename() + "\". " + os_last_error_str(), LL_ERROR);
+				read_error = true;
+				return false;
+			}
+			if (read == 0)
+			{
+				eof = true;
+				break;
+			}
+			buffer_end += read;
+		}
+
+		if (buffer_end < sizeof(SRunEntry))
+		{
+			if (buffer_end > 0)
+			{
+				Server->Log("Sorted run file \"" + file->getFilename() + "\" is truncated", LL_ERROR);
+				read_error = true;
+			}
+			return false;
+		}
+	}
+
+	memcpy(&entry, buffer.data() + buffer_pos, sizeof(SRunEntry));
+	buffer_pos += sizeof(SRunEntry);
+	return true;
+}
+
+bool FileIndexRebuild::RunReader::has_error()
+{
+	return read_error;
+}
+
+bool FileIndexRebuild::SMergeItemGreater::operator()(const SMergeItem& a, const SMergeItem& b) const
+{
+	return run_entry_less(b.entry, a.entry);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "FileIndex.h"
+#include "../Interface/Types.h"
+#include "../Interface/File.h"
+#include <vector>
+#include <queue>
+#include <string>
+
+struct SStartupStatus;
+
+/**
+* Rebuilds the file entry index without sorting the whole files table in one query.
+* Rowid ranges of the files table are read and sorted by several threads into
+* run files (bounded memory per thread). The runs are then merged and fed to
+* FileIndex::create() as a single sorted stream.
+* Sorted ranges are kept on disk until the index was created successfully, so an
+* interrupted rebuild only has to sort the ranges which were not finished yet.
+*/
+class FileIndexRebuild : public FileIndex::ICreateSource
+{
+public:
+#pragma pack(1)
+	struct SRunEntry
+	{
+		FileIndex::SIndexKey key;
+		int64 created;
+		int64 id;
+		int64 next_entry;
+		int64 prev_entry;
+		char pointed_to;
+	};
+#pragma pack()
+
+	FileIndexRebuild(SStartupStatus& status, size_t n_threads, size_t max_memory);
+	~FileIndexRebuild();
+
+	//Reads and sorts the files table (URBACKUPDB_SERVER_FILES) into runs
+	bool sort_runs(int64 n_files);
+
+	bool start_merge();
+
+	virtual bool next_entry(size_t n_done, FileIndex::SCreateEntry& entry);
+
+	bool has_error();
+
+	//Deletes all sorted runs
+	static void cleanup();
+
+private:
+	class RunReader
+	{
+	public:
+		RunReader(IFile* file, size_t buffer_size);
+		~RunReader();
+
+		bool next(SRunEntry& entry);
+
+		bool has_error();
+
+	private:
+		IFile* file;
+		std::vector<char> buffer;
+		size_t buffer_pos;
+		size_t buffer_end;
+		bool eof;
+		bool read_error;
+	};
+
+	struct SMergeItem
+	{
+		SRunEntry entry;
+		size_t run;
+	};
+
+	struct SMergeItemGreater
+	{
+		bool operator()(const SMergeItem& a, const SMergeItem& b) const;
+	};
+
+	bool load_params(int64 n_files, int64 min_id, int64 max_id, int64 range_ids);
+
+	void update_progress(int64 n_merged);
+
+	SStartupStatus& status;
+	size_t n_threads;
+	size_t max_memory;
+
+	int64 n_total;
+	int64 n_merged;
+	int64 merge_starttime;
+	int64 last_log_time;
+	int64 last_log_merged;
+
+	std::vector<RunReader*> runs;
+	std::priority_queue<SMergeItem, std::vector<SMergeItem>, SMergeItemGreater> merge_queue;
+
+	bool _has_error;
+};
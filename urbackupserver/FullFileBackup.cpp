@@ -147,6 +147,7 @@ bool FullFileBackup::doFileBackup()
 	ServerLogger::Log(logid, clientname+": Loading file list...", LL_INFO);
 
 	int64 full_backup_starttime=Server->getTimeMS();
+	int64 throttle_wait_starttime=client_main->getThrottleWaitTime();
 
 	rc=fc.GetFile(group>0?("urbackup/filelist_"+convert(group)+".ub"):"urbackup/filelist.ub", tmp_filelist, hashed_transfer, false, 0, false, 0);
 	if(rc!=ERR_SUCCESS)
@@ -229,7 +230,9 @@ bool FullFileBackup::doFileBackup()
 		use_tmpfiles, tmpfile_path, server_token, use_reflink,
 		backupid, false, hashpipe_prepare, client_main, client_main->getProtocolVersions().filesrv_protocol_version,
 		0, logid, with_hashes, shares_without_snapshot, with_sparse_hashing, metadata_download_thread.get(),
-		backup_with_components, filepath_corrections, max_file_id));
+		backup_with_components, filepath_corrections, max_file_id, &telemetry));
+
+	addParallelDownloadConnections(server_download.get(), false);
 
 	bool queue_downloads = client_main->getProtocolVersions().filesrv_protocol_version>2;
 
@@ -305,7 +308,7 @@ bool FullFileBackup::doFileBackup()
 						}
 						else
 						{
-							int64 done_bytes = fc.getReceivedDataBytes(true) + linked_bytes;
+							int64 done_bytes = fc.getReceivedDataBytes(true) + server_download->getParallelReceivedDataBytes(true) + linked_bytes;
 							ServerStatus::setProcessDoneBytes(clientname, status_id, done_bytes);
 							ServerStatus::setProcessPcDone(clientname, status_id,
 								(std::min)(100, (int)(((float)done_bytes) / ((float)files_size / 100.f) + 0.5f)));
@@ -317,10 +320,10 @@ bool FullFileBackup::doFileBackup()
 
 					if (ctime - last_eta_update > eta_update_intervall)
 					{
-						calculateEtaFileBackup(last_eta_update, eta_set_time, ctime, fc, NULL, linked_bytes, last_eta_received_bytes, eta_estimated_speed, files_size);
+						calculateEtaFileBackup(last_eta_update, eta_set_time, ctime, fc, NULL, server_download.get(), linked_bytes, last_eta_received_bytes, eta_estimated_speed, files_size);
 					}
 
-					calculateDownloadSpeed(ctime, fc, NULL);
+					calculateDownloadSpeed(ctime, fc, NULL, server_download.get());
 
 				} while (server_download->sleepQueue());
 
@@ -626,7 +629,7 @@ bool FullFileBackup::doFileBackup()
 		}
 		else
 		{
-			int64 done_bytes = fc.getReceivedDataBytes(true) + linked_bytes;
+			int64 done_bytes = fc.getReceivedDataBytes(true) + server_download->getParallelReceivedDataBytes(true) + linked_bytes;
 			ServerStatus::setProcessDoneBytes(clientname, status_id, done_bytes);
 			ServerStatus::setProcessPcDone(clientname, status_id,
 				(std::min)(100,(int)(((float)done_bytes)/((float)files_size/100.f)+0.5f)));
@@ -638,10 +641,10 @@ bool FullFileBackup::doFileBackup()
 		int64 ctime = Server->getTimeMS();
 		if(ctime-last_eta_update>eta_update_intervall)
 		{
-			calculateEtaFileBackup(last_eta_update, eta_set_time, ctime, fc, NULL, linked_bytes, last_eta_received_bytes, eta_estimated_speed, files_size);
+			calculateEtaFileBackup(last_eta_update, eta_set_time, ctime, fc, NULL, server_download.get(), linked_bytes, last_eta_received_bytes, eta_estimated_speed, files_size);
 		}
 
-		calculateDownloadSpeed(ctime, fc, NULL);
+		calculateDownloadSpeed(ctime, fc, NULL, server_download.get());
 	}
 
 	ServerStatus::setProcessSpeed(clientname, status_id, 0);
@@ -865,7 +868,7 @@ bool FullFileBackup::doFileBackup()
 		}
 	}
 
-	if( bsh->hasError() || bsh_prepare->hasError() )
+	if( hashThreadsHaveError() )
 	{
 		disk_error=true;
 	}
@@ -963,12 +966,17 @@ bool FullFileBackup::doFileBackup()
 		}
 	}
 
-	_i64 transferred_bytes=fc.getTransferredBytes();
-	_i64 transferred_compressed=fc.getRealTransferredBytes();
+	_i64 transferred_bytes=fc.getTransferredBytes()+server_download->getParallelTransferredBytes();
+	_i64 transferred_compressed=fc.getRealTransferredBytes()+server_download->getParallelRealTransferredBytes();
 	int64 passed_time=transfer_stop_time-full_backup_starttime;
 	if(passed_time==0) passed_time=1;
 
 	ServerLogger::Log(logid, "Transferred "+PrettyPrintBytes(transferred_bytes)+" - Average speed: "+PrettyPrintSpeed((size_t)((transferred_bytes*1000)/(passed_time)) ), LL_INFO );
+	int64 throttle_wait_time = client_main->getThrottleWaitTime() - throttle_wait_starttime;
+	if(throttle_wait_time>0)
+	{
+		ServerLogger::Log(logid, "Time spent waiting because of bandwidth limits: "+PrettyPrintTime(throttle_wait_time), LL_INFO);
+	}
 	if(transferred_compressed>0)
 	{
 		ServerLogger::Log(logid, "(Before compression: "+PrettyPrintBytes(transferred_compressed)+" ratio: "+convert((float)transferred_compressed/transferred_bytes)+")");
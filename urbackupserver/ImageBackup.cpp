@@ -546,7 +546,8 @@ bool ImageBackup::doImage(const std::string &pLetter, const std::string &pParent
 	}
 
 	CTCPStack tcpstack(client_main->isOnInternetConnection());
-	IPipe *cc=client_main->getClientCommandConnection(server_settings.get(), 10000);
+	IPipe *cc=client_main->compressCommandConnection(
+		client_main->getClientCommandConnection(server_settings.get(), 10000), server_settings.get());
 	if(cc==NULL)
 	{
 		ServerLogger::Log(logid, "Connecting to \""+clientname+"\" for image backup failed", LL_ERROR);
@@ -703,6 +704,7 @@ bool ImageBackup::doImage(const std::string &pLetter, const std::string &pParent
 	_i64 transferred_bytes=0;
 	_i64 transferred_bytes_real=0;
 	int64 image_backup_starttime=Server->getTimeMS();
+	int64 throttle_wait_starttime=client_main->getThrottleWaitTime();
 
 	unsigned int curr_image_recv_timeout=image_recv_timeout;
 
@@ -806,6 +808,12 @@ bool ImageBackup::doImage(const std::string &pLetter, const std::string &pParent
 							}
 							else
 							{
+								cc = client_main->compressCommandConnection(cc, server_settings.get());
+								if (cc == NULL)
+								{
+									Server->wait(60000);
+									continue;
+								}
 								identity = client_main->getIdentity();
 								reconnected = true;
 								ServerStatus::setROnline(clientname, true);
@@ -1616,6 +1624,11 @@ bool ImageBackup::doImage(const std::string &pLetter, const std::string &pParent
 							if(passed_time==0) passed_time=1;
 
 							ServerLogger::Log(logid, "Transferred "+PrettyPrintBytes(transferred_bytes)+" - Average speed: "+PrettyPrintSpeed((size_t)((transferred_bytes*1000)/(passed_time)) ), LL_INFO );
+							int64 throttle_wait_time = client_main->getThrottleWaitTime() - throttle_wait_starttime;
+							if(throttle_wait_time>0)
+							{
+								ServerLogger::Log(logid, "Time spent waiting because of bandwidth limits: "+PrettyPrintTime(throttle_wait_time), LL_INFO);
+							}
 							if(transferred_bytes_real>0)
 							{
 								ServerLogger::Log(logid, "(Before compression: "+PrettyPrintBytes(transferred_bytes_real)+" ratio: "+convert((float)transferred_bytes_real/transferred_bytes)+")");
@@ -1853,6 +1866,11 @@ do_image_cleanup:
 	int64 passed_time=Server->getTimeMS()-image_backup_starttime;
 	if(passed_time==0) passed_time=1;
 	ServerLogger::Log(logid, "Transferred "+PrettyPrintBytes(transferred_bytes)+" - Average speed: "+PrettyPrintSpeed((size_t)((transferred_bytes*1000)/(passed_time) )), LL_INFO );
+	int64 throttle_wait_time = client_main->getThrottleWaitTime() - throttle_wait_starttime;
+	if(throttle_wait_time>0)
+	{
+		ServerLogger::Log(logid, "Time spent waiting because of bandwidth limits: "+PrettyPrintTime(throttle_wait_time), LL_INFO);
+	}
 	if(transferred_bytes_real>0)
 	{
 		ServerLogger::Log(logid, "(Before compression: "+PrettyPrintBytes(transferred_bytes_real)+" ratio: "+convert((float)transferred_bytes_real/transferred_bytes)+")");
@@ -214,6 +214,7 @@ bool IncrFileBackup::doFileBackup()
 	}
 
 	int64 incr_backup_starttime=Server->getTimeMS();
+	int64 throttle_wait_starttime=client_main->getThrottleWaitTime();
 	int64 incr_backup_stoptime=0;
 
 	rc=fc.GetFile(group>0?("urbackup/filelist_"+convert(group)+".ub"):"urbackup/filelist.ub", tmp_filelist, hashed_transfer, false, 0, false, 0);
@@ -507,7 +508,9 @@ bool IncrFileBackup::doFileBackup()
 		use_tmpfiles, tmpfile_path, server_token, use_reflink,
 		backupid, r_incremental, hashpipe_prepare, client_main, client_main->getProtocolVersions().filesrv_protocol_version,
 		incremental_num, logid, with_hashes, shares_without_snapshot, with_sparse_hashing, metadata_download_thread.get(),
-		backup_with_components, filepath_corrections, max_file_id));
+		backup_with_components, filepath_corrections, max_file_id, &telemetry));
+
+	addParallelDownloadConnections(server_download.get(), fc_chunked.get()!=NULL);
 
 	bool queue_downloads = client_main->getProtocolVersions().filesrv_protocol_version>2;
 
@@ -675,7 +678,8 @@ bool IncrFileBackup::doFileBackup()
 						else
 						{
 							int64 done_bytes = fc.getReceivedDataBytes(true)
-								+ (fc_chunked.get() ? fc_chunked->getReceivedDataBytes(true) : 0) + linked_bytes;
+								+ (fc_chunked.get() ? fc_chunked->getReceivedDataBytes(true) : 0)
+								+ server_download->getParallelReceivedDataBytes(true) + linked_bytes;
 							ServerStatus::setProcessDoneBytes(clientname, status_id, done_bytes);
 							ServerStatus::setProcessPcDone(clientname, status_id,
 								(std::min)(100, (int)(((float)done_bytes) / ((float)files_size / 100.f) + 0.5f)));
@@ -687,10 +691,10 @@ bool IncrFileBackup::doFileBackup()
 
 					if (ctime - last_eta_update > eta_update_intervall)
 					{
-						calculateEtaFileBackup(last_eta_update, eta_set_time, ctime, fc, fc_chunked.get(), linked_bytes, last_eta_received_bytes, eta_estimated_speed, files_size);
+						calculateEtaFileBackup(last_eta_update, eta_set_time, ctime, fc, fc_chunked.get(), server_download.get(), linked_bytes, last_eta_received_bytes, eta_estimated_speed, files_size);
 					}
 
-					calculateDownloadSpeed(ctime, fc, fc_chunked.get());
+					calculateDownloadSpeed(ctime, fc, fc_chunked.get(), server_download.get());
 				} while (server_download->sleepQueue());
 
 				if(server_download->isOffline() && !r_offline)
@@ -1357,7 +1361,8 @@ bool IncrFileBackup::doFileBackup()
 		else
 		{
 			int64 done_bytes = fc.getReceivedDataBytes(true)
-				+ (fc_chunked.get() ? fc_chunked->getReceivedDataBytes(true) : 0) + linked_bytes;
+				+ (fc_chunked.get() ? fc_chunked->getReceivedDataBytes(true) : 0)
+				+ server_download->getParallelReceivedDataBytes(true) + linked_bytes;
 			ServerStatus::setProcessDoneBytes(clientname, status_id, done_bytes);
 			ServerStatus::setProcessPcDone(clientname, status_id,
 				(std::min)(100,(int)(((float)done_bytes)/((float)files_size/100.f)+0.5f)) );
@@ -1369,10 +1374,10 @@ bool IncrFileBackup::doFileBackup()
 		int64 ctime = Server->getTimeMS();
 		if(ctime-last_eta_update>eta_update_intervall)
 		{
-			calculateEtaFileBackup(last_eta_update, eta_set_time, ctime, fc, fc_chunked.get(), linked_bytes, last_eta_received_bytes, eta_estimated_speed, files_size);
+			calculateEtaFileBackup(last_eta_update, eta_set_time, ctime, fc, fc_chunked.get(), server_download.get(), linked_bytes, last_eta_received_bytes, eta_estimated_speed, files_size);
 		}
 
-		calculateDownloadSpeed(ctime, fc, fc_chunked.get());
+		calculateDownloadSpeed(ctime, fc, fc_chunked.get(), server_download.get());
 	}
 
 	ServerStatus::setProcessSpeed(clientname, status_id, 0);
@@ -1409,7 +1414,7 @@ bool IncrFileBackup::doFileBackup()
 
 	waitForFileThreads();
 
-	if( bsh->hasError() || bsh_prepare->hasError() )
+	if( hashThreadsHaveError() )
 	{
 		disk_error=true;
 	}
@@ -1801,10 +1806,17 @@ bool IncrFileBackup::doFileBackup()
 	running_updater->stop();
 	backup_dao->updateFileBackupRunning(backupid);
 
-	_i64 transferred_bytes=fc.getTransferredBytes()+(fc_chunked.get()?fc_chunked->getTransferredBytes():0);
-	_i64 transferred_compressed=fc.getRealTransferredBytes()+(fc_chunked.get()?fc_chunked->getRealTransferredBytes():0);
+	_i64 transferred_bytes=fc.getTransferredBytes()+(fc_chunked.get()?fc_chunked->getTransferredBytes():0)
+		+server_download->getParallelTransferredBytes();
+	_i64 transferred_compressed=fc.getRealTransferredBytes()+(fc_chunked.get()?fc_chunked->getRealTransferredBytes():0)
+		+server_download->getParallelRealTransferredBytes();
 	int64 passed_time=incr_backup_stoptime-incr_backup_starttime;
 	ServerLogger::Log(logid, "Transferred "+PrettyPrintBytes(transferred_bytes)+" - Average speed: "+PrettyPrintSpeed((size_t)((transferred_bytes*1000)/(passed_time)) ), LL_INFO );
+	int64 throttle_wait_time = client_main->getThrottleWaitTime() - throttle_wait_starttime;
+	if(throttle_wait_time>0)
+	{
+		ServerLogger::Log(logid, "Time spent waiting because of bandwidth limits: "+PrettyPrintTime(throttle_wait_time), LL_INFO);
+	}
 	if(transferred_compressed>0)
 	{
 		ServerLogger::Log(logid, "(Before compression: "+PrettyPrintBytes(transferred_compressed)+" ratio: "+convert((float)transferred_compressed/transferred_bytes)+")");
@@ -36,10 +36,27 @@ MDB_dbi LMDBFileIndex::dbi;
 ISharedMutex* LMDBFileIndex::mutex=NULL;
 LMDBFileIndex* LMDBFileIndex::fileindex=NULL;
 THREADPOOL_TICKET LMDBFileIndex::fileindex_ticket = ILLEGAL_THREADPOOL_TICKET;
+FileIndexFilter* LMDBFileIndex::filter = NULL;
 
 
 const size_t c_initial_map_size=1*1024*1024;
 const size_t c_create_commit_n = 10000;
+const size_t c_filter_fill_batch = 100000;
+const unsigned int c_filter_default_bits_per_entry = 16;
+
+namespace
+{
+	class FilterFillThread : public IThread
+	{
+	public:
+		void operator()()
+		{
+			LMDBFileIndex fileindex;
+			fileindex.fill_filter();
+			delete this;
+		}
+	};
+}
 
 
 bool LMDBFileIndex::initFileIndex()
@@ -47,6 +64,35 @@ bool LMDBFileIndex::initFileIndex()
 	mutex = Server->createSharedMutex();
 
 	fileindex=new LMDBFileIndex;
+
+	if (Server->getServerParameter("fileindex_filter") == "true"
+		&& !fileindex->has_error())
+	{
+		unsigned int bits_per_entry = c_filter_default_bits_per_entry;
+		std::string str_bits = Server->getServerParameter("fileindex_filter_bits");
+		if (!str_bits.empty())
+		{
+			bits_per_entry = static_cast<unsigned int>(watoi(str_bits));
+		}
+
+		int64 n_entries = 0;
+		{
+			IScopedReadLock lock(mutex);
+			MDB_stat stat;
+			if (mdb_env_stat(env, &stat) == 0)
+			{
+				n_entries = static_cast<int64>(stat.ms_entries);
+			}
+		}
+
+		//ms_entries has one entry per (hash, filesize, clientid), i.e. files with the same
+		//content on multiple clients are counted multiple times and the filter is
+		//somewhat oversized. Leave room for growth. The filter is sized again on restart
+		filter = new FileIndexFilter(n_entries * 2, bits_per_entry);
+
+		Server->getThreadPool()->execute(new FilterFillThread, "fileindex filter");
+	}
+
 	fileindex_ticket = Server->getThreadPool()->execute(fileindex, "fileindex writer");
 
 	return !fileindex->has_error();
@@ -57,6 +103,11 @@ void LMDBFileIndex::shutdownFileIndex()
 {
 	fileindex->shutdown();
 	Server->getThreadPool()->waitFor(fileindex_ticket);
+
+	if (filter != NULL)
+	{
+		Server->Log("File entry index filter: " + filter->get_stats_str(), LL_INFO);
+	}
 }
 
 
@@ -102,7 +153,58 @@ void LMDBFileIndex::begin_txn(unsigned int flags)
 	}
 }
 
+namespace
+{
+	class CallbackCreateSource : public FileIndex::ICreateSource
+	{
+	public:
+		CallbackCreateSource(FileIndex::get_data_callback_t get_data_callback, void *userdata)
+			: get_data_callback(get_data_callback), userdata(userdata), n_rows(0), pos(0)
+		{
+		}
+
+		virtual bool next_entry(size_t n_done, FileIndex::SCreateEntry& entry)
+		{
+			while(pos>=res.size())
+			{
+				res=get_data_callback(n_done, n_rows, userdata);
+				++n_rows;
+				pos=0;
+
+				if(res.empty())
+				{
+					return false;
+				}
+			}
+
+			const std::string& shahash=res[pos]["shahash"];
+			entry.id = watoi64(res[pos]["id"]);
+			entry.key = FileIndex::SIndexKey(reinterpret_cast<const char*>(shahash.c_str()), watoi64(res[pos]["filesize"]), watoi(res[pos]["clientid"]));
+			entry.next_entry = watoi64(res[pos]["next_entry"]);
+			entry.prev_entry = watoi64(res[pos]["prev_entry"]);
+			entry.pointed_to = watoi(res[pos]["pointed_to"]);
+
+			++pos;
+
+			return true;
+		}
+
+	private:
+		FileIndex::get_data_callback_t get_data_callback;
+		void* userdata;
+		size_t n_rows;
+		db_results res;
+		size_t pos;
+	};
+}
+
 void LMDBFileIndex::create(get_data_callback_t get_data_callback, void *userdata)
+{
+	CallbackCreateSource source(get_data_callback, userdata);
+	create(&source);
+}
+
+void LMDBFileIndex::create(ICreateSource* source)
 {
 	begin_txn(0);
 
@@ -111,102 +213,93 @@ void LMDBFileIndex::create(get_data_callback_t get_data_callback, void *userdata
 	ServerFilesDao filesdao(db);
 
 	size_t n_done=0;
-	size_t n_rows=0;
 
 	SIndexKey last;
 	int64 last_prev_entry;
 	int64 last_id;
-	db_results res;
-	do
+	SCreateEntry entry;
+	while(source->next_entry(n_done, entry))
 	{
-		res=get_data_callback(n_done, n_rows, userdata);
+		const SIndexKey& key = entry.key;
+		int64 id = entry.id;
 
-		++n_rows;
+		assert(memcmp(&last, &key, sizeof(SIndexKey))!=1);
 
-		for(size_t i=0;i<res.size();++i)
+		if(key==last)
 		{
-			const std::string& shahash=res[i]["shahash"];
-			int64 id = watoi64(res[i]["id"]);
-			SIndexKey key(reinterpret_cast<const char*>(shahash.c_str()), watoi64(res[i]["filesize"]), watoi(res[i]["clientid"]));
-
-			int64 next_entry = watoi64(res[i]["next_entry"]);
-			int64 prev_entry = watoi64(res[i]["prev_entry"]);
-			int pointed_to = watoi(res[i]["pointed_to"]);
-
-			assert(memcmp(&last, &key, sizeof(SIndexKey))!=1);
-
-			if(key==last)
+			if(last_prev_entry==0)
 			{
-				if(last_prev_entry==0)
-				{
-					filesdao.setPrevEntry(id, last_id);
-				}
-
-				if(next_entry==0
-					&& (last_prev_entry==0 || last_prev_entry==id) )
-				{
-					filesdao.setNextEntry(last_id, id);
-				}
-
-				if(pointed_to)
-				{
-					filesdao.setPointedTo(0, id);
-				}
-
-				last=key;
-				last_id=id;
-				last_prev_entry=prev_entry;
-
-				continue;
+				filesdao.setPrevEntry(id, last_id);
 			}
-			else
+
+			if(entry.next_entry==0
+				&& (last_prev_entry==0 || last_prev_entry==id) )
 			{
-				if(!pointed_to)
-				{
-					filesdao.setPointedTo(1, id);
-				}
+				filesdao.setNextEntry(last_id, id);
 			}
-			
-			put(key, id, MDB_APPEND);
 
-			if(_has_error)
+			if(entry.pointed_to)
 			{
-				Server->Log("LMDB error after putting element. Error state interrupting..", LL_ERROR);
-				return;
+				filesdao.setPointedTo(0, id);
 			}
 
-			if(n_done % 1000 == 0 && n_done>0)
+			last=key;
+			last_id=id;
+			last_prev_entry=entry.prev_entry;
+
+			continue;
+		}
+		else
+		{
+			if(!entry.pointed_to)
 			{
-				if ((Server->getFailBits() & IServer::FAIL_DATABASE_CORRUPTED) ||
-					(Server->getFailBits() & IServer::FAIL_DATABASE_IOERR) ||
-					(Server->getFailBits() & IServer::FAIL_DATABASE_FULL))
-				{
-					Server->Log("Database error. Stopping.", LL_ERROR);
-					return;
-				}
-				Server->Log("File entry index contains "+convert(n_done)+" entries now.", LL_INFO);
+				filesdao.setPointedTo(1, id);
 			}
+		}
+			
+		put(key, id, MDB_APPEND);
+
+		if(_has_error)
+		{
+			Server->Log("LMDB error after putting element. Error state interrupting..", LL_ERROR);
+			return;
+		}
 
-			if(n_done % c_create_commit_n == 0 && n_done>0)
+		if(n_done % 1000 == 0 && n_done>0)
+		{
+			if ((Server->getFailBits() & IServer::FAIL_DATABASE_CORRUPTED) ||
+				(Server->getFailBits() & IServer::FAIL_DATABASE_IOERR) ||
+				(Server->getFailBits() & IServer::FAIL_DATABASE_FULL))
 			{
-				commit_transaction();
-				begin_txn(0);
+				Server->Log("Database error. Stopping.", LL_ERROR);
+				return;
 			}
+			Server->Log("File entry index contains "+convert(n_done)+" entries now.", LL_INFO);
+		}
+
+		if(n_done % c_create_commit_n == 0 && n_done>0)
+		{
+			commit_transaction();
+			begin_txn(0);
+		}
 
-			++n_done;
+		++n_done;
 
-			last=key;
-			last_id=id;
-			last_prev_entry=prev_entry;
-		}		
+		last=key;
+		last_id=id;
+		last_prev_entry=entry.prev_entry;
 	}
-	while(!res.empty());
 
 	commit_transaction();
 }
 
 int64 LMDBFileIndex::get(const LMDBFileIndex::SIndexKey& key)
 {
+	if (filter_excludes(key))
+	{
+		return 0;
+	}
+
 	begin_txn(MDB_RDONLY);
 
 	MDB_val mdb_tkey;
@@ -320,6 +413,11 @@ void LMDBFileIndex::put_internal(const SIndexKey& key, int64 value, int flags, b
 		_has_error=true;
 	}
 
+	if (!_has_error && filter != NULL)
+	{
+		filter->add(key);
+	}
+
 	if(!_has_error && log)
 	{
 		STransactionLogItem item = { key, value, flags};
@@ -588,6 +686,11 @@ size_t LMDBFileIndex::get_map_size()
 
 int64 LMDBFileIndex::get_any_client( const SIndexKey& key )
 {
+	if (filter_excludes(key))
+	{
+		return 0;
+	}
+
 	begin_txn(MDB_RDONLY);
 
 	MDB_cursor* cursor;
@@ -608,9 +711,9 @@ int64 LMDBFileIndex::get_any_client( const SIndexKey& key )
 
 	int64 ret = 0;
 	if(rc==MDB_NOTFOUND ||
-		!orig_key.isEqualWithoutClientid(orig_key) )
+		(rc==0 && !orig_key.isEqualWithoutClientid(*curr_key)) )
 	{
-
+		filter_miss();
 	}
 	else if(rc)
 	{
@@ -641,6 +744,11 @@ void LMDBFileIndex::abort_transaction()
 
 std::map<int, int64> LMDBFileIndex::get_all_clients( const SIndexKey& key )
 {
+	if (filter_excludes(key))
+	{
+		return std::map<int, int64>();
+	}
+
 	begin_txn(MDB_RDONLY);
 
 	MDB_cursor* cursor;
@@ -680,6 +788,10 @@ std::map<int, int64> LMDBFileIndex::get_all_clients( const SIndexKey& key )
 		Server->Log("LMDB: Failed to read ("+(std::string)mdb_strerror(rc)+")", LL_ERROR);
 		_has_error=true;
 	}
+	else if (ret.empty())
+	{
+		filter_miss();
+	}
 
 	mdb_cursor_close(cursor);
 
@@ -690,12 +802,61 @@ std::map<int, int64> LMDBFileIndex::get_all_clients( const SIndexKey& key )
 
 int64 LMDBFileIndex::get_prefer_client( const SIndexKey& key )
 {
+	if (filter_excludes(key))
+	{
+		return 0;
+	}
+
 	begin_txn(MDB_RDONLY);
 
 	MDB_cursor* cursor;
 
 	mdb_cursor_open(txn, dbi, &cursor);
 
+	int64 ret = get_prefer_client_internal(cursor, key);
+
+	mdb_cursor_close(cursor);
+
+	abort_transaction();
+
+	return ret;
+}
+
+void LMDBFileIndex::get_many_prefer_client(const std::vector<SIndexKey>& keys, std::vector<int64>& res)
+{
+	res.resize(keys.size());
+
+	MDB_cursor* cursor = NULL;
+
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		assert(i == 0 || !(keys[i] < keys[i - 1]));
+
+		if (filter_excludes(keys[i]))
+		{
+			res[i] = 0;
+			continue;
+		}
+
+		if (cursor == NULL)
+		{
+			begin_txn(MDB_RDONLY);
+			mdb_cursor_open(txn, dbi, &cursor);
+		}
+
+		res[i] = get_prefer_client_internal(cursor, keys[i]);
+	}
+
+	if (cursor != NULL)
+	{
+		mdb_cursor_close(cursor);
+
+		abort_transaction();
+	}
+}
+
+int64 LMDBFileIndex::get_prefer_client_internal(MDB_cursor* cursor, const SIndexKey& key)
+{
 	SIndexKey orig_key = key;
 
 	MDB_val mdb_tkey;
@@ -734,9 +895,10 @@ int64 LMDBFileIndex::get_prefer_client( const SIndexKey& key )
 		}
 	}
 
-	mdb_cursor_close(cursor);
-
-	abort_transaction();
+	if (ret == 0 && !_has_error)
+	{
+		filter_miss();
+	}
 
 	return ret;
 }
@@ -861,3 +1023,81 @@ void LMDBFileIndex::del( const SIndexKey& key )
 {
 	del_internal(key, true, true);
 }
+
+
+bool LMDBFileIndex::filter_excludes(const SIndexKey& key)
+{
+	return filter != NULL
+		&& !filter->may_contain(key);
+}
+
+void LMDBFileIndex::filter_miss()
+{
+	if (filter != NULL)
+	{
+		filter->add_false_positive();
+	}
+}
+
+void LMDBFileIndex::fill_filter()
+{
+	Server->Log("Filling file entry index filter...", LL_INFO);
+
+	SIndexKey last_key;
+	bool has_last_key = false;
+	int64 n_done = 0;
+
+	//Read in batches so that no read transaction stays open for long
+	while (true)
+	{
+		begin_txn(MDB_RDONLY);
+
+		MDB_cursor* cursor;
+		mdb_cursor_open(txn, dbi, &cursor);
+
+		MDB_val mdb_tkey;
+		mdb_tkey.mv_data = &last_key;
+		mdb_tkey.mv_size = sizeof(SIndexKey);
+
+		MDB_val mdb_tvalue;
+
+		int rc = mdb_cursor_get(cursor, &mdb_tkey, &mdb_tvalue, MDB_SET_RANGE);
+
+		size_t n_batch = 0;
+		while (rc == 0 && n_batch < c_filter_fill_batch)
+		{
+			SIndexKey* curr_key = reinterpret_cast<SIndexKey*>(mdb_tkey.mv_data);
+
+			if (!has_last_key
+				|| !curr_key->isEqualWithoutClientid(last_key))
+			{
+				filter->add(*curr_key);
+				++n_done;
+			}
+
+			last_key = *curr_key;
+			has_last_key = true;
+			++n_batch;
+
+			rc = mdb_cursor_get(cursor, &mdb_tkey, &mdb_tvalue, MDB_NEXT);
+		}
+
+		mdb_cursor_close(cursor);
+
+		abort_transaction();
+
+		if (rc == MDB_NOTFOUND)
+		{
+			break;
+		}
+		else if (rc)
+		{
+			Server->Log("LMDB: Failed to read while filling filter (" + (std::string)mdb_strerror(rc) + "). Filter stays disabled.", LL_ERROR);
+			return;
+		}
+	}
+
+	filter->set_ready();
+
+	Server->Log("File entry index filter ready with " + convert(n_done) + " keys. " + filter->get_stats_str(), LL_INFO);
+}
\ No newline at end of file
@@ -7,7 +7,8 @@
 #endif
 #include "FileIndex.h"
 #include "../Interface/SharedMutex.h"
-#include <memory>
+#include "FileIndexFilter.h"
+#include <memory>
 
 class LMDBFileIndex : public FileIndex
 {
@@ -27,6 +28,8 @@ public:
 
 	virtual void create(get_data_callback_t get_data_callback, void *userdata);
 
+	virtual void create(ICreateSource* source);
+
 	virtual int64 get(const SIndexKey& key);
 
 	virtual int64 get_any_client(const SIndexKey& key);
@@ -35,6 +38,8 @@ public:
 
 	virtual std::map<int, int64> get_all_clients(const SIndexKey& key);
 
+	virtual void get_many_prefer_client(const std::vector<SIndexKey>& keys, std::vector<int64>& res);
+
 	virtual void start_transaction(void);
 
 	virtual void put(const SIndexKey& key, int64 value);
@@ -54,10 +59,18 @@ public:
 	void abort_transaction();
 
 	size_t get_map_size();
+
+	void fill_filter();
 private:
 
 	void begin_txn(unsigned int flags);
 
+	int64 get_prefer_client_internal(MDB_cursor* cursor, const SIndexKey& key);
+
+	bool filter_excludes(const SIndexKey& key);
+
+	void filter_miss();
+
 	static MDB_env *env;
 	static MDB_dbi dbi;
 	size_t map_size;
@@ -89,6 +102,7 @@ private:
 	static ISharedMutex* mutex;
 	static LMDBFileIndex* fileindex;
 	static THREADPOOL_TICKET fileindex_ticket;
+	static FileIndexFilter* filter;
 
 	bool no_sync;
 };
\ No newline at end of file
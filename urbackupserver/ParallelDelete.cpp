@@ -0,0 +1,430 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef CLIENT_ONLY
+
+#include "ParallelDelete.h"
+#include "../Interface/Server.h"
+#include "../Interface/Thread.h"
+#include "../Interface/ThreadPool.h"
+#include "../stringtools.h"
+#include "ClientMain.h"
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#if defined(__FreeBSD__) || defined(__APPLE__)
+#define fstatat64 fstatat
+#define stat64 stat
+#define lstat64 lstat
+#endif
+
+namespace
+{
+	const int64 removed_batch = 1000;
+
+	class DeleteWorker : public IThread
+	{
+	public:
+		DeleteWorker(ParallelDelete* parallel_delete)
+			: parallel_delete(parallel_delete)
+		{}
+
+		void operator()()
+		{
+			parallel_delete->workerThread();
+			delete this;
+		}
+
+	private:
+		ParallelDelete* parallel_delete;
+	};
+}
+
+ParallelDelete::ParallelDelete(size_t n_threads, int64 busy_ops_per_second, logid_t logid)
+	: n_threads(n_threads), busy_ops_per_second(busy_ops_per_second), logid(logid),
+	symlink_callback(NULL), symlink_userdata(NULL),
+	mutex(Server->createMutex()), work_cond(Server->createCondition()),
+	main_cond(Server->createCondition()), symlink_cond(Server->createCondition()),
+	active_dirs(0), do_stop(false), has_error(false), removed(0),
+	throttle_mutex(Server->createMutex()), throttle_window_start(0), throttle_window_ops(0),
+	last_busy_check(0), is_busy(false)
+{
+	if (this->n_threads == 0)
+	{
+		this->n_threads = 1;
+	}
+}
+
+ParallelDelete::~ParallelDelete()
+{
+}
+
+bool ParallelDelete::removeDir(const std::string & root_path, os_symlink_callback_t p_symlink_callback, void * userdata, bool delete_root)
+{
+#ifdef _WIN32
+	return os_remove_nonempty_dir(root_path, p_symlink_callback, userdata, delete_root);
+#else
+	if (delete_root)
+	{
+		struct stat64 f_info;
+		int rc = lstat64(root_path.c_str(), &f_info);
+		if (rc == 0 && S_ISLNK(f_info.st_mode))
+		{
+			if (unlink(root_path.c_str()) != 0)
+			{
+				ServerLogger::Log(logid, "Error deleting symlink \"" + root_path + "\" (root)", LL_ERROR);
+			}
+			return true;
+		}
+	}
+
+	symlink_callback = p_symlink_callback;
+	symlink_userdata = userdata;
+	removed = 0;
+	has_error = false;
+	do_stop = false;
+
+	//The root is removed relative to its parent directory as well
+	int root_parent_fd = -1;
+	std::string root_name;
+	if (delete_root)
+	{
+		std::string root_parent = ExtractFilePath(root_path, "/");
+		if (root_parent.empty())
+		{
+			root_parent = "/";
+		}
+		root_parent_fd = open(root_parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (root_parent_fd >= 0)
+		{
+			root_name = ExtractFileName(root_path, "/");
+		}
+	}
+
+	active_dirs = 1;
+	work.push_back(new SDeleteDir(root_path, root_name, root_parent_fd, NULL, delete_root));
+
+	std::vector<THREADPOOL_TICKET> tickets;
+	for (size_t i = 0; i < n_threads; ++i)
+	{
+		tickets.push_back(Server->getThreadPool()->execute(new DeleteWorker(this), "delete worker"));
+	}
+
+	{
+		IScopedLock lock(mutex.get());
+		while (active_dirs > 0)
+		{
+			while (!symlink_requests.empty())
+			{
+				SSymlinkRequest* req = symlink_requests.front();
+				symlink_requests.pop_front();
+
+				lock.relock(NULL);
+				symlink_callback(req->path, NULL, symlink_userdata);
+				lock.relock(mutex.get());
+
+				req->done = true;
+				symlink_cond->notify_all();
+			}
+
+			if (active_dirs == 0)
+			{
+				break;
+			}
+
+			main_cond->wait(&lock);
+		}
+
+		do_stop = true;
+		work_cond->notify_all();
+	}
+
+	Server->getThreadPool()->waitFor(tickets);
+
+	if (root_parent_fd >= 0)
+	{
+		close(root_parent_fd);
+	}
+
+	ServerLogger::Log(logid, "Removed " + convert(removed) + " entries from \"" + root_path + "\" with " + convert(n_threads) + " threads", LL_DEBUG);
+
+	return !has_error;
+#endif
+}
+
+int64 ParallelDelete::getRemovedEntries()
+{
+	IScopedLock lock(mutex.get());
+	return removed;
+}
+
+void ParallelDelete::workerThread()
+{
+	ScopedBackgroundPrio background_prio;
+
+	while (true)
+	{
+		SDeleteDir* dir;
+		{
+			IScopedLock lock(mutex.get());
+			while (work.empty() && !do_stop)
+			{
+				work_cond->wait(&lock);
+			}
+
+			if (work.empty())
+			{
+				return;
+			}
+
+			//Depth first keeps the number of queued directories small
+			dir = work.back();
+			work.pop_back();
+		}
+
+		scanDir(dir);
+		finishDir(dir);
+	}
+}
+
+void ParallelDelete::scanDir(SDeleteDir * dir)
+{
+#ifndef _WIN32
+	if (dir->parent_fd >= 0)
+	{
+		dir->fd = openat(dir->parent_fd, dir->name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+	}
+	else
+	{
+		dir->fd = open(dir->path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+	}
+
+	//The directory stream gets its own descriptor. dir->fd stays open for the children
+	int dp_fd = dir->fd >= 0 ? dup(dir->fd) : -1;
+	DIR* dp = dp_fd >= 0 ? fdopendir(dp_fd) : NULL;
+	if (dp == NULL)
+	{
+		ServerLogger::Log(logid, "No permission to access \"" + dir->path + "\"", LL_ERROR);
+		if (dp_fd >= 0)
+		{
+			close(dp_fd);
+		}
+		IScopedLock lock(mutex.get());
+		has_error = true;
+		return;
+	}
+
+	int fd = dir->fd;
+
+	int64 curr_removed = 0;
+	struct dirent* dirp;
+	while ((dirp = readdir(dp)) != NULL)
+	{
+		std::string name = dirp->d_name;
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+
+		bool is_dir = false;
+		bool is_symlink = false;
+#ifndef sun
+		if (dirp->d_type != DT_UNKNOWN)
+		{
+			is_dir = dirp->d_type == DT_DIR;
+			is_symlink = dirp->d_type == DT_LNK;
+		}
+		else
+#endif
+		{
+			struct stat64 f_info;
+			if (fstatat64(fd, name.c_str(), &f_info, AT_SYMLINK_NOFOLLOW) != 0)
+			{
+				ServerLogger::Log(logid, "Error getting file type of \"" + dir->path + "/" + name + "\"", LL_ERROR);
+				continue;
+			}
+			is_dir = S_ISDIR(f_info.st_mode);
+			is_symlink = S_ISLNK(f_info.st_mode);
+		}
+
+		if (is_symlink && symlink_callback != NULL)
+		{
+			handleSymlink(dir->path + "/" + name);
+		}
+		else if (is_dir)
+		{
+			SDeleteDir* child = new SDeleteDir(dir->path + "/" + name, name, fd, dir, true);
+
+			IScopedLock lock(mutex.get());
+			++dir->pending;
+			++active_dirs;
+			work.push_back(child);
+			work_cond->notify_one();
+		}
+		else
+		{
+			throttle();
+
+			if (unlinkat(fd, name.c_str(), 0) != 0)
+			{
+				ServerLogger::Log(logid, "Error deleting file \"" + dir->path + "/" + name + "\". " + os_last_error_str(), LL_ERROR);
+			}
+			else if (++curr_removed >= removed_batch)
+			{
+				addRemoved(curr_removed);
+				curr_removed = 0;
+			}
+		}
+	}
+
+	closedir(dp);
+
+	addRemoved(curr_removed);
+#endif
+}
+
+void ParallelDelete::finishDir(SDeleteDir * dir)
+{
+	while (dir != NULL)
+	{
+		{
+			IScopedLock lock(mutex.get());
+			--dir->pending;
+			if (dir->pending > 0)
+			{
+				return;
+			}
+		}
+
+#ifndef _WIN32
+		if (dir->fd >= 0)
+		{
+			close(dir->fd);
+			dir->fd = -1;
+		}
+#endif
+
+		if (dir->remove)
+		{
+#ifndef _WIN32
+			int rc;
+			if (dir->parent_fd >= 0)
+			{
+				rc = unlinkat(dir->parent_fd, dir->name.c_str(), AT_REMOVEDIR);
+			}
+			else
+			{
+				rc = rmdir(dir->path.c_str());
+			}
+			if (rc != 0)
+			{
+				ServerLogger::Log(logid, "Error deleting directory \"" + dir->path + "\". " + os_last_error_str(), LL_ERROR);
+			}
+			else
+			{
+				addRemoved(1);
+			}
+#endif
+		}
+
+		SDeleteDir* parent = dir->parent;
+		delete dir;
+
+		{
+			IScopedLock lock(mutex.get());
+			--active_dirs;
+			if (active_dirs == 0)
+			{
+				main_cond->notify_all();
+			}
+		}
+
+		dir = parent;
+	}
+}
+
+void ParallelDelete::handleSymlink(const std::string & path)
+{
+	SSymlinkRequest req(path);
+
+	IScopedLock lock(mutex.get());
+	symlink_requests.push_back(&req);
+	main_cond->notify_all();
+
+	while (!req.done)
+	{
+		symlink_cond->wait(&lock);
+	}
+}
+
+void ParallelDelete::throttle()
+{
+	if (busy_ops_per_second <= 0)
+	{
+		return;
+	}
+
+	IScopedLock lock(throttle_mutex.get());
+
+	int64 now = Server->getTimeMS();
+	if (now - last_busy_check >= 1000)
+	{
+		is_busy = ClientMain::getNumberOfRunningBackups() > 0;
+		last_busy_check = now;
+	}
+
+	if (!is_busy)
+	{
+		return;
+	}
+
+	if (now - throttle_window_start >= 1000)
+	{
+		throttle_window_start = now;
+		throttle_window_ops = 0;
+	}
+
+	++throttle_window_ops;
+
+	if (throttle_window_ops > busy_ops_per_second)
+	{
+		//Keep the lock while waiting so that all workers pause
+		Server->wait(static_cast<unsigned int>(throttle_window_start + 1000 - now));
+		throttle_window_start = Server->getTimeMS();
+		throttle_window_ops = 1;
+	}
+}
+
+void ParallelDelete::addRemoved(int64 n)
+{
+	if (n == 0)
+	{
+		return;
+	}
+
+	IScopedLock lock(mutex.get());
+	removed += n;
+}
+
+#endif //CLIENT_ONLY
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "../Interface/Mutex.h"
+#include "../Interface/Condition.h"
+#include "../Interface/Types.h"
+#include "../urbackupcommon/os_functions.h"
+#include "server_log.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+
+/**
+* Removes a directory tree with several worker threads. Workers open,
+* unlink and remove directory entries relative to the file descriptor of
+* their parent directory, so deep trees do not need full path resolution.
+* A directory is removed once all of its sub-directories are gone and
+* keeps its descriptor open until then. While backups are
+* running unlinks are limited to busy_ops_per_second. Symlinks are passed
+* to the symlink callback on the thread calling removeDir().
+* Unlinking is idempotent, so an interrupted deletion is resumed by
+* running it again, which walks whatever is left of the tree.
+*/
+class ParallelDelete
+{
+public:
+	ParallelDelete(size_t n_threads, int64 busy_ops_per_second, logid_t logid);
+	~ParallelDelete();
+
+	bool removeDir(const std::string &root_path, os_symlink_callback_t symlink_callback, void* userdata, bool delete_root);
+
+	int64 getRemovedEntries();
+
+	void workerThread();
+
+private:
+	struct SDeleteDir
+	{
+		SDeleteDir(const std::string& path, const std::string& name, int parent_fd, SDeleteDir* parent, bool remove)
+			: path(path), name(name), parent_fd(parent_fd), fd(-1), parent(parent), pending(1), remove(remove)
+		{}
+
+		//Full path for log messages and the symlink callback only
+		std::string path;
+		std::string name;
+		//-1 if path is opened/removed directly
+		int parent_fd;
+		int fd;
+		SDeleteDir* parent;
+		size_t pending;
+		bool remove;
+	};
+
+	struct SSymlinkRequest
+	{
+		SSymlinkRequest(const std::string& path)
+			: path(path), done(false)
+		{}
+
+		std::string path;
+		bool done;
+	};
+
+	void scanDir(SDeleteDir* dir);
+	void finishDir(SDeleteDir* dir);
+	void handleSymlink(const std::string& path);
+	void throttle();
+	void addRemoved(int64 n);
+
+	size_t n_threads;
+	int64 busy_ops_per_second;
+	logid_t logid;
+
+	os_symlink_callback_t symlink_callback;
+	void* symlink_userdata;
+
+	std::auto_ptr<IMutex> mutex;
+	std::auto_ptr<ICondition> work_cond;
+	std::auto_ptr<ICondition> main_cond;
+	std::auto_ptr<ICondition> symlink_cond;
+
+	std::vector<SDeleteDir*> work;
+	std::deque<SSymlinkRequest*> symlink_requests;
+	size_t active_dirs;
+	bool do_stop;
+	bool has_error;
+	int64 removed;
+
+	std::auto_ptr<IMutex> throttle_mutex;
+	int64 throttle_window_start;
+	int64 throttle_window_ops;
+	int64 last_busy_check;
+	bool is_busy;
+};
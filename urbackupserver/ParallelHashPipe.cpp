@@ -0,0 +1,234 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+#ifndef CLIENT_ONLY
+
+#include "ParallelHashPipe.h"
+#include "FileBackup.h"
+#include "server_hash.h"
+#include "../Interface/Server.h"
+#include "../common/data.h"
+#include <string.h>
+
+namespace
+{
+	bool is_cmd(const char* buffer, size_t bsize, const char* cmd)
+	{
+		size_t cmd_size = strlen(cmd);
+		return bsize == cmd_size
+			&& memcmp(buffer, cmd, cmd_size) == 0;
+	}
+}
+
+ParallelHashPipe::ParallelHashPipe(const std::vector<IPipe*>& outputs, EPartition partition, size_t n_producers, MaxFileId* max_file_id)
+	: outputs(outputs), partition(partition), n_producers(n_producers), n_exit(0), next_output(0),
+	max_file_id(max_file_id), mutex(Server->createMutex())
+{
+}
+
+size_t ParallelHashPipe::Read(char * buffer, size_t bsize, int timeoutms)
+{
+	return 0;
+}
+
+bool ParallelHashPipe::Write(const char * buffer, size_t bsize, int timeoutms, bool flush)
+{
+	if (is_cmd(buffer, bsize, "exit"))
+	{
+		IScopedLock lock(mutex.get());
+		++n_exit;
+		if (n_exit < n_producers)
+		{
+			return true;
+		}
+		return writeAll(buffer, bsize);
+	}
+	else if (is_cmd(buffer, bsize, "flush"))
+	{
+		return writeAll(buffer, bsize);
+	}
+
+	if (partition == EPartition_LeastLoaded
+		&& max_file_id != NULL)
+	{
+		CRData rd(buffer, bsize);
+		int64 fileid;
+		if (rd.getVarInt(&fileid))
+		{
+			max_file_id->startHashing(static_cast<size_t>(fileid));
+		}
+	}
+
+	size_t output;
+	{
+		IScopedLock lock(mutex.get());
+		output = selectOutput(buffer, bsize);
+	}
+
+	//The outputs accept multiple producers. Writing without the lock keeps a
+	//full output from blocking producers which write to the other outputs
+	return outputs[output]->Write(buffer, bsize);
+}
+
+size_t ParallelHashPipe::Read(std::string * ret, int timeoutms)
+{
+	return 0;
+}
+
+bool ParallelHashPipe::Write(const std::string & str, int timeoutms, bool flush)
+{
+	return Write(str.data(), str.size(), timeoutms, flush);
+}
+
+bool ParallelHashPipe::writeAll(const char* msg, size_t msg_size)
+{
+	bool ret = true;
+	for (size_t i = 0; i < outputs.size(); ++i)
+	{
+		if (!outputs[i]->Write(msg, msg_size))
+		{
+			ret = false;
+		}
+	}
+	return ret;
+}
+
+size_t ParallelHashPipe::selectOutput(const char* msg, size_t msg_size)
+{
+	if (outputs.size() == 1)
+	{
+		return 0;
+	}
+
+	if (partition == EPartition_Hash)
+	{
+		CRData rd(msg, msg_size);
+		int iaction;
+		rd.getInt(&iaction);
+		if (iaction == BackupServerHash::EAction_LinkOrCopy)
+		{
+			int64 fileid;
+			std::string temp_fn;
+			int backupid;
+			int incremental;
+			char with_hashes;
+			std::string tfn;
+			std::string hashpath;
+			std::string sha2;
+			if (rd.getVarInt(&fileid)
+				&& rd.getStr(&temp_fn)
+				&& rd.getInt(&backupid)
+				&& rd.getInt(&incremental)
+				&& rd.getChar(&with_hashes)
+				&& rd.getStr(&tfn)
+				&& rd.getStr(&hashpath)
+				&& rd.getStr(&sha2)
+				&& sha2.size() >= sizeof(unsigned int))
+			{
+				unsigned int h;
+				memcpy(&h, sha2.data(), sizeof(h));
+				return h % outputs.size();
+			}
+		}
+
+		next_output = (next_output + 1) % outputs.size();
+		return next_output;
+	}
+
+	size_t ret = next_output;
+	size_t min_elements = outputs[ret]->getNumElements();
+	for (size_t i = 1; i < outputs.size() && min_elements>0; ++i)
+	{
+		size_t idx = (next_output + i) % outputs.size();
+		size_t num_elements = outputs[idx]->getNumElements();
+		if (num_elements < min_elements)
+		{
+			min_elements = num_elements;
+			ret = idx;
+		}
+	}
+	next_output = (ret + 1) % outputs.size();
+	return ret;
+}
+
+bool ParallelHashPipe::Flush(int timeoutms)
+{
+	return true;
+}
+
+bool ParallelHashPipe::isWritable(int timeoutms)
+{
+	return true;
+}
+
+bool ParallelHashPipe::isReadable(int timeoutms)
+{
+	return false;
+}
+
+bool ParallelHashPipe::hasError(void)
+{
+	for (size_t i = 0; i < outputs.size(); ++i)
+	{
+		if (outputs[i]->hasError())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void ParallelHashPipe::shutdown(void)
+{
+	for (size_t i = 0; i < outputs.size(); ++i)
+	{
+		outputs[i]->shutdown();
+	}
+}
+
+size_t ParallelHashPipe::getNumElements(void)
+{
+	size_t ret = 0;
+	for (size_t i = 0; i < outputs.size(); ++i)
+	{
+		ret += outputs[i]->getNumElements();
+	}
+	return ret;
+}
+
+void ParallelHashPipe::addThrottler(IPipeThrottler * throttler)
+{
+}
+
+void ParallelHashPipe::addOutgoingThrottler(IPipeThrottler * throttler)
+{
+}
+
+void ParallelHashPipe::addIncomingThrottler(IPipeThrottler * throttler)
+{
+}
+
+_i64 ParallelHashPipe::getTransferedBytes(void)
+{
+	return 0;
+}
+
+void ParallelHashPipe::resetTransferedBytes(void)
+{
+}
+
+#endif //CLIENT_ONLY
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../Interface/Pipe.h"
+#include "../Interface/Mutex.h"
+#include <vector>
+#include <memory>
+
+class MaxFileId;
+
+/**
+* Distributes the messages of one file backup to the input pipes of several
+* hash worker threads. "flush" is sent to all workers, "exit" is sent to all
+* workers once every producer has sent it. Reading is not supported.
+*/
+class ParallelHashPipe : public IPipe
+{
+public:
+	enum EPartition
+	{
+		//Prepare hash messages. Each file goes to the worker with the shortest queue.
+		EPartition_LeastLoaded,
+		//BackupServerHash messages. Files with the same content go to the same worker.
+		EPartition_Hash
+	};
+
+	ParallelHashPipe(const std::vector<IPipe*>& outputs, EPartition partition, size_t n_producers, MaxFileId* max_file_id);
+
+	virtual size_t Read(char *buffer, size_t bsize, int timeoutms);
+	virtual bool Write(const char *buffer, size_t bsize, int timeoutms, bool flush);
+	virtual size_t Read(std::string *ret, int timeoutms);
+	virtual bool Write(const std::string &str, int timeoutms, bool flush);
+
+	virtual bool Flush(int timeoutms);
+
+	virtual bool isWritable(int timeoutms);
+	virtual bool isReadable(int timeoutms);
+
+	virtual bool hasError(void);
+
+	virtual void shutdown(void);
+
+	virtual size_t getNumElements(void);
+
+	virtual void addThrottler(IPipeThrottler *throttler);
+	virtual void addOutgoingThrottler(IPipeThrottler *throttler);
+	virtual void addIncomingThrottler(IPipeThrottler *throttler);
+
+	virtual _i64 getTransferedBytes(void);
+	virtual void resetTransferedBytes(void);
+
+private:
+	bool writeAll(const char* msg, size_t msg_size);
+	size_t selectOutput(const char* msg, size_t msg_size);
+
+	std::vector<IPipe*> outputs;
+	EPartition partition;
+	size_t n_producers;
+	size_t n_exit;
+	size_t next_output;
+	MaxFileId* max_file_id;
+
+	std::auto_ptr<IMutex> mutex;
+};
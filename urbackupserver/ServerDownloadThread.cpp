@@ -32,6 +32,7 @@
 #include "../urbackupcommon/os_functions.h"
 #include "server.h"
 #include "FileMetadataDownloadThread.h"
+#include "BackupTelemetry.h"
 
 namespace
 {
@@ -40,12 +41,35 @@ namespace
 	const size_t queue_items_chunked = 4;
 
 	const char* tmpfile_dirname = ".b68xO+K9SCOF35cLk4Bf9Q";
+
+	class ScopedFinishDownload
+	{
+	public:
+		ScopedFinishDownload(MaxFileId& max_file_id, const SQueueItem& item, const bool& hashed)
+			: max_file_id(max_file_id), id(item.id), track_download(item.track_download), hashed(hashed)
+		{
+		}
+
+		~ScopedFinishDownload()
+		{
+			if (track_download && !hashed)
+			{
+				max_file_id.setMaxDownloaded(id);
+			}
+		}
+
+	private:
+		MaxFileId& max_file_id;
+		size_t id;
+		bool track_download;
+		const bool& hashed;
+	};
 }
 
 ServerDownloadThread::ServerDownloadThread( FileClient& fc, FileClientChunked* fc_chunked, const std::string& backuppath, const std::string& backuppath_hashes, const std::string& last_backuppath, const std::string& last_backuppath_complete, bool hashed_transfer, bool save_incomplete_file, int clientid,
 	const std::string& clientname, const std::string& clientsubname, bool use_tmpfiles, const std::string& tmpfile_path, const std::string& server_token, bool use_reflink, int backupid, bool r_incremental, IPipe* hashpipe_prepare, ClientMain* client_main,
 	int filesrv_protocol_version, int incremental_num, logid_t logid, bool with_hashes, const std::vector<std::string>& shares_without_snapshot, bool with_sparse_hashing, server::FileMetadataDownloadThread* file_metadata_download, bool sc_failure_fatal,
-	FilePathCorrections& filepath_corrections, MaxFileId& max_file_id)
+	FilePathCorrections& filepath_corrections, MaxFileId& max_file_id, BackupTelemetry* telemetry)
 	: fc(fc), fc_chunked(fc_chunked), backuppath(backuppath), backuppath_hashes(backuppath_hashes), 
 	last_backuppath(last_backuppath), last_backuppath_complete(last_backuppath_complete), hashed_transfer(hashed_transfer), save_incomplete_file(save_incomplete_file), clientid(clientid),
 	clientname(clientname), clientsubname(clientsubname),
@@ -53,10 +77,13 @@ ServerDownloadThread::ServerDownloadThread( FileClient& fc, FileClientChunked* f
 	is_offline(false), client_main(client_main), filesrv_protocol_version(filesrv_protocol_version), skipping(false), queue_size(0),
 	all_downloads_ok(true), incremental_num(incremental_num), logid(logid), has_timeout(false), with_hashes(with_hashes), with_metadata(client_main->getProtocolVersions().file_meta>0), shares_without_snapshot(shares_without_snapshot),
 	with_sparse_hashing(with_sparse_hashing), exp_backoff(false), num_embedded_metadata_files(0), file_metadata_download(file_metadata_download), num_issues(0), last_snap_num_issues(0), has_disk_error(false), sc_failure_fatal(sc_failure_fatal),
-	tmpfile_num(0), filepath_corrections(filepath_corrections), max_file_id(max_file_id)
+	tmpfile_num(0), tmpfile_num_step(1), filepath_corrections(filepath_corrections), max_file_id(max_file_id), telemetry(telemetry),
+	primary(NULL), curr_hashed(false)
 {
 	mutex = Server->createMutex();
 	cond = Server->createCondition();
+	barrier_mutex = Server->createMutex();
+	barrier_cond = Server->createCondition();
 
 	if (BackupServer::useTreeHashing())
 	{
@@ -70,12 +97,24 @@ ServerDownloadThread::ServerDownloadThread( FileClient& fc, FileClientChunked* f
 
 ServerDownloadThread::~ServerDownloadThread()
 {
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		delete lanes[i];
+	}
+
 	Server->destroy(mutex);
 	Server->destroy(cond);
+	Server->destroy(barrier_mutex);
+	Server->destroy(barrier_cond);
 }
 
 void ServerDownloadThread::operator()( void )
 {
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		lane_tickets.push_back(Server->getThreadPool()->execute(lanes[i], "fbackup load"));
+	}
+
 	if(fc_chunked!=NULL && filesrv_protocol_version>2)
 	{
 		fc_chunked->setQueueCallback(this);
@@ -86,6 +125,11 @@ void ServerDownloadThread::operator()( void )
 		fc.setQueueCallback(this);
 	}
 
+	if(filesrv_protocol_version>4)
+	{
+		fc.setBundleSmallFiles(true);
+	}
+
 	while(true)
 	{
 		SQueueItem curr;
@@ -111,6 +155,9 @@ void ServerDownloadThread::operator()( void )
 			}			
 		}
 
+		curr_hashed = false;
+		ScopedFinishDownload finish_download(max_file_id, curr, curr_hashed);
+
 		if(curr.action==EQueueAction_Quit)
 		{
 			IScopedLock lock(mutex);
@@ -130,6 +177,37 @@ void ServerDownloadThread::operator()( void )
 			continue;
 		}
 
+		if (curr.barrier != NULL)
+		{
+			if (!waitBarrier(curr.barrier))
+			{
+				continue;
+			}
+
+			//All connections are idle. Start/stop the snapshot once.
+			if (!is_offline && !skipping)
+			{
+				bool ok;
+				if (curr.action == EQueueAction_StartShadowcopy)
+				{
+					ok = start_shadowcopy(curr.fn);
+				}
+				else
+				{
+					ok = stop_shadowcopy(curr.fn);
+				}
+
+				if (!ok)
+				{
+					IScopedLock lock(mutex);
+					is_offline = true;
+				}
+			}
+
+			releaseBarrier(curr.barrier);
+			continue;
+		}
+
 		if(is_offline || skipping)
 		{
 			if(curr.fileclient== EFileClient_Chunked)
@@ -235,7 +313,13 @@ void ServerDownloadThread::operator()( void )
 		}
 	}
 
-	if(!is_offline && !skipping && client_main->getProtocolVersions().file_meta>0)
+	if (!lane_tickets.empty())
+	{
+		Server->getThreadPool()->waitFor(lane_tickets);
+	}
+
+	//Only the primary connection ends the metadata stream, after all lanes are done
+	if(primary==NULL && !isOffline() && !skipping && client_main->getProtocolVersions().file_meta>0)
 	{
 		_u32 rc = fc.InformMetadataStreamEnd(server_token, 3);
 
@@ -291,6 +375,24 @@ void ServerDownloadThread::addToQueueFull(size_t id, const std::string &fn, cons
 		}
 	}
 
+	if (ni.id != std::string::npos
+		&& (!lanes.empty() || primary != NULL))
+	{
+		max_file_id.startDownloading(ni.id);
+		ni.track_download = true;
+	}
+
+	if (!at_front_postpone_quitstop
+		&& !is_script)
+	{
+		ServerDownloadThread* lane = getLeastLoadedLane();
+		if (lane != this)
+		{
+			lane->pushQueueItem(ni, queue_items_full);
+			return;
+		}
+	}
+
 	IScopedLock lock(mutex);
 
 	if(!at_front_postpone_quitstop)
@@ -348,11 +450,20 @@ void ServerDownloadThread::addToQueueChunked(size_t id, const std::string &fn, c
 		}
 	}
 
-	IScopedLock lock(mutex);
-	dl_queue.push_back(ni);
-	cond->notify_one();
+	if (ni.id != std::string::npos
+		&& (!lanes.empty() || primary != NULL))
+	{
+		max_file_id.startDownloading(ni.id);
+		ni.track_download = true;
+	}
 
-	queue_size+=queue_items_chunked;
+	ServerDownloadThread* lane = this;
+	if (!is_script)
+	{
+		lane = getLeastLoadedLane();
+	}
+
+	lane->pushQueueItem(ni, queue_items_chunked);
 }
 
 void ServerDownloadThread::addToQueueStartShadowcopy(const std::string& fn)
@@ -364,6 +475,12 @@ void ServerDownloadThread::addToQueueStartShadowcopy(const std::string& fn)
 	ni.patch_dl_files.prepared=false;
 	ni.patch_dl_files.prepare_error=false;
 
+	if (!lanes.empty())
+	{
+		queueBarrier(ni);
+		return;
+	}
+
 	IScopedLock lock(mutex);
 	dl_queue.push_back(ni);
 	cond->notify_one();
@@ -378,6 +495,12 @@ void ServerDownloadThread::addToQueueStopShadowcopy(const std::string& fn)
 	ni.patch_dl_files.prepared=false;
 	ni.patch_dl_files.prepare_error=false;
 
+	if (!lanes.empty())
+	{
+		queueBarrier(ni);
+		return;
+	}
+
 	IScopedLock lock(mutex);
 	dl_queue.push_back(ni);
 	cond->notify_one();
@@ -522,6 +645,7 @@ bool ServerDownloadThread::load_file(SQueueItem todl)
 	std::string cfn=getDLPath(todl);
 
 	int64 script_start_time = Server->getTimeSeconds()-60;
+	int64 download_starttime = Server->getTimeMS();
 
     _u32 rc=fc.GetFile(cfn, fd, hashed_transfer, todl.metadata_only, todl.folder_items, todl.is_script, with_metadata ? (todl.id+1) : 0);
 
@@ -535,6 +659,11 @@ bool ServerDownloadThread::load_file(SQueueItem todl)
 		--hash_retries;
 	}
 
+	if(telemetry!=NULL)
+	{
+		telemetry->addStageTime(EBackupStage_Download, Server->getTimeMS() - download_starttime);
+	}
+
 	bool ret = true;
 	bool hash_file = false;
 	bool script_ok = true;
@@ -795,6 +924,7 @@ bool ServerDownloadThread::load_file_patch(SQueueItem todl)
 	int64 script_start_time = Server->getTimeSeconds()-60;
 
 	IFile* sparse_extents_f=NULL;
+	int64 download_starttime = Server->getTimeMS();
 	_u32 rc=fc_chunked->GetFilePatch((cfn), dlfiles.orig_file, dlfiles.patchfile, dlfiles.chunkhashes, dlfiles.hashoutput,
 		todl.predicted_filesize, with_metadata ? (todl.id+1) : 0, todl.is_script, &sparse_extents_f);
 
@@ -827,6 +957,11 @@ bool ServerDownloadThread::load_file_patch(SQueueItem todl)
 		--hash_retries;
 	}
 
+	if(telemetry!=NULL)
+	{
+		telemetry->addStageTime(EBackupStage_Download, Server->getTimeMS() - download_starttime);
+	}
+
 	ScopedDeleteFile sparse_extents_f_delete(sparse_extents_f);
 
 	if(download_filesize<0)
@@ -1015,6 +1150,8 @@ void ServerDownloadThread::hashFile(int64 fileid, std::string dstpath, std::stri
 
 	ServerLogger::Log(logid, "GT: Loaded file \""+ExtractFileName((dstpath))+"\"", LL_DEBUG);
 
+	curr_hashed = true;
+
 	Server->destroy(fd);
 	Server->destroy(sparse_extents_f);
 	if(hashoutput!=NULL)
@@ -1039,11 +1176,24 @@ void ServerDownloadThread::hashFile(int64 fileid, std::string dstpath, std::stri
 		}
 		
 	}
+	if(telemetry!=NULL)
+	{
+		telemetry->fileQueued(fileid);
+	}
+
 	hashpipe_prepare->Write(data.getDataPtr(), data.getDataSize() );
 }
 
 bool ServerDownloadThread::isOffline()
 {
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		if (lanes[i]->isOffline())
+		{
+			return true;
+		}
+	}
+
 	IScopedLock lock(mutex);
 	return is_offline;
 }
@@ -1053,6 +1203,11 @@ void ServerDownloadThread::queueStop()
 	SQueueItem ni;
 	ni.action = EQueueAction_Quit;
 
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		lanes[i]->queueStop();
+	}
+
 	IScopedLock lock(mutex);
 	dl_queue.push_back(ni);
 	cond->notify_one();
@@ -1060,22 +1215,43 @@ void ServerDownloadThread::queueStop()
 
 bool ServerDownloadThread::isDownloadOk( size_t id )
 {
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		if (!lanes[i]->isDownloadOk(id))
+		{
+			return false;
+		}
+	}
+
 	return !download_nok_ids.hasId(id);
 }
 
 
 bool ServerDownloadThread::isDownloadPartial( size_t id )
 {
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		if (lanes[i]->isDownloadPartial(id))
+		{
+			return true;
+		}
+	}
+
 	return download_partial_ids.hasId(id);
 }
 
 
 size_t ServerDownloadThread::getMaxOkId()
 {
-	return max_ok_id;
+	size_t ret = max_ok_id;
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		ret = (std::max)(ret, lanes[i]->getMaxOkId());
+	}
+	return ret;
 }
 
-std::string ServerDownloadThread::getQueuedFileFull(FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id)
+std::string ServerDownloadThread::getQueuedFileFull(FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id, int64& predicted_filesize)
 {
 	IScopedLock lock(mutex);
 	int max_prepare = 1;
@@ -1135,6 +1311,7 @@ std::string ServerDownloadThread::getQueuedFileFull(FileClient::MetadataQueue& m
 				metadata = it->metadata_only ? FileClient::MetadataQueue_Metadata : FileClient::MetadataQueue_Data;
 				folder_items = it->folder_items;
 				finish_script = it->script_end;
+				predicted_filesize = it->is_script ? -1 : it->predicted_filesize;
 				return (getDLPath(*it));
 			}
 		}
@@ -1154,7 +1331,8 @@ IFsFile * ServerDownloadThread::getTempFile()
 	IFsFile *pfd = NULL;
 	while (pfd == NULL)
 	{
-		size_t num = tmpfile_num++;
+		size_t num = tmpfile_num;
+		tmpfile_num += tmpfile_num_step;
 			
 		std::string fn = backuppath + os_file_sep() + tmpfile_dirname + os_file_sep() + convert(num);
 		pfd = Server->openFile(os_file_prefix(fn), MODE_RW_CREATE);
@@ -1163,7 +1341,7 @@ IFsFile * ServerDownloadThread::getTempFile()
 		{
 			if (!os_directory_exists(os_file_prefix(backuppath + os_file_sep() + tmpfile_dirname)))
 			{
-				if (num != 0)
+				if (num >= tmpfile_num_step)
 				{
 					ServerLogger::Log(logid, "Temporary file path did not exist. Creating it. (ServerDownloadThread)", LL_DEBUG);
 				}
@@ -1174,7 +1352,7 @@ IFsFile * ServerDownloadThread::getTempFile()
 						+ backuppath + os_file_sep() + tmpfile_dirname+"\". " + os_last_error_str(), LL_WARNING);
 				}
 			}
-			if (num != 0)
+			if (num >= tmpfile_num_step)
 			{
 				ServerLogger::Log(logid, "Error opening temporary file. Retrying...", LL_WARNING);
 				--tries;
@@ -1517,8 +1695,16 @@ bool ServerDownloadThread::stop_shadowcopy(std::string path)
 
 bool ServerDownloadThread::sleepQueue()
 {
+	size_t total_queue_size = 0;
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		IScopedLock lock(lanes[i]->mutex);
+		total_queue_size += lanes[i]->queue_size;
+	}
+
 	IScopedLock lock(mutex);
-	if(queue_size>max_queue_size)
+	total_queue_size += queue_size;
+	if(total_queue_size>max_queue_size*(lanes.size()+1))
 	{
 		lock.relock(NULL);
 		Server->wait(1000);
@@ -1529,16 +1715,33 @@ bool ServerDownloadThread::sleepQueue()
 
 size_t ServerDownloadThread::getNumEmbeddedMetadataFiles()
 {
-	return num_embedded_metadata_files;
+	size_t ret = num_embedded_metadata_files;
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		ret += lanes[i]->getNumEmbeddedMetadataFiles();
+	}
+	return ret;
 }
 
 size_t ServerDownloadThread::getNumIssues()
 {
-	return num_issues;
+	size_t ret = num_issues;
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		ret += lanes[i]->getNumIssues();
+	}
+	return ret;
 }
 
 bool ServerDownloadThread::getHasDiskError()
 {
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		if (lanes[i]->getHasDiskError())
+		{
+			return true;
+		}
+	}
 	return has_disk_error;
 }
 
@@ -1561,6 +1764,11 @@ void ServerDownloadThread::queueSkip()
 	SQueueItem ni;
 	ni.action = EQueueAction_Skip;
 
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		lanes[i]->queueSkip();
+	}
+
 	IScopedLock lock(mutex);
 	dl_queue.push_front(ni);
 	cond->notify_one();
@@ -1601,6 +1809,14 @@ void ServerDownloadThread::unqueueFileChunked( const std::string& remotefn )
 
 bool ServerDownloadThread::isAllDownloadsOk()
 {
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		if (!lanes[i]->isAllDownloadsOk())
+		{
+			return false;
+		}
+	}
+
 	IScopedLock lock(mutex);
 	return all_downloads_ok;
 }
@@ -1897,11 +2113,25 @@ bool ServerDownloadThread::logScriptOutput(std::string cfn, const SQueueItem &to
 
 bool ServerDownloadThread::hasTimeout()
 {
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		if (lanes[i]->hasTimeout())
+		{
+			return true;
+		}
+	}
 	return has_timeout;
 }
 
 bool ServerDownloadThread::shouldBackoff()
 {
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		if (lanes[i]->shouldBackoff())
+		{
+			return true;
+		}
+	}
 	return exp_backoff;
 }
 
@@ -2044,3 +2274,162 @@ void ServerDownloadThread::base_dir_lost_hint()
 		"system snapshot it was backing up was deleted because it ran out of snapshot storage space. "
 		"See https://www.urbackup.org/faq.html#base_dir_lost for details and for how to fix this issue", LL_INFO);
 }
+
+void ServerDownloadThread::addParallelConnection(FileClient* p_fc, FileClientChunked* p_fc_chunked)
+{
+	ServerDownloadThread* lane = new ServerDownloadThread(*p_fc, p_fc_chunked, backuppath, backuppath_hashes,
+		last_backuppath, last_backuppath_complete, hashed_transfer, save_incomplete_file, clientid,
+		clientname, clientsubname, use_tmpfiles, tmpfile_path, server_token, use_reflink, backupid, r_incremental,
+		hashpipe_prepare, client_main, filesrv_protocol_version, incremental_num, logid, with_hashes, shares_without_snapshot,
+		with_sparse_hashing, file_metadata_download, sc_failure_fatal, filepath_corrections, max_file_id, telemetry);
+
+	lane->lane_fc.reset(p_fc);
+	lane->lane_fc_chunked.reset(p_fc_chunked);
+	lane->primary = this;
+
+	lanes.push_back(lane);
+
+	//Each connection uses its own temporary file names
+	tmpfile_num_step = lanes.size() + 1;
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		lanes[i]->tmpfile_num = i + 1;
+		lanes[i]->tmpfile_num_step = tmpfile_num_step;
+	}
+}
+
+size_t ServerDownloadThread::getNumConnections()
+{
+	return lanes.size() + 1;
+}
+
+int64 ServerDownloadThread::getParallelReceivedDataBytes(bool with_sparse)
+{
+	int64 ret = 0;
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		ret += lanes[i]->fc.getReceivedDataBytes(with_sparse);
+		if (lanes[i]->fc_chunked != NULL)
+		{
+			ret += lanes[i]->fc_chunked->getReceivedDataBytes(with_sparse);
+		}
+	}
+	return ret;
+}
+
+int64 ServerDownloadThread::getParallelTransferredBytes()
+{
+	int64 ret = 0;
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		ret += lanes[i]->fc.getTransferredBytes();
+		if (lanes[i]->fc_chunked != NULL)
+		{
+			ret += lanes[i]->fc_chunked->getTransferredBytes();
+		}
+	}
+	return ret;
+}
+
+int64 ServerDownloadThread::getParallelRealTransferredBytes()
+{
+	int64 ret = 0;
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		ret += lanes[i]->fc.getRealTransferredBytes();
+		if (lanes[i]->fc_chunked != NULL)
+		{
+			ret += lanes[i]->fc_chunked->getRealTransferredBytes();
+		}
+	}
+	return ret;
+}
+
+ServerDownloadThread* ServerDownloadThread::getLeastLoadedLane()
+{
+	ServerDownloadThread* ret = this;
+	size_t ret_queue_size;
+	{
+		IScopedLock lock(mutex);
+		ret_queue_size = queue_size;
+	}
+
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		IScopedLock lock(lanes[i]->mutex);
+		if (lanes[i]->queue_size < ret_queue_size)
+		{
+			ret = lanes[i];
+			ret_queue_size = lanes[i]->queue_size;
+		}
+	}
+
+	return ret;
+}
+
+void ServerDownloadThread::pushQueueItem(const SQueueItem& ni, size_t n_queue_items)
+{
+	IScopedLock lock(mutex);
+	dl_queue.push_back(ni);
+	cond->notify_one();
+
+	queue_size += n_queue_items;
+}
+
+void ServerDownloadThread::queueBarrier(SQueueItem& ni)
+{
+	ni.barrier = new SDownloadBarrier(lanes.size() + 1);
+
+	pushQueueItem(ni, 0);
+	for (size_t i = 0; i < lanes.size(); ++i)
+	{
+		lanes[i]->pushQueueItem(ni, 0);
+	}
+}
+
+bool ServerDownloadThread::waitBarrier(SDownloadBarrier* barrier)
+{
+	ServerDownloadThread* owner = primary != NULL ? primary : this;
+
+	IScopedLock lock(owner->barrier_mutex);
+	++barrier->n_arrived;
+
+	if (primary == NULL)
+	{
+		while (barrier->n_arrived < barrier->n_lanes)
+		{
+			barrier_cond->wait(&lock);
+		}
+		return true;
+	}
+
+	owner->barrier_cond->notify_all();
+
+	while (!barrier->released)
+	{
+		owner->barrier_cond->wait(&lock);
+	}
+
+	++barrier->n_passed;
+	if (barrier->n_passed == barrier->n_lanes)
+	{
+		delete barrier;
+	}
+
+	return false;
+}
+
+void ServerDownloadThread::releaseBarrier(SDownloadBarrier* barrier)
+{
+	IScopedLock lock(barrier_mutex);
+	barrier->released = true;
+	++barrier->n_passed;
+	if (barrier->n_passed == barrier->n_lanes)
+	{
+		delete barrier;
+	}
+	else
+	{
+		barrier_cond->notify_all();
+	}
+}
@@ -5,6 +5,8 @@
 #include <algorithm>
 #include <assert.h>
 #include <set>
+#include <vector>
+#include <memory>
 
 #include "../Interface/Mutex.h"
 #include "../Interface/Condition.h"
@@ -21,6 +23,7 @@ class FileClient;
 class FileClientChunked;
 class FilePathCorrections;
 class MaxFileId;
+class BackupTelemetry;
 
 namespace server {
 	class FileMetadataDownloadThread;
@@ -56,6 +59,19 @@ namespace
 		std::string filepath_old;
 	};
 
+	struct SDownloadBarrier
+	{
+		SDownloadBarrier(size_t n_lanes)
+			: n_lanes(n_lanes), n_arrived(0), n_passed(0), released(false)
+		{
+		}
+
+		size_t n_lanes;
+		size_t n_arrived;
+		size_t n_passed;
+		bool released;
+	};
+
 	struct SQueueItem
 	{
 		SQueueItem()
@@ -67,7 +83,9 @@ namespace
 			folder_items(0),
 			script_end(false),
 			switched(false),
-			write_metadata(false)
+			write_metadata(false),
+			track_download(false),
+			barrier(NULL)
 		{
 		}
 
@@ -91,6 +109,8 @@ namespace
 		std::string sha_dig;
 		unsigned int script_random;
 		bool switched;
+		bool track_download;
+		SDownloadBarrier* barrier;
 	};
 	
 	
@@ -147,7 +167,7 @@ public:
 		bool use_tmpfiles, const std::string& tmpfile_path, const std::string& server_token, bool use_reflink, int backupid, bool r_incremental, IPipe* hashpipe_prepare, ClientMain* client_main,
 		int filesrv_protocol_version, int incremental_num, logid_t logid, bool with_hashes, const std::vector<std::string>& shares_without_snapshot,
 		bool with_sparse_hashing, server::FileMetadataDownloadThread* file_metadata_download, bool sc_failure_fatal, FilePathCorrections& filepath_corrections,
-		MaxFileId& max_file_id);
+		MaxFileId& max_file_id, BackupTelemetry* telemetry);
 
 	~ServerDownloadThread();
 
@@ -193,7 +213,7 @@ public:
 
 	virtual void resetQueueFull();
 
-	virtual std::string getQueuedFileFull(FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id);
+	virtual std::string getQueuedFileFull(FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id, int64& predicted_filesize);
 
 	virtual void unqueueFileFull(const std::string& fn, bool finish_script);
 
@@ -215,8 +235,31 @@ public:
 
 	bool deleteTempFolder();
 
+	//Adds another connection to the client's file server (takes ownership).
+	//Must be called before the thread is started. Files are distributed
+	//to the least loaded connection, scripts stay on the first one.
+	void addParallelConnection(FileClient* p_fc, FileClientChunked* p_fc_chunked);
+
+	size_t getNumConnections();
+
+	int64 getParallelReceivedDataBytes(bool with_sparse);
+
+	int64 getParallelTransferredBytes();
+
+	int64 getParallelRealTransferredBytes();
+
 private:
 
+	ServerDownloadThread* getLeastLoadedLane();
+
+	void pushQueueItem(const SQueueItem& ni, size_t n_queue_items);
+
+	void queueBarrier(SQueueItem& ni);
+
+	bool waitBarrier(SDownloadBarrier* barrier);
+
+	void releaseBarrier(SDownloadBarrier* barrier);
+
 	IFsFile* getTempFile();
 
 	std::string getDLPath(const SQueueItem& todl);
@@ -306,6 +349,18 @@ private:
 	bool sc_failure_fatal;
 
 	size_t tmpfile_num;
+	size_t tmpfile_num_step;
 
 	MaxFileId& max_file_id;
+
+	BackupTelemetry* telemetry;
+
+	ServerDownloadThread* primary;
+	std::vector<ServerDownloadThread*> lanes;
+	std::vector<THREADPOOL_TICKET> lane_tickets;
+	std::auto_ptr<FileClient> lane_fc;
+	std::auto_ptr<FileClientChunked> lane_fc_chunked;
+	IMutex* barrier_mutex;
+	ICondition* barrier_cond;
+	bool curr_hashed;
 };
@@ -0,0 +1,218 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "../../Interface/Server.h"
+#include "../../Interface/Thread.h"
+#include "../../Interface/ThreadPool.h"
+#include "../../urbackupcommon/InternetServicePipe2.h"
+#include "../../urbackupcommon/CompressedPipeZstd.h"
+#include "../../cryptoplugin/ICryptoFactory.h"
+#include "../../stringtools.h"
+#include "../../socket_header.h"
+#include <vector>
+#include <memory>
+#include <string.h>
+
+extern ICryptoFactory *crypto_fak;
+
+namespace
+{
+	const size_t c_default_bench_mb = 1024;
+	const size_t c_write_size = 32 * 1024;
+	const size_t c_data_size = 1024 * 1024;
+	const int c_bench_compression_level = 3;
+
+	class PipeWriter : public IThread
+	{
+	public:
+		PipeWriter(IPipe* pipe, const std::vector<char>& data, size_t total_bytes)
+			: pipe(pipe), data(data), total_bytes(total_bytes), ok(false)
+		{
+		}
+
+		void operator()()
+		{
+			size_t written = 0;
+			while (written < total_bytes)
+			{
+				size_t off = written % data.size();
+				size_t tw = (std::min)(c_write_size, (std::min)(data.size() - off, total_bytes - written));
+				written += tw;
+				if (!pipe->Write(&data[off], tw, -1, written == total_bytes))
+				{
+					return;
+				}
+			}
+			ok = true;
+		}
+
+		bool isOk()
+		{
+			return ok;
+		}
+
+	private:
+		IPipe* pipe;
+		const std::vector<char>& data;
+		size_t total_bytes;
+		bool ok;
+	};
+
+	bool bench_stack(const std::string& name, bool with_compression, const std::vector<char>& data, size_t total_bytes)
+	{
+		int sv[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+		{
+			Server->Log("Error creating socket pair", LL_ERROR);
+			return false;
+		}
+
+		std::auto_ptr<IPipe> send_sock(Server->PipeFromSocket(sv[0]));
+		std::auto_ptr<IPipe> recv_sock(Server->PipeFromSocket(sv[1]));
+
+		std::string key = "bench key";
+		InternetServicePipe2 send_isp(send_sock.get(), key);
+		InternetServicePipe2 recv_isp(recv_sock.get(), key);
+
+		IPipe* send_pipe = &send_isp;
+		IPipe* recv_pipe = &recv_isp;
+
+#ifndef NO_ZSTD_COMPRESSION
+		std::auto_ptr<CompressedPipeZstd> send_comp;
+		std::auto_ptr<CompressedPipeZstd> recv_comp;
+		if (with_compression)
+		{
+			send_comp.reset(new CompressedPipeZstd(&send_isp, c_bench_compression_level, 0));
+			recv_comp.reset(new CompressedPipeZstd(&recv_isp, c_bench_compression_level, 0));
+			send_pipe = send_comp.get();
+			recv_pipe = recv_comp.get();
+		}
+#else
+		if (with_compression)
+		{
+			Server->Log("Compiled without zstd compression", LL_ERROR);
+			return false;
+		}
+#endif
+
+		int64 starttime = Server->getTimeMS();
+
+		PipeWriter writer(send_pipe, data, total_bytes);
+		THREADPOOL_TICKET ticket = Server->getThreadPool()->execute(&writer, "crypt bench");
+
+		std::vector<char> buf(c_data_size);
+		size_t received = 0;
+		bool ret = true;
+		while (received < total_bytes)
+		{
+			size_t rc = recv_pipe->ReadInto(buf.data(), buf.size(), (std::min)(buf.size(), total_bytes - received));
+			if (rc == 0)
+			{
+				Server->Log("Error reading from pipe after " + PrettyPrintBytes(received), LL_ERROR);
+				ret = false;
+				break;
+			}
+
+			size_t off = received % data.size();
+			size_t cmp = (std::min)(rc, data.size() - off);
+			if (memcmp(buf.data(), &data[off], cmp) != 0)
+			{
+				Server->Log("Received wrong data at " + PrettyPrintBytes(received), LL_ERROR);
+				ret = false;
+				break;
+			}
+
+			received += rc;
+		}
+
+		int64 passed_ms = Server->getTimeMS() - starttime;
+		if (passed_ms <= 0)
+		{
+			passed_ms = 1;
+		}
+
+		if (!ret)
+		{
+			send_sock->shutdown();
+		}
+
+		Server->getThreadPool()->waitFor(ticket);
+
+		if (!writer.isOk())
+		{
+			ret = false;
+		}
+
+		Server->Log(name + ": " + convert((received / (1024.0*1024.0)) / (passed_ms / 1000.0)) + " MB/s"
+			+ " (" + PrettyPrintBytes(send_sock->getTransferedBytes()) + " transferred)", LL_INFO);
+
+		return ret;
+	}
+}
+
+int crypt_pipe_bench()
+{
+#ifdef _WIN32
+	Server->Log("crypt_pipe_bench is not supported on Windows", LL_ERROR);
+	return 1;
+#else
+	if (crypto_fak == NULL)
+	{
+		str_map params;
+		crypto_fak = (ICryptoFactory *)Server->getPlugin(Server->getThreadID(), Server->StartPlugin("cryptoplugin", params));
+		if (crypto_fak == NULL)
+		{
+			Server->Log("Error loading Cryptoplugin", LL_ERROR);
+			return 1;
+		}
+	}
+
+	size_t bench_mb = c_default_bench_mb;
+	std::string s_bench_mb = Server->getServerParameter("bench_mb");
+	if (!s_bench_mb.empty())
+	{
+		bench_mb = watoi(s_bench_mb);
+	}
+
+	//Half random, half zero bytes, so it is somewhat compressible
+	std::vector<char> data(c_data_size);
+	unsigned int rnd = 1;
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		rnd = rnd * 1103515245 + 12345;
+		data[i] = (i / 64) % 2 == 0 ? static_cast<char>(rnd >> 16) : 0;
+	}
+
+	size_t total_bytes = bench_mb * 1024 * 1024;
+
+	Server->Log("Sending " + PrettyPrintBytes(total_bytes) + " over socket pair...", LL_INFO);
+
+	int rc = 0;
+	if (!bench_stack("Encrypted", false, data, total_bytes))
+	{
+		rc = 1;
+	}
+
+	if (!bench_stack("Encrypted+zstd", true, data, total_bytes))
+	{
+		rc = 1;
+	}
+
+	return rc;
+#endif
+}
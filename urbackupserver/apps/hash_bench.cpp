@@ -0,0 +1,154 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "../../Interface/Server.h"
+#include "../../urbackupcommon/sha2/sha2.h"
+#include "../../common/adler32.h"
+#include "../../fileservplugin/chunk_settings.h"
+#include "../../stringtools.h"
+#include <vector>
+#include <stdlib.h>
+
+namespace
+{
+	const size_t c_default_bench_mb = 256;
+	const size_t c_bench_buffer_size = 8 * 1024 * 1024;
+
+	double mb_per_s(size_t bytes, int64 passed_ms)
+	{
+		if (passed_ms <= 0)
+		{
+			passed_ms = 1;
+		}
+		return (bytes / (1024.0*1024.0)) / (passed_ms / 1000.0);
+	}
+
+	std::string bench_sha256(const std::vector<unsigned char>& data, size_t total_bytes)
+	{
+		sha256_ctx ctx;
+		sha256_init(&ctx);
+		int64 starttime = Server->getTimeMS();
+		for (size_t done = 0; done < total_bytes; done += data.size())
+		{
+			sha256_update(&ctx, data.data(), static_cast<unsigned int>(data.size()));
+		}
+		unsigned char dig[SHA256_DIGEST_SIZE];
+		sha256_final(&ctx, dig);
+		int64 passed_ms = Server->getTimeMS() - starttime;
+
+		Server->Log("sha256: " + convert(mb_per_s(total_bytes, passed_ms)) + " MB/s", LL_INFO);
+
+		return std::string(reinterpret_cast<char*>(dig), SHA256_DIGEST_SIZE);
+	}
+
+	void bench_sha512(const std::vector<unsigned char>& data, size_t total_bytes)
+	{
+		sha512_ctx ctx;
+		sha512_init(&ctx);
+		int64 starttime = Server->getTimeMS();
+		for (size_t done = 0; done < total_bytes; done += data.size())
+		{
+			sha512_update(&ctx, data.data(), static_cast<unsigned int>(data.size()));
+		}
+		unsigned char dig[SHA512_DIGEST_SIZE];
+		sha512_final(&ctx, dig);
+		int64 passed_ms = Server->getTimeMS() - starttime;
+
+		Server->Log("sha512: " + convert(mb_per_s(total_bytes, passed_ms)) + " MB/s", LL_INFO);
+	}
+
+	void bench_adler32(const std::vector<unsigned char>& data, size_t total_bytes, std::vector<unsigned int>& small_hashes)
+	{
+		const char* buf = reinterpret_cast<const char*>(data.data());
+		size_t n_checkpoints = data.size() / c_checkpoint_dist;
+		small_hashes.resize(n_checkpoints*(c_checkpoint_dist / c_small_hash_dist));
+
+		int64 starttime = Server->getTimeMS();
+		for (size_t done = 0; done < total_bytes; done += n_checkpoints*c_checkpoint_dist)
+		{
+			for (size_t i = 0; i < n_checkpoints; ++i)
+			{
+				urb_adler32_blocks(buf + i*c_checkpoint_dist, static_cast<unsigned int>(c_checkpoint_dist),
+					c_small_hash_dist, small_hashes.data() + i*(c_checkpoint_dist / c_small_hash_dist));
+			}
+		}
+		int64 passed_ms = Server->getTimeMS() - starttime;
+
+		Server->Log("adler32 (" + urb_adler32_accel_name() + ", " + PrettyPrintBytes(c_small_hash_dist) + " blocks): "
+			+ convert(mb_per_s(total_bytes, passed_ms)) + " MB/s", LL_INFO);
+	}
+}
+
+int hash_bench()
+{
+	size_t bench_mb = c_default_bench_mb;
+	std::string s_bench_mb = Server->getServerParameter("bench_mb");
+	if (!s_bench_mb.empty())
+	{
+		bench_mb = watoi(s_bench_mb);
+	}
+
+	size_t total_bytes = bench_mb * 1024 * 1024;
+
+	std::vector<unsigned char> data(c_bench_buffer_size);
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		data[i] = static_cast<unsigned char>(rand());
+	}
+
+	int rc = 0;
+	std::string sha256_portable;
+	std::vector<unsigned int> adler_portable;
+	for (int accel = 0; accel < 2; ++accel)
+	{
+		sha2_set_accel(accel != 0);
+		urb_adler32_set_accel(accel != 0);
+
+		Server->Log("Hashing " + PrettyPrintBytes(total_bytes) + " with " + sha2_accel_name() + "...", LL_INFO);
+
+		std::string sha256_dig = bench_sha256(data, total_bytes);
+		if (accel == 0)
+		{
+			sha256_portable = sha256_dig;
+		}
+		else if (sha256_dig != sha256_portable)
+		{
+			Server->Log("sha256 result differs from portable implementation", LL_ERROR);
+			rc = 1;
+		}
+
+		bench_sha512(data, total_bytes);
+
+		std::vector<unsigned int> small_hashes;
+		bench_adler32(data, total_bytes, small_hashes);
+		if (accel == 0)
+		{
+			adler_portable = small_hashes;
+		}
+		else if (small_hashes != adler_portable)
+		{
+			Server->Log("adler32 results differ from portable implementation", LL_ERROR);
+			rc = 1;
+		}
+	}
+
+	sha2_set_accel(true);
+	urb_adler32_set_accel(true);
+
+	return rc;
+}
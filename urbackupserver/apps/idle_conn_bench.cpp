@@ -0,0 +1,206 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "../../Interface/Server.h"
+#include "../../Interface/Service.h"
+#include "../../Interface/CustomClient.h"
+#include "../../Interface/Pipe.h"
+#include "../../stringtools.h"
+#include "../../socket_header.h"
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+	const size_t c_default_bench_connections = 2000;
+	const unsigned short c_default_bench_port = 55420;
+	const int64 c_default_bench_idle_ms = 10000;
+	const size_t c_bench_pings = 1000;
+
+	class EchoClient : public ICustomClient
+	{
+	public:
+		EchoClient()
+			: pipe(NULL)
+		{
+		}
+
+		virtual void Init(THREAD_ID pTID, IPipe *pPipe, const std::string& pEndpointName)
+		{
+			pipe = pPipe;
+		}
+
+		virtual bool Run(IRunOtherCallback* run_other)
+		{
+			return !pipe->hasError();
+		}
+
+		virtual void ReceivePackets(IRunOtherCallback* run_other)
+		{
+			std::string data;
+			if (pipe->Read(&data, 0) > 0)
+			{
+				pipe->Write(data);
+			}
+		}
+
+	private:
+		IPipe* pipe;
+	};
+
+	class EchoService : public IService
+	{
+	public:
+		virtual ICustomClient* createClient()
+		{
+			return new EchoClient;
+		}
+
+		virtual void destroyClient(ICustomClient * pClient)
+		{
+			delete pClient;
+		}
+	};
+
+	int64 get_cpu_time_ms()
+	{
+#ifndef _WIN32
+		rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) == 0)
+		{
+			return static_cast<int64>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000
+				+ (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+		}
+#endif
+		return 0;
+	}
+
+	bool ping_pong(IPipe* pipe, size_t n_pings, int64& passed_ms)
+	{
+		int64 starttime = Server->getTimeMS();
+		std::string ret;
+		for (size_t i = 0; i < n_pings; ++i)
+		{
+			if (!pipe->Write("ping"))
+			{
+				return false;
+			}
+
+			ret.clear();
+			while (ret.size() < 4)
+			{
+				std::string data;
+				if (pipe->Read(&data, 10000) == 0)
+				{
+					return false;
+				}
+				ret += data;
+			}
+		}
+		passed_ms = Server->getTimeMS() - starttime;
+		return true;
+	}
+}
+
+/**
+* Measures the CPU time the service workers burn for many idle connections
+* and the round trip time of an echo on one of the connections.
+*/
+int idle_conn_bench()
+{
+	size_t n_connections = c_default_bench_connections;
+	std::string s_connections = Server->getServerParameter("bench_connections");
+	if (!s_connections.empty())
+	{
+		n_connections = watoi(s_connections);
+	}
+
+	unsigned short port = c_default_bench_port;
+	std::string s_port = Server->getServerParameter("bench_port");
+	if (!s_port.empty())
+	{
+		port = static_cast<unsigned short>(watoi(s_port));
+	}
+
+	int64 idle_ms = c_default_bench_idle_ms;
+	std::string s_idle = Server->getServerParameter("bench_idle_seconds");
+	if (!s_idle.empty())
+	{
+		idle_ms = watoi64(s_idle) * 1000;
+	}
+
+	int max_clients_per_thread = -1;
+	std::string s_max_clients = Server->getServerParameter("bench_max_clients_per_thread");
+	if (!s_max_clients.empty())
+	{
+		max_clients_per_thread = watoi(s_max_clients);
+	}
+
+	Server->StartCustomStreamService(new EchoService, "idle_conn_bench", port, max_clients_per_thread, IServer::BindTarget_Localhost);
+
+	std::vector<IPipe*> connections;
+	for (size_t i = 0; i < n_connections; ++i)
+	{
+		IPipe* c = Server->ConnectStream("127.0.0.1", port, 10000);
+		if (c == NULL)
+		{
+			Server->Log("Connecting to bench service failed after " + convert(connections.size()) + " connections. Check the open file limit.", LL_ERROR);
+			break;
+		}
+		connections.push_back(c);
+	}
+
+	int rc = 0;
+	if (!connections.empty())
+	{
+		//Let the workers pick up all connections
+		Server->wait(1000);
+
+		int64 idle_cpu_start = get_cpu_time_ms();
+		Server->wait(static_cast<unsigned int>(idle_ms));
+		int64 idle_cpu_ms = get_cpu_time_ms() - idle_cpu_start;
+
+		Server->Log(convert(connections.size()) + " idle connections: " + convert(idle_cpu_ms) + "ms CPU time in "
+			+ PrettyPrintTime(idle_ms) + " (" + convert(static_cast<double>(idle_cpu_ms) * 100 / idle_ms) + "% of one core)", LL_INFO);
+
+		int64 ping_ms;
+		if (ping_pong(connections[connections.size() / 2], c_bench_pings, ping_ms))
+		{
+			Server->Log("Echo round trip with " + convert(connections.size()) + " connections: "
+				+ convert(static_cast<double>(ping_ms) / c_bench_pings) + "ms", LL_INFO);
+		}
+		else
+		{
+			Server->Log("Echo on bench connection failed", LL_ERROR);
+			rc = 1;
+		}
+	}
+	else
+	{
+		rc = 1;
+	}
+
+	for (size_t i = 0; i < connections.size(); ++i)
+	{
+		Server->destroy(connections[i]);
+	}
+
+	return rc;
+}
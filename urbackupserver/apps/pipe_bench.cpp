@@ -0,0 +1,163 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "../../Interface/Server.h"
+#include "../../Interface/RingBufferPipe.h"
+#include "../../Interface/Thread.h"
+#include "../../Interface/ThreadPool.h"
+#include "../../stringtools.h"
+#include <vector>
+#include <memory>
+#include <string.h>
+
+namespace
+{
+	const size_t c_default_bench_messages = 1000000;
+	const size_t c_default_bench_msg_size = 256;
+	const size_t c_bench_capacity = 2 * 1024 * 1024;
+	const char c_fill_char = 'x';
+
+	class PipeProducer : public IThread
+	{
+	public:
+		PipeProducer(IPipe* pipe, size_t n_messages, size_t msg_size)
+			: pipe(pipe), n_messages(n_messages), msg_size(msg_size)
+		{
+		}
+
+		void operator()()
+		{
+			std::string msg(msg_size, c_fill_char);
+			for (size_t i = 0; i < n_messages; ++i)
+			{
+				pipe->Write(msg);
+			}
+		}
+
+	private:
+		IPipe* pipe;
+		size_t n_messages;
+		size_t msg_size;
+	};
+
+	bool bench_pipe(const std::string& name, IPipe* pipe,
+		size_t n_producers, size_t n_messages, size_t msg_size)
+	{
+		std::vector<PipeProducer*> producers;
+		std::vector<THREADPOOL_TICKET> tickets;
+
+		int64 starttime = Server->getTimeMS();
+
+		for (size_t i = 0; i < n_producers; ++i)
+		{
+			producers.push_back(new PipeProducer(pipe, n_messages, msg_size));
+			tickets.push_back(Server->getThreadPool()->execute(producers[i], "pipe bench"));
+		}
+
+		size_t total_messages = n_producers*n_messages;
+		size_t total_bytes = 0;
+		bool ret = true;
+		std::string msg;
+		for (size_t i = 0; i < total_messages; ++i)
+		{
+			size_t size = pipe->Read(&msg);
+			const char* data = msg.data();
+
+			if (size != msg_size
+				|| data[0] != c_fill_char
+				|| data[size - 1] != c_fill_char)
+			{
+				Server->Log("Received wrong message " + convert(i) + " from pipe", LL_ERROR);
+				ret = false;
+				pipe->shutdown();
+				break;
+			}
+
+			total_bytes += size;
+		}
+
+		int64 passed_ms = Server->getTimeMS() - starttime;
+		if (passed_ms <= 0)
+		{
+			passed_ms = 1;
+		}
+
+		Server->getThreadPool()->waitFor(tickets);
+
+		for (size_t i = 0; i < producers.size(); ++i)
+		{
+			delete producers[i];
+		}
+
+		Server->Log(name + " (" + convert(n_producers) + " producer" + (n_producers > 1 ? "s" : "") + "): "
+			+ convert(static_cast<int64>(total_messages*1000 / passed_ms)) + " msgs/s "
+			+ convert((total_bytes / (1024.0*1024.0)) / (passed_ms / 1000.0)) + " MB/s", LL_INFO);
+
+		return ret;
+	}
+}
+
+int pipe_bench()
+{
+	size_t n_messages = c_default_bench_messages;
+	std::string s_messages = Server->getServerParameter("bench_messages");
+	if (!s_messages.empty())
+	{
+		n_messages = watoi(s_messages);
+	}
+
+	size_t msg_size = c_default_bench_msg_size;
+	std::string s_msg_size = Server->getServerParameter("bench_msg_size");
+	if (!s_msg_size.empty())
+	{
+		msg_size = watoi(s_msg_size);
+	}
+
+	if (msg_size == 0)
+	{
+		msg_size = 1;
+	}
+
+	Server->Log("Sending " + convert(n_messages) + " messages of " + PrettyPrintBytes(msg_size) + "...", LL_INFO);
+
+	int rc = 0;
+	size_t producer_counts[] = { 1, 4 };
+	for (size_t i = 0; i < sizeof(producer_counts) / sizeof(producer_counts[0]); ++i)
+	{
+		size_t n_producers = producer_counts[i];
+		size_t producer_messages = n_messages / n_producers;
+
+		{
+			std::auto_ptr<IPipe> pipe(Server->createMemoryPipe());
+			if (!bench_pipe("Memory pipe", pipe.get(), n_producers, producer_messages, msg_size))
+			{
+				rc = 1;
+			}
+		}
+
+		{
+			std::auto_ptr<IRingBufferPipe> pipe(Server->createRingBufferPipe(c_bench_capacity, n_producers > 1));
+			if (!bench_pipe("Ring buffer pipe", pipe.get(), n_producers, producer_messages, msg_size))
+			{
+				rc = 1;
+			}
+		}
+	}
+
+	return rc;
+}
@@ -322,6 +322,27 @@ void read_config_file(std::string fn, std::vector<std::string>& real_args)
 				real_args.push_back(strlower(val));
 			}
 		}
+		if (settings->getValue("FILEINDEX_FILTER", &val))
+		{
+			val = trim(unquote_value(val));
+
+			if (!val.empty())
+			{
+				if (val == "1") val = "true";
+				real_args.push_back("--fileindex_filter");
+				real_args.push_back(strlower(val));
+			}
+		}
+		if (settings->getValue("FILEINDEX_REBUILD_THREADS", &val))
+		{
+			val = trim(unquote_value(val));
+
+			if (!val.empty())
+			{
+				real_args.push_back("--fileindex_rebuild_threads");
+				real_args.push_back(val);
+			}
+		}
 	}	
 
 	if(destroy_server)
@@ -23,6 +23,7 @@
 #include "database.h"
 #include "server_settings.h"
 #include "LMDBFileIndex.h"
+#include "FileIndexRebuild.h"
 #include "../stringtools.h"
 #include "../urbackupcommon/os_functions.h"
 #include "serverinterface/helper.h"
@@ -158,17 +159,49 @@ bool create_files_index_common(FileIndex& fileindex, SStartupStatus& status)
 
 	Server->Log("Starting creating files index...", LL_INFO);
 
-	IQuery *q_read=db->Prepare("SELECT id, shahash, filesize, clientid, next_entry, prev_entry, pointed_to FROM files ORDER BY shahash ASC, filesize ASC, clientid ASC, created DESC");
+	int rebuild_threads = watoi(Server->getServerParameter("fileindex_rebuild_threads", "0"));
 
-	SCallbackData data;
-	data.cur=q_read->Cursor();
-	data.pos=0;
-	data.max_pos=n_files;
-	data.status=&status;
+	if (rebuild_threads > 0)
+	{
+		size_t rebuild_memory = watoi64(Server->getServerParameter("fileindex_rebuild_memory", "1024")) * 1024 * 1024;
+
+		std::auto_ptr<FileIndexRebuild> rebuild(new FileIndexRebuild(status, rebuild_threads, rebuild_memory));
+
+		if (!rebuild->sort_runs(n_files)
+			|| !rebuild->start_merge())
+		{
+			return false;
+		}
+
+		{
+			DBScopedWriteTransaction write_transaction(db_files_new);
+			fileindex.create(rebuild.get());
+		}
 
+		if (rebuild->has_error())
+		{
+			return false;
+		}
+	}
+	else
 	{
-		DBScopedWriteTransaction write_transaction(db_files_new);
-		fileindex.create(create_callback, &data);
+		IQuery *q_read=db->Prepare("SELECT id, shahash, filesize, clientid, next_entry, prev_entry, pointed_to FROM files ORDER BY shahash ASC, filesize ASC, clientid ASC, created DESC");
+
+		SCallbackData data;
+		data.cur=q_read->Cursor();
+		data.pos=0;
+		data.max_pos=n_files;
+		data.status=&status;
+
+		{
+			DBScopedWriteTransaction write_transaction(db_files_new);
+			fileindex.create(create_callback, &data);
+		}
+
+		if (data.cur->has_error())
+		{
+			return false;
+		}
 	}
 
 	if(fileindex.has_error())
@@ -177,10 +210,8 @@ bool create_files_index_common(FileIndex& fileindex, SStartupStatus& status)
 	}
 	else
 	{
-		if (data.cur->has_error())
-		{
-			return false;
-		}
+		//Sorted runs are only valid for the unmodified files table
+		FileIndexRebuild::cleanup();
 
 		Server->Log("Creating backupid index...", LL_INFO);
 
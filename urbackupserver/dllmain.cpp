@@ -97,6 +97,7 @@ SStartupStatus startup_status;
 #include "../urbackupcommon/WalCheckpointThread.h"
 #include "FileMetadataDownloadThread.h"
 #include "../urbackupcommon/chunk_hasher.h"
+#include "../urbackupcommon/CompressedPipeZstd.h"
 #include "LogReport.h"
 
 #define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
@@ -151,6 +152,10 @@ bool verify_hashes(std::string arg);
 void updateRights(int t_userid, std::string s_rights, IDatabase *db);
 int md5sum_check();
 int blockalign();
+int hash_bench();
+int pipe_bench();
+int crypt_pipe_bench();
+int idle_conn_bench();
 
 std::string lang="en";
 std::string time_format_str="%Y-%m-%d %H:%M";
@@ -522,10 +527,26 @@ DLLEXPORT void LoadActions(IServer* pServer)
 		{
 			rc = blockalign();
 		}
+		else if (app == "hash_bench")
+		{
+			rc = hash_bench();
+		}
+		else if (app == "pipe_bench")
+		{
+			rc = pipe_bench();
+		}
+		else if (app == "crypt_pipe_bench")
+		{
+			rc = crypt_pipe_bench();
+		}
+		else if (app == "idle_conn_bench")
+		{
+			rc = idle_conn_bench();
+		}
 		else
 		{
 			rc=100;
-			Server->Log("App not found. Available apps: cleanup, remove_unknown, cleanup_database, repair_database, defrag_database, export_auth_log, check_fileindex, skiphash_copy, md5sum_check, hash, blockalign");
+			Server->Log("App not found. Available apps: cleanup, remove_unknown, cleanup_database, repair_database, defrag_database, export_auth_log, check_fileindex, skiphash_copy, md5sum_check, hash, blockalign, hash_bench, pipe_bench, crypt_pipe_bench, idle_conn_bench");
 		}
 		exit(rc);
 	}
@@ -650,6 +671,9 @@ DLLEXPORT void LoadActions(IServer* pServer)
 	DataplanDb::init();
 	init_log_report();
 	ServerChannelThread::init_mutex();
+#ifndef NO_ZSTD_COMPRESSION
+	CompressedPipeZstd::init_mutex();
+#endif
 
 	open_settings_database();
 	
@@ -460,7 +460,7 @@ FileDownload::FileDownload( std::string servername, unsigned int tcpport )
 	fc->setQueueCallback(this);
 }
 
-std::string FileDownload::getQueuedFileFull( FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id)
+std::string FileDownload::getQueuedFileFull( FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id, int64& predicted_filesize)
 {
 	for(size_t i=0;i<dlqueueFull.size();++i)
 	{
@@ -469,6 +469,7 @@ std::string FileDownload::getQueuedFileFull( FileClient::MetadataQueue& metadata
 			metadata=FileClient::MetadataQueue_Data;
 			folder_items=0;
 			file_id=0;
+			predicted_filesize=-1;
 			finish_script=false;
 			return dlqueueFull[i].remotefn;
 		}
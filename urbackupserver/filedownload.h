@@ -48,7 +48,7 @@ public:
 	virtual void unqueueFileChunked(const std::string& remotefn);
 	virtual void resetQueueChunked();
 
-	virtual std::string getQueuedFileFull(FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id);
+	virtual std::string getQueuedFileFull(FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id, int64& predicted_filesize);
 	virtual void unqueueFileFull(const std::string& fn, bool finish_script);
 	virtual void resetQueueFull();
 private:
@@ -42,6 +42,7 @@ const int max_offline=5;
 
 IPipeThrottler *BackupServer::global_internet_throttler=NULL;
 IPipeThrottler *BackupServer::global_local_throttler=NULL;
+std::map<std::pair<int, bool>, IPipeThrottler*> BackupServer::group_throttlers;
 IMutex *BackupServer::throttle_mutex=NULL;
 bool BackupServer::file_snapshots_enabled=false;
 bool BackupServer::image_snapshots_enabled = false;
@@ -666,6 +667,15 @@ IPipeThrottler *BackupServer::getGlobalInternetThrottler(int speed_bps)
 	{
 		global_internet_throttler=Server->createPipeThrottler(
 			new ThrottleUpdater(-1, ThrottleScope_GlobalInternet));
+
+		for (std::map<std::pair<int, bool>, IPipeThrottler*>::iterator it = group_throttlers.begin();
+			it != group_throttlers.end(); ++it)
+		{
+			if (it->first.second)
+			{
+				it->second->setParent(global_internet_throttler, 1);
+			}
+		}
 	}
 	else
 	{
@@ -692,6 +702,15 @@ IPipeThrottler *BackupServer::getGlobalLocalThrottler(int speed_bps)
 	{
 		global_local_throttler=Server->createPipeThrottler(
 			new ThrottleUpdater(-1, ThrottleScope_GlobalLocal));
+
+		for (std::map<std::pair<int, bool>, IPipeThrottler*>::iterator it = group_throttlers.begin();
+			it != group_throttlers.end(); ++it)
+		{
+			if (!it->first.second)
+			{
+				it->second->setParent(global_local_throttler, 1);
+			}
+		}
 	}
 	else
 	{
@@ -703,8 +722,41 @@ IPipeThrottler *BackupServer::getGlobalLocalThrottler(int speed_bps)
 	return global_local_throttler;
 }
 
+IPipeThrottler * BackupServer::getClientGroupThrottler(int groupid, bool internet)
+{
+	IScopedLock lock(throttle_mutex);
+
+	std::pair<int, bool> key(groupid, internet);
+	std::map<std::pair<int, bool>, IPipeThrottler*>::iterator it = group_throttlers.find(key);
+	if (it != group_throttlers.end())
+	{
+		return it->second;
+	}
+
+	//Groups have no limit of their own. They share the global
+	//limit fairly between the groups
+	IPipeThrottler* group_throttler = Server->createPipeThrottler(0, false);
+
+	IPipeThrottler* global_throttler = internet ? global_internet_throttler : global_local_throttler;
+	if (global_throttler != NULL)
+	{
+		group_throttler->setParent(global_throttler, 1);
+	}
+
+	group_throttlers[key] = group_throttler;
+
+	return group_throttler;
+}
+
 void BackupServer::cleanupThrottlers(void)
 {
+	for (std::map<std::pair<int, bool>, IPipeThrottler*>::iterator it = group_throttlers.begin();
+		it != group_throttlers.end(); ++it)
+	{
+		Server->destroy(it->second);
+	}
+	group_throttlers.clear();
+
 	if(global_internet_throttler!=NULL)
 	{
 		Server->destroy(global_internet_throttler);
@@ -31,6 +31,7 @@ public:
 	static size_t throttleSpeedToBps(int speed_bps, bool& percent_max);
 	static IPipeThrottler *getGlobalInternetThrottler(int speed_bps);
 	static IPipeThrottler *getGlobalLocalThrottler(int speed_bps);
+	static IPipeThrottler *getClientGroupThrottler(int groupid, bool internet);
 
 	static void cleanupThrottlers(void);
 
@@ -101,6 +102,7 @@ private:
 
 	static IPipeThrottler *global_internet_throttler;
 	static IPipeThrottler *global_local_throttler;
+	static std::map<std::pair<int, bool>, IPipeThrottler*> group_throttlers;
 	static IMutex *throttle_mutex;
 
 	bool internet_only_mode;
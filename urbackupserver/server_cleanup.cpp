@@ -38,6 +38,7 @@
 #include "dao/ServerLinkDao.h"
 #include "dao/ServerFilesDao.h"
 #include "server_dir_links.h"
+#include "ParallelDelete.h"
 #include <stdio.h>
 #include <algorithm>
 #include "create_files_index.h"
@@ -60,6 +61,7 @@ bool ServerCleanupThread::allow_clientlist_deletion = true;
 void cleanupLastActs();
 
 const unsigned int min_cleanup_interval=12*60*60;
+const size_t file_entry_update_batch_size=100000;
 
 void ServerCleanupThread::initMutex(void)
 {
@@ -144,6 +146,8 @@ void ServerCleanupThread::operator()(void)
 	}
 
 	int64 last_cleanup=0;
+	int64 last_incremental_stats=0;
+	int stats_update_interval=10;
 
 	Server->waitForStartupComplete();
 
@@ -271,7 +275,7 @@ void ServerCleanupThread::operator()(void)
 			IScopedLock lock(mutex);
 			if(!update_stats)
 			{
-				cond->wait(&lock, 3600000);
+				cond->wait(&lock, stats_update_interval>0 ? stats_update_interval*1000 : 3600000);
 			}
 			if(do_quit)
 			{
@@ -297,6 +301,21 @@ void ServerCleanupThread::operator()(void)
 				}
 
 				update_stats = false;
+				last_incremental_stats = Server->getTimeMS();
+			}
+			else if (!update_stats_disabled
+				&& stats_update_interval>0
+				&& Server->getTimeMS() - last_incremental_stats >= stats_update_interval*1000)
+			{
+				lock.relock(NULL);
+
+				{
+					IScopedLock lock(a_mutex);
+					ServerUpdateStats sus(false, false, true);
+					sus();
+				}
+
+				last_incremental_stats = Server->getTimeMS();
 			}
 		}
 		db=Server->getDatabase(Server->getThreadID(), URBACKUPDB_SERVER);
@@ -307,6 +326,7 @@ void ServerCleanupThread::operator()(void)
 		{
 			int chour=watoi(res[0]["time"]);
 			ServerSettings settings(db);
+			stats_update_interval = settings.getSettings()->stats_update_interval;
 			std::vector<STimeSpan> tw=settings.getCleanupWindow();
 			if( ( (!tw.empty() && ServerSettings::isInTimeSpan(tw)) || ( tw.empty() && (chour==3 || chour==4) ) )
 				&& Server->getTimeSeconds()-last_cleanup>min_cleanup_interval
@@ -1489,6 +1509,10 @@ bool ServerCleanupThread::deleteFileBackup(const std::string &backupfolder, int
 		path += ".startup-del";
 	}
 
+	ServerSettings settings(db);
+	ParallelDelete parallel_delete((std::max)(1, settings.getSettings()->cleanup_delete_threads),
+		settings.getSettings()->cleanup_delete_busy_rate, logid);
+
 	bool b=false;
 	if( BackupServer::isFileSnapshotsEnabled())
 	{
@@ -1498,7 +1522,7 @@ bool ServerCleanupThread::deleteFileBackup(const std::string &backupfolder, int
 		{
 			ServerLinkDao link_dao(Server->getDatabase(Server->getThreadID(), URBACKUPDB_SERVER_LINKS));
 
-			b=remove_directory_link_dir(path, link_dao, clientid);
+			b=remove_directory_link_dir(path, link_dao, clientid, true, true, &parallel_delete);
 
 			if(!b && SnapshotHelper::isSubvolume(false, clientname, backuppath) )
 			{
@@ -1507,7 +1531,7 @@ bool ServerCleanupThread::deleteFileBackup(const std::string &backupfolder, int
 
 				if(b)
 				{
-					b=remove_directory_link_dir(path, link_dao, clientid);
+					b=remove_directory_link_dir(path, link_dao, clientid, true, true, &parallel_delete);
 				}
 			}
 		}
@@ -1520,7 +1544,7 @@ bool ServerCleanupThread::deleteFileBackup(const std::string &backupfolder, int
 	{
 		ServerLinkDao link_dao(Server->getDatabase(Server->getThreadID(), URBACKUPDB_SERVER_LINKS));
 
-		b=remove_directory_link_dir(path, link_dao, clientid);
+		b=remove_directory_link_dir(path, link_dao, clientid, true, true, &parallel_delete);
 	}
 
 	bool del=true;
@@ -2539,99 +2563,78 @@ void ServerCleanupThread::removeFileBackupSql( int backupid )
 	DBScopedSynchronous synchronous_files(filesdao->getDatabase());
 	filesdao->BeginWriteTransaction();
 
-	BackupServerHash::SInMemCorrection correction;
-
-	ServerFilesDao::SBackupIdMinMax minmax = filesdao->getBackupIdMinMax(backupid);
+	BackupServerHash::SInMemCorrection updates;
+	updates.min_correct = 0;
+	updates.max_correct = -1;
 
-	correction.max_correct = minmax.tmax;
-	correction.min_correct = minmax.tmin;
-
-	IQuery* q_iterate = filesdao->getDatabase()->Prepare("SELECT id, shahash, filesize, rsize, clientid, backupid, incremental, next_entry, prev_entry, pointed_to FROM files WHERE backupid=?", false);
+	//Entries of the same file are next to each other in (shahash, filesize) order.
+	//All linked list entries of the backup in a group are therefore removed at once and only
+	//the remaining neighbors need an update
+	IQuery* q_iterate = filesdao->getDatabase()->Prepare("SELECT id, shahash, filesize, clientid, incremental, next_entry, prev_entry, pointed_to FROM files WHERE backupid=? ORDER BY shahash, filesize", false);
 	q_iterate->Bind(backupid);
 	IDatabaseCursor* cursor = q_iterate->Cursor();
 
 	bool modified_file_entry_index = false;
 
+	std::vector<BackupServerHash::SDeleteEntry> group;
+	std::string group_shahash;
+	int64 group_filesize = -1;
+	int group_clientid = 0;
+	int group_incremental = 0;
+	size_t n_entries = 0;
+	size_t n_updates = 0;
+
 	db_single_result res;
 	while(cursor->next(res))
 	{
-		int64 id = watoi64(res["id"]);
-
 		int64 filesize = watoi64(res["filesize"]);
-		int64 rsize = watoi64(res["rsize"]);
-		int clientid = watoi(res["clientid"]);
-		int backupid = watoi(res["backupid"]);
-		int incremental = watoi(res["incremental"]);
-		int64 next_entry = watoi64(res["next_entry"]);
-		int64 prev_entry = watoi64(res["prev_entry"]);
-		int pointed_to = watoi(res["pointed_to"]);
-
-		std::map<int64, int64>::iterator it_next = correction.next_entries.find(id);
-		if (it_next != correction.next_entries.end())
-		{
-			if (it_next->second != next_entry)
-			{
-				int abc = 5;
-			}
-
-			next_entry = it_next->second;
 
-			correction.next_entries.erase(it_next);
-		}
-
-		std::map<int64, int64>::iterator it_prev= correction.prev_entries.find(id);
-		if (it_prev != correction.prev_entries.end())
+		if (!group.empty()
+			&& (filesize != group_filesize
+				|| res["shahash"] != group_shahash))
 		{
-			if (it_prev->second != prev_entry)
+			BackupServerHash::deleteFileGroupSQL(*filesdao, *fileindex.get(), group_shahash, group_filesize,
+				group_clientid, backupid, group_incremental, group, true, updates);
+			group.clear();
+
+			if (updates.next_entries.size() + updates.prev_entries.size()
+				+ updates.pointed_to.size() >= file_entry_update_batch_size)
 			{
-				int abc = 5;
+				n_updates += BackupServerHash::applyFileEntryUpdates(*filesdao, updates);
 			}
-
-			prev_entry = it_prev->second;
-
-			correction.prev_entries.erase(it_prev);
 		}
 
-		std::map<int64, int>::iterator it_pointed_to = correction.pointed_to.find(id);
-		if (it_pointed_to != correction.pointed_to.end())
+		if (group.empty())
 		{
-			if (it_pointed_to->second != pointed_to)
-			{
-				int abc = 5;
-			}
-
-			pointed_to = it_pointed_to->second;
-
-			correction.pointed_to.erase(it_pointed_to);
+			group_shahash = res["shahash"];
+			group_filesize = filesize;
+			group_clientid = watoi(res["clientid"]);
+			group_incremental = watoi(res["incremental"]);
 		}
 
-		if (pointed_to)
+		BackupServerHash::SDeleteEntry entry;
+		entry.id = watoi64(res["id"]);
+		entry.next_entry = watoi64(res["next_entry"]);
+		entry.prev_entry = watoi64(res["prev_entry"]);
+		entry.pointed_to = watoi(res["pointed_to"]);
+
+		if (entry.pointed_to)
 		{
 			modified_file_entry_index = true;
 		}
 
-		BackupServerHash::deleteFileSQL(*filesdao, *fileindex.get(), res["shahash"].c_str(),
-			filesize, rsize, clientid, backupid, incremental, id, prev_entry, next_entry, pointed_to, false, false, false, true, &correction);
+		group.push_back(entry);
+		++n_entries;
 	}
 	filesdao->getDatabase()->destroyQuery(q_iterate);
 
-	for (std::map<int64, int64>::iterator it_next = correction.next_entries.begin();
-		 it_next != correction.next_entries.end(); ++it_next)
-	{
-		filesdao->setNextEntry(it_next->second, it_next->first);
-	}
-
-	for (std::map<int64, int64>::iterator it_prev = correction.prev_entries.begin();
-		 it_prev != correction.prev_entries.end(); ++it_prev)
+	if (!group.empty())
 	{
-		filesdao->setPrevEntry(it_prev->second, it_prev->first);
+		BackupServerHash::deleteFileGroupSQL(*filesdao, *fileindex.get(), group_shahash, group_filesize,
+			group_clientid, backupid, group_incremental, group, true, updates);
 	}
 
-	for (std::map<int64, int>::iterator it_pointed_to = correction.pointed_to.begin();
-		 it_pointed_to != correction.pointed_to.end(); ++it_pointed_to)
-	{
-		filesdao->setPointedTo(it_pointed_to->second, it_pointed_to->first);
-	}
+	n_updates += BackupServerHash::applyFileEntryUpdates(*filesdao, updates);
 
 	filesdao->deleteFiles(backupid);
 
@@ -2642,6 +2645,9 @@ void ServerCleanupThread::removeFileBackupSql( int backupid )
 
 	filesdao->endTransaction();
 
+	Server->Log("Removed " + convert(n_entries) + " file entries of backup " + convert(backupid)
+		+ " with " + convert(n_updates) + " link updates", LL_DEBUG);
+
 	cleanupdao->removeFileBackup(backupid);
 }
 
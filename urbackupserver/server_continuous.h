@@ -78,7 +78,7 @@ public:
 
 		logid = ServerLogger::getLogId(clientid);
 
-		local_hash.reset(new BackupServerHash(NULL, clientid, use_snapshots, use_reflink, use_tmpfiles, logid, use_snapshots, max_file_id));
+		local_hash.reset(new BackupServerHash(NULL, clientid, use_snapshots, use_reflink, use_tmpfiles, logid, use_snapshots, max_file_id, NULL));
 	}
 
 	~BackupServerContinuous()
@@ -719,7 +719,7 @@ private:
 			continuous_hash_path, continuous_path, std::string(), hashed_transfer_full,
 			false, clientid, clientname, std::string(), use_tmpfiles, tmpfile_path, server_token,
 			use_reflink, backupid, true, hashpipe_prepare, client_main, client_main->getProtocolVersions().file_protocol_version,
-			0, logid, true, shares_without_snapshot, true, NULL, false, filepath_corrections, max_file_id));
+			0, logid, true, shares_without_snapshot, true, NULL, false, filepath_corrections, max_file_id, NULL));
 
 		server_download_ticket = Server->getThreadPool()->execute(server_download.get(), "backup download");
 	}
@@ -864,7 +864,7 @@ private:
 		return false;
 	}
 
-	virtual std::string getQueuedFileFull(FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id)
+	virtual std::string getQueuedFileFull(FileClient::MetadataQueue& metadata, size_t& folder_items, bool& finish_script, int64& file_id, int64& predicted_filesize)
 	{
 		for(std::deque<SQueueItem>::iterator it=dl_queue.begin();
 			it!=dl_queue.end();++it)
@@ -877,6 +877,7 @@ private:
 				it->queued_metdata=true;
 				folder_items=0;
 				file_id=0;
+				predicted_filesize=-1;
 				finish_script=false;
 				return it->change.fn1;
 			}
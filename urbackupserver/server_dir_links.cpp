@@ -21,6 +21,7 @@
 #include "../Interface/Server.h"
 #include "../stringtools.h"
 #include "server_settings.h"
+#include "ParallelDelete.h"
 #include "../Interface/Mutex.h"
 #include "../Interface/Database.h"
 #include "../Interface/File.h"
@@ -493,12 +494,19 @@ namespace
 	}
 }
 
-bool remove_directory_link_dir(const std::string &path, ServerLinkDao& link_dao, int clientid, bool delete_root, bool with_transaction)
+bool remove_directory_link_dir(const std::string &path, ServerLinkDao& link_dao, int clientid, bool delete_root, bool with_transaction,
+	ParallelDelete* parallel_delete)
 {
 	IScopedLock lock(NULL);
 	dir_link_lock_client_mutex(clientid, lock);
 
 	SSymlinkCallbackData userdata(&link_dao, clientid, with_transaction);
+
+	if (parallel_delete != NULL)
+	{
+		return parallel_delete->removeDir(os_file_prefix(path), symlink_callback, &userdata, delete_root);
+	}
+
 	return os_remove_nonempty_dir(os_file_prefix(path), symlink_callback, &userdata, delete_root);
 }
 
@@ -22,7 +22,9 @@ bool replay_directory_link_journal();
 bool remove_directory_link(const std::string &path, ServerLinkDao& link_dao, int clientid,
 	std::auto_ptr<DBScopedSynchronous>& synchronous_link_dao, bool with_transaction=true);
 
-bool remove_directory_link_dir(const std::string &path, ServerLinkDao& link_dao, int clientid, bool delete_root=true, bool with_transaction=true);
+class ParallelDelete;
+bool remove_directory_link_dir(const std::string &path, ServerLinkDao& link_dao, int clientid, bool delete_root=true, bool with_transaction=true,
+	ParallelDelete* parallel_delete=NULL);
 
 bool reference_contained_directory_links(ServerLinkDao& link_dao, int clientid,
 	const std::string& pool_name, const std::string &path, const std::string& link_path);
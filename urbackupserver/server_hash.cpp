@@ -33,13 +33,38 @@
 #include <memory.h>
 #include "../urbackupcommon/file_metadata.h"
 #include "FileBackup.h"
+#include "BackupTelemetry.h"
 #include <assert.h>
+#include <atomic>
 #ifdef _WIN32
 #include <Windows.h>
 #endif
 
 const size_t freespace_mod=50*1024*1024; //50 MB
 const size_t BUFFER_SIZE=64*1024; //64KB
+const size_t prefetch_min_queue=16;
+const size_t prefetch_max_batch=1000;
+const int64 reflink_blocksize=4096; //btrfs/XFS reject clone ranges not aligned to the fs block size
+
+namespace
+{
+	//Every file entry index change of a key bumps the generation of its bucket (from any
+	//hash thread). Prefetched index results read before the change are then not used
+	const size_t prefetch_generation_buckets=4096;
+	std::atomic<unsigned int> prefetch_generations[prefetch_generation_buckets];
+
+	std::atomic<unsigned int>& prefetchGeneration(const char* pHash, _i64 filesize)
+	{
+		unsigned int h;
+		memcpy(&h, pHash, sizeof(h));
+		return prefetch_generations[(h ^ static_cast<unsigned int>(filesize)) % prefetch_generation_buckets];
+	}
+
+	void invalidatePrefetchAll(const char* pHash, _i64 filesize)
+	{
+		++prefetchGeneration(pHash, filesize);
+	}
+}
 
 IMutex * delete_mutex=NULL;
 
@@ -54,15 +79,17 @@ void destroy_mutex1(void)
 }
 
 BackupServerHash::BackupServerHash(IPipe *pPipe, int pClientid, bool use_snapshots, bool use_reflink, bool use_tmpfiles, logid_t logid,
-	bool snapshot_file_inplace, MaxFileId& max_file_id)
+	bool snapshot_file_inplace, MaxFileId& max_file_id, BackupTelemetry* telemetry)
 	: use_snapshots(use_snapshots), use_reflink(use_reflink), use_tmpfiles(use_tmpfiles), filesdao(NULL), old_backupfolders_loaded(false),
-	  logid(logid), snapshot_file_inplace(snapshot_file_inplace), max_file_id(max_file_id)
+	  logid(logid), snapshot_file_inplace(snapshot_file_inplace), max_file_id(max_file_id), telemetry(telemetry), addfile_db_time(0),
+	  chunk_clone_source(NULL), chunk_clone_range(false), chunk_clone_bytes(0)
 {
 	pipe=pPipe;
 	clientid=pClientid;
 	link_logcnt=0;
 	space_logcnt=0;
 	working=false;
+	num_queued_msgs=0;
 	has_error=false;
 	chunk_patcher.setCallback(this);
 	fileindex=NULL;
@@ -105,11 +132,38 @@ void BackupServerHash::operator()(void)
 {
 	setupDatabase();
 
+	//Reused so reading from the pipe does not allocate
+	std::string data;
 	while(true)
 	{
-		working=false;
-		std::string data;
-		size_t rc=pipe->Read(&data, static_cast<int>(60000) );
+		//Prefetched messages are still pending work
+		working=!queued_msgs.empty();
+		size_t rc;
+		if(!queued_msgs.empty())
+		{
+			data=queued_msgs.front();
+			queued_msgs.pop_front();
+			num_queued_msgs=queued_msgs.size();
+			rc=data.size();
+		}
+		else
+		{
+			prefetched_entryids.clear();
+
+			rc=pipe->Read(&data, static_cast<int>(60000) );
+
+			if(rc>0
+				&& pipe->getNumElements()>=prefetch_min_queue)
+			{
+				working=true;
+				queued_msgs.push_back(data);
+				prefetchFileIndex();
+				data=queued_msgs.front();
+				queued_msgs.pop_front();
+				num_queued_msgs=queued_msgs.size();
+			}
+		}
+
 		if(rc==0)
 		{
 			link_logcnt=0;
@@ -144,6 +198,11 @@ void BackupServerHash::operator()(void)
 				int64 fileid;
 				rd.getVarInt(&fileid);
 
+				if(telemetry!=NULL)
+				{
+					telemetry->fileDequeued(fileid);
+				}
+
 				std::string temp_fn;
 				rd.getStr(&temp_fn);
 
@@ -205,8 +264,16 @@ void BackupServerHash::operator()(void)
 						}
 					}
 
+					int64 addfile_starttime = Server->getTimeMS();
+					addfile_db_time = 0;
+
 					addFile(backupid, incremental, tf, tfn, hashpath, sha2,
 						old_file_fn, hashoutput_fn, t_filesize, metadata, with_hashes!=0, extent_iterator.get(), fileid);
+
+					if(telemetry!=NULL)
+					{
+						telemetry->addStageTime(EBackupStage_LinkCopy, Server->getTimeMS() - addfile_starttime - addfile_db_time);
+					}
 				}
 
 				if(!hashoutput_fn.empty())
@@ -277,9 +344,114 @@ void BackupServerHash::operator()(void)
 	}
 }
 
+void BackupServerHash::prefetchFileIndex()
+{
+	while(queued_msgs.size()<prefetch_max_batch)
+	{
+		std::string data;
+		if(pipe->Read(&data, 0)==0)
+		{
+			break;
+		}
+		queued_msgs.push_back(data);
+		num_queued_msgs=queued_msgs.size();
+	}
+
+	std::vector<FileIndex::SIndexKey> keys;
+	keys.reserve(queued_msgs.size());
+
+	for(size_t i=0;i<queued_msgs.size();++i)
+	{
+		CRData rd(&queued_msgs[i]);
+
+		int iaction;
+		if(!rd.getInt(&iaction)
+			|| static_cast<EAction>(iaction)!=EAction_LinkOrCopy)
+		{
+			continue;
+		}
+
+		int64 fileid;
+		std::string temp_fn;
+		int backupid;
+		int incremental;
+		char with_hashes;
+		std::string tfn;
+		std::string hashpath;
+		std::string sha2;
+		std::string hashoutput_fn;
+		std::string old_file_fn;
+		int64 t_filesize;
+
+		if(rd.getVarInt(&fileid)
+			&& rd.getStr(&temp_fn)
+			&& rd.getInt(&backupid)
+			&& rd.getInt(&incremental)
+			&& rd.getChar(&with_hashes)
+			&& rd.getStr(&tfn)
+			&& rd.getStr(&hashpath)
+			&& rd.getStr(&sha2)
+			&& rd.getStr(&hashoutput_fn)
+			&& rd.getStr(&old_file_fn)
+			&& rd.getInt64(&t_filesize)
+			&& sha2.size()==SHA_DEF_DIGEST_SIZE
+			&& t_filesize>=link_file_min_size)
+		{
+			keys.push_back(FileIndex::SIndexKey(sha2.c_str(), t_filesize, clientid));
+		}
+	}
+
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	if(keys.empty())
+	{
+		return;
+	}
+
+	std::vector<unsigned int> generations;
+	generations.resize(keys.size());
+	for(size_t i=0;i<keys.size();++i)
+	{
+		generations[i] = prefetchGeneration(keys[i].getHash(), keys[i].getFilesize());
+	}
+
+	std::vector<int64> entryids;
+	fileindex->get_many_with_cache_prefer_client(keys, entryids);
+
+	for(size_t i=0;i<keys.size();++i)
+	{
+		SPrefetchedEntry& entry = prefetched_entryids[keys[i]];
+		entry.entryid = entryids[i];
+		entry.generation = generations[i];
+	}
+
+	ServerLogger::Log(logid, "HT: Prefetched file entry index results for "+convert(keys.size())+" files", LL_DEBUG);
+}
+
+void BackupServerHash::invalidatePrefetch(const std::string& shahash, int64 filesize)
+{
+	if(!prefetched_entryids.empty()
+		&& filesize>=link_file_min_size)
+	{
+		prefetched_entryids.erase(FileIndex::SIndexKey(shahash.c_str(), filesize, clientid));
+	}
+}
+
 void BackupServerHash::addFileSQL(int backupid, int clientid, int incremental, const std::string &fp, const std::string &hash_path, const std::string &shahash, _i64 filesize, _i64 rsize, int64 prev_entry, int64 prev_entry_clientid, int64 next_entry, bool update_fileindex)
 {
+	invalidatePrefetch(shahash, filesize);
+
+	int64 starttime = Server->getTimeMS();
+
 	addFileSQL(*filesdao, *fileindex, backupid, clientid, incremental, fp, hash_path, shahash, filesize, rsize, prev_entry, prev_entry_clientid, next_entry, update_fileindex);
+
+	int64 passed_time = Server->getTimeMS() - starttime;
+	addfile_db_time += passed_time;
+	if(telemetry!=NULL)
+	{
+		telemetry->addStageTime(EBackupStage_DbInsert, passed_time);
+	}
 }
 
 void BackupServerHash::addFileSQL(ServerFilesDao& filesdao, FileIndex& fileindex, int backupid, const int clientid, int incremental, const std::string &fp,
@@ -388,6 +560,8 @@ void BackupServerHash::addFileSQL(ServerFilesDao& filesdao, FileIndex& fileindex
 			+" hash="+base64_encode(reinterpret_cast<const unsigned char*>(shahash.c_str()), bytes_in_index), LL_DEBUG));
 		fileindex.put_delayed(FileIndex::SIndexKey(shahash.c_str(), filesize, clientid), entryid);
 	}
+
+	invalidatePrefetchAll(shahash.c_str(), filesize);
 }
 
 void BackupServerHash::deleteFileSQL(ServerFilesDao& filesdao, FileIndex& fileindex, int64 id)
@@ -595,12 +769,153 @@ void BackupServerHash::deleteFileSQL(ServerFilesDao& filesdao, FileIndex& filein
 		filesdao.delFileEntry(id);
 	}
 
+	invalidatePrefetchAll(pHash, filesize);
+
 	if(use_transaction)
 	{
 		filesdao.endTransaction();
 	}
 }
 
+void BackupServerHash::deleteFileGroupSQL(ServerFilesDao& filesdao, FileIndex& fileindex, const std::string& shahash, _i64 filesize, int clientid,
+	int backupid, int incremental, const std::vector<SDeleteEntry>& entries, bool with_backupstat, SInMemCorrection& updates)
+{
+	std::map<int64, size_t> entry_idx;
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		entry_idx[entries[i].id] = i;
+	}
+
+	std::vector<char> visited(entries.size(), 0);
+	size_t n_visited = 0;
+
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		const SDeleteEntry& head = entries[i];
+
+		if (head.prev_entry != 0
+			&& entry_idx.find(head.prev_entry) != entry_idx.end())
+		{
+			//Not the first entry of a run of deleted entries
+			continue;
+		}
+
+		bool damaged = false;
+		int64 pointed_id = 0;
+		size_t curr = i;
+		while (true)
+		{
+			if (visited[curr])
+			{
+				damaged = true;
+				break;
+			}
+
+			visited[curr] = 1;
+			++n_visited;
+
+			if (entries[curr].pointed_to
+				&& pointed_id == 0)
+			{
+				pointed_id = entries[curr].id;
+			}
+
+			if (entries[curr].next_entry == 0)
+			{
+				break;
+			}
+
+			std::map<int64, size_t>::iterator it_next = entry_idx.find(entries[curr].next_entry);
+			if (it_next == entry_idx.end())
+			{
+				break;
+			}
+
+			curr = it_next->second;
+		}
+
+		if (damaged)
+		{
+			FILEENTRY_DEBUG(Server->Log("File entry list with filesize=" + convert(filesize) + " hash="
+				+ base64_encode(reinterpret_cast<const unsigned char*>(shahash.c_str()), bytes_in_index)
+				+ " starting at id " + convert(head.id) + " contains a loop. The file entry index may be damaged.", LL_WARNING));
+			continue;
+		}
+
+		int64 prev_id = head.prev_entry;
+		int64 next_id = entries[curr].next_entry;
+
+		if (prev_id == 0 && next_id == 0)
+		{
+			//All entries of the client are deleted
+			deleteFileSQL(filesdao, fileindex, shahash.c_str(), filesize, 0, clientid, backupid, incremental,
+				pointed_id != 0 ? pointed_id : head.id, 0, 0, pointed_id != 0 ? 1 : 0, false, false, false, with_backupstat, NULL);
+			continue;
+		}
+
+		if (pointed_id != 0)
+		{
+			int64 target_id = next_id != 0 ? next_id : prev_id;
+
+			updates.pointed_to[target_id] = 1;
+			fileindex.put_delayed(FileIndex::SIndexKey(shahash.c_str(), filesize, clientid), target_id);
+
+			FILEENTRY_DEBUG(Server->Log("Changed file index entry filesize=" + convert(filesize) + " hash="
+				+ base64_encode(reinterpret_cast<const unsigned char*>(shahash.c_str()), bytes_in_index)
+				+ " from " + convert(pointed_id) + " to " + convert(target_id) + " (batch)", LL_DEBUG));
+		}
+
+		if (next_id != 0)
+		{
+			updates.prev_entries[next_id] = prev_id;
+		}
+
+		if (prev_id != 0)
+		{
+			updates.next_entries[prev_id] = next_id;
+		}
+	}
+
+	if (n_visited < entries.size())
+	{
+		FILEENTRY_DEBUG(Server->Log(convert(entries.size() - n_visited) + " file entries with filesize=" + convert(filesize) + " hash="
+			+ base64_encode(reinterpret_cast<const unsigned char*>(shahash.c_str()), bytes_in_index)
+			+ " are not reachable from the start of a file entry list. The file entry index may be damaged.", LL_WARNING));
+	}
+
+	invalidatePrefetchAll(shahash.c_str(), filesize);
+}
+
+size_t BackupServerHash::applyFileEntryUpdates(ServerFilesDao& filesdao, SInMemCorrection& updates)
+{
+	//std::map iterates in id order, so the updates touch the files table sequentially
+	for (std::map<int64, int64>::iterator it = updates.next_entries.begin();
+		it != updates.next_entries.end(); ++it)
+	{
+		filesdao.setNextEntry(it->second, it->first);
+	}
+
+	for (std::map<int64, int64>::iterator it = updates.prev_entries.begin();
+		it != updates.prev_entries.end(); ++it)
+	{
+		filesdao.setPrevEntry(it->second, it->first);
+	}
+
+	for (std::map<int64, int>::iterator it = updates.pointed_to.begin();
+		it != updates.pointed_to.end(); ++it)
+	{
+		filesdao.setPointedTo(it->second, it->first);
+	}
+
+	size_t ret = updates.next_entries.size() + updates.prev_entries.size() + updates.pointed_to.size();
+
+	updates.next_entries.clear();
+	updates.prev_entries.clear();
+	updates.pointed_to.clear();
+
+	return ret;
+}
+
 bool BackupServerHash::findFileAndLink(const std::string &tfn, IFile *tf, std::string hash_fn, const std::string &sha2,
 	_i64 t_filesize, const std::string &hashoutput_fn, bool copy_from_hardlink_if_failed,
 	bool &tries_once, std::string &ff_last, bool &hardlink_limit, bool &copied_file, int64& entryid, int& entryclientid
@@ -673,6 +988,8 @@ bool BackupServerHash::findFileAndLink(const std::string &tfn, IFile *tf, std::s
 					}
 					first_logmsg=false;
 
+					invalidatePrefetch(sha2, t_filesize);
+
 					deleteFileSQL(*filesdao, *fileindex, sha2.c_str(), t_filesize, existing_file.rsize, existing_file.clientid, existing_file.backupid, existing_file.incremental,
 						existing_file.id, existing_file.prev_entry, existing_file.next_entry, existing_file.pointed_to, true, true, detach_dbs, false, NULL);
 
@@ -1099,7 +1416,18 @@ ServerFilesDao::SFindFileEntry BackupServerHash::findFileHash(const std::string
 	bool switch_to_next_client=false;
 	if(state.state==0)
 	{
-		entryid = fileindex->get_with_cache_prefer_client(FileIndex::SIndexKey(pHash.c_str(), filesize, clientid));
+		FileIndex::SIndexKey key(pHash.c_str(), filesize, clientid);
+		std::map<FileIndex::SIndexKey, SPrefetchedEntry>::iterator it = prefetched_entryids.find(key);
+		if(it!=prefetched_entryids.end()
+			&& it->second.generation==prefetchGeneration(pHash.c_str(), filesize))
+		{
+			entryid = it->second.entryid;
+			prefetched_entryids.erase(it);
+		}
+		else
+		{
+			entryid = fileindex->get_with_cache_prefer_client(key);
+		}
 		state.state=1;
 		save_orig=true;
 	}
@@ -1266,6 +1594,17 @@ bool BackupServerHash::copyFile(IFile *tf, const std::string &dest, ExtentIterat
 		return false;
 	}
 
+	if (copyFileKernel(tf, dst.get(), extent_iterator))
+	{
+		return true;
+	}
+
+	if (extent_iterator != NULL)
+	{
+		extent_iterator->reset();
+	}
+
+	dst->Seek(0);
 	tf->Seek(0);
 	_u32 read;
 	char buf[BUFFER_SIZE];
@@ -1372,17 +1711,100 @@ bool BackupServerHash::copyFileWithHashoutput(IFile *tf, const std::string &dest
 		}
 		ObjectScope dst_hash_s(dst_hash);
 
+		if (copyFileKernel(tf, dst, extent_iterator))
+		{
+			if (extent_iterator != NULL)
+			{
+				extent_iterator->reset();
+			}
+
+			return build_chunk_hashs(tf, dst_hash, this, NULL, false, NULL, NULL, false, NULL, extent_iterator);
+		}
+
+		if (extent_iterator != NULL)
+		{
+			extent_iterator->reset();
+		}
+
+		dst->Seek(0);
+
 		return build_chunk_hashs(tf, dst_hash, this, dst, false, NULL, NULL, false, NULL, extent_iterator);
 	}
 	
 	return true;
 }
 
+bool BackupServerHash::copyFileKernel(IFile *tf, IFsFile *dst, ExtentIterator* extent_iterator)
+{
+	//tf is always a plain file opened via Server->openFile here
+	IFsFile* tf_fs = dynamic_cast<IFsFile*>(tf);
+	if (tf_fs == NULL)
+	{
+		return false;
+	}
+
+	int64 fsize = tf_fs->Size();
+	int64 fpos = 0;
+	IFsFile::SSparseExtent curr_extent;
+
+	if (extent_iterator != NULL)
+	{
+		curr_extent = extent_iterator->nextExtent();
+	}
+
+	while (fpos < fsize)
+	{
+		int64 data_end = fsize;
+		if (curr_extent.offset != -1)
+		{
+			data_end = (std::min)(fsize, curr_extent.offset);
+		}
+
+		if (data_end > fpos
+			&& !os_copy_file_range(tf_fs, fpos, dst, fpos, data_end - fpos))
+		{
+			ServerLogger::Log(logid, "HT: Kernel copy to \"" + dst->getFilename() + "\" failed. Copying via buffer. " + os_last_error_str(), LL_DEBUG);
+			return false;
+		}
+
+		if (curr_extent.offset == -1)
+		{
+			fpos = fsize;
+			break;
+		}
+
+		int64 extent_end = (std::min)(fsize, curr_extent.offset + curr_extent.size);
+
+		if (extent_end > curr_extent.offset
+			&& !punchHoleOrZero(dst, curr_extent.offset, extent_end - curr_extent.offset))
+		{
+			return false;
+		}
+
+		fpos = (std::max)(data_end, extent_end);
+		curr_extent = extent_iterator->nextExtent();
+	}
+
+	if (dst->Size() < fsize
+		&& !dst->Resize(fsize))
+	{
+		ServerLogger::Log(logid, "Error resizing file \"" + dst->getFilename() + "\" to " + convert(fsize), LL_ERROR);
+		return false;
+	}
+
+	return true;
+}
+
 bool BackupServerHash::isWorking(void)
 {
 	return working;
 }
 
+size_t BackupServerHash::getNumQueued(void)
+{
+	return num_queued_msgs;
+}
+
 bool BackupServerHash::hasError(void)
 {
 	volatile bool r=has_error;
@@ -1473,6 +1895,35 @@ int64 BackupServerHash::chunk_patcher_pos()
 	return chunk_patch_pos;
 }
 
+bool BackupServerHash::next_chunk_patcher_copy(int64 copy_off, size_t bsize)
+{
+	if (!has_reflink
+		|| !chunk_clone_range
+		|| chunk_clone_source == NULL)
+	{
+		return false;
+	}
+
+	if (copy_off%reflink_blocksize != 0
+		|| chunk_patch_pos%reflink_blocksize != 0
+		|| bsize%reflink_blocksize != 0)
+	{
+		return false;
+	}
+
+	if (!os_clone_file_range(chunk_clone_source, copy_off, chunk_output_fn, chunk_patch_pos, bsize))
+	{
+		ServerLogger::Log(logid, "HT: Reflinking range of \"" + chunk_output_fn->getFilename() + "\" failed. Copying data instead. " + os_last_error_str(), LL_DEBUG);
+		chunk_clone_range = false;
+		return false;
+	}
+
+	chunk_patch_pos += bsize;
+	chunk_clone_bytes += bsize;
+
+	return true;
+}
+
 bool BackupServerHash::patchFile(IFile *patch, const std::string &source, const std::string &dest,
 	const std::string hash_output, const std::string hash_dest, _i64 tfilesize, ExtentIterator* extent_iterator)
 {
@@ -1506,7 +1957,7 @@ bool BackupServerHash::patchFile(IFile *patch, const std::string &source, const
 		}
 		ObjectScope dst_s(chunk_output_fn);
 
-		IFile *f_source=openFileRetry(source, MODE_READ, errstr);
+		IFsFile *f_source=openFileRetry(source, MODE_READ, errstr);
 		if (f_source == NULL)
 		{
 			ServerLogger::Log(logid, "Error opening patch source file \"" + source + "\". "+errstr, LL_ERROR);
@@ -1518,7 +1969,16 @@ bool BackupServerHash::patchFile(IFile *patch, const std::string &source, const
 		enabled_sparse = false;
 		chunk_patcher_has_error = false;
 		chunk_patcher.setRequireUnchanged(!has_reflink);
+		chunk_clone_source = f_source;
+		chunk_clone_range = has_reflink;
+		chunk_clone_bytes = 0;
 		bool b=chunk_patcher.ApplyPatch(f_source, patch, extent_iterator);
+		chunk_clone_source = NULL;
+
+		if (chunk_clone_bytes > 0)
+		{
+			ServerLogger::Log(logid, "HT: Reflinked " + PrettyPrintBytes(chunk_clone_bytes) + " of moved data in \"" + dest + "\"", LL_DEBUG);
+		}
 
 		if (!b)
 		{
@@ -12,12 +12,14 @@
 #include "dao/ServerFilesDao.h"
 #include <vector>
 #include <map>
+#include <deque>
 #include "../urbackupcommon/chunk_hasher.h"
 #include "server_log.h"
 #include "../urbackupcommon/ExtentIterator.h"
 
 class FileMetadata;
 class MaxFileId;
+class BackupTelemetry;
 
 const int64 link_file_min_size = 2048;
 
@@ -45,13 +47,15 @@ public:
 	};
 
 	BackupServerHash(IPipe *pPipe, int pClientid, bool use_snapshots, bool use_reflink,
-		bool use_tmpfiles, logid_t logid, bool snapshot_file_inplace, MaxFileId& max_file_id);
+		bool use_tmpfiles, logid_t logid, bool snapshot_file_inplace, MaxFileId& max_file_id, BackupTelemetry* telemetry);
 	~BackupServerHash(void);
 
 	void operator()(void);
 	
 	bool isWorking(void);
 
+	size_t getNumQueued(void);
+
 	bool hasError(void);
 
 	virtual bool handle_not_enough_space(const std::string &path);
@@ -62,6 +66,8 @@ public:
 
 	virtual int64 chunk_patcher_pos();
 
+	virtual bool next_chunk_patcher_copy(int64 copy_off, size_t bsize);
+
 	void setupDatabase(void);
 	void deinitDatabase(void);
 
@@ -96,6 +102,21 @@ public:
 	static void deleteFileSQL(ServerFilesDao& filesdao, FileIndex& fileindex, const char* pHash, _i64 filesize, _i64 rsize, int clientid, int backupid, int incremental, int64 id, int64 prev_id, int64 next_id, int pointed_to,
 		bool use_transaction, bool del_entry, bool detach_dbs, bool with_backupstat, SInMemCorrection* correction);
 
+	struct SDeleteEntry
+	{
+		int64 id;
+		int64 prev_entry;
+		int64 next_entry;
+		int pointed_to;
+	};
+
+	//Removes all entries of one (shahash, filesize, clientid) group which belong to the same backup.
+	//The entry rows are not deleted. Link changes of the remaining entries are collected in 'updates'
+	static void deleteFileGroupSQL(ServerFilesDao& filesdao, FileIndex& fileindex, const std::string& shahash, _i64 filesize, int clientid,
+		int backupid, int incremental, const std::vector<SDeleteEntry>& entries, bool with_backupstat, SInMemCorrection& updates);
+
+	static size_t applyFileEntryUpdates(ServerFilesDao& filesdao, SInMemCorrection& updates);
+
 private:
 	void addFile(int backupid, int incremental, IFile *tf, const std::string &tfn,
 			std::string hash_fn, const std::string &sha2, const std::string &orig_fn, const std::string &hashoutput_fn, int64 t_filesize,
@@ -117,6 +138,7 @@ private:
 
 	bool copyFile(IFile *tf, const std::string &dest, ExtentIterator* extent_iterator);
 	bool copyFileWithHashoutput(IFile *tf, const std::string &dest, const std::string hash_dest, ExtentIterator* extent_iterator);
+	bool copyFileKernel(IFile *tf, IFsFile *dst, ExtentIterator* extent_iterator);
 	bool freeSpace(int64 fs, const std::string &fp);
 	
 	int countFilesInTmp(void);
@@ -135,6 +157,20 @@ private:
 
 	bool punchHoleOrZero(IFile *tf, int64 offset, int64 size);
 
+	void prefetchFileIndex();
+
+	void invalidatePrefetch(const std::string& shahash, int64 filesize);
+
+	struct SPrefetchedEntry
+	{
+		int64 entryid;
+		unsigned int generation;
+	};
+
+	std::deque<std::string> queued_msgs;
+	volatile size_t num_queued_msgs;
+	std::map<FileIndex::SIndexKey, SPrefetchedEntry> prefetched_entryids;
+
 	std::map<std::pair<std::string, _i64>, std::vector<STmpFile> > files_tmp;
 
 	ServerFilesDao* filesdao;
@@ -178,4 +214,11 @@ private:
 	bool snapshot_file_inplace;
 
 	MaxFileId& max_file_id;
+
+	BackupTelemetry* telemetry;
+	int64 addfile_db_time;
+
+	IFsFile* chunk_clone_source;
+	bool chunk_clone_range;
+	int64 chunk_clone_bytes;
 };
@@ -30,6 +30,8 @@
 #include <memory.h>
 #include "../common/adler32.h"
 #include "../urbackupcommon/file_metadata.h"
+#include "FileBackup.h"
+#include "BackupTelemetry.h"
 
 namespace
 {
@@ -50,8 +52,8 @@ namespace
 }
 
 BackupServerPrepareHash::BackupServerPrepareHash(IPipe *pPipe, IPipe *pOutput, int pClientid,
-	logid_t logid, bool ignore_hash_mismatch)
-	: logid(logid), ignore_hash_mismatch(ignore_hash_mismatch)
+	logid_t logid, bool ignore_hash_mismatch, MaxFileId& max_file_id, BackupTelemetry* telemetry)
+	: logid(logid), ignore_hash_mismatch(ignore_hash_mismatch), max_file_id(max_file_id), telemetry(telemetry)
 {
 	pipe=pPipe;
 	output=pOutput;
@@ -69,10 +71,11 @@ BackupServerPrepareHash::~BackupServerPrepareHash(void)
 
 void BackupServerPrepareHash::operator()(void)
 {
+	//Reused so reading from the pipe does not allocate
+	std::string data;
 	while(true)
 	{
 		working=false;
-		std::string data;
 		size_t rc=pipe->Read(&data);
 		if(data=="exit")
 		{
@@ -95,6 +98,11 @@ void BackupServerPrepareHash::operator()(void)
 			int64 fileid;
 			rd.getVarInt(&fileid);
 
+			if(telemetry!=NULL)
+			{
+				telemetry->fileDequeued(fileid);
+			}
+
 			std::string temp_fn;
 			rd.getStr(&temp_fn);
 
@@ -151,6 +159,7 @@ void BackupServerPrepareHash::operator()(void)
 					ServerLogger::Log(logid, "Error opening file \""+old_file_fn+"\" for reading. File: old_file. "+os_last_error_str()+" Target path: \""+tfn+"\"", LL_ERROR);
 					has_error=true;
 					if(tf!=NULL) Server->destroy(tf);
+					max_file_id.setMaxDownloaded(fileid);
 					continue;
 				}
 			}
@@ -163,6 +172,7 @@ void BackupServerPrepareHash::operator()(void)
 				{
 					Server->destroy(old_file);
 				}
+				max_file_id.setMaxDownloaded(fileid);
 			}
 			else
 			{
@@ -178,6 +188,7 @@ void BackupServerPrepareHash::operator()(void)
 				}
 
 				ServerLogger::Log(logid, "PT: Hashing file \""+ExtractFileName(tfn)+"\"", LL_DEBUG);
+				int64 hash_starttime = Server->getTimeMS();
 				std::string h;
 				if(!diff_file)
 				{
@@ -227,6 +238,11 @@ void BackupServerPrepareHash::operator()(void)
 					}
 				}
 
+				if(telemetry!=NULL)
+				{
+					telemetry->addStageTime(EBackupStage_Hash, Server->getTimeMS() - hash_starttime);
+				}
+
 				if (h.empty())
 				{
 					ServerLogger::Log(logid, "Error while hashing file \"" + tf->getFilename() + "\" (destination: \""+ tfn+"\"). Failing backup.", LL_ERROR);
@@ -279,6 +295,11 @@ void BackupServerPrepareHash::operator()(void)
 				data.addString(sparse_extents_fn);
 				metadata.serialize(data);
 
+				if(telemetry!=NULL)
+				{
+					telemetry->fileQueued(fileid);
+				}
+
 				output->Write(data.getDataPtr(), data.getDataSize() );
 			}
 		}
@@ -11,6 +11,9 @@
 #include "../urbackupcommon/ExtentIterator.h"
 #include "../urbackupcommon/TreeHash.h"
 
+class MaxFileId;
+class BackupTelemetry;
+
 const char HASH_FUNC_SHA512_NO_SPARSE = 0;
 const char HASH_FUNC_SHA512 = 1;
 const char HASH_FUNC_TREE = 2;
@@ -32,7 +35,7 @@ namespace
 class BackupServerPrepareHash : public IThread, public IChunkPatcherCallback
 {
 public:
-	BackupServerPrepareHash(IPipe *pPipe, IPipe *pOutput, int pClientid, logid_t logid, bool ignore_hash_mismatch);
+	BackupServerPrepareHash(IPipe *pPipe, IPipe *pOutput, int pClientid, logid_t logid, bool ignore_hash_mismatch, MaxFileId& max_file_id, BackupTelemetry* telemetry);
 	~BackupServerPrepareHash(void);
 
 	void operator()(void);
@@ -85,8 +88,11 @@ private:
 
 	logid_t logid;
 
-	bool ignore_hash_mismatch;
+	bool ignore_hash_mismatch;
 
+	MaxFileId& max_file_id;
+
+	BackupTelemetry* telemetry;
 };
 
 #endif //SERVER_PREPARE_HASH_H
\ No newline at end of file
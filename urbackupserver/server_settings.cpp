@@ -331,6 +331,9 @@ void ServerSettings::readSettingsDefault(ISettingsReader* settings_default,
 		settings->use_tmpfiles_images = (settings_global->getValue("use_tmpfiles_images", "false") == "true");
 		settings->tmpdir = settings_global->getValue("tmpdir", "");
 		settings->update_stats_cachesize = static_cast<size_t>(settings_global->getValue("update_stats_cachesize", 200 * 1024));
+		settings->stats_update_interval = settings_global->getValue("stats_update_interval", 10);
+		settings->cleanup_delete_threads = settings_global->getValue("cleanup_delete_threads", 4);
+		settings->cleanup_delete_busy_rate = settings_global->getValue("cleanup_delete_busy_rate", 2000);
 		settings->global_soft_fs_quota = settings_global->getValue("global_soft_fs_quota", "95%");
 		settings->use_incremental_symlinks = (settings_global->getValue("use_incremental_symlinks", "true") == "true");
 		settings->show_server_updates = (settings_global->getValue("show_server_updates", "true") == "true");
@@ -506,6 +509,18 @@ void ServerSettings::readSettingsDefault(ISettingsReader* settings_default,
 	settings->max_running_jobs_per_client = 1;
 	readIntClientSetting(q_get_client_setting, "max_running_jobs_per_client", &settings->max_running_jobs_per_client, false);
 
+	settings->file_hash_threads = 1;
+	readIntClientSetting(q_get_client_setting, "file_hash_threads", &settings->file_hash_threads, false);
+
+	settings->file_download_connections = 1;
+	readIntClientSetting(q_get_client_setting, "file_download_connections", &settings->file_download_connections, false);
+
+	settings->local_compress = false;
+	readBoolClientSetting(q_get_client_setting, "local_compress", &settings->local_compress, false);
+
+	settings->local_compression_level = 0;
+	readIntClientSetting(q_get_client_setting, "local_compression_level", &settings->local_compression_level, false);
+
 	settings->create_linked_user_views = false;
 	readBoolClientSetting(q_get_client_setting, "create_linked_user_views", &settings->create_linked_user_views, false);
 
@@ -653,6 +668,10 @@ void ServerSettings::readSettingsClient(ISettingsReader* settings_client, IQuery
 	readBoolClientSetting(q_get_client_setting, "internet_readd_file_entries", &settings->internet_readd_file_entries);
 	readBoolClientSetting(q_get_client_setting, "background_backups", &settings->background_backups);
 	readIntClientSetting(q_get_client_setting, "max_running_jobs_per_client", &settings->max_running_jobs_per_client);
+	readIntClientSetting(q_get_client_setting, "file_hash_threads", &settings->file_hash_threads);
+	readIntClientSetting(q_get_client_setting, "file_download_connections", &settings->file_download_connections);
+	readBoolClientSetting(q_get_client_setting, "local_compress", &settings->local_compress);
+	readIntClientSetting(q_get_client_setting, "local_compression_level", &settings->local_compression_level);
 	readBoolClientSetting(q_get_client_setting, "create_linked_user_views", &settings->create_linked_user_views);
 
 	readStringClientSetting(q_get_client_setting, "local_incr_image_style", std::string(), &settings->local_incr_image_style, false);
@@ -1215,6 +1234,7 @@ void ServerSettings::readSettings()
 
 	IQuery* q_get_client_setting = db->Prepare("SELECT value, value_client, use FROM settings_db.settings WHERE clientid=? AND key=?", false);
 	createSettingsReaders(db, clientid, settings_default, settings_client, settings_global, settings_default_id);
+	local_settings->groupid = settings_default_id*-1;
 	int clientid_backup = clientid;
 
 	ISettingsReader* settings_global_ptr = settings_global.get() != NULL ? settings_global.get() : settings_default.get();
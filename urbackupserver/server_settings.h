@@ -35,6 +35,7 @@ struct SSettings
 	size_t refcount;
 
 	int clientid;
+	int groupid;
 	std::string backupfolder;
 	std::string backupfolder_uncompr;
 	std::string update_freq_incr;
@@ -106,6 +107,9 @@ struct SSettings
 	std::string local_image_transfer_mode;
 	std::string internet_image_transfer_mode;
 	size_t update_stats_cachesize;
+	int stats_update_interval;
+	int cleanup_delete_threads;
+	int cleanup_delete_busy_rate;
 	std::string global_soft_fs_quota;
 	std::string client_quota;
 	bool end_to_end_file_backup_verification;
@@ -120,6 +124,10 @@ struct SSettings
 	bool internet_readd_file_entries;
 	std::string client_access_key;
 	int max_running_jobs_per_client;
+	int file_hash_threads;
+	int file_download_connections;
+	bool local_compress;
+	int local_compression_level;
 	bool background_backups;
 	bool create_linked_user_views;
 	std::string local_incr_image_style;
@@ -378,6 +378,17 @@ void ServerStatus::setProcessSpeed(const std::string &clientname, size_t id, dou
 	}
 }
 
+void ServerStatus::setProcessStageStats(const std::string &clientname, size_t id, const std::vector<SBackupStageStats>& stage_stats)
+{
+	IScopedLock lock(mutex);
+	SProcess* proc = getProcessInt(clientname, id);
+
+	if (proc != NULL)
+	{
+		proc->stage_stats = stage_stats;
+	}
+}
+
 bool ServerStatus::removeStatus( const std::string &clientname )
 {
 	IScopedLock lock(mutex);
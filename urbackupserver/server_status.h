@@ -11,6 +11,7 @@
 #include "../Interface/ThreadPool.h"
 
 #include "server_log.h"
+#include "BackupTelemetry.h"
 
 enum SStatusAction
 {
@@ -81,6 +82,7 @@ struct SProcess
 	int64 total_bytes;
 	int64 done_bytes;
 	bool paused;
+	std::vector<SBackupStageStats> stage_stats;
 
 	bool operator==(const SProcess& other) const
 	{
@@ -169,6 +171,9 @@ public:
 	static void setProcessSpeed(const std::string &clientname, size_t id,
 		double speed_bpms);
 
+	static void setProcessStageStats(const std::string &clientname, size_t id,
+		const std::vector<SBackupStageStats>& stage_stats);
+
 	static void setProcessEta(const std::string &clientname, size_t id,
 		int64 eta_ms);
 
@@ -32,8 +32,8 @@
 #include "dao/ServerFilesDao.h"
 #include <algorithm>
 
-ServerUpdateStats::ServerUpdateStats(bool image_repair_mode, bool interruptible)
-	: image_repair_mode(image_repair_mode), interruptible(interruptible)
+ServerUpdateStats::ServerUpdateStats(bool image_repair_mode, bool interruptible, bool incremental)
+	: image_repair_mode(image_repair_mode), interruptible(interruptible), incremental(incremental)
 {
 }
 
@@ -82,6 +82,17 @@ void ServerUpdateStats::operator()(void)
 	}
 
 	db=Server->getDatabase(Server->getThreadID(), URBACKUPDB_SERVER);
+
+	if(incremental)
+	{
+		//Only apply the file entry changes since the last run. No history entry,
+		//no image size reconciliation and no enlarged cache
+		createQueries();
+		update_files();
+		destroyQueries();
+		return;
+	}
+
 	backupdao.reset(new ServerBackupDao(db));
 	fileindex.reset(create_lmdb_files_index());
 	ServerSettings server_settings(db);
@@ -211,7 +222,10 @@ void ServerUpdateStats::update_files(void)
 {
 	num_updated_files=0;
 	
-	Server->Log("Updating file statistics...");
+	if(!incremental)
+	{
+		Server->Log("Updating file statistics...");
+	}
 
 	IDatabase* files_db = Server->getDatabase(Server->getThreadID(), URBACKUPDB_SERVER_FILES);
 	ServerFilesDao filesdao(files_db);
@@ -219,26 +233,24 @@ void ServerUpdateStats::update_files(void)
 	size_t total_num = static_cast<size_t>(filesdao.getIncomingStatsCount().value);
 	size_t total_i=0;
 
-	std::map<int, _i64> size_data_clients=getFilebackupSizesClients();
-	std::map<int, _i64> size_data_backups;
-	std::map<int, SDelInfo> del_sizes;
+	if(total_num==0)
+	{
+		db->Write("UPDATE backups SET size_calculated=1 WHERE size_calculated=0 AND done=1");
+		return;
+	}
 
 	DBScopedSynchronous synchonous_db(db);
 	DBScopedSynchronous synchonous_files_db(files_db);
-
-	DBScopedWriteTransaction files_db_transaction(NULL);
-	bool started_transaction = false;
 	
 	std::vector<ServerFilesDao::SIncomingStat> stat_entries;
 
 	int last_pc=0;
-	do
+	while(true)
 	{
 		if(interruptible)
 		{
 			if( ClientMain::getNumberOfRunningFileBackups()>0 )
 			{
-				files_db_transaction.rollback();
 				return;
 			}
 		}
@@ -247,17 +259,24 @@ void ServerUpdateStats::update_files(void)
 
 		stat_entries = filesdao.getIncomingStats();
 
-		if(!started_transaction && !stat_entries.empty())
+		if(stat_entries.empty())
 		{
-			files_db_transaction.reset(files_db);
-			started_transaction = true;
+			break;
 		}
 
+		//Every batch is committed on its own, so the locks on both databases
+		//are only held for one batch and the client sizes stay current
+		DBScopedWriteTransaction files_db_transaction(files_db);
+
+		std::map<int, _i64> size_data_clients=getFilebackupSizesClients();
+		std::map<int, _i64> size_data_backups;
+		std::map<int, SDelInfo> del_sizes;
+
 		for(size_t i=0;i<stat_entries.size();++i,++total_i)
 		{
 			++num_updated_files;
 
-			if(total_i%1000==0 && total_i>0)
+			if(total_i%1000==0 && total_i>0 && !incremental)
 			{
 				int pc=(std::min)(100, (int)((float)total_i/(float)total_num*100.f+0.5f));
 				if(pc!=last_pc)
@@ -335,15 +354,18 @@ void ServerUpdateStats::update_files(void)
 
 			filesdao.delIncomingStatEntry(entry.id);
 		}
-	}
-	while(!stat_entries.empty());
 
+		DBScopedWriteTransaction db_transaction(db);
 
-	DBScopedWriteTransaction db_transaction(db);
+		updateSizes(size_data_clients);
+		updateDels(del_sizes);
+		updateBackups(size_data_backups);
+	}
 
-	updateSizes(size_data_clients);
-	updateDels(del_sizes);
-	updateBackups(size_data_backups);
+	if(incremental && total_i>0)
+	{
+		Server->Log("Applied "+convert(total_i)+" file statistics changes", LL_DEBUG);
+	}
 
 	db->Write("UPDATE backups SET size_calculated=1 WHERE size_calculated=0 AND done=1");
 }
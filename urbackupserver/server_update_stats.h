@@ -18,7 +18,7 @@ struct SDelInfo
 class ServerUpdateStats : public IThread
 {
 public:
-	ServerUpdateStats(bool image_repair_mode=false, bool interruptible=false);
+	ServerUpdateStats(bool image_repair_mode=false, bool interruptible=false, bool incremental=false);
 
 	void operator()(void);
 
@@ -46,6 +46,7 @@ private:
 
 	bool image_repair_mode;
 	bool interruptible;
+	bool incremental;
 
 	IQuery *q_get_images;
 	IQuery *q_update_images_size;
@@ -20,6 +20,9 @@
 
 #include "action_header.h"
 #include "../server_status.h"
+#ifndef NO_ZSTD_COMPRESSION
+#include "../../urbackupcommon/CompressedPipeZstd.h"
+#endif
 
 void getLastActs(Helper &helper, JSON::Object &ret, std::vector<int> clientids);
 
@@ -106,6 +109,36 @@ ACTION_IMPL(progress)
 
 					obj.set("past_speed_bpms", past_speed_bpms);
 
+					const std::vector<SBackupStageStats>& stage_stats = clients[i].processes[j].stage_stats;
+					if (!stage_stats.empty())
+					{
+						JSON::Array stages;
+						for (size_t k = 0; k < stage_stats.size(); ++k)
+						{
+							JSON::Object stage;
+							stage.set("name", BackupTelemetry::stageName(static_cast<EBackupStage>(k)));
+							stage.set("count", stage_stats[k].count);
+							stage.set("total_ms", stage_stats[k].total_ms);
+							stage.set("max_ms", stage_stats[k].max_ms);
+
+							JSON::Array hist;
+							for (size_t l = 0; l < stage_stats[k].buckets.size(); ++l)
+							{
+								if (stage_stats[k].buckets[l] > 0)
+								{
+									JSON::Object bucket;
+									bucket.set("lt_ms", BackupTelemetry::bucketLimitMs(l));
+									bucket.set("count", stage_stats[k].buckets[l]);
+									hist.add(bucket);
+								}
+							}
+							stage.set("hist", hist);
+
+							stages.add(stage);
+						}
+						obj.set("stages", stages);
+					}
+
 					if (clients[i].processes[j].can_stop 
 						&& (all_stop_rights
 							|| std::find(stop_clientids.begin(), stop_clientids.end(), curr_clientid) != stop_clientids.end() ) )
@@ -125,6 +158,24 @@ ACTION_IMPL(progress)
 			}
 		}
 		ret.set("progress", pg);
+
+#ifndef NO_ZSTD_COMPRESSION
+		SZstdPipeStats zstd_stats = CompressedPipeZstd::getGlobalStats();
+		if (zstd_stats.uncompressed_sent_bytes + zstd_stats.uncompressed_received_bytes > 0)
+		{
+			JSON::Object compression_stats;
+			compression_stats.set("uncompressed_sent", zstd_stats.uncompressed_sent_bytes);
+			compression_stats.set("compressed_sent", zstd_stats.compressed_sent_bytes);
+			compression_stats.set("uncompressed_received", zstd_stats.uncompressed_received_bytes);
+			compression_stats.set("compressed_received", zstd_stats.compressed_received_bytes);
+			compression_stats.set("bytes_saved", (zstd_stats.uncompressed_sent_bytes - zstd_stats.compressed_sent_bytes)
+				+ (zstd_stats.uncompressed_received_bytes - zstd_stats.compressed_received_bytes));
+			compression_stats.set("compress_time_ms", zstd_stats.compress_time_us / 1000);
+			compression_stats.set("decompress_time_ms", zstd_stats.decompress_time_us / 1000);
+			compression_stats.set("level_changes", zstd_stats.level_changes);
+			ret.set("compression_stats", compression_stats);
+		}
+#endif
 	}
 	else if (session != NULL)
 	{
@@ -255,6 +255,10 @@ JSON::Object getJSONClientSettings(IDatabase *db, int t_clientid)
 	SET_SETTING_STR(internet_full_image_style);
 	SET_SETTING_BOOL(create_linked_user_views);
 	SET_SETTING_INT(max_running_jobs_per_client);
+	SET_SETTING_INT(file_hash_threads);
+	SET_SETTING_INT(file_download_connections);
+	SET_SETTING_BOOL(local_compress);
+	SET_SETTING_INT(local_compression_level);
 	SET_SETTING_STR(cbt_volumes);
 	SET_SETTING_STR(cbt_crash_persistent_volumes);
 	SET_SETTING_BOOL(ignore_disk_errors);
@@ -338,6 +342,9 @@ void getGeneralSettings(JSON::Object& obj, IDatabase *db, ServerSettings &settin
 	SET_SETTING(use_tmpfiles_images);
 	SET_SETTING(tmpdir);
 	SET_SETTING(update_stats_cachesize);
+	SET_SETTING(stats_update_interval);
+	SET_SETTING(cleanup_delete_threads);
+	SET_SETTING(cleanup_delete_busy_rate);
 	SET_SETTING(use_incremental_symlinks);
 	SET_SETTING(show_server_updates);
 	SET_SETTING(server_url);
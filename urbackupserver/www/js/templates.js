@@ -37,7 +37,7 @@
 (function(){dust.register("new_version_available",body_0);function body_0(chk,ctx){return chk.f(ctx.get(["tThere is a new version of UrBackup server available"], false),ctx,"h").w(" (").f(ctx.get(["new_version_number"], false),ctx,"h").w("). Download it <a href=\"http://www.urbackup.org/download.html\">here</a>.<br/><a href=\"javascript: stopShowNewVersion('").f(ctx.get(["new_version_number"], false),ctx,"h").w("')\">").f(ctx.get(["tOk. Stop showing this."], false),ctx,"h").w("</a><br/>");}body_0.__dustBody=!0;return body_0;})();
 (function(){dust.register("nospc_fatal",body_0);function body_0(chk,ctx){return chk.w("<div class=\"alert alert-danger\">").f(ctx.get(["nospc_fatal_text"], false),ctx,"h").w("<br><br><a href=\"javascript: resetStatusError('nospc_fatal')\">").f(ctx.get(["tOk. Reset this error"], false),ctx,"h").w("</a></div><br /><br />");}body_0.__dustBody=!0;return body_0;})();
 (function(){dust.register("nospc_stalled",body_0);function body_0(chk,ctx){return chk.w("<table cellspacing=\"0\" cellpadding=\"0\"><tr>\t\t\t<th style=\"border: 3px solid red; padding: 3px;width: 500px\">").f(ctx.get(["nospc_stalled_text"], false),ctx,"h").w("<br><br><a href=\"javascript: resetStatusError('nospc_stalled')\">").f(ctx.get(["tOk. Reset this error"], false),ctx,"h").w("</a></th></tr></table><br><br>");}body_0.__dustBody=!0;return body_0;})();
-(function(){dust.register("progress_table",body_0);function body_0(chk,ctx){return chk.w("<div class=\"panel panel-primary\"><div class=\"panel-heading\">").f(ctx.get(["tActivities"], false),ctx,"h").w("</div><div class=\"panel-body\"><table class=\"table table-striped\"><thead><tr>\t\t\t<th>").f(ctx.get(["tComputer name"], false),ctx,"h").w("</th><th>").f(ctx.get(["tAction"], false),ctx,"h").w("</th><th>").f(ctx.get(["tDetails"], false),ctx,"h").w("</th><th>").f(ctx.get(["tProgress"], false),ctx,"h").w("</th><th>").f(ctx.get(["tETA"], false),ctx,"h").w("</th><th style=\"width: 15em\">").f(ctx.get(["tSpeed"], false),ctx,"h").w("</th><th>").f(ctx.get(["tFiles in queue"], false),ctx,"h").w("</th><th>&nbsp;</th></tr></thead><tbody>").f(ctx.get(["rows"], false),ctx,"h",["s"]).w("</tbody></table></div></div>");}body_0.__dustBody=!0;return body_0;})();
+(function(){dust.register("progress_table",body_0);function body_0(chk,ctx){return chk.w("<div class=\"panel panel-primary\"><div class=\"panel-heading\">").f(ctx.get(["tActivities"], false),ctx,"h").w("</div><div class=\"panel-body\"><table class=\"table table-striped\"><thead><tr>\t\t\t<th>").f(ctx.get(["tComputer name"], false),ctx,"h").w("</th><th>").f(ctx.get(["tAction"], false),ctx,"h").w("</th><th>").f(ctx.get(["tDetails"], false),ctx,"h").w("</th><th>").f(ctx.get(["tProgress"], false),ctx,"h").w("</th><th>").f(ctx.get(["tETA"], false),ctx,"h").w("</th><th style=\"width: 15em\">").f(ctx.get(["tSpeed"], false),ctx,"h").w("</th><th>").f(ctx.get(["tFiles in queue"], false),ctx,"h").w("</th><th>&nbsp;</th></tr></thead><tbody>").f(ctx.get(["rows"], false),ctx,"h",["s"]).w("</tbody></table>").x(ctx.get(["compression_saved"], false),ctx,{"block":body_1},{}).w("</div></div>");}body_0.__dustBody=!0;function body_1(chk,ctx){return chk.w("<p>").f(ctx.get(["tSaved by transfer compression"], false),ctx,"h").w(": ").f(ctx.get(["compression_saved"], false),ctx,"h").w(" (").f(ctx.get(["tCPU time"], false),ctx,"h").w(": ").f(ctx.get(["compression_cpu_time"], false),ctx,"h").w(")</p>");}body_1.__dustBody=!0;return body_0;})();
 (function(){dust.register("progress_table_none",body_0);function body_0(chk,ctx){return chk.w("<div class=\"panel panel-default\"><div class=\"panel-heading\">").f(ctx.get(["tActivities"], false),ctx,"h").w("</div><div class=\"panel-body\"><table class=\"table table-striped\"><thead><tr>\t\t\t<th>").f(ctx.get(["tComputer name"], false),ctx,"h").w("</th><th>").f(ctx.get(["tAction"], false),ctx,"h").w("</th><th>").f(ctx.get(["tDetails"], false),ctx,"h").w("</th><th>").f(ctx.get(["tProgress"], false),ctx,"h").w("</th><th>").f(ctx.get(["tFiles in queue"], false),ctx,"h").w("</th><th>&nbsp;</th></tr></thead><tbody><tr><td colspan=\"6\">").f(ctx.get(["tNo activities"], false),ctx,"h").w("</td></tr></tbody></table></div></div>");}body_0.__dustBody=!0;return body_0;})();
 (function(){dust.register("restore_linux_img",body_0);function body_0(chk,ctx){return chk.w("<div class=\"panel panel-default\"><div class=\"panel-heading\">").f(ctx.get(["tRestore Linux image"], false),ctx,"h").w("</div><div class=\"panel-body\"><p>").f(ctx.get(["tTo restore your Linux disk please enter following in a terminal:"], false),ctx,"h").w("<blockquote><p><code>TF=`mktemp` && wget \"").f(ctx.get(["linux_restore_url"], false),ctx,"h").w("\" -O $TF && sudo sh $TF; rm -f $TF</code></p></blockquote></p></div></div>");}body_0.__dustBody=!0;return body_0;})();
 (function(){dust.register("logs_table",body_0);function body_0(chk,ctx){return chk.w("<div class=\"panel panel-default\" style=\"margin-top:20px\"><div class=\"panel-heading\">").f(ctx.get(["tLogs"], false),ctx,"h").w("</div><div class=\"panel-body\"><table class=\"table table-hover\"><thead><tr>\t<th>&nbsp;</th><th>").f(ctx.get(["tComputer name"], false),ctx,"h").w("</th><th>").f(ctx.get(["tBackup time"], false),ctx,"h").w("</th><th>").f(ctx.get(["tErrors"], false),ctx,"h").w("</th><th>").f(ctx.get(["tWarnings"], false),ctx,"h").w("</th><th>").f(ctx.get(["tAction"], false),ctx,"h").w("</th></tr></thead><tbody>").f(ctx.get(["rows"], false),ctx,"h",["s"]).w("</tbody></table></div></div><div class=\"row\"><div class=\"col-md-2\"><div class=\"panel panel-default\"><div class=\"panel-heading\">").f(ctx.get(["tLive Log"], false),ctx,"h").w("</div><div class=\"panel-body\"><form class=\"form form-inline\"><div class=\"form-group\"><select class=\"form-control\" id=\"live_log_clientid\" class=\"selectpicker\" data-container=\"body\" data-live-search=\"true\" onChange=\"show_live_log()\">").f(ctx.get(["live_log_clients"], false),ctx,"h",["s"]).w("</select></div></form></div></div></div><div class=\"col-md-10\"><div class=\"panel panel-default\"><div class=\"panel-heading\">").f(ctx.get(["tReports"], false),ctx,"h").w("</div><div class=\"panel-body\">").x(ctx.get(["has_user"], false),ctx,{"else":body_1,"block":body_2},{}).w("</div></div></div></div> <!-- row -->");}body_0.__dustBody=!0;function body_1(chk,ctx){return chk.f(ctx.get(["tYou need to create a user to be able to send reports"], false),ctx,"h");}body_1.__dustBody=!0;function body_2(chk,ctx){return chk.w("<form class=\"form-horizontal\"><div class=\"form-group\"><label class=\"col-sm-2 control-label\">").f(ctx.get(["tSend reports to"], false),ctx,"h").w(":</label><p class=\"form-control-static\" id=\"s_report_mails\"></p></div><div class=\"form-group\"><div class=\"col-sm-2\">&nbsp;</div><input type=\"hidden\" id=\"report_mail\" value=\"").f(ctx.get(["report_mail"], false),ctx,"h").w("\"/><div class=\"col-sm-4\"><input type=\"text\" class=\"form-control\" id=\"report_new_mail\" value=\"\" placeholder=\"").f(ctx.get(["tAdd Email Address"], false),ctx,"h").w("\"/></div><a href=\"javascript: logs_add_mail()\" class=\"btn btn-default\">+</a></div><div class=\"form-group\"><label class=\"col-sm-2 control-label\">").f(ctx.get(["tSend"], false),ctx,"h").w("</label><div class=\"col-sm-4\"><select class=\"form-control\" id=\"report_sendonly\"><option value=\"0\" ").f(ctx.get(["sel_all"], false),ctx,"h").w(">").f(ctx.get(["tAll"], false),ctx,"h").w("</option><option value=\"1\" ").f(ctx.get(["sel_failed"], false),ctx,"h").w(">").f(ctx.get(["tFailed"], false),ctx,"h").w("</option><option value=\"3\" ").f(ctx.get(["sel_failed_clienttimeout"], false),ctx,"h").w(">").f(ctx.get(["tFailed without failures caused by client timeout"], false),ctx,"h").w("</option><option value=\"2\" ").f(ctx.get(["sel_succ"], false),ctx,"h").w(">").f(ctx.get(["tSuccessfull"], false),ctx,"h").w("</option></select></div></div><div class=\"form-group\"><label class=\"col-sm-2 control-label\">").f(ctx.get(["tMinimum log level"], false),ctx,"h").w("</label><div class=\"col-sm-4\"><select class=\"form-control\" id=\"report_loglevel\"><option value=\"0\" ").f(ctx.get(["sel_info"], false),ctx,"h").w(">").f(ctx.get(["tInfo"], false),ctx,"h").w("</option><option value=\"1\" ").f(ctx.get(["sel_warn"], false),ctx,"h").w(">").f(ctx.get(["tWarning"], false),ctx,"h").w("</option><option value=\"2\" ").f(ctx.get(["sel_error"], false),ctx,"h").w(">").f(ctx.get(["tError"], false),ctx,"h").w("</option></select></div></div><div class=\"col-sm-offset-2\"><input type=\"button\" class=\"btn btn-default\" value=\"").f(ctx.get(["tSave"], false),ctx,"h").w("\" onClick=\"saveReportSettings()\" /></div>").x(ctx.get(["can_report_script_edit"], false),ctx,{"block":body_3},{}).w("\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t</form>");}body_2.__dustBody=!0;function body_3(chk,ctx){return chk.w("<br /><br /><a href=\"javascript: show_report_script1()\">").f(ctx.get(["tEdit report script"], false),ctx,"h").w("</a>");}body_3.__dustBody=!0;return body_0;})();
@@ -55,7 +55,7 @@
 (function(){dust.register("settings_user_add_done",body_0);function body_0(chk,ctx){return chk.w("<div class=\"alert alert-success\">").f(ctx.get(["msg"], false),ctx,"h").w("</div>");}body_0.__dustBody=!0;return body_0;})();
 (function(){dust.register("settings_user_pw_change",body_0);function body_0(chk,ctx){return chk.w("<br /><div class=\"panel panel-default\"><div class=\"panel-heading\"><strong>").f(ctx.get(["tChange password for user"], false),ctx,"h").w(":</strong> ").f(ctx.get(["username"], false),ctx,"h").w("</div><div class=\"panel-body\"><form class=\"form-horizontal\" action=\"#\" onsubmit=\"changeUserPW(").f(ctx.get(["userid"], false),ctx,"h").w("); return false;\"><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"password1\">").f(ctx.get(["tPassword"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"password\" class=\"form-control\" id=\"password1\" value=\"\"/></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"password2\">").f(ctx.get(["tRepeat password"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"password\" class=\"form-control\" id=\"password2\" value=\"\"/></div></div><input type=\"button\" class=\"btn btn-default\" value=\"").f(ctx.get(["tCancel"], false),ctx,"h").w("\" onclick=\"userSettings()\"> <input type=\"submit\" class=\"btn btn-default\" value=\"").f(ctx.get(["tChange"], false),ctx,"h").w("\" /></form></div></div>");}body_0.__dustBody=!0;return body_0;})();
 (function(){dust.register("settings_user_rights_change",body_0);function body_0(chk,ctx){return chk.w("<br /><div class=\"panel panel-default\"><div class=\"panel-heading\"><strong>").f(ctx.get(["tChange rights for user"], false),ctx,"h").w(":</strong> ").f(ctx.get(["username"], false),ctx,"h").w("</div><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\" action=\"#\" onsubmit=\"submitChangeUserRights(").f(ctx.get(["userid"], false),ctx,"h").w("); return false;\"><table class=\"table-striped\" id=\"rightstable\"><thead><tr><th>").f(ctx.get(["tDomain"], false),ctx,"h").w("</td><th>").f(ctx.get(["tRights"], false),ctx,"h").w("</td><th>").f(ctx.get(["tTranslation"], false),ctx,"h").w("</td><th>").f(ctx.get(["tActions"], false),ctx,"h").w("</td></tr></thead><tbody>").f(ctx.get(["rows"], false),ctx,"h",["s"]).w("</tbody></table><br /><a class=\"btn btn-default\" href=\"javascript: addNewDomain(").f(ctx.get(["userid"], false),ctx,"h").w(", '").f(ctx.get(["username"], false),ctx,"h").w("')\">").f(ctx.get(["tNew domain"], false),ctx,"h").w("</a><br /><input type=\"button\" class=\"btn btn-default\" value=\"").f(ctx.get(["tCancel"], false),ctx,"h").w("\" onclick=\"userSettings()\"> <input type=\"submit\" class=\"btn btn-default\" value=\"").f(ctx.get(["tChange"], false),ctx,"h").w("\" /></form></div></div>");}body_0.__dustBody=!0;return body_0;})();
-(function(){dust.register("settings_inv_row",body_0);function body_0(chk,ctx){return chk.x(ctx.get(["client_settings"], false),ctx,{"else":body_1,"block":body_2},{}).w("<div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_incr\">").f(ctx.get(["tInterval for incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_incr\" value=\"").f(ctx.get(["update_freq_incr"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["thours"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_incr_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_incr_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_full\">").f(ctx.get(["tInterval for full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_full\" value=\"").f(ctx.get(["update_freq_full"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tdays"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_full_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_full_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div>\t\t\t\t</div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_file_incr\">").f(ctx.get(["tMaximal number of incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_file_incr\" value=\"").f(ctx.get(["max_file_incr"], false),ctx,"h").w("\"/></div><div id=\"max_file_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_file_incr\">").f(ctx.get(["tMinimal number of incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_file_incr\" value=\"").f(ctx.get(["min_file_incr"], false),ctx,"h").w("\"/></div><div id=\"min_file_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_file_full\">").f(ctx.get(["tMaximal number of full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_file_full\" value=\"").f(ctx.get(["max_file_full"], false),ctx,"h").w("\"/></div><div id=\"max_file_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_file_full\">").f(ctx.get(["tMinimal number of full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_file_full\" value=\"").f(ctx.get(["min_file_full"], false),ctx,"h").w("\"/></div><div id=\"min_file_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"exclude_files\">").f(ctx.get(["tExcluded files (with wildcards)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"exclude_files_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"exclude_files\" value=\"").f(ctx.get(["exclude_files"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#exclude_files\" target=\"_blank\">?</a></div></div></div><div id=\"exclude_files_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"include_files\">").f(ctx.get(["tIncluded files (with wildcards)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"include_files_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"include_files\" value=\"").f(ctx.get(["include_files"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#include_files\" target=\"_blank\">?</a></div></div></div><div id=\"include_files_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"default_dirs\">").f(ctx.get(["tDefault directories to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"default_dirs_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"default_dirs\" value=\"").f(ctx.get(["default_dirs"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#default_dirs\" target=\"_blank\">?</a></div></div></div><div id=\"default_dirs_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backup_dirs_optional\">").f(ctx.get(["tDirectories to backup are optional by default:"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"backup_dirs_optional\" ").f(ctx.get(["backup_dirs_optional"], false),ctx,"h").w("/></label></div><div id=\"backup_dirs_optional_sw\" style=\"display: inline\"></div></div></form></div></div></div><div class=\"tab-pane\" id=\"image_backups\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_image_incr\">").f(ctx.get(["tInterval for incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_image_incr\" value=\"").f(ctx.get(["update_freq_image_incr"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tdays"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_image_incr_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_image_incr_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_image_full\">").f(ctx.get(["tInterval for full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_image_full\" value=\"").f(ctx.get(["update_freq_image_full"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tDays"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_image_full_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_image_full_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_image_incr\">").f(ctx.get(["tMaximal number of incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_image_incr\" value=\"").f(ctx.get(["max_image_incr"], false),ctx,"h").w("\"/></div><div id=\"max_image_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_image_incr\">").f(ctx.get(["tMinimal number of incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_image_incr\" value=\"").f(ctx.get(["min_image_incr"], false),ctx,"h").w("\"/></div><div id=\"min_image_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_image_full\">").f(ctx.get(["tMaximal number of full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_image_full\" value=\"").f(ctx.get(["max_image_full"], false),ctx,"h").w("\"/></div><div id=\"max_image_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_image_full\">").f(ctx.get(["tMinimal number of full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_image_full\" value=\"").f(ctx.get(["min_image_full"], false),ctx,"h").w("\"/></div><div id=\"min_image_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_letters\">").f(ctx.get(["tVolumes to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"image_letters_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"image_letters\" value=\"").f(ctx.get(["image_letters"], false),ctx,"h",["s","h"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#image_letters\" target=\"_blank\">?</a></div></div></div><div id=\"image_letters_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_file_format\">").f(ctx.get(["tImage backup file format"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"image_file_format\"><option value=\"vhdz\" ").f(ctx.get(["image_file_format_0"], false),ctx,"h").w(">").f(ctx.get(["tCompressed VHD (Compressed non-standard Virtual HardDisk)"], false),ctx,"h").w("</option><option value=\"vhd\" ").f(ctx.get(["image_file_format_1"], false),ctx,"h").w(">").f(ctx.get(["tVHD (Virtual HardDisk)"], false),ctx,"h").w("</option>").x(ctx.get(["cowraw_available"], false),ctx,{"block":body_3},{}).w("</select></div><div id=\"image_file_format_sw\" style=\"display: inline\"></div></div></form></div></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_4},{}).w("<div class=\"tab-pane\" id=\"client\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\">").x(ctx.get(["main_client"], false),ctx,{"block":body_5},{}).w("<div class=\"form-group\" id=\"backup_window_row\"><label class=\"col-sm-4 control-label\">").f(ctx.get(["tBackup window"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window\" value=\"").f(ctx.get(["backup_window"], false),ctx,"h",["s"]).w("\" onchange=\"backupWindowChange()\"/><div class=\"input-group-addon\"><a href=\"javascript: showBackupWindowDetails()\">").f(ctx.get(["tShow details"], false),ctx,"h").w("</a>&nbsp;&nbsp;<a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_incr_file_row\"><label class=\"col-sm-4 control-label\">").f(ctx.get(["tBackup window for incremental file backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_incr_file\" value=\"").f(ctx.get(["backup_window_incr_file"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_incr_file_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_full_file_row\"><label class=\"col-sm-4 control-label\" for=\"backup_window_full_file\">").f(ctx.get(["tBackup window for full file backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_full_file\" value=\"").f(ctx.get(["backup_window_full_file"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_full_file_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_incr_image_row\"><label class=\"col-sm-4 control-label\" for=\"backup_window_incr_image\">").f(ctx.get(["tBackup window for incremental image backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_incr_image\" value=\"").f(ctx.get(["backup_window_incr_image"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_incr_image_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_full_image_row\"><label class=\"col-sm-4 control-label\" for=\"backup_window_full_image\">").f(ctx.get(["tBackup window for full image backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_full_image\" value=\"").f(ctx.get(["backup_window_full_image"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_full_image_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_6},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_speed\">").f(ctx.get(["tMax backup speed for local network"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"local_speed\" value=\"").f(ctx.get(["local_speed"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">MBit/s</div></div></div><div id=\"local_speed_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_7},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"client_quota\">").f(ctx.get(["tSoft client quota"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"client_quota\" value=\"").f(ctx.get(["client_quota"], false),ctx,"h").w("\"/></div><div id=\"client_quota_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_8},{}).w("</form></div></div></div><div class=\"tab-pane\" id=\"archive\"><div class=\"panel panel-default\"><div class=\"panel-body\"><div id=\"archive_sw\" style=\"float: right; margin-left: 10pt; margin-right: 10pt\"></div><table class=\"table table-striped\" id=\"archive_table\"><thead><tr><th>").f(ctx.get(["tArchive every"], false),ctx,"h").w("</th><th>").f(ctx.get(["tArchive for"], false),ctx,"h").w("</th><th>").f(ctx.get(["tArchive window"], false),ctx,"h").w(" <a class=\"btn btn-xs btn-default\" href=\"help.htm#archive_window\" target=\"_blank\" title=\"h;dom;mon;dow\">?</a></th><th>").f(ctx.get(["tBackup type"], false),ctx,"h").w("</th><th>").f(ctx.get(["tVolume letters"], false),ctx,"h").w("</th>").f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<th>").f(ctx.get(["tNext archival"], false),ctx,"h").w("</th>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]).w("<th>&nbsp;</th><th>&nbsp;</th></tr></thead><tbody><tr><td><div style=\"float: left; width: 60%\"><input class=\"form-control\" type=\"text\" id=\"archive_every\"></div><select class=\"form-control\" style=\"width: 40%\" id=\"archive_every_unit\"><option value=\"h\">").f(ctx.get(["thours"], false),ctx,"h").w("</option><option value=\"d\" selected=\"selected\">").f(ctx.get(["tdays"], false),ctx,"h").w("</option><option value=\"w\">").f(ctx.get(["tweeks"], false),ctx,"h").w("</option><option value=\"m\">").f(ctx.get(["tmonth"], false),ctx,"h").w("</option><option value=\"y\">").f(ctx.get(["tyears"], false),ctx,"h").w("</option></select></td><td><div style=\"float: left; width: 60%\"><input class=\"form-control\" type=\"text\" id=\"archive_for\"></div><select class=\"form-control\" style=\"width: 40%\" onchange=\"changeArchiveForUnit()\" id=\"archive_for_unit\"><option value=\"h\">").f(ctx.get(["thours"], false),ctx,"h").w("</option><option value=\"d\" selected=\"selected\">").f(ctx.get(["tdays"], false),ctx,"h").w("</option><option value=\"w\">").f(ctx.get(["tweeks"], false),ctx,"h").w("</option><option value=\"m\">").f(ctx.get(["tmonth"], false),ctx,"h").w("</option><option value=\"y\">").f(ctx.get(["tyears"], false),ctx,"h").w("</option><option value=\"i\">").f(ctx.get(["tforever"], false),ctx,"h").w("</option></select></td><td><input class=\"form-control\" type=\"text\" id=\"archive_window\" value=\"*;*;*;*\"></td><td><select class=\"form-control\" id=\"archive_backup_type\" onchange=\"changeArchiveBackupType()\"><option value=\"file\">").f(ctx.get(["tFile backup"], false),ctx,"h").w("</option><option value=\"incr_file\">").f(ctx.get(["tIncremental file backup"], false),ctx,"h").w("</option><option value=\"full_file\">").f(ctx.get(["tFull file backup"], false),ctx,"h").w("</option><option value=\"image\">").f(ctx.get(["tImage backup"], false),ctx,"h").w("</option><option value=\"incr_image\">").f(ctx.get(["tIncremental image backup"], false),ctx,"h").w("</option><option value=\"full_image\">").f(ctx.get(["tFull image backup"], false),ctx,"h").w("</option></select></td><td><input class=\"form-control\" type=\"text\" id=\"archive_letters\" value=\"ALL\" disabled=\"disabled\"></td>").f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<td>&nbsp;</td>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]).w("<td></td><td>").x(ctx.get(["archive_global"], false),ctx,{"block":body_9},{}).f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<input type=\"button\" class=\"btn btn-sm btn-default\" value=\"").f(ctx.get(["tAdd"], false),ctx,"h").w("\" id=\"archive_add\" onclick=\"addArchiveItem(false)\" />").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]).w("\t\t</td></tr></tbody></table></div></div></div><div class=\"tab-pane\" id=\"alerts\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"alert_script\">").f(ctx.get(["tAlert script"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"alert_script\" onChange=\"updateAlertScriptParams()\">").f(ctx.get(["alert_scripts"], false),ctx,"h",["s"]).w("</select></div>").x(ctx.get(["can_edit_scripts"], false),ctx,{"block":body_10},{}).w("<div id=\"alert_script_sw\" style=\"float: right; margin-left: 10pt; margin-right: 10pt\"></div></div>\t\t\t<div id=\"alert_script_params_container\">").f(ctx.get(["mod_alert_params"], false),ctx,"h",["s"]).w("</div></form></div></div></div>").f(ctx.get(["internet_settings_start"], false),ctx,"h",["s"]).w("<div class=\"tab-pane\" id=\"internet\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\">").x(ctx.get(["global_settings"], false),ctx,{"block":body_11},{}).x(ctx.get(["main_client"], false),ctx,{"block":body_12},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_image_backups\">").f(ctx.get(["tDo image backups over internet"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_image_backups\" value=\"false\" ").f(ctx.get(["internet_image_backups"], false),ctx,"h").w("/></label></div><div id=\"internet_image_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_full_file_backups\">").f(ctx.get(["tDo full file backups over internet"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_full_file_backups\" value=\"false\" ").f(ctx.get(["internet_full_file_backups"], false),ctx,"h").w("/></label></div><div id=\"internet_full_file_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_speed\">").f(ctx.get(["tMax backup speed for internet connection"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"internet_speed\" value=\"").f(ctx.get(["internet_speed"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">KBit/s</div></div></div><div id=\"internet_speed_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["global_settings"], false),ctx,{"block":body_15},{}).x(ctx.get(["main_client"], false),ctx,{"block":body_16},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_calculate_filehashes_on_client\">").f(ctx.get(["tCalculate file-hashes on the client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_calculate_filehashes_on_client\" value=\"false\" ").f(ctx.get(["internet_calculate_filehashes_on_client"], false),ctx,"h").w("/></label></div><div id=\"internet_calculate_filehashes_on_client_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_parallel_file_hashing\">Beta: Calculate file hashes on client in parallel:</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_parallel_file_hashing\" value=\"false\" ").f(ctx.get(["internet_parallel_file_hashing"], false),ctx,"h").w("/></label></div><div id=\"internet_parallel_file_hashing_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_17},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_file_dataplan_limit\">").f(ctx.get(["tDo not start file backups if current estimated data usage limit per month is smaller than"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"internet_file_dataplan_limit\" value=\"").f(ctx.get(["internet_file_dataplan_limit"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMB"], false),ctx,"h").w("</div></div></div><div id=\"internet_file_dataplan_limit_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_image_dataplan_limit\">").f(ctx.get(["tDo not start image backups if current estimated data usage limit per month is smaller than"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"internet_image_dataplan_limit\" value=\"").f(ctx.get(["internet_image_dataplan_limit"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMB"], false),ctx,"h").w("</div></div></div><div id=\"internet_image_dataplan_limit_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["global_settings"], false),ctx,{"block":body_18},{}).w("</form></div></div></div>").f(ctx.get(["internet_settings_end"], false),ctx,"h",["s"]).w("<div class=\"tab-pane\" id=\"advanced\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\">").f(ctx.get(["global_settings_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"use_tmpfiles\">").f(ctx.get(["tTemporary files as file backup buffer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"use_tmpfiles\" value=\"false\" ").f(ctx.get(["use_tmpfiles"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"use_tmpfiles_images\">").f(ctx.get(["tTemporary files as image backup buffer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"use_tmpfiles_images\" value=\"false\" ").f(ctx.get(["use_tmpfiles_images"], false),ctx,"h").w("/></label></div></div>").f(ctx.get(["global_settings_end"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_full_file_transfer_mode\">").f(ctx.get(["tLocal full file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_full_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["local_full_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["local_full_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"local_full_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_full_file_transfer_mode\">").f(ctx.get(["tInternet full file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_full_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["internet_full_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["internet_full_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"internet_full_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_incr_file_transfer_mode\">").f(ctx.get(["tLocal incremental file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_incr_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["local_incr_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["local_incr_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option><option value=\"blockhash\" ").f(ctx.get(["local_incr_file_transfer_mode_2"], false),ctx,"h").w(">").f(ctx.get(["tBlock differences - hashed"], false),ctx,"h").w("</option></select></div><div id=\"local_incr_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_incr_file_transfer_mode\">").f(ctx.get(["tInternet incremental file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_incr_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["internet_incr_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["internet_incr_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option><option value=\"blockhash\" ").f(ctx.get(["internet_incr_file_transfer_mode_2"], false),ctx,"h").w(">").f(ctx.get(["tBlock differences - hashed"], false),ctx,"h").w("</option></select></div><div id=\"internet_incr_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_image_transfer_mode\">").f(ctx.get(["tLocal image backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_image_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["local_image_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["local_image_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"local_image_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_image_transfer_mode\">").f(ctx.get(["tInternet image backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_image_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["internet_image_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["internet_image_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"internet_image_transfer_mode_sw\" style=\"display: inline\"></div></div>\t\t\t<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_incr_image_style\">").f(ctx.get(["tLocal incremental image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_incr_image_style\"><option value=\"to-full\" ").f(ctx.get(["local_incr_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tBased on last full image backup"], false),ctx,"h").w("</option><option value=\"to-last\" ").f(ctx.get(["local_incr_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tBased on last image backup"], false),ctx,"h").w("</option></select></div><div id=\"local_incr_image_style_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_incr_image_style\">").f(ctx.get(["tInternet incremental image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_incr_image_style\"><option value=\"to-full\" ").f(ctx.get(["internet_incr_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tBased on last full image backup"], false),ctx,"h").w("</option><option value=\"to-last\" ").f(ctx.get(["internet_incr_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tBased on last image backup"], false),ctx,"h").w("</option></select></div><div id=\"internet_incr_image_style_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_full_image_style\">").f(ctx.get(["tLocal full image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_full_image_style\"><option value=\"full\" ").f(ctx.get(["local_full_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tFull image backup #1"], false),ctx,"h").w("</option><option value=\"synthetic\" ").f(ctx.get(["local_full_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tSynthetic full image backup"], false),ctx,"h").w("</option></select></div><div id=\"local_full_image_style_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_full_image_style\">").f(ctx.get(["tInternet full image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_full_image_style\"><option value=\"full\" ").f(ctx.get(["internet_full_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tFull image backup #1"], false),ctx,"h").w("</option><option value=\"synthetic\" ").f(ctx.get(["internet_full_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tSynthetic full image backup"], false),ctx,"h").w("</option></select></div><div id=\"internet_full_image_style_sw\" style=\"display: inline\"></div></div>").f(ctx.get(["global_settings_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_stats_cachesize\">").f(ctx.get(["tDatabase cache size during batch processing"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_stats_cachesize\" value=\"").f(ctx.get(["update_stats_cachesize"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMB"], false),ctx,"h").w("</div></div></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"use_incremental_symlinks\">").f(ctx.get(["tUse symlinks during incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"use_incremental_symlinks\" value=\"false\" ").f(ctx.get(["use_incremental_symlinks"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_expect_endpoint\">").f(ctx.get(["tList of server IPs (proxys) from which to expect endpoint information (forwarded for) when connecting to Internet service (needs server restart)"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"internet_expect_endpoint\" value=\"").f(ctx.get(["internet_expect_endpoint"], false),ctx,"h").w("\"/></label></div></div>").f(ctx.get(["global_settings_end"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"end_to_end_file_backup_verification\">").f(ctx.get(["tDebugging: End-to-end verification of all file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"end_to_end_file_backup_verification\" value=\"false\" ").f(ctx.get(["end_to_end_file_backup_verification"], false),ctx,"h").w("/></label></div><div id=\"end_to_end_file_backup_verification_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"verify_using_client_hashes\">").f(ctx.get(["tDebugging: Verify file backups using client side hashes"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"verify_using_client_hashes\" value=\"false\" ").f(ctx.get(["verify_using_client_hashes"], false),ctx,"h").w("/></label></div><div id=\"verify_using_client_hashes_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_readd_file_entries\">").f(ctx.get(["tPeriodically readd file entries of internet clients to database (disable only if you do not run fulls)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_readd_file_entries\" value=\"true\" ").f(ctx.get(["internet_readd_file_entries"], false),ctx,"h").w("/></label></div><div id=\"internet_readd_file_entries_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"background_backups\">").f(ctx.get(["tRun backups with background priority on the clients"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"background_backups\" value=\"true\" ").f(ctx.get(["background_backups"], false),ctx,"h").w("/></label></div><div id=\"background_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"create_linked_user_views\">").f(ctx.get(["tCreate symbolically linked views for each user on the clients after file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"create_linked_user_views\" value=\"true\" ").f(ctx.get(["create_linked_user_views"], false),ctx,"h").w("/></label></div><div id=\"create_linked_user_views_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_running_jobs_per_client\">").f(ctx.get(["tMaximum number of simultaneous jobs per client"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"max_running_jobs_per_client\" value=\"").f(ctx.get(["max_running_jobs_per_client"], false),ctx,"h").w("\"/></label></div><div id=\"max_running_jobs_per_client_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"cbt_volumes\">").f(ctx.get(["tList of volumes for which change block tracking should be used (if available)"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"cbt_volumes\" value=\"").f(ctx.get(["cbt_volumes"], false),ctx,"h").w("\"/></label></div><div id=\"cbt_volumes_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"cbt_crash_persistent_volumes\">").f(ctx.get(["tList of volumes for which the change block tracking should be crash persistent"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"cbt_crash_persistent_volumes\" value=\"").f(ctx.get(["cbt_crash_persistent_volumes"], false),ctx,"h").w("\"/></label></div><div id=\"cbt_crash_persistent_volumes_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"ignore_disk_errors\">").f(ctx.get(["tDo not fail backups in case of hash mismatches or read errors"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"ignore_disk_errors\" value=\"true\" ").f(ctx.get(["ignore_disk_errors"], false),ctx,"h").w("/></label></div><div id=\"ignore_disk_errors_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_snapshot_groups\">").f(ctx.get(["tVolumes to snapshot in groups during image backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"image_snapshot_groups\" value=\"").f(ctx.get(["image_snapshot_groups"], false),ctx,"h").w("\"/></label></div><div id=\"image_snapshot_groups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"file_snapshot_groups\">").f(ctx.get(["tVolumes to snapshot in groups during file backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"file_snapshot_groups\" value=\"").f(ctx.get(["file_snapshot_groups"], false),ctx,"h").w("\"/></label></div><div id=\"file_snapshot_groups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"vss_select_components\">").f(ctx.get(["tWindows components backup configuration"], false),ctx,"h").w("</label><div class=\"col-sm-6\" id=\"vss_select_components_div\"><label><input type=\"text\" class=\"form-control\" id=\"vss_select_components\" value=\"").f(ctx.get(["vss_select_components"], false),ctx,"h").w("\"/></label></div><div id=\"vss_select_components_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"client_settings_tray_access_pw\">").f(ctx.get(["tRequire tray icon users to enter following text before being able to change settings"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"client_settings_tray_access_pw\" value=\"").f(ctx.get(["client_settings_tray_access_pw"], false),ctx,"h").w("\"/></label></div></div></form></div></div></div>").x(ctx.get(["client_settings"], false),ctx,{"block":body_19},{});}body_0.__dustBody=!0;function body_1(chk,ctx){return chk.w("<div class=\"tab-pane\" id=\"file_backups\">");}body_1.__dustBody=!0;function body_2(chk,ctx){return chk.w("<div class=\"tab-pane active\" id=\"file_backups\">");}body_2.__dustBody=!0;function body_3(chk,ctx){return chk.w("<option value=\"cowraw\" ").f(ctx.get(["image_file_format_2"], false),ctx,"h").w(">").f(ctx.get(["tRaw copy-on-write file"], false),ctx,"h").w("</option>");}body_3.__dustBody=!0;function body_4(chk,ctx){return chk.w("<div class=\"tab-pane\" id=\"permissions\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_config_paths\">").f(ctx.get(["tAllow client-side changing of the directories to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_config_paths\" ").f(ctx.get(["allow_config_paths"], false),ctx,"h").w("/></label></div><div id=\"allow_config_paths_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_full_file_backups\">").f(ctx.get(["tAllow client-side starting of full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_starting_full_file_backups\" ").f(ctx.get(["allow_starting_full_file_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_full_file_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_incr_file_backups\">").f(ctx.get(["tAllow client-side starting of incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_starting_incr_file_backups\" ").f(ctx.get(["allow_starting_incr_file_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_incr_file_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_full_image_backups\">").f(ctx.get(["tAllow client-side starting of full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"checkbox\" id=\"allow_starting_full_image_backups\" ").f(ctx.get(["allow_starting_full_image_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_full_image_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_incr_image_backups\">").f(ctx.get(["tAllow client-side starting of incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_starting_incr_image_backups\" ").f(ctx.get(["allow_starting_incr_image_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_incr_image_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_log_view\">").f(ctx.get(["tAllow client-side viewing of backup logs"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_log_view\" ").f(ctx.get(["allow_log_view"], false),ctx,"h").w("/></label></div><div id=\"allow_log_view_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_pause\">").f(ctx.get(["tAllow client-side pausing of backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_pause\" ").f(ctx.get(["allow_pause"], false),ctx,"h").w("/></label></div><div id=\"allow_pause_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_verwrite\">").f(ctx.get(["tAllow client-side changing of settings"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_overwrite\" ").f(ctx.get(["allow_overwrite"], false),ctx,"h").w("/></label></div><div id=\"allow_overwrite_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_tray_exit\">").f(ctx.get(["tAllow clients to quit the tray icon"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_tray_exit\" ").f(ctx.get(["allow_tray_exit"], false),ctx,"h").w("/></label></div><div id=\"allow_tray_exit_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_file_restore\">").f(ctx.get(["tAllow clients to start file restores"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_file_restore\" ").f(ctx.get(["allow_file_restore"], false),ctx,"h").w("/></label></div><div id=\"allow_file_restore_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_component_config\">").f(ctx.get(["tAllow clients to configure components to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_component_config\" ").f(ctx.get(["allow_component_config"], false),ctx,"h").w("/></label></div><div id=\"allow_component_config_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_component_restore\">").f(ctx.get(["tAllow clients to start component restores"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_component_restore\" ").f(ctx.get(["allow_component_restore"], false),ctx,"h").w("/></label></div><div id=\"allow_component_restore_sw\" style=\"display: inline\"></div></div></form></div></div></div>");}body_4.__dustBody=!0;function body_5(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"startup_backup_delay\">").f(ctx.get(["tDelay after system startup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"startup_backup_delay\" value=\"").f(ctx.get(["startup_backup_delay"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMin"], false),ctx,"h").w("</div></div></div><div id=\"startup_backup_delay_sw\" style=\"display: inline\"></div></div>");}body_5.__dustBody=!0;function body_6(chk,ctx){return chk.f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"computername\">").f(ctx.get(["tComputer name"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"computername\" value=\"").f(ctx.get(["computername"], false),ctx,"h").w("\"/></div><div id=\"computername_sw\" style=\"display: inline\"></div></div>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]);}body_6.__dustBody=!0;function body_7(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"silent_update\">").f(ctx.get(["tPerform autoupdates silently"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"silent_update\" ").f(ctx.get(["silent_update"], false),ctx,"h").w("/></label></div><div id=\"silent_update_sw\" style=\"display: inline\"></div></div>");}body_7.__dustBody=!0;function body_8(chk,ctx){return chk.f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"virtual_clients\">").f(ctx.get(["tVirtual sub client names"], false),ctx,"h").w("</label><div class=\"col-sm-6\" id=\"virtual_clients_div\"><input type=\"text\" class=\"form-control\" id=\"virtual_clients\" value=\"").f(ctx.get(["virtual_clients"], false),ctx,"h").w("\"/></div><div id=\"virtual_clients_sw\" style=\"display: inline\"></div></div>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]);}body_8.__dustBody=!0;function body_9(chk,ctx){return chk.w("<input type=\"button\" class=\"btn btn-sm btn-default\" value=\"").f(ctx.get(["tAdd"], false),ctx,"h").w("\" id=\"archive_add\" onclick=\"addArchiveItem(true)\" />");}body_9.__dustBody=!0;function body_10(chk,ctx){return chk.w("<a href=\"javascript: show_scripts1()\">").f(ctx.get(["tEdit scripts"], false),ctx,"h").w("</a>");}body_10.__dustBody=!0;function body_11(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_mode_enabled\">").f(ctx.get(["tEnable internet mode (requires server restart)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_mode_enabled\" value=\"false\" ").f(ctx.get(["internet_mode_enabled"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_server\">").f(ctx.get(["tInternet server name/IP"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"internet_server\" value=\"").f(ctx.get(["internet_server"], false),ctx,"h",["s"]).w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_server_port\">").f(ctx.get(["tInternet server port"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"internet_server_port\" value=\"").f(ctx.get(["internet_server_port"], false),ctx,"h").w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_server_proxy\">").f(ctx.get(["tConnect via HTTP(S) proxy (leave empty to connect without)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"internet_server_proxy\" value=\"").f(ctx.get(["internet_server_proxy"], false),ctx,"h",["s"]).w("\"/></div></div>");}body_11.__dustBody=!0;function body_12(chk,ctx){return chk.nx(ctx.get(["global_settings"], false),ctx,{"block":body_13},{}).x(ctx.get(["with_authkey"], false),ctx,{"block":body_14},{});}body_12.__dustBody=!0;function body_13(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_mode_enabled\">").f(ctx.get(["tEnable internet mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_mode_enabled\" value=\"false\" ").f(ctx.get(["internet_mode_enabled"], false),ctx,"h").w("/></label></div><div id=\"internet_mode_enabled_sw\" style=\"display: inline\"></div></div>");}body_13.__dustBody=!0;function body_14(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_authkey\">").f(ctx.get(["tInternet auth key"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"internet_authkey\" value=\"").f(ctx.get(["internet_authkey"], false),ctx,"h",["s"]).w("\"/></label></div></div>");}body_14.__dustBody=!0;function body_15(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"global_internet_speed\">").f(ctx.get(["tTotal max backup speed for internet connection"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"global_internet_speed\" value=\"").f(ctx.get(["global_internet_speed"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">KBit/s</div></div></div><div id=\"global_internet_speed_sw\" style=\"display: inline\"></div></div>");}body_15.__dustBody=!0;function body_16(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_encrypt\">").f(ctx.get(["tEncrypted transfer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_encrypt\" value=\"false\" ").f(ctx.get(["internet_encrypt"], false),ctx,"h").w("/></label></div><div id=\"internet_encrypt_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_compress\">").f(ctx.get(["tCompressed transfer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_compress\" value=\"false\" ").f(ctx.get(["internet_compress"], false),ctx,"h").w("/></label></div><div id=\"internet_compress_sw\" style=\"display: inline\"></div></div>");}body_16.__dustBody=!0;function body_17(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_connect_always\">").f(ctx.get(["tConnect to Internet backup server if connected to local backup server"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_connect_always\" value=\"false\" ").f(ctx.get(["internet_connect_always"], false),ctx,"h").w("/></label></div><div id=\"internet_connect_always_sw\" style=\"display: inline\"></div></div>");}body_17.__dustBody=!0;function body_18(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_dataplan_db\">").f(ctx.get(["tUpdate data limit estimation database"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"update_dataplan_db\" value=\"true\" ").f(ctx.get(["update_dataplan_db"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"restore_authkey\">").f(ctx.get(["tInternet restore authentication key"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"restore_authkey\" value=\"").f(ctx.get(["restore_authkey"], false),ctx,"h",["s"]).w("\"/></div></div>");}body_18.__dustBody=!0;function body_19(chk,ctx){return chk.w("</div>");}body_19.__dustBody=!0;return body_0;})();
+(function(){dust.register("settings_inv_row",body_0);function body_0(chk,ctx){return chk.x(ctx.get(["client_settings"], false),ctx,{"else":body_1,"block":body_2},{}).w("<div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_incr\">").f(ctx.get(["tInterval for incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_incr\" value=\"").f(ctx.get(["update_freq_incr"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["thours"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_incr_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_incr_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_full\">").f(ctx.get(["tInterval for full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_full\" value=\"").f(ctx.get(["update_freq_full"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tdays"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_full_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_full_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div>\t\t\t\t</div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_file_incr\">").f(ctx.get(["tMaximal number of incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_file_incr\" value=\"").f(ctx.get(["max_file_incr"], false),ctx,"h").w("\"/></div><div id=\"max_file_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_file_incr\">").f(ctx.get(["tMinimal number of incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_file_incr\" value=\"").f(ctx.get(["min_file_incr"], false),ctx,"h").w("\"/></div><div id=\"min_file_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_file_full\">").f(ctx.get(["tMaximal number of full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_file_full\" value=\"").f(ctx.get(["max_file_full"], false),ctx,"h").w("\"/></div><div id=\"max_file_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_file_full\">").f(ctx.get(["tMinimal number of full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_file_full\" value=\"").f(ctx.get(["min_file_full"], false),ctx,"h").w("\"/></div><div id=\"min_file_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"exclude_files\">").f(ctx.get(["tExcluded files (with wildcards)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"exclude_files_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"exclude_files\" value=\"").f(ctx.get(["exclude_files"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#exclude_files\" target=\"_blank\">?</a></div></div></div><div id=\"exclude_files_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"include_files\">").f(ctx.get(["tIncluded files (with wildcards)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"include_files_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"include_files\" value=\"").f(ctx.get(["include_files"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#include_files\" target=\"_blank\">?</a></div></div></div><div id=\"include_files_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"default_dirs\">").f(ctx.get(["tDefault directories to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"default_dirs_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"default_dirs\" value=\"").f(ctx.get(["default_dirs"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#default_dirs\" target=\"_blank\">?</a></div></div></div><div id=\"default_dirs_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backup_dirs_optional\">").f(ctx.get(["tDirectories to backup are optional by default:"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"backup_dirs_optional\" ").f(ctx.get(["backup_dirs_optional"], false),ctx,"h").w("/></label></div><div id=\"backup_dirs_optional_sw\" style=\"display: inline\"></div></div></form></div></div></div><div class=\"tab-pane\" id=\"image_backups\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_image_incr\">").f(ctx.get(["tInterval for incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_image_incr\" value=\"").f(ctx.get(["update_freq_image_incr"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tdays"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_image_incr_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_image_incr_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_image_full\">").f(ctx.get(["tInterval for full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_image_full\" value=\"").f(ctx.get(["update_freq_image_full"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tDays"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_image_full_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_image_full_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_image_incr\">").f(ctx.get(["tMaximal number of incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_image_incr\" value=\"").f(ctx.get(["max_image_incr"], false),ctx,"h").w("\"/></div><div id=\"max_image_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_image_incr\">").f(ctx.get(["tMinimal number of incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_image_incr\" value=\"").f(ctx.get(["min_image_incr"], false),ctx,"h").w("\"/></div><div id=\"min_image_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_image_full\">").f(ctx.get(["tMaximal number of full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_image_full\" value=\"").f(ctx.get(["max_image_full"], false),ctx,"h").w("\"/></div><div id=\"max_image_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_image_full\">").f(ctx.get(["tMinimal number of full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_image_full\" value=\"").f(ctx.get(["min_image_full"], false),ctx,"h").w("\"/></div><div id=\"min_image_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_letters\">").f(ctx.get(["tVolumes to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"image_letters_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"image_letters\" value=\"").f(ctx.get(["image_letters"], false),ctx,"h",["s","h"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#image_letters\" target=\"_blank\">?</a></div></div></div><div id=\"image_letters_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_file_format\">").f(ctx.get(["tImage backup file format"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"image_file_format\"><option value=\"vhdz\" ").f(ctx.get(["image_file_format_0"], false),ctx,"h").w(">").f(ctx.get(["tCompressed VHD (Compressed non-standard Virtual HardDisk)"], false),ctx,"h").w("</option><option value=\"vhd\" ").f(ctx.get(["image_file_format_1"], false),ctx,"h").w(">").f(ctx.get(["tVHD (Virtual HardDisk)"], false),ctx,"h").w("</option>").x(ctx.get(["cowraw_available"], false),ctx,{"block":body_3},{}).w("</select></div><div id=\"image_file_format_sw\" style=\"display: inline\"></div></div></form></div></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_4},{}).w("<div class=\"tab-pane\" id=\"client\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\">").x(ctx.get(["main_client"], false),ctx,{"block":body_5},{}).w("<div class=\"form-group\" id=\"backup_window_row\"><label class=\"col-sm-4 control-label\">").f(ctx.get(["tBackup window"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window\" value=\"").f(ctx.get(["backup_window"], false),ctx,"h",["s"]).w("\" onchange=\"backupWindowChange()\"/><div class=\"input-group-addon\"><a href=\"javascript: showBackupWindowDetails()\">").f(ctx.get(["tShow details"], false),ctx,"h").w("</a>&nbsp;&nbsp;<a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_incr_file_row\"><label class=\"col-sm-4 control-label\">").f(ctx.get(["tBackup window for incremental file backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_incr_file\" value=\"").f(ctx.get(["backup_window_incr_file"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_incr_file_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_full_file_row\"><label class=\"col-sm-4 control-label\" for=\"backup_window_full_file\">").f(ctx.get(["tBackup window for full file backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_full_file\" value=\"").f(ctx.get(["backup_window_full_file"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_full_file_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_incr_image_row\"><label class=\"col-sm-4 control-label\" for=\"backup_window_incr_image\">").f(ctx.get(["tBackup window for incremental image backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_incr_image\" value=\"").f(ctx.get(["backup_window_incr_image"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_incr_image_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_full_image_row\"><label class=\"col-sm-4 control-label\" for=\"backup_window_full_image\">").f(ctx.get(["tBackup window for full image backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_full_image\" value=\"").f(ctx.get(["backup_window_full_image"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_full_image_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_6},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_speed\">").f(ctx.get(["tMax backup speed for local network"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"local_speed\" value=\"").f(ctx.get(["local_speed"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">MBit/s</div></div></div><div id=\"local_speed_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_7},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"client_quota\">").f(ctx.get(["tSoft client quota"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"client_quota\" value=\"").f(ctx.get(["client_quota"], false),ctx,"h").w("\"/></div><div id=\"client_quota_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_8},{}).w("</form></div></div></div><div class=\"tab-pane\" id=\"archive\"><div class=\"panel panel-default\"><div class=\"panel-body\"><div id=\"archive_sw\" style=\"float: right; margin-left: 10pt; margin-right: 10pt\"></div><table class=\"table table-striped\" id=\"archive_table\"><thead><tr><th>").f(ctx.get(["tArchive every"], false),ctx,"h").w("</th><th>").f(ctx.get(["tArchive for"], false),ctx,"h").w("</th><th>").f(ctx.get(["tArchive window"], false),ctx,"h").w(" <a class=\"btn btn-xs btn-default\" href=\"help.htm#archive_window\" target=\"_blank\" title=\"h;dom;mon;dow\">?</a></th><th>").f(ctx.get(["tBackup type"], false),ctx,"h").w("</th><th>").f(ctx.get(["tVolume letters"], false),ctx,"h").w("</th>").f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<th>").f(ctx.get(["tNext archival"], false),ctx,"h").w("</th>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]).w("<th>&nbsp;</th><th>&nbsp;</th></tr></thead><tbody><tr><td><div style=\"float: left; width: 60%\"><input class=\"form-control\" type=\"text\" id=\"archive_every\"></div><select class=\"form-control\" style=\"width: 40%\" id=\"archive_every_unit\"><option value=\"h\">").f(ctx.get(["thours"], false),ctx,"h").w("</option><option value=\"d\" selected=\"selected\">").f(ctx.get(["tdays"], false),ctx,"h").w("</option><option value=\"w\">").f(ctx.get(["tweeks"], false),ctx,"h").w("</option><option value=\"m\">").f(ctx.get(["tmonth"], false),ctx,"h").w("</option><option value=\"y\">").f(ctx.get(["tyears"], false),ctx,"h").w("</option></select></td><td><div style=\"float: left; width: 60%\"><input class=\"form-control\" type=\"text\" id=\"archive_for\"></div><select class=\"form-control\" style=\"width: 40%\" onchange=\"changeArchiveForUnit()\" id=\"archive_for_unit\"><option value=\"h\">").f(ctx.get(["thours"], false),ctx,"h").w("</option><option value=\"d\" selected=\"selected\">").f(ctx.get(["tdays"], false),ctx,"h").w("</option><option value=\"w\">").f(ctx.get(["tweeks"], false),ctx,"h").w("</option><option value=\"m\">").f(ctx.get(["tmonth"], false),ctx,"h").w("</option><option value=\"y\">").f(ctx.get(["tyears"], false),ctx,"h").w("</option><option value=\"i\">").f(ctx.get(["tforever"], false),ctx,"h").w("</option></select></td><td><input class=\"form-control\" type=\"text\" id=\"archive_window\" value=\"*;*;*;*\"></td><td><select class=\"form-control\" id=\"archive_backup_type\" onchange=\"changeArchiveBackupType()\"><option value=\"file\">").f(ctx.get(["tFile backup"], false),ctx,"h").w("</option><option value=\"incr_file\">").f(ctx.get(["tIncremental file backup"], false),ctx,"h").w("</option><option value=\"full_file\">").f(ctx.get(["tFull file backup"], false),ctx,"h").w("</option><option value=\"image\">").f(ctx.get(["tImage backup"], false),ctx,"h").w("</option><option value=\"incr_image\">").f(ctx.get(["tIncremental image backup"], false),ctx,"h").w("</option><option value=\"full_image\">").f(ctx.get(["tFull image backup"], false),ctx,"h").w("</option></select></td><td><input class=\"form-control\" type=\"text\" id=\"archive_letters\" value=\"ALL\" disabled=\"disabled\"></td>").f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<td>&nbsp;</td>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]).w("<td></td><td>").x(ctx.get(["archive_global"], false),ctx,{"block":body_9},{}).f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<input type=\"button\" class=\"btn btn-sm btn-default\" value=\"").f(ctx.get(["tAdd"], false),ctx,"h").w("\" id=\"archive_add\" onclick=\"addArchiveItem(false)\" />").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]).w("\t\t</td></tr></tbody></table></div></div></div><div class=\"tab-pane\" id=\"alerts\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"alert_script\">").f(ctx.get(["tAlert script"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"alert_script\" onChange=\"updateAlertScriptParams()\">").f(ctx.get(["alert_scripts"], false),ctx,"h",["s"]).w("</select></div>").x(ctx.get(["can_edit_scripts"], false),ctx,{"block":body_10},{}).w("<div id=\"alert_script_sw\" style=\"float: right; margin-left: 10pt; margin-right: 10pt\"></div></div>\t\t\t<div id=\"alert_script_params_container\">").f(ctx.get(["mod_alert_params"], false),ctx,"h",["s"]).w("</div></form></div></div></div>").f(ctx.get(["internet_settings_start"], false),ctx,"h",["s"]).w("<div class=\"tab-pane\" id=\"internet\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\">").x(ctx.get(["global_settings"], false),ctx,{"block":body_11},{}).x(ctx.get(["main_client"], false),ctx,{"block":body_12},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_image_backups\">").f(ctx.get(["tDo image backups over internet"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_image_backups\" value=\"false\" ").f(ctx.get(["internet_image_backups"], false),ctx,"h").w("/></label></div><div id=\"internet_image_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_full_file_backups\">").f(ctx.get(["tDo full file backups over internet"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_full_file_backups\" value=\"false\" ").f(ctx.get(["internet_full_file_backups"], false),ctx,"h").w("/></label></div><div id=\"internet_full_file_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_speed\">").f(ctx.get(["tMax backup speed for internet connection"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"internet_speed\" value=\"").f(ctx.get(["internet_speed"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">KBit/s</div></div></div><div id=\"internet_speed_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["global_settings"], false),ctx,{"block":body_15},{}).x(ctx.get(["main_client"], false),ctx,{"block":body_16},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_calculate_filehashes_on_client\">").f(ctx.get(["tCalculate file-hashes on the client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_calculate_filehashes_on_client\" value=\"false\" ").f(ctx.get(["internet_calculate_filehashes_on_client"], false),ctx,"h").w("/></label></div><div id=\"internet_calculate_filehashes_on_client_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_parallel_file_hashing\">Beta: Calculate file hashes on client in parallel:</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_parallel_file_hashing\" value=\"false\" ").f(ctx.get(["internet_parallel_file_hashing"], false),ctx,"h").w("/></label></div><div id=\"internet_parallel_file_hashing_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_17},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_file_dataplan_limit\">").f(ctx.get(["tDo not start file backups if current estimated data usage limit per month is smaller than"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"internet_file_dataplan_limit\" value=\"").f(ctx.get(["internet_file_dataplan_limit"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMB"], false),ctx,"h").w("</div></div></div><div id=\"internet_file_dataplan_limit_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_image_dataplan_limit\">").f(ctx.get(["tDo not start image backups if current estimated data usage limit per month is smaller than"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"internet_image_dataplan_limit\" value=\"").f(ctx.get(["internet_image_dataplan_limit"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMB"], false),ctx,"h").w("</div></div></div><div id=\"internet_image_dataplan_limit_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["global_settings"], false),ctx,{"block":body_18},{}).w("</form></div></div></div>").f(ctx.get(["internet_settings_end"], false),ctx,"h",["s"]).w("<div class=\"tab-pane\" id=\"advanced\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\">").f(ctx.get(["global_settings_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"use_tmpfiles\">").f(ctx.get(["tTemporary files as file backup buffer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"use_tmpfiles\" value=\"false\" ").f(ctx.get(["use_tmpfiles"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"use_tmpfiles_images\">").f(ctx.get(["tTemporary files as image backup buffer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"use_tmpfiles_images\" value=\"false\" ").f(ctx.get(["use_tmpfiles_images"], false),ctx,"h").w("/></label></div></div>").f(ctx.get(["global_settings_end"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_full_file_transfer_mode\">").f(ctx.get(["tLocal full file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_full_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["local_full_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["local_full_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"local_full_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_full_file_transfer_mode\">").f(ctx.get(["tInternet full file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_full_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["internet_full_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["internet_full_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"internet_full_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_incr_file_transfer_mode\">").f(ctx.get(["tLocal incremental file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_incr_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["local_incr_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["local_incr_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option><option value=\"blockhash\" ").f(ctx.get(["local_incr_file_transfer_mode_2"], false),ctx,"h").w(">").f(ctx.get(["tBlock differences - hashed"], false),ctx,"h").w("</option></select></div><div id=\"local_incr_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_incr_file_transfer_mode\">").f(ctx.get(["tInternet incremental file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_incr_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["internet_incr_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["internet_incr_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option><option value=\"blockhash\" ").f(ctx.get(["internet_incr_file_transfer_mode_2"], false),ctx,"h").w(">").f(ctx.get(["tBlock differences - hashed"], false),ctx,"h").w("</option></select></div><div id=\"internet_incr_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_image_transfer_mode\">").f(ctx.get(["tLocal image backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_image_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["local_image_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["local_image_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"local_image_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_image_transfer_mode\">").f(ctx.get(["tInternet image backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_image_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["internet_image_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["internet_image_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"internet_image_transfer_mode_sw\" style=\"display: inline\"></div></div>\t\t\t<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_incr_image_style\">").f(ctx.get(["tLocal incremental image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_incr_image_style\"><option value=\"to-full\" ").f(ctx.get(["local_incr_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tBased on last full image backup"], false),ctx,"h").w("</option><option value=\"to-last\" ").f(ctx.get(["local_incr_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tBased on last image backup"], false),ctx,"h").w("</option></select></div><div id=\"local_incr_image_style_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_incr_image_style\">").f(ctx.get(["tInternet incremental image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_incr_image_style\"><option value=\"to-full\" ").f(ctx.get(["internet_incr_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tBased on last full image backup"], false),ctx,"h").w("</option><option value=\"to-last\" ").f(ctx.get(["internet_incr_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tBased on last image backup"], false),ctx,"h").w("</option></select></div><div id=\"internet_incr_image_style_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_full_image_style\">").f(ctx.get(["tLocal full image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_full_image_style\"><option value=\"full\" ").f(ctx.get(["local_full_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tFull image backup #1"], false),ctx,"h").w("</option><option value=\"synthetic\" ").f(ctx.get(["local_full_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tSynthetic full image backup"], false),ctx,"h").w("</option></select></div><div id=\"local_full_image_style_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_full_image_style\">").f(ctx.get(["tInternet full image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_full_image_style\"><option value=\"full\" ").f(ctx.get(["internet_full_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tFull image backup #1"], false),ctx,"h").w("</option><option value=\"synthetic\" ").f(ctx.get(["internet_full_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tSynthetic full image backup"], false),ctx,"h").w("</option></select></div><div id=\"internet_full_image_style_sw\" style=\"display: inline\"></div></div>").f(ctx.get(["global_settings_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_stats_cachesize\">").f(ctx.get(["tDatabase cache size during batch processing"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_stats_cachesize\" value=\"").f(ctx.get(["update_stats_cachesize"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMB"], false),ctx,"h").w("</div></div></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"use_incremental_symlinks\">").f(ctx.get(["tUse symlinks during incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"use_incremental_symlinks\" value=\"false\" ").f(ctx.get(["use_incremental_symlinks"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_expect_endpoint\">").f(ctx.get(["tList of server IPs (proxys) from which to expect endpoint information (forwarded for) when connecting to Internet service (needs server restart)"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"internet_expect_endpoint\" value=\"").f(ctx.get(["internet_expect_endpoint"], false),ctx,"h").w("\"/></label></div></div>").f(ctx.get(["global_settings_end"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"end_to_end_file_backup_verification\">").f(ctx.get(["tDebugging: End-to-end verification of all file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"end_to_end_file_backup_verification\" value=\"false\" ").f(ctx.get(["end_to_end_file_backup_verification"], false),ctx,"h").w("/></label></div><div id=\"end_to_end_file_backup_verification_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"verify_using_client_hashes\">").f(ctx.get(["tDebugging: Verify file backups using client side hashes"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"verify_using_client_hashes\" value=\"false\" ").f(ctx.get(["verify_using_client_hashes"], false),ctx,"h").w("/></label></div><div id=\"verify_using_client_hashes_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_readd_file_entries\">").f(ctx.get(["tPeriodically readd file entries of internet clients to database (disable only if you do not run fulls)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_readd_file_entries\" value=\"true\" ").f(ctx.get(["internet_readd_file_entries"], false),ctx,"h").w("/></label></div><div id=\"internet_readd_file_entries_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"background_backups\">").f(ctx.get(["tRun backups with background priority on the clients"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"background_backups\" value=\"true\" ").f(ctx.get(["background_backups"], false),ctx,"h").w("/></label></div><div id=\"background_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"create_linked_user_views\">").f(ctx.get(["tCreate symbolically linked views for each user on the clients after file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"create_linked_user_views\" value=\"true\" ").f(ctx.get(["create_linked_user_views"], false),ctx,"h").w("/></label></div><div id=\"create_linked_user_views_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_running_jobs_per_client\">").f(ctx.get(["tMaximum number of simultaneous jobs per client"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"max_running_jobs_per_client\" value=\"").f(ctx.get(["max_running_jobs_per_client"], false),ctx,"h").w("\"/></label></div><div id=\"max_running_jobs_per_client_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"file_hash_threads\">").f(ctx.get(["tNumber of threads for file hashing and copying during file backups (0: number of CPU cores)"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"file_hash_threads\" value=\"").f(ctx.get(["file_hash_threads"], false),ctx,"h").w("\"/></label></div><div id=\"file_hash_threads_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"file_download_connections\">").f(ctx.get(["tNumber of parallel connections for downloading files during file backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"file_download_connections\" value=\"").f(ctx.get(["file_download_connections"], false),ctx,"h").w("\"/></label></div><div id=\"file_download_connections_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_compress\">").f(ctx.get(["tCompress transfers in the local network (if supported by the client)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"local_compress\" value=\"true\" ").f(ctx.get(["local_compress"], false),ctx,"h").w("/></label></div><div id=\"local_compress_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_compression_level\">").f(ctx.get(["tCompression level for transfers in the local network (0: adaptive)"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"local_compression_level\" value=\"").f(ctx.get(["local_compression_level"], false),ctx,"h").w("\"/></label></div><div id=\"local_compression_level_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"cbt_volumes\">").f(ctx.get(["tList of volumes for which change block tracking should be used (if available)"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"cbt_volumes\" value=\"").f(ctx.get(["cbt_volumes"], false),ctx,"h").w("\"/></label></div><div id=\"cbt_volumes_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"cbt_crash_persistent_volumes\">").f(ctx.get(["tList of volumes for which the change block tracking should be crash persistent"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"cbt_crash_persistent_volumes\" value=\"").f(ctx.get(["cbt_crash_persistent_volumes"], false),ctx,"h").w("\"/></label></div><div id=\"cbt_crash_persistent_volumes_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"ignore_disk_errors\">").f(ctx.get(["tDo not fail backups in case of hash mismatches or read errors"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"ignore_disk_errors\" value=\"true\" ").f(ctx.get(["ignore_disk_errors"], false),ctx,"h").w("/></label></div><div id=\"ignore_disk_errors_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_snapshot_groups\">").f(ctx.get(["tVolumes to snapshot in groups during image backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"image_snapshot_groups\" value=\"").f(ctx.get(["image_snapshot_groups"], false),ctx,"h").w("\"/></label></div><div id=\"image_snapshot_groups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"file_snapshot_groups\">").f(ctx.get(["tVolumes to snapshot in groups during file backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"file_snapshot_groups\" value=\"").f(ctx.get(["file_snapshot_groups"], false),ctx,"h").w("\"/></label></div><div id=\"file_snapshot_groups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"vss_select_components\">").f(ctx.get(["tWindows components backup configuration"], false),ctx,"h").w("</label><div class=\"col-sm-6\" id=\"vss_select_components_div\"><label><input type=\"text\" class=\"form-control\" id=\"vss_select_components\" value=\"").f(ctx.get(["vss_select_components"], false),ctx,"h").w("\"/></label></div><div id=\"vss_select_components_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"client_settings_tray_access_pw\">").f(ctx.get(["tRequire tray icon users to enter following text before being able to change settings"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"client_settings_tray_access_pw\" value=\"").f(ctx.get(["client_settings_tray_access_pw"], false),ctx,"h").w("\"/></label></div></div></form></div></div></div>").x(ctx.get(["client_settings"], false),ctx,{"block":body_19},{});}body_0.__dustBody=!0;function body_1(chk,ctx){return chk.w("<div class=\"tab-pane\" id=\"file_backups\">");}body_1.__dustBody=!0;function body_2(chk,ctx){return chk.w("<div class=\"tab-pane active\" id=\"file_backups\">");}body_2.__dustBody=!0;function body_3(chk,ctx){return chk.w("<option value=\"cowraw\" ").f(ctx.get(["image_file_format_2"], false),ctx,"h").w(">").f(ctx.get(["tRaw copy-on-write file"], false),ctx,"h").w("</option>");}body_3.__dustBody=!0;function body_4(chk,ctx){return chk.w("<div class=\"tab-pane\" id=\"permissions\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_config_paths\">").f(ctx.get(["tAllow client-side changing of the directories to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_config_paths\" ").f(ctx.get(["allow_config_paths"], false),ctx,"h").w("/></label></div><div id=\"allow_config_paths_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_full_file_backups\">").f(ctx.get(["tAllow client-side starting of full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_starting_full_file_backups\" ").f(ctx.get(["allow_starting_full_file_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_full_file_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_incr_file_backups\">").f(ctx.get(["tAllow client-side starting of incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_starting_incr_file_backups\" ").f(ctx.get(["allow_starting_incr_file_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_incr_file_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_full_image_backups\">").f(ctx.get(["tAllow client-side starting of full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"checkbox\" id=\"allow_starting_full_image_backups\" ").f(ctx.get(["allow_starting_full_image_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_full_image_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_incr_image_backups\">").f(ctx.get(["tAllow client-side starting of incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_starting_incr_image_backups\" ").f(ctx.get(["allow_starting_incr_image_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_incr_image_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_log_view\">").f(ctx.get(["tAllow client-side viewing of backup logs"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_log_view\" ").f(ctx.get(["allow_log_view"], false),ctx,"h").w("/></label></div><div id=\"allow_log_view_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_pause\">").f(ctx.get(["tAllow client-side pausing of backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_pause\" ").f(ctx.get(["allow_pause"], false),ctx,"h").w("/></label></div><div id=\"allow_pause_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_verwrite\">").f(ctx.get(["tAllow client-side changing of settings"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_overwrite\" ").f(ctx.get(["allow_overwrite"], false),ctx,"h").w("/></label></div><div id=\"allow_overwrite_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_tray_exit\">").f(ctx.get(["tAllow clients to quit the tray icon"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_tray_exit\" ").f(ctx.get(["allow_tray_exit"], false),ctx,"h").w("/></label></div><div id=\"allow_tray_exit_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_file_restore\">").f(ctx.get(["tAllow clients to start file restores"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_file_restore\" ").f(ctx.get(["allow_file_restore"], false),ctx,"h").w("/></label></div><div id=\"allow_file_restore_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_component_config\">").f(ctx.get(["tAllow clients to configure components to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_component_config\" ").f(ctx.get(["allow_component_config"], false),ctx,"h").w("/></label></div><div id=\"allow_component_config_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_component_restore\">").f(ctx.get(["tAllow clients to start component restores"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_component_restore\" ").f(ctx.get(["allow_component_restore"], false),ctx,"h").w("/></label></div><div id=\"allow_component_restore_sw\" style=\"display: inline\"></div></div></form></div></div></div>");}body_4.__dustBody=!0;function body_5(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"startup_backup_delay\">").f(ctx.get(["tDelay after system startup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"startup_backup_delay\" value=\"").f(ctx.get(["startup_backup_delay"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMin"], false),ctx,"h").w("</div></div></div><div id=\"startup_backup_delay_sw\" style=\"display: inline\"></div></div>");}body_5.__dustBody=!0;function body_6(chk,ctx){return chk.f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"computername\">").f(ctx.get(["tComputer name"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"computername\" value=\"").f(ctx.get(["computername"], false),ctx,"h").w("\"/></div><div id=\"computername_sw\" style=\"display: inline\"></div></div>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]);}body_6.__dustBody=!0;function body_7(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"silent_update\">").f(ctx.get(["tPerform autoupdates silently"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"silent_update\" ").f(ctx.get(["silent_update"], false),ctx,"h").w("/></label></div><div id=\"silent_update_sw\" style=\"display: inline\"></div></div>");}body_7.__dustBody=!0;function body_8(chk,ctx){return chk.f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"virtual_clients\">").f(ctx.get(["tVirtual sub client names"], false),ctx,"h").w("</label><div class=\"col-sm-6\" id=\"virtual_clients_div\"><input type=\"text\" class=\"form-control\" id=\"virtual_clients\" value=\"").f(ctx.get(["virtual_clients"], false),ctx,"h").w("\"/></div><div id=\"virtual_clients_sw\" style=\"display: inline\"></div></div>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]);}body_8.__dustBody=!0;function body_9(chk,ctx){return chk.w("<input type=\"button\" class=\"btn btn-sm btn-default\" value=\"").f(ctx.get(["tAdd"], false),ctx,"h").w("\" id=\"archive_add\" onclick=\"addArchiveItem(true)\" />");}body_9.__dustBody=!0;function body_10(chk,ctx){return chk.w("<a href=\"javascript: show_scripts1()\">").f(ctx.get(["tEdit scripts"], false),ctx,"h").w("</a>");}body_10.__dustBody=!0;function body_11(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_mode_enabled\">").f(ctx.get(["tEnable internet mode (requires server restart)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_mode_enabled\" value=\"false\" ").f(ctx.get(["internet_mode_enabled"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_server\">").f(ctx.get(["tInternet server name/IP"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"internet_server\" value=\"").f(ctx.get(["internet_server"], false),ctx,"h",["s"]).w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_server_port\">").f(ctx.get(["tInternet server port"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"internet_server_port\" value=\"").f(ctx.get(["internet_server_port"], false),ctx,"h").w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_server_proxy\">").f(ctx.get(["tConnect via HTTP(S) proxy (leave empty to connect without)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"internet_server_proxy\" value=\"").f(ctx.get(["internet_server_proxy"], false),ctx,"h",["s"]).w("\"/></div></div>");}body_11.__dustBody=!0;function body_12(chk,ctx){return chk.nx(ctx.get(["global_settings"], false),ctx,{"block":body_13},{}).x(ctx.get(["with_authkey"], false),ctx,{"block":body_14},{});}body_12.__dustBody=!0;function body_13(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_mode_enabled\">").f(ctx.get(["tEnable internet mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_mode_enabled\" value=\"false\" ").f(ctx.get(["internet_mode_enabled"], false),ctx,"h").w("/></label></div><div id=\"internet_mode_enabled_sw\" style=\"display: inline\"></div></div>");}body_13.__dustBody=!0;function body_14(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_authkey\">").f(ctx.get(["tInternet auth key"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"internet_authkey\" value=\"").f(ctx.get(["internet_authkey"], false),ctx,"h",["s"]).w("\"/></label></div></div>");}body_14.__dustBody=!0;function body_15(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"global_internet_speed\">").f(ctx.get(["tTotal max backup speed for internet connection"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"global_internet_speed\" value=\"").f(ctx.get(["global_internet_speed"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">KBit/s</div></div></div><div id=\"global_internet_speed_sw\" style=\"display: inline\"></div></div>");}body_15.__dustBody=!0;function body_16(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_encrypt\">").f(ctx.get(["tEncrypted transfer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_encrypt\" value=\"false\" ").f(ctx.get(["internet_encrypt"], false),ctx,"h").w("/></label></div><div id=\"internet_encrypt_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_compress\">").f(ctx.get(["tCompressed transfer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_compress\" value=\"false\" ").f(ctx.get(["internet_compress"], false),ctx,"h").w("/></label></div><div id=\"internet_compress_sw\" style=\"display: inline\"></div></div>");}body_16.__dustBody=!0;function body_17(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_connect_always\">").f(ctx.get(["tConnect to Internet backup server if connected to local backup server"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_connect_always\" value=\"false\" ").f(ctx.get(["internet_connect_always"], false),ctx,"h").w("/></label></div><div id=\"internet_connect_always_sw\" style=\"display: inline\"></div></div>");}body_17.__dustBody=!0;function body_18(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_dataplan_db\">").f(ctx.get(["tUpdate data limit estimation database"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"update_dataplan_db\" value=\"true\" ").f(ctx.get(["update_dataplan_db"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"restore_authkey\">").f(ctx.get(["tInternet restore authentication key"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"restore_authkey\" value=\"").f(ctx.get(["restore_authkey"], false),ctx,"h",["s"]).w("\"/></div></div>");}body_18.__dustBody=!0;function body_19(chk,ctx){return chk.w("</div>");}body_19.__dustBody=!0;return body_0;})();
 (function(){dust.register("settings_user_create",body_0);function body_0(chk,ctx){return chk.w("<br /><div class=\"panel panel-primary\"><div class=\"panel-body\"><form class=\"form-horizontal\" action=\"#\" onsubmit=\"createUser2(); return false;\"><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"username\">").f(ctx.get(["tUsername"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"username\" value=\"\"/></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"password1\">").f(ctx.get(["tPassword"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"password\" class=\"form-control\" id=\"password1\" value=\"\" /></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"password2\">").f(ctx.get(["tRepeat password"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"password\" class=\"form-control\" id=\"password2\" value=\"\"/></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\">").f(ctx.get(["tRights for"], false),ctx,"h").w(":</label><div class=\"col-sm-6\">").f(ctx.get(["rights"], false),ctx,"h",["s"]).w("</div></div><input type=\"button\" value=\"").f(ctx.get(["tCancel"], false),ctx,"h").w("\" onclick=\"userSettings()\" class=\"btn btn-default\"> <input type=\"submit\" value=\"").f(ctx.get(["tCreate"], false),ctx,"h").w("\" class=\"btn btn-primary\"/></form></div></div>");}body_0.__dustBody=!0;return body_0;})();
 (function(){dust.register("settings_users_start",body_0);function body_0(chk,ctx){return chk.w("<br /><div class=\"panel panel-default\"><div class=\"panel-body\"><table class=\"table table-striped\"><thead><tr>\t\t\t<th>").f(ctx.get(["tUsername"], false),ctx,"h").w("</th><th>").f(ctx.get(["tRights"], false),ctx,"h").w("</th><th>").f(ctx.get(["tActions"], false),ctx,"h").w("</th></tr></thead><tbody>").f(ctx.get(["rows"], false),ctx,"h",["s"]).w("</tbody></table><input type=\"button\" class=\"btn btn-default\" value=\"").f(ctx.get(["tCreate user"], false),ctx,"h").w("\" onclick=\"createUser()\"/></div></div>");}body_0.__dustBody=!0;return body_0;})();
 (function(){dust.register("settings_users_start_row",body_0);function body_0(chk,ctx){return chk.w("<tr><td>").f(ctx.get(["name"], false),ctx,"h").w("</td><td>").f(ctx.get(["rights"], false),ctx,"h").w("</td><td>").x(ctx.get(["can_change"], false),ctx,{"block":body_1},{}).w("<input type=\"button\" class=\"btn btn-xs btn-default\" value=\"").f(ctx.get(["tChange password"], false),ctx,"h").w("\" onclick=\"changeUserPassword(").f(ctx.get(["id"], false),ctx,"h").w(", '").f(ctx.get(["name"], false),ctx,"h").w("')\" /></td></tr>");}body_0.__dustBody=!0;function body_1(chk,ctx){return chk.w("<input type=\"button\" class=\"btn btn-xs btn-danger\" value=\"").f(ctx.get(["tRemove"], false),ctx,"h").w("\" onclick=\"deleteUser(").f(ctx.get(["id"], false),ctx,"h").w(")\" /> <input type=\"button\" class=\"btn btn-xs btn-default\" value=\"").f(ctx.get(["tChange rights"], false),ctx,"h").w("\" onclick=\"changeUserRights(").f(ctx.get(["id"], false),ctx,"h").w(", '").f(ctx.get(["name"], false),ctx,"h").w("')\" />");}body_1.__dustBody=!0;return body_0;})();
@@ -1708,6 +1708,12 @@ translations.en = {
 "tRun backups with background priority on the clients": "Run backups with background priority on the clients",
 "tCreate symbolically linked views for each user on the clients after file backups": "Create symbolically linked views for each user on the clients after file backups",
 "tMaximum number of simultaneous jobs per client": "Maximum number of simultaneous jobs per client",
+"tNumber of threads for file hashing and copying during file backups (0: number of CPU cores)": "Number of threads for file hashing and copying during file backups (0: number of CPU cores)",
+"tNumber of parallel connections for downloading files during file backups": "Number of parallel connections for downloading files during file backups",
+"tCompress transfers in the local network (if supported by the client)": "Compress transfers in the local network (if supported by the client)",
+"tCompression level for transfers in the local network (0: adaptive)": "Compression level for transfers in the local network (0: adaptive)",
+"tSaved by transfer compression": "Saved by transfer compression",
+"tCPU time": "CPU time",
 "tList of volumes for which change block tracking should be used (if available)": "List of volumes for which change block tracking should be used (if available)",
 "tList of volumes for which the change block tracking should be crash persistent": "List of volumes for which the change block tracking should be crash persistent",
 "tEnable logins via LDAP/AD": "Enable logins via LDAP/AD",
@@ -687,7 +687,16 @@ function show_progress2(data)
 			
 			rows+=dustRender("progress_row", data.progress[i]);
 		}
-		tdata=dustRender("progress_table", {"rows": rows});
+		var table_params = {"rows": rows};
+		
+		if(data.compression_stats && data.compression_stats.bytes_saved>0)
+		{
+			table_params.compression_saved = format_size(data.compression_stats.bytes_saved);
+			table_params.compression_cpu_time = format_time_seconds(Math.round((data.compression_stats.compress_time_ms
+				+ data.compression_stats.decompress_time_ms)/1000));
+		}
+		
+		tdata=dustRender("progress_table", table_params);
 	}
 	else
 	{
@@ -4112,6 +4121,10 @@ g.settings_list=[
 "internet_incr_image_style",
 "internet_full_image_style",
 "max_running_jobs_per_client",
+"file_hash_threads",
+"file_download_connections",
+"local_compress",
+"local_compression_level",
 "cbt_volumes",
 "cbt_crash_persistent_volumes",
 "ignore_disk_errors",